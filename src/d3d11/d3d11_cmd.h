@@ -2,6 +2,8 @@
 
 #include "d3d11_include.h"
 
+#include "../dxvk/dxvk_include.h"
+
 namespace dxvk {
 
   /**
@@ -13,6 +15,7 @@ namespace dxvk {
   enum class D3D11CmdType {
     DrawIndirect,
     DrawIndirectIndexed,
+    UpdateBuffer,
   };
 
 
@@ -39,4 +42,24 @@ namespace dxvk {
     uint32_t            count;
   };
 
+
+
+  /**
+   * \brief Buffer update command data
+   * 
+   * Stores the ranges of a staging buffer to copy
+   * to the destination buffer. Multiple updates of
+   * the same buffer are copied with a single copy
+   * command. Buffer pointers are only used to check
+   * whether an update can be appended.
+   */
+  struct D3D11CmdUpdateBufferData : public D3D11CmdData {
+    constexpr static uint32_t MaxRegionCount = 16;
+
+    const void*         dstBuffer;
+    const void*         srcBuffer;
+    uint32_t            count;
+    VkBufferCopy        regions[MaxRegionCount];
+  };
+
 }
\ No newline at end of file
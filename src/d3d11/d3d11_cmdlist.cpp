@@ -49,12 +49,38 @@ namespace dxvk {
   }
   
   
+  void D3D11CommandList::TrackBufferRename(DxvkBuffer* pBuffer) {
+    m_renamedBuffers.insert(pBuffer);
+    m_usedBuffers.insert(pBuffer);
+  }
+  
+  
+  void D3D11CommandList::TrackBufferUse(DxvkBuffer* pBuffer) {
+    m_usedBuffers.insert(pBuffer);
+  }
+  
+  
+  void D3D11CommandList::MarkOrderDependent() {
+    m_orderDependent = true;
+  }
+  
+  
   void D3D11CommandList::EmitToCommandList(ID3D11CommandList* pCommandList) {
     auto cmdList = static_cast<D3D11CommandList*>(pCommandList);
     
     for (const auto& chunk : m_chunks)
       cmdList->m_chunks.push_back(chunk);
     
+    cmdList->m_renamedBuffers.insert(
+      m_renamedBuffers.begin(),
+      m_renamedBuffers.end());
+    
+    cmdList->m_usedBuffers.insert(
+      m_usedBuffers.begin(),
+      m_usedBuffers.end());
+    
+    cmdList->m_orderDependent |= m_orderDependent;
+    
     MarkSubmitted();
   }
   
@@ -67,6 +93,15 @@ namespace dxvk {
   }
   
   
+  bool D3D11CommandList::EmitToCsBatch(DxvkCsBatch* CsBatch) {
+    if (!CsBatch->addCommandList(m_chunks, m_renamedBuffers, m_usedBuffers))
+      return false;
+    
+    MarkSubmitted();
+    return true;
+  }
+  
+  
   void D3D11CommandList::MarkSubmitted() {
     if (m_submitted.exchange(true) && !m_warned.exchange(true)
      && m_device->GetOptions()->dcSingleUseMode) {
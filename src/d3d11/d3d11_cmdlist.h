@@ -1,5 +1,9 @@
 #pragma once
 
+#include <unordered_set>
+
+#include "../dxvk/dxvk_cs_pool.h"
+
 #include "d3d11_context.h"
 
 namespace dxvk {
@@ -26,12 +30,27 @@ namespace dxvk {
     void AddChunk(
             DxvkCsChunkRef&&    Chunk);
     
+    void TrackBufferRename(
+            DxvkBuffer*         pBuffer);
+    
+    void TrackBufferUse(
+            DxvkBuffer*         pBuffer);
+    
+    void MarkOrderDependent();
+    
+    bool IsOrderDependent() const {
+      return m_orderDependent;
+    }
+    
     void EmitToCommandList(
             ID3D11CommandList*  pCommandList);
     
     void EmitToCsThread(
             DxvkCsThread*       CsThread);
     
+    bool EmitToCsBatch(
+            DxvkCsBatch*        CsBatch);
+    
   private:
     
     D3D11Device* const m_device;
@@ -39,6 +58,14 @@ namespace dxvk {
     
     std::vector<DxvkCsChunkRef> m_chunks;
 
+    // Buffers that the command list replaces the backing
+    // storage of, buffers that it uses in any way, as well
+    // as whether it contains commands which must be executed
+    // on the immediate context.
+    std::unordered_set<DxvkBuffer*> m_renamedBuffers;
+    std::unordered_set<DxvkBuffer*> m_usedBuffers;
+    bool                            m_orderDependent = false;
+
     std::atomic<bool> m_submitted = { false };
     std::atomic<bool> m_warned    = { false };
 
@@ -385,6 +385,9 @@ namespace dxvk {
       auto dstBuffer = static_cast<D3D11Buffer*>(pDstResource)->GetBufferSlice();
       auto srcBuffer = static_cast<D3D11Buffer*>(pSrcResource)->GetBufferSlice();
 
+      TrackBufferUse(static_cast<D3D11Buffer*>(pDstResource));
+      TrackBufferUse(static_cast<D3D11Buffer*>(pSrcResource));
+
       if (CopyFlags & D3D11_COPY_DISCARD)
         DiscardBuffer(static_cast<D3D11Buffer*>(pDstResource));
       
@@ -605,6 +608,9 @@ namespace dxvk {
     if (dstResourceDim == D3D11_RESOURCE_DIMENSION_BUFFER) {
       auto dstBuffer = static_cast<D3D11Buffer*>(pDstResource)->GetBufferSlice();
       auto srcBuffer = static_cast<D3D11Buffer*>(pSrcResource)->GetBufferSlice();
+
+      TrackBufferUse(static_cast<D3D11Buffer*>(pDstResource));
+      TrackBufferUse(static_cast<D3D11Buffer*>(pSrcResource));
       
       if (dstBuffer.length() != srcBuffer.length()) {
         Logger::err(str::format(
@@ -703,6 +709,8 @@ namespace dxvk {
     if (!counterSlice.defined())
       return;
 
+    TrackBufferUse(buf);
+
     EmitCs([
       cDstSlice = buf->GetBufferSlice(DstAlignedByteOffset),
       cSrcSlice = std::move(counterSlice)
@@ -833,6 +841,7 @@ namespace dxvk {
       // buffers that can be used for atomic operations, we can
       // use the fast Vulkan buffer clear function.
       Rc<DxvkBufferView> bufferView = uav->GetBufferView();
+      TrackBufferUse(bufferView);
       
       if (bufferView->info().format == VK_FORMAT_R32_UINT
        || bufferView->info().format == VK_FORMAT_R32_SINT
@@ -920,6 +929,8 @@ namespace dxvk {
     clearValue.color.float32[3] = Values[3];
     
     if (uav->GetResourceType() == D3D11_RESOURCE_DIMENSION_BUFFER) {
+      TrackBufferUse(bufView);
+
       EmitCs([
         cClearValue = clearValue,
         cDstView    = std::move(bufView)
@@ -1014,6 +1025,8 @@ namespace dxvk {
     if (uav != nullptr) {
       bufView = uav->GetBufferView();
       imgView = uav->GetImageView();
+
+      TrackBufferUse(bufView);
     }
 
     // 3D views are unsupported
@@ -1183,6 +1196,8 @@ namespace dxvk {
     if (resourceType == D3D11_RESOURCE_DIMENSION_BUFFER) {
       const auto bufferResource = static_cast<D3D11Buffer*>(pDstResource);
       const auto bufferSlice = bufferResource->GetBufferSlice();
+
+      TrackBufferUse(bufferResource);
       
       VkDeviceSize offset = bufferSlice.offset();
       VkDeviceSize size   = bufferSlice.length();
@@ -1211,19 +1226,23 @@ namespace dxvk {
         if (CopyFlags & D3D11_COPY_DISCARD)
           DiscardBuffer(bufferResource);
         
-        DxvkDataSlice dataSlice = AllocUpdateBufferSlice(size);
-        std::memcpy(dataSlice.ptr(), pSrcData, size);
-        
-        EmitCs([
-          cDataBuffer   = std::move(dataSlice),
-          cBufferSlice  = bufferSlice.subSlice(offset, size)
-        ] (DxvkContext* ctx) {
-          ctx->updateBuffer(
-            cBufferSlice.buffer(),
-            cBufferSlice.offset(),
-            cBufferSlice.length(),
-            cDataBuffer.ptr());
-        });
+        if (m_uploadRing != nullptr) {
+          UploadBufferData(bufferSlice.subSlice(offset, size), pSrcData);
+        } else {
+          DxvkDataSlice dataSlice = AllocUpdateBufferSlice(size);
+          std::memcpy(dataSlice.ptr(), pSrcData, size);
+          
+          EmitCs([
+            cDataBuffer   = std::move(dataSlice),
+            cBufferSlice  = bufferSlice.subSlice(offset, size)
+          ] (DxvkContext* ctx) {
+            ctx->updateBuffer(
+              cBufferSlice.buffer(),
+              cBufferSlice.offset(),
+              cBufferSlice.length(),
+              cDataBuffer.ptr());
+          });
+        }
       }
     } else {
       const D3D11CommonTexture* textureInfo = GetCommonTexture(pDstResource);
@@ -1271,34 +1290,64 @@ namespace dxvk {
       const VkDeviceSize bytesPerLayer = regionExtent.height * bytesPerRow;
       const VkDeviceSize bytesTotal    = regionExtent.depth  * bytesPerLayer;
       
-      DxvkDataSlice imageDataBuffer = AllocUpdateBufferSlice(bytesTotal);
+      bool useRing = m_uploadRing != nullptr
+        && layers.aspectMask != (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT);
       
-      util::packImageData(imageDataBuffer.ptr(), pSrcData,
-        regionExtent, formatInfo->elementSize,
-        SrcRowPitch, SrcDepthPitch);
-      
-      EmitCs([
-        cDstImage         = textureInfo->GetImage(),
-        cDstLayers        = layers,
-        cDstOffset        = offset,
-        cDstExtent        = extent,
-        cSrcData          = std::move(imageDataBuffer),
-        cSrcBytesPerRow   = bytesPerRow,
-        cSrcBytesPerLayer = bytesPerLayer,
-        cPackedFormat     = packedFormat
-      ] (DxvkContext* ctx) {
-        if (cDstLayers.aspectMask != (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)) {
-          ctx->updateImage(cDstImage, cDstLayers,
-            cDstOffset, cDstExtent, cSrcData.ptr(),
-            cSrcBytesPerRow, cSrcBytesPerLayer);
-        } else {
-          ctx->updateDepthStencilImage(cDstImage, cDstLayers,
-            VkOffset2D { cDstOffset.x,     cDstOffset.y      },
-            VkExtent2D { cDstExtent.width, cDstExtent.height },
-            cSrcData.ptr(), cSrcBytesPerRow, cSrcBytesPerLayer,
-            cPackedFormat);
-        }
-      });
+      if (useRing) {
+        // Pack the data directly into the upload ring. The buffer
+        // offset must be a multiple of both 4 and the texel size.
+        VkDeviceSize alignment = CACHE_LINE_SIZE % formatInfo->elementSize
+          ? formatInfo->elementSize * 4
+          : CACHE_LINE_SIZE;
+        
+        DxvkBufferSlice stagingSlice = AllocUploadSlice(alignment, bytesTotal);
+        
+        util::packImageData(stagingSlice.mapPtr(0), pSrcData,
+          regionExtent, formatInfo->elementSize,
+          SrcRowPitch, SrcDepthPitch);
+        
+        EmitCs([
+          cDstImage         = textureInfo->GetImage(),
+          cDstLayers        = layers,
+          cDstOffset        = offset,
+          cDstExtent        = extent,
+          cSrcSlice         = std::move(stagingSlice)
+        ] (DxvkContext* ctx) {
+          ctx->copyBufferToImage(cDstImage, cDstLayers,
+            cDstOffset, cDstExtent,
+            cSrcSlice.buffer(), cSrcSlice.offset(),
+            VkExtent2D { 0u, 0u });
+        });
+      } else {
+        DxvkDataSlice imageDataBuffer = AllocUpdateBufferSlice(bytesTotal);
+        
+        util::packImageData(imageDataBuffer.ptr(), pSrcData,
+          regionExtent, formatInfo->elementSize,
+          SrcRowPitch, SrcDepthPitch);
+        
+        EmitCs([
+          cDstImage         = textureInfo->GetImage(),
+          cDstLayers        = layers,
+          cDstOffset        = offset,
+          cDstExtent        = extent,
+          cSrcData          = std::move(imageDataBuffer),
+          cSrcBytesPerRow   = bytesPerRow,
+          cSrcBytesPerLayer = bytesPerLayer,
+          cPackedFormat     = packedFormat
+        ] (DxvkContext* ctx) {
+          if (cDstLayers.aspectMask != (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)) {
+            ctx->updateImage(cDstImage, cDstLayers,
+              cDstOffset, cDstExtent, cSrcData.ptr(),
+              cSrcBytesPerRow, cSrcBytesPerLayer);
+          } else {
+            ctx->updateDepthStencilImage(cDstImage, cDstLayers,
+              VkOffset2D { cDstOffset.x,     cDstOffset.y      },
+              VkExtent2D { cDstExtent.width, cDstExtent.height },
+              cSrcData.ptr(), cSrcBytesPerRow, cSrcBytesPerLayer,
+              cPackedFormat);
+          }
+        });
+      }
 
       if (textureInfo->CanUpdateMappedBufferEarly())
         UpdateMappedBuffer(textureInfo, subresource);
@@ -3393,16 +3442,19 @@ namespace dxvk {
     EmitCs([
       cSlotId = slotId,
       cStage  = GetShaderStage(ShaderStage),
-      cSlice  = pShaderModule           != nullptr
-             && pShaderModule->GetIcb() != nullptr
-        ? DxvkBufferSlice(pShaderModule->GetIcb())
-        : DxvkBufferSlice(),
-      cShader = pShaderModule != nullptr
-        ? pShaderModule->GetShader()
-        : nullptr
+      cModule = pShaderModule != nullptr
+        ? *pShaderModule
+        : D3D11CommonShader()
     ] (DxvkContext* ctx) {
-      ctx->bindShader        (cStage, cShader);
-      ctx->bindResourceBuffer(cSlotId, cSlice);
+      // The shader may still be translated in the background,
+      // so only resolve it once the CS thread actually needs it
+      Rc<DxvkShader> shader = cModule.GetShader();
+      Rc<DxvkBuffer> icb    = cModule.GetIcb();
+
+      ctx->bindShader        (cStage, shader);
+      ctx->bindResourceBuffer(cSlotId, icb != nullptr
+        ? DxvkBufferSlice(icb)
+        : DxvkBufferSlice());
     });
   }
 
@@ -3440,6 +3492,9 @@ namespace dxvk {
   void D3D11DeviceContext::BindDrawBuffers(
           D3D11Buffer*                     pBufferForArgs,
           D3D11Buffer*                     pBufferForCount) {
+    TrackBufferUse(pBufferForArgs);
+    TrackBufferUse(pBufferForCount);
+
     EmitCs([
       cArgBuffer = pBufferForArgs  ? pBufferForArgs->GetBufferSlice()  : DxvkBufferSlice(),
       cCntBuffer = pBufferForCount ? pBufferForCount->GetBufferSlice() : DxvkBufferSlice()
@@ -3454,6 +3509,8 @@ namespace dxvk {
           D3D11Buffer*                      pBuffer,
           UINT                              Offset,
           UINT                              Stride) {
+    TrackBufferUse(pBuffer);
+
     EmitCs([
       cSlotId       = Slot,
       cBufferSlice  = pBuffer != nullptr ? pBuffer->GetBufferSlice(Offset) : DxvkBufferSlice(),
@@ -3472,6 +3529,8 @@ namespace dxvk {
       ? VK_INDEX_TYPE_UINT16
       : VK_INDEX_TYPE_UINT32;
     
+    TrackBufferUse(pBuffer);
+
     EmitCs([
       cBufferSlice  = pBuffer != nullptr ? pBuffer->GetBufferSlice(Offset) : DxvkBufferSlice(),
       cIndexType    = indexType
@@ -3493,6 +3552,8 @@ namespace dxvk {
       counterSlice = pBuffer->GetSOCounter();
     }
 
+    TrackBufferUse(pBuffer);
+
     EmitCs([
       cSlotId       = Slot,
       cOffset       = Offset,
@@ -3515,6 +3576,8 @@ namespace dxvk {
   void D3D11DeviceContext::BindConstantBuffer(
           UINT                              Slot,
           D3D11Buffer*                      pBuffer) {
+    TrackBufferUse(pBuffer);
+
     EmitCs([
       cSlotId      = Slot,
       cBufferSlice = pBuffer ? pBuffer->GetBufferSlice() : DxvkBufferSlice()
@@ -3529,6 +3592,9 @@ namespace dxvk {
           D3D11Buffer*                      pBuffer,
           UINT                              Offset,
           UINT                              Length) {
+    if (Length)
+      TrackBufferUse(pBuffer);
+
     EmitCs([
       cSlotId      = Slot,
       cBufferSlice = Length ? pBuffer->GetBufferSlice(16 * Offset, 16 * Length) : DxvkBufferSlice()
@@ -3553,6 +3619,9 @@ namespace dxvk {
   void D3D11DeviceContext::BindShaderResource(
           UINT                              Slot,
           D3D11ShaderResourceView*          pResource) {
+    if (pResource != nullptr)
+      TrackBufferUse(pResource->GetBufferView());
+
     EmitCs([
       cSlotId     = Slot,
       cImageView  = pResource != nullptr ? pResource->GetImageView()  : nullptr,
@@ -3568,6 +3637,9 @@ namespace dxvk {
           D3D11UnorderedAccessView*         pUav,
           UINT                              CtrSlot,
           UINT                              Counter) {
+    if (pUav != nullptr)
+      TrackBufferUse(pUav->GetBufferView());
+
     EmitCs([
       cUavSlotId    = UavSlot,
       cCtrSlotId    = CtrSlot,
@@ -3592,6 +3664,8 @@ namespace dxvk {
   
   void D3D11DeviceContext::DiscardBuffer(
           D3D11Buffer*                      pBuffer) {
+    TrackBufferUse(pBuffer);
+
     EmitCs([cBuffer = pBuffer->GetBuffer()] (DxvkContext* ctx) {
       ctx->discardBuffer(cBuffer);
     });
@@ -3928,6 +4002,61 @@ namespace dxvk {
   }
   
   
+  void D3D11DeviceContext::UploadBufferData(
+    const DxvkBufferSlice&                  DstSlice,
+    const void*                             pSrcData) {
+    DxvkBufferSlice srcSlice = AllocUploadSlice(16, DstSlice.length());
+    std::memcpy(srcSlice.mapPtr(0), pSrcData, DstSlice.length());
+    
+    VkBufferCopy region;
+    region.srcOffset = srcSlice.offset();
+    region.dstOffset = DstSlice.offset();
+    region.size      = DstSlice.length();
+    
+    // If possible, append the update to the previous one so
+    // that multiple small updates to the same buffer can be
+    // executed with one single copy command. Destination
+    // ranges within one copy must not overlap.
+    auto cmdData = static_cast<D3D11CmdUpdateBufferData*>(m_cmdData);
+    
+    bool canAppend = cmdData && cmdData->type == D3D11CmdType::UpdateBuffer
+      && cmdData->dstBuffer == DstSlice.buffer().ptr()
+      && cmdData->srcBuffer == srcSlice.buffer().ptr()
+      && cmdData->count < D3D11CmdUpdateBufferData::MaxRegionCount;
+    
+    for (uint32_t i = 0; canAppend && i < cmdData->count; i++) {
+      const VkBufferCopy& prev = cmdData->regions[i];
+      
+      canAppend = region.dstOffset >= prev.dstOffset + prev.size
+               || region.dstOffset + region.size <= prev.dstOffset;
+    }
+    
+    if (canAppend) {
+      VkBufferCopy& last = cmdData->regions[cmdData->count - 1];
+      
+      if (last.srcOffset + last.size == region.srcOffset
+       && last.dstOffset + last.size == region.dstOffset)
+        last.size += region.size;
+      else
+        cmdData->regions[cmdData->count++] = region;
+    } else {
+      cmdData = EmitCsCmd<D3D11CmdUpdateBufferData>([
+        cDstBuffer = DstSlice.buffer(),
+        cSrcBuffer = srcSlice.buffer()
+      ] (DxvkContext* ctx, const D3D11CmdUpdateBufferData* data) {
+        ctx->updateBufferRegions(cDstBuffer, cSrcBuffer,
+          data->count, data->regions);
+      });
+      
+      cmdData->type       = D3D11CmdType::UpdateBuffer;
+      cmdData->dstBuffer  = DstSlice.buffer().ptr();
+      cmdData->srcBuffer  = srcSlice.buffer().ptr();
+      cmdData->count      = 1;
+      cmdData->regions[0] = region;
+    }
+  }
+  
+  
   bool D3D11DeviceContext::TestRtvUavHazards(
           UINT                              NumRTVs,
           ID3D11RenderTargetView* const*    ppRTVs,
@@ -4172,6 +4301,27 @@ namespace dxvk {
   }
   
   
+  DxvkBufferSlice D3D11DeviceContext::AllocUploadSlice(
+          VkDeviceSize                      Align,
+          VkDeviceSize                      Size) {
+    DxvkBufferSlice slice = m_uploadRing->alloc(Align, Size);
+    
+    // Release the ring's use of retired chunks once all
+    // commands reading from them have been recorded, so
+    // that they can be reused once the GPU is done.
+    if (unlikely(m_uploadRing->hasRetiredChunks())) {
+      EmitCs([
+        cChunks = m_uploadRing->takeRetiredChunks()
+      ] (DxvkContext* ctx) {
+        for (const auto& chunk : cChunks)
+          chunk->release(DxvkAccess::Read);
+      });
+    }
+    
+    return slice;
+  }
+  
+  
   DxvkCsChunkRef D3D11DeviceContext::AllocCsChunk() {
     return m_parent->AllocCsChunk(m_csFlags);
   }
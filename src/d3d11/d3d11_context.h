@@ -713,6 +713,7 @@ namespace dxvk {
     
     Rc<DxvkDevice>              m_device;
     Rc<DxvkDataBuffer>          m_updateBuffer;
+    Rc<DxvkUploadRing>          m_uploadRing;
     
     DxvkCsChunkFlags            m_csFlags;
     DxvkCsChunkRef              m_csChunk;
@@ -861,6 +862,10 @@ namespace dxvk {
       const D3D11CommonTexture*               pTexture,
             VkImageSubresource                Subresource);
     
+    void UploadBufferData(
+      const DxvkBufferSlice&                  DstSlice,
+      const void*                             pSrcData);
+    
     bool TestRtvUavHazards(
             UINT                              NumRTVs,
             ID3D11RenderTargetView* const*    ppRTVs,
@@ -901,6 +906,10 @@ namespace dxvk {
     
     DxvkDataSlice AllocUpdateBufferSlice(size_t Size);
     
+    DxvkBufferSlice AllocUploadSlice(
+            VkDeviceSize                      Align,
+            VkDeviceSize                      Size);
+    
     DxvkCsChunkRef AllocCsChunk();
     
     template<typename T>
@@ -951,6 +960,18 @@ namespace dxvk {
     
     virtual void EmitCsChunk(DxvkCsChunkRef&& chunk) = 0;
     
+    virtual void TrackBufferUse(DxvkBuffer* pBuffer) { }
+    
+    void TrackBufferUse(D3D11Buffer* pBuffer) {
+      if (pBuffer != nullptr)
+        TrackBufferUse(pBuffer->GetBuffer().ptr());
+    }
+    
+    void TrackBufferUse(const Rc<DxvkBufferView>& BufferView) {
+      if (BufferView != nullptr)
+        TrackBufferUse(BufferView->buffer().ptr());
+    }
+    
   };
   
 }
@@ -9,6 +9,7 @@ namespace dxvk {
           UINT            ContextFlags)
   : D3D11DeviceContext(pParent, Device, GetCsChunkFlags(pParent)),
     m_contextFlags(ContextFlags),
+    m_trackBuffers(pParent->GetOptions()->numCommandListWorkers > 0),
     m_commandList (CreateCommandList()) {
     ClearState();
   }
@@ -24,6 +25,35 @@ namespace dxvk {
   }
   
   
+  void STDMETHODCALLTYPE D3D11DeferredContext::Begin(
+          ID3D11Asynchronous*               pAsync) {
+    D3D10DeviceLock lock = LockContext();
+
+    // Queries are tracked by the context that executes
+    // the command list, so it can't be recorded on a
+    // command list worker
+    m_commandList->MarkOrderDependent();
+
+    D3D11DeviceContext::Begin(pAsync);
+
+    if (pAsync)
+      static_cast<D3D11Query*>(pAsync)->SetCsSeqNum(DxvkCsThread::SynchronizeAll);
+  }
+
+
+  void STDMETHODCALLTYPE D3D11DeferredContext::End(
+          ID3D11Asynchronous*               pAsync) {
+    D3D10DeviceLock lock = LockContext();
+
+    m_commandList->MarkOrderDependent();
+
+    D3D11DeviceContext::End(pAsync);
+
+    if (pAsync)
+      static_cast<D3D11Query*>(pAsync)->SetCsSeqNum(DxvkCsThread::SynchronizeAll);
+  }
+
+
   HRESULT STDMETHODCALLTYPE D3D11DeferredContext::GetData(
           ID3D11Asynchronous*               pAsync,
           void*                             pData,
@@ -192,6 +222,9 @@ namespace dxvk {
     pMapEntry->RowPitch     = pBuffer->Desc()->ByteWidth;
     pMapEntry->DepthPitch   = pBuffer->Desc()->ByteWidth;
     
+    if (m_trackBuffers)
+      m_commandList->TrackBufferRename(pBuffer->GetBuffer().ptr());
+    
     if (likely(pBuffer->Desc()->Usage == D3D11_USAGE_DYNAMIC && m_csFlags.test(DxvkCsChunkFlag::SingleUse))) {
       // For resources that cannot be written by the GPU,
       // we may write to the buffer resource directly and
@@ -318,6 +351,12 @@ namespace dxvk {
   }
 
 
+  void D3D11DeferredContext::TrackBufferUse(DxvkBuffer* pBuffer) {
+    if (m_trackBuffers)
+      m_commandList->TrackBufferUse(pBuffer);
+  }
+
+
   DxvkCsChunkFlags D3D11DeferredContext::GetCsChunkFlags(
           D3D11Device*                  pDevice) {
     return pDevice->GetOptions()->dcSingleUseMode
@@ -34,6 +34,12 @@ namespace dxvk {
     
     UINT STDMETHODCALLTYPE GetContextFlags();
     
+    void STDMETHODCALLTYPE Begin(
+            ID3D11Asynchronous*               pAsync);
+    
+    void STDMETHODCALLTYPE End(
+            ID3D11Asynchronous*               pAsync);
+    
     HRESULT STDMETHODCALLTYPE GetData(
             ID3D11Asynchronous*               pAsync,
             void*                             pData,
@@ -81,6 +87,10 @@ namespace dxvk {
     
     const UINT m_contextFlags;
     
+    // Buffer usage is only needed to batch command
+    // lists onto the immediate context's CS workers
+    const bool m_trackBuffers;
+    
     // Command list that we're recording
     Com<D3D11CommandList> m_commandList;
     
@@ -105,6 +115,8 @@ namespace dxvk {
     Com<D3D11CommandList> CreateCommandList();
     
     void EmitCsChunk(DxvkCsChunkRef&& chunk);
+    
+    void TrackBufferUse(DxvkBuffer* pBuffer);
 
     static DxvkCsChunkFlags GetCsChunkFlags(
             D3D11Device*                  pDevice);
@@ -14,6 +14,11 @@ namespace dxvk {
     const Rc<DxvkDevice>& Device)
   : D3D11DeviceContext(pParent, Device, DxvkCsChunkFlag::SingleUse),
     m_csThread(Device->createContext()) {
+    // Only the immediate context writes upload data to
+    // the ring, since deferred command lists may never
+    // be executed or be executed more than once.
+    m_uploadRing = new DxvkUploadRing(Device);
+
     EmitCs([
       cDevice          = m_device,
       cRelaxedBarriers = pParent->GetOptions()->relaxedBarriers
@@ -25,6 +30,20 @@ namespace dxvk {
     });
     
     ClearState();
+
+    int32_t numWorkers = std::min<int32_t>(
+      pParent->GetOptions()->numCommandListWorkers,
+      dxvk::thread::hardware_concurrency());
+
+    if (numWorkers > 0) {
+      DxvkBarrierControlFlags barrierControl;
+
+      if (pParent->GetOptions()->relaxedBarriers)
+        barrierControl.set(DxvkBarrierControl::IgnoreWriteAfterWrite);
+
+      m_csWorkers = std::make_unique<DxvkCsWorkerPool>(
+        Device, uint32_t(numWorkers), barrierControl);
+    }
   }
   
   
@@ -71,13 +90,26 @@ namespace dxvk {
     // DataSize is 0, but we should ignore that pointer
     pData = DataSize ? pData : nullptr;
 
-    // Ensure that all query commands actually get
-    // executed before trying to access the query
-    SynchronizeCsThread();
+    // Ensure that the query commands actually got executed
+    // before trying to access the query. We only need to
+    // wait for the chunk that last used the query, and
+    // return early rather than blocking the app thread.
+    auto query = static_cast<D3D11Query*>(pAsync);
+    uint64_t seq = query->GetCsSeqNum();
+
+    if (unlikely(seq == DxvkCsThread::SynchronizeAll)) {
+      SynchronizeCsThread();
+      seq = m_csThread.lastSequenceNumber();
+    } else if (seq > m_csThread.lastSequenceNumber()) {
+      D3D10DeviceLock lock = LockContext();
+      FlushCsChunk();
+    }
 
     // Get query status directly from the query object
-    auto query = static_cast<D3D11Query*>(pAsync);
-    HRESULT hr = query->GetData(pData, GetDataFlags);
+    HRESULT hr = S_FALSE;
+
+    if (m_csThread.isExecuted(seq))
+      hr = query->GetData(pData, GetDataFlags);
     
     // If we're likely going to spin on the asynchronous object,
     // flush the context so that we're keeping the GPU busy.
@@ -96,10 +128,31 @@ namespace dxvk {
   }
   
   
+  void STDMETHODCALLTYPE D3D11ImmediateContext::Begin(ID3D11Asynchronous* pAsync) {
+    D3D10DeviceLock lock = LockContext();
+
+    D3D11DeviceContext::Begin(pAsync);
+
+    // The command ends up in the chunk that is
+    // currently being recorded, i.e. the next
+    // chunk to get dispatched to the CS thread
+    if (pAsync) {
+      static_cast<D3D11Query*>(pAsync)->SetCsSeqNum(
+        m_csThread.lastSequenceNumber() + 1);
+    }
+  }
+
+
   void STDMETHODCALLTYPE D3D11ImmediateContext::End(ID3D11Asynchronous* pAsync) {
+    D3D10DeviceLock lock = LockContext();
+
     D3D11DeviceContext::End(pAsync);
 
     auto query = static_cast<D3D11Query*>(pAsync);
+
+    if (query)
+      query->SetCsSeqNum(m_csThread.lastSequenceNumber() + 1);
+
     if (unlikely(query && query->IsEvent())) {
       query->NotifyEnd();
       query->IsStalling()
@@ -163,10 +216,17 @@ namespace dxvk {
 
     auto commandList = static_cast<D3D11CommandList*>(pCommandList);
     
+    if (m_csWorkers && ExecuteCommandListParallel(commandList, RestoreContextState))
+      return;
+    
     // Flush any outstanding commands so that
     // we don't mess up the execution order
     FlushCsChunk();
     
+    // Command lists submitted after this one must
+    // not be recorded before it, so close the batch
+    m_csBatch = nullptr;
+    
     // As an optimization, flush everything if the
     // number of pending draw calls is high enough.
     FlushImplicit(FALSE);
@@ -593,7 +653,53 @@ namespace dxvk {
   }
   
   
+  bool D3D11ImmediateContext::ExecuteCommandListParallel(
+          D3D11CommandList*                 pCommandList,
+          BOOL                              RestoreContextState) {
+    if (pCommandList->IsOrderDependent())
+      return false;
+
+    // Command lists are recorded on separate contexts and do not
+    // affect the immediate context's state, so restoring the state
+    // is a no-op. Consecutive command lists can be added to the same
+    // batch as long as we didn't emit any commands in between, and
+    // the batch still is pending on the CS thread.
+    if (m_csBatch != nullptr && m_csChunk->empty()
+     && (RestoreContextState || m_csBatchClearedState)
+     && pCommandList->EmitToCsBatch(m_csBatch.ptr()))
+      return true;
+
+    // The command list cannot access the immediate context's
+    // state, so we can clear it before executing the batch
+    if (!RestoreContextState)
+      ClearState();
+
+    Rc<DxvkCsBatch> batch = new DxvkCsBatch();
+    pCommandList->EmitToCsBatch(batch.ptr());
+
+    EmitCs([
+      cWorkers = m_csWorkers.get(),
+      cBatch   = batch
+    ] (DxvkContext* ctx) {
+      cWorkers->executeBatch(ctx, cBatch);
+    });
+
+    // Dispatch the batch right away so that it can get
+    // executed as soon as the CS thread catches up. This
+    // closes the batch, so re-open it for the next call.
+    FlushCsChunk();
+
+    m_csBatch = std::move(batch);
+    m_csBatchClearedState = !RestoreContextState;
+    return true;
+  }
+
+
   void D3D11ImmediateContext::EmitCsChunk(DxvkCsChunkRef&& chunk) {
+    // Any command recorded after a batch of command lists
+    // must be executed after the entire batch
+    m_csBatch = nullptr;
+
     m_csThread.dispatchChunk(std::move(chunk));
     m_csIsBusy = true;
   }
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <chrono>
+#include <memory>
+
+#include "../dxvk/dxvk_cs_pool.h"
 
 #include "d3d11_context.h"
 #include "d3d11_state_object.h"
@@ -8,6 +11,7 @@
 namespace dxvk {
   
   class D3D11Buffer;
+  class D3D11CommandList;
   class D3D11CommonTexture;
   
   class D3D11ImmediateContext : public D3D11DeviceContext {
@@ -32,6 +36,8 @@ namespace dxvk {
             UINT                              DataSize,
             UINT                              GetDataFlags);
     
+    void STDMETHODCALLTYPE Begin(ID3D11Asynchronous *pAsync);
+
     void STDMETHODCALLTYPE End(ID3D11Asynchronous *pAsync);
     
     void STDMETHODCALLTYPE Flush();
@@ -106,6 +112,10 @@ namespace dxvk {
     
   private:
     
+    std::unique_ptr<DxvkCsWorkerPool> m_csWorkers;
+    Rc<DxvkCsBatch>                   m_csBatch;
+    BOOL                              m_csBatchClearedState = FALSE;
+
     DxvkCsThread m_csThread;
     bool         m_csIsBusy = false;
 
@@ -138,6 +148,10 @@ namespace dxvk {
             D3D11_MAP                         MapType,
             UINT                              MapFlags);
     
+    bool ExecuteCommandListParallel(
+            D3D11CommandList*                 pCommandList,
+            BOOL                              RestoreContextState);
+    
     void EmitCsChunk(DxvkCsChunkRef&& chunk);
 
     void FlushImplicit(BOOL StrongHint);
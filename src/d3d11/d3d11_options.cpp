@@ -7,9 +7,15 @@ namespace dxvk {
   D3D11Options::D3D11Options(const Config& config) {
     this->allowMapFlagNoWait    = config.getOption<bool>("d3d11.allowMapFlagNoWait", true);
     this->dcSingleUseMode       = config.getOption<bool>("d3d11.dcSingleUseMode", true);
+    this->numCommandListWorkers = config.getOption<int32_t>("d3d11.numCommandListWorkers", 0);
+    this->numShaderTranslationThreads = config.getOption<int32_t>("d3d11.numShaderTranslationThreads", 0);
     this->strictDivision           = config.getOption<bool>("d3d11.strictDivision", false);
     this->constantBufferRangeCheck = config.getOption<bool>("d3d11.constantBufferRangeCheck", false);
     this->zeroInitWorkgroupMemory  = config.getOption<bool>("d3d11.zeroInitWorkgroupMemory", false);
+    this->spirvPromoteRegisters    = config.getOption<bool>("d3d11.spirvPromoteRegisters", true);
+    this->spirvDedupConstants      = config.getOption<bool>("d3d11.spirvDedupConstants", true);
+    this->spirvFoldBranches        = config.getOption<bool>("d3d11.spirvFoldBranches", true);
+    this->spirvEliminateDeadCode   = config.getOption<bool>("d3d11.spirvEliminateDeadCode", true);
     this->relaxedBarriers       = config.getOption<bool>("d3d11.relaxedBarriers", false);
     this->maxTessFactor         = config.getOption<int32_t>("d3d11.maxTessFactor", 0);
     this->samplerAnisotropy     = config.getOption<int32_t>("d3d11.samplerAnisotropy", -1);
@@ -17,6 +23,7 @@ namespace dxvk {
     this->numBackBuffers        = config.getOption<int32_t>("dxgi.numBackBuffers", 0);
     this->maxFrameLatency       = config.getOption<int32_t>("dxgi.maxFrameLatency", 0);
     this->syncInterval          = config.getOption<int32_t>("dxgi.syncInterval", -1);
+    this->maxFrameRate          = config.getOption<int32_t>("dxgi.maxFrameRate", 0);
   }
   
 }
\ No newline at end of file
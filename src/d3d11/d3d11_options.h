@@ -25,6 +25,23 @@ namespace dxvk {
     /// than once.
     bool dcSingleUseMode;
 
+    /// Number of threads recording command lists
+    ///
+    /// If greater than zero, command lists executed on
+    /// the immediate context are recorded in parallel
+    /// by a pool of worker threads. May help engines
+    /// that rely heavily on deferred contexts.
+    int32_t numCommandListWorkers;
+
+    /// Number of threads translating shaders
+    ///
+    /// Shaders are translated to SPIR-V in the background
+    /// and only waited for when they are first used. If
+    /// zero, one thread per CPU core is used, and if
+    /// negative, shaders are translated on the thread
+    /// that creates them.
+    int32_t numShaderTranslationThreads;
+
     /// Enables sm4-compliant division-by-zero behaviour
     /// Windows drivers don't normally do this, but some
     /// games may expect correct behaviour.
@@ -41,6 +58,15 @@ namespace dxvk {
     /// TGSM in compute shaders before reading it.
     bool zeroInitWorkgroupMemory;
 
+    /// SPIR-V optimization passes
+    ///
+    /// Each pass can be disabled individually
+    /// in case it causes issues with a driver.
+    bool spirvPromoteRegisters;
+    bool spirvDedupConstants;
+    bool spirvFoldBranches;
+    bool spirvEliminateDeadCode;
+
     /// Use relaxed memory barriers
     ///
     /// May improve performance in some games,
@@ -72,6 +98,11 @@ namespace dxvk {
     /// a higher value. May help with frame timing issues.
     int32_t maxFrameLatency;
 
+    /// Limit frame rate. Values of zero or less
+    /// disable the limiter. Can be overridden with
+    /// the \c DXVK_FRAME_RATE environment variable.
+    int32_t maxFrameRate;
+
     /// Defer surface creation until first present call. This
     /// fixes issues with games that create multiple swap chains
     /// for a single window that may interfere with each other.
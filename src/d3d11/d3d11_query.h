@@ -65,6 +65,24 @@ namespace dxvk {
       m_stallMask |= 1;
       m_stallFlag |= bit::popcnt(m_stallMask) >= 16;
     }
+
+    /**
+     * \brief CS chunk that last used the query
+     *
+     * Sequence number of the CS chunk containing the
+     * most recent \c Begin or \c End command for this
+     * query. Queries used on deferred contexts are set
+     * to \c DxvkCsThread::SynchronizeAll since the chunk
+     * is not known until the command list is executed.
+     * \returns CS chunk sequence number
+     */
+    uint64_t GetCsSeqNum() const {
+      return m_csSeqNum;
+    }
+
+    void SetCsSeqNum(uint64_t SeqNum) {
+      m_csSeqNum = SeqNum;
+    }
     
     D3D10Query* GetD3D10Iface() {
       return &m_d3d10;
@@ -100,6 +118,8 @@ namespace dxvk {
     uint32_t m_stallMask = 0;
     bool     m_stallFlag = false;
 
+    uint64_t m_csSeqNum = 0;
+
     UINT64 GetTimestampQueryFrequency() const;
     
   };
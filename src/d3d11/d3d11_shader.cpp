@@ -3,58 +3,154 @@
 
 namespace dxvk {
   
-  D3D11CommonShader:: D3D11CommonShader() { }
-  D3D11CommonShader::~D3D11CommonShader() { }
-  
-  
-  D3D11CommonShader::D3D11CommonShader(
-          D3D11Device*    pDevice,
-    const DxvkShaderKey*  pShaderKey,
-    const DxbcModuleInfo* pDxbcModuleInfo,
-    const void*           pShaderBytecode,
-          size_t          BytecodeLength) {
-    const std::string name = pShaderKey->toString();
-    Logger::debug(str::format("Compiling shader ", name));
-    
-    DxbcReader reader(
-      reinterpret_cast<const char*>(pShaderBytecode),
-      BytecodeLength);
-    
-    DxbcModule module(reader);
-    
-    // If requested by the user, dump both the raw DXBC
-    // shader and the compiled SPIR-V module to a file.
-    const std::string dumpPath = env::getEnvVar("DXVK_SHADER_DUMP_PATH");
-    
-    if (dumpPath.size() != 0) {
-      reader.store(std::ofstream(str::format(dumpPath, "/", name, ".dxbc"),
-        std::ios_base::binary | std::ios_base::trunc));
+  /**
+   * \brief Computes shader variant hash
+   * 
+   * Covers all compiler inputs other than the shader
+   * code and the xfb info, which are already part of
+   * the shader key. Options are hashed individually
+   * since the option struct contains padding bytes.
+   */
+  static Sha1Hash GetShaderVariantHash(const DxbcModuleInfo* pDxbcModuleInfo) {
+    const DxbcOptions& options = pDxbcModuleInfo->options;
+
+    float maxTessFactor = pDxbcModuleInfo->tess != nullptr
+      ? pDxbcModuleInfo->tess->maxTessFactor
+      : 0.0f;
+
+    std::array<uint32_t, 13> data = {{
+      uint32_t(options.useDepthClipWorkaround),
+      uint32_t(options.useStorageImageReadWithoutFormat),
+      uint32_t(options.useSubgroupOpsForAtomicCounters),
+      uint32_t(options.useDemoteToHelperInvocation),
+      uint32_t(options.useSubgroupOpsForEarlyDiscard),
+      uint32_t(options.useSdivForBufferIndex),
+      uint32_t(options.strictDivision),
+      uint32_t(options.constantBufferRangeCheck),
+      uint32_t(options.zeroInitWorkgroupMemory),
+      uint32_t(options.minSsboAlignment),
+      uint32_t(pDxbcModuleInfo->tess != nullptr),
+      uint32_t(options.spirvPasses.raw()),
+      0u,
+    }};
+
+    std::memcpy(&data[12], &maxTessFactor, sizeof(maxTessFactor));
+    return Sha1Hash::compute(data.data(), sizeof(data));
+  }
+
+
+  D3D11ShaderTranslation::D3D11ShaderTranslation(
+    const Rc<DxvkDevice>&       Device,
+    const DxvkShaderKey&        ShaderKey,
+    const DxvkShaderCacheKey&   CacheKey,
+    const DxbcModule&           Module,
+    const DxbcModuleInfo&       ModuleInfo)
+  : m_status    (D3D11ShaderTranslationStatus::Queued),
+    m_device    (Device),
+    m_shaderKey (ShaderKey),
+    m_cacheKey  (CacheKey),
+    m_module    (std::make_unique<DxbcModule>(Module)),
+    m_moduleInfo(ModuleInfo),
+    m_tessInfo  () {
+    if (ModuleInfo.tess != nullptr) {
+      m_tessInfo = *ModuleInfo.tess;
+      m_moduleInfo.tess = &m_tessInfo;
     }
-    
+  }
+
+
+  D3D11ShaderTranslation::D3D11ShaderTranslation(
+    const Rc<DxvkDevice>&       Device,
+    const DxvkShaderKey&        ShaderKey,
+    const Rc<DxvkShader>&       Shader)
+  : m_status    (D3D11ShaderTranslationStatus::Running),
+    m_device    (Device),
+    m_shaderKey (ShaderKey),
+    m_moduleInfo(),
+    m_tessInfo  () {
+    SetShader(Shader);
+  }
+
+
+  D3D11ShaderTranslation::~D3D11ShaderTranslation() {
+
+  }
+
+
+  const D3D11ShaderData& D3D11ShaderTranslation::GetData() {
+    if (m_status.load() != D3D11ShaderTranslationStatus::Ready && !TryTranslate()) {
+      std::unique_lock<std::mutex> lock(m_mutex);
+
+      m_cond.wait(lock, [this] () {
+        return m_status.load() == D3D11ShaderTranslationStatus::Ready;
+      });
+    }
+
+    return m_data;
+  }
+
+
+  bool D3D11ShaderTranslation::TryTranslate() {
+    auto expected = D3D11ShaderTranslationStatus::Queued;
+
+    if (!m_status.compare_exchange_strong(expected, D3D11ShaderTranslationStatus::Running))
+      return false;
+
+    Rc<DxvkShader> shader;
+
+    try {
+      shader = Translate();
+    } catch (const DxvkError& e) {
+      Logger::err(str::format("D3D11: Failed to translate ", m_shaderKey.toString(), ": ", e.message()));
+    }
+
+    m_module = nullptr;
+
+    SetShader(shader);
+    return true;
+  }
+
+
+  Rc<DxvkShader> D3D11ShaderTranslation::Translate() {
+    const std::string name = m_shaderKey.toString();
+    const std::string dumpPath = env::getEnvVar("DXVK_SHADER_DUMP_PATH");
+
+    Logger::debug(str::format("Compiling shader ", name));
+
     // Decide whether we need to create a pass-through
     // geometry shader for vertex shader stream output
-    bool passthroughShader = pDxbcModuleInfo->xfb != nullptr
-      && module.programInfo().type() != DxbcProgramType::GeometryShader;
+    bool passthroughShader = m_moduleInfo.xfb != nullptr
+      && m_module->programInfo().type() != DxbcProgramType::GeometryShader;
+
+    Rc<DxvkShader> shader = passthroughShader
+      ? m_module->compilePassthroughShader(m_moduleInfo, name)
+      : m_module->compile                 (m_moduleInfo, name);
+    shader->setShaderKey(m_shaderKey);
 
-    m_shader = passthroughShader
-      ? module.compilePassthroughShader(*pDxbcModuleInfo, name)
-      : module.compile                 (*pDxbcModuleInfo, name);
-    m_shader->setShaderKey(*pShaderKey);
-    
     if (dumpPath.size() != 0) {
       std::ofstream dumpStream(
         str::format(dumpPath, "/", name, ".spv"),
         std::ios_base::binary | std::ios_base::trunc);
-      
-      m_shader->dump(dumpStream);
+
+      shader->dump(dumpStream);
     }
-    
+
+    m_device->addShader(m_cacheKey, shader);
+    return shader;
+  }
+
+
+  void D3D11ShaderTranslation::SetShader(
+    const Rc<DxvkShader>&       Shader) {
+    D3D11ShaderData data;
+    data.shader = Shader;
+
     // Create shader constant buffer if necessary
-    if (m_shader->shaderConstants().data() != nullptr) {
+    if (Shader != nullptr && Shader->shaderConstants().data() != nullptr) {
       DxvkBufferCreateInfo info;
-      info.size   = m_shader->shaderConstants().sizeInBytes();
+      info.size   = Shader->shaderConstants().sizeInBytes();
       info.usage  = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-      info.stages = util::pipelineStages(m_shader->stage())
+      info.stages = util::pipelineStages(Shader->stage())
                   | VK_PIPELINE_STAGE_HOST_BIT;
       info.access = VK_ACCESS_UNIFORM_READ_BIT
                   | VK_ACCESS_HOST_WRITE_BIT;
@@ -64,19 +160,54 @@ namespace dxvk {
         | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
         | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
       
-      m_buffer = pDevice->GetDXVKDevice()->createBuffer(info, memFlags);
+      data.buffer = m_device->createBuffer(info, memFlags);
 
-      std::memcpy(m_buffer->mapPtr(0),
-        m_shader->shaderConstants().data(),
-        m_shader->shaderConstants().sizeInBytes());
+      std::memcpy(data.buffer->mapPtr(0),
+        Shader->shaderConstants().data(),
+        Shader->shaderConstants().sizeInBytes());
     }
 
-    pDevice->GetDXVKDevice()->registerShader(m_shader);
+    if (Shader != nullptr)
+      m_device->registerShader(Shader);
+
+    { std::lock_guard<std::mutex> lock(m_mutex);
+      m_data = std::move(data);
+      m_status.store(D3D11ShaderTranslationStatus::Ready);
+      m_cond.notify_all();
+    }
   }
 
+
+  D3D11CommonShader:: D3D11CommonShader() { }
+  D3D11CommonShader::~D3D11CommonShader() { }
   
-  D3D11ShaderModuleSet:: D3D11ShaderModuleSet() { }
-  D3D11ShaderModuleSet::~D3D11ShaderModuleSet() { }
+  
+  D3D11CommonShader::D3D11CommonShader(
+    const Rc<D3D11ShaderTranslation>& Translation)
+  : m_translation(Translation) { }
+
+  
+  D3D11ShaderModuleSet::D3D11ShaderModuleSet(int32_t NumThreads) {
+    // Use one worker per CPU core by default, since the
+    // application thread is usually blocked on shader
+    // creation while loading
+    if (NumThreads == 0)
+      NumThreads = dxvk::thread::hardware_concurrency();
+
+    for (int32_t i = 0; i < NumThreads; i++)
+      m_workers.emplace_back([this] () { RunWorker(); });
+  }
+
+
+  D3D11ShaderModuleSet::~D3D11ShaderModuleSet() {
+    { std::lock_guard<std::mutex> lock(m_queueMutex);
+      m_stopThreads.store(true);
+      m_queueCond.notify_all();
+    }
+
+    for (auto& worker : m_workers)
+      worker.join();
+  }
   
   
   D3D11CommonShader D3D11ShaderModuleSet::GetShaderModule(
@@ -93,22 +224,104 @@ namespace dxvk {
         return entry->second;
     }
     
-    // This shader has not been compiled yet, so we have to create a
-    // new module. This takes a while, so we won't lock the structure.
-    D3D11CommonShader module(pDevice, pShaderKey,
-      pDxbcModuleInfo, pShaderBytecode, BytecodeLength);
+    // This shader has not been created yet. Parsing the DXBC
+    // module is cheap and reports invalid shader code to the
+    // application, so do that right away and only defer the
+    // actual translation.
+    Rc<D3D11ShaderTranslation> translation = CreateTranslation(pDevice,
+      pShaderKey, pDxbcModuleInfo, pShaderBytecode, BytecodeLength);
+
+    D3D11CommonShader module(translation);
     
     // Insert the new module into the lookup table. If another thread
-    // has compiled the same shader in the meantime, we should return
-    // that object instead and discard the newly created module.
+    // has created the same shader in the meantime, we should return
+    // that object instead and discard the new translation.
     { std::unique_lock<std::mutex> lock(m_mutex);
       
       auto status = m_modules.insert({ *pShaderKey, module });
       if (!status.second)
         return status.first->second;
     }
+
+    // Transform feedback info references data owned by
+    // the application, so translate those shaders now.
+    if (m_workers.empty() || pDxbcModuleInfo->xfb != nullptr) {
+      translation->TryTranslate();
+    } else {
+      std::lock_guard<std::mutex> lock(m_queueMutex);
+      m_queue.push(translation);
+      m_queueCond.notify_one();
+    }
     
     return module;
   }
+
+
+  Rc<D3D11ShaderTranslation> D3D11ShaderModuleSet::CreateTranslation(
+          D3D11Device*    pDevice,
+    const DxvkShaderKey*  pShaderKey,
+    const DxbcModuleInfo* pDxbcModuleInfo,
+    const void*           pShaderBytecode,
+          size_t          BytecodeLength) {
+    const std::string dumpPath = env::getEnvVar("DXVK_SHADER_DUMP_PATH");
+
+    Rc<DxvkDevice> device = pDevice->GetDXVKDevice();
+
+    DxvkShaderCacheKey cacheKey;
+    cacheKey.shader  = *pShaderKey;
+    cacheKey.variant = GetShaderVariantHash(pDxbcModuleInfo);
+
+    // Skip translation entirely if the shader has been compiled
+    // with the same options before. When dumping shaders we need
+    // the DXBC module anyway, so always compile in that case.
+    if (dumpPath.size() == 0) {
+      Rc<DxvkShader> shader = device->lookupShader(cacheKey);
+
+      if (shader != nullptr)
+        return new D3D11ShaderTranslation(device, *pShaderKey, shader);
+    }
+
+    DxbcReader reader(
+      reinterpret_cast<const char*>(pShaderBytecode),
+      BytecodeLength);
+
+    DxbcModule module(reader);
+
+    // If requested by the user, dump the raw DXBC shader
+    // to a file. The SPIR-V is dumped after translation.
+    if (dumpPath.size() != 0) {
+      reader.store(std::ofstream(str::format(dumpPath, "/", pShaderKey->toString(), ".dxbc"),
+        std::ios_base::binary | std::ios_base::trunc));
+    }
+
+    return new D3D11ShaderTranslation(device,
+      *pShaderKey, cacheKey, module, *pDxbcModuleInfo);
+  }
+
+
+  void D3D11ShaderModuleSet::RunWorker() {
+    env::setThreadName("dxvk-dxbc");
+
+    while (true) {
+      Rc<D3D11ShaderTranslation> translation;
+
+      { std::unique_lock<std::mutex> lock(m_queueMutex);
+
+        m_queueCond.wait(lock, [this] () {
+          return m_stopThreads.load() || !m_queue.empty();
+        });
+
+        if (m_stopThreads.load())
+          break;
+
+        translation = std::move(m_queue.front());
+        m_queue.pop();
+      }
+
+      // Does nothing if a thread that needed the
+      // shader has already translated it itself
+      translation->TryTranslate();
+    }
+  }
   
 }
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <memory>
 #include <mutex>
+#include <queue>
 #include <unordered_map>
+#include <vector>
 
 #include "../dxbc/dxbc_module.h"
 #include "../dxvk/dxvk_device.h"
@@ -10,6 +15,7 @@
 
 #include "../util/sha1/sha1_util.h"
 
+#include "../util/thread.h"
 #include "../util/util_env.h"
 
 #include "d3d11_device_child.h"
@@ -19,12 +25,134 @@ namespace dxvk {
   
   class D3D11Device;
   
+  /**
+   * \brief Translated shader data
+   *
+   * Stores the SPIR-V shader and the buffer
+   * containing the immediate constant buffer.
+   */
+  struct D3D11ShaderData {
+    Rc<DxvkShader> shader;
+    Rc<DxvkBuffer> buffer;
+  };
+
+
+  /**
+   * \brief Shader translation status
+   */
+  enum class D3D11ShaderTranslationStatus : uint32_t {
+    Queued    = 0,  ///< Waiting for a worker thread
+    Running   = 1,  ///< Being translated by some thread
+    Ready     = 2,  ///< Translation has finished
+  };
+
+
+  /**
+   * \brief Shader translation
+   *
+   * Translates a DXBC module to SPIR-V, either on a worker
+   * thread or on the first thread that needs the shader.
+   * Once translation has finished, the module is released
+   * and only the resulting shader data is kept around.
+   */
+  class D3D11ShaderTranslation : public RcObject {
+
+  public:
+
+    /**
+     * \brief Creates a pending translation
+     *
+     * The module info is copied, except for transform
+     * feedback info, which must stay valid until the
+     * translation has finished.
+     * \param [in] Device DXVK device
+     * \param [in] ShaderKey Shader key
+     * \param [in] CacheKey Shader cache key
+     * \param [in] Module Parsed DXBC module
+     * \param [in] ModuleInfo DXBC module info
+     */
+    D3D11ShaderTranslation(
+      const Rc<DxvkDevice>&       Device,
+      const DxvkShaderKey&        ShaderKey,
+      const DxvkShaderCacheKey&   CacheKey,
+      const DxbcModule&           Module,
+      const DxbcModuleInfo&       ModuleInfo);
+
+    /**
+     * \brief Creates a finished translation
+     *
+     * Used for shaders that were found in the shader cache.
+     * \param [in] Device DXVK device
+     * \param [in] ShaderKey Shader key
+     * \param [in] Shader The shader
+     */
+    D3D11ShaderTranslation(
+      const Rc<DxvkDevice>&       Device,
+      const DxvkShaderKey&        ShaderKey,
+      const Rc<DxvkShader>&       Shader);
+
+    ~D3D11ShaderTranslation();
+
+    /**
+     * \brief Shader key
+     * \returns Shader key
+     */
+    const DxvkShaderKey& GetShaderKey() const {
+      return m_shaderKey;
+    }
+
+    /**
+     * \brief Retrieves shader data
+     *
+     * Translates the shader on the calling thread if no
+     * other thread has started doing so yet, or waits for
+     * the translation to finish otherwise. If translation
+     * failed, the shader will be \c nullptr.
+     * \returns Translated shader data
+     */
+    const D3D11ShaderData& GetData();
+
+    /**
+     * \brief Translates the shader
+     *
+     * Does nothing if another thread has
+     * already claimed the translation.
+     * \returns \c true if the shader was
+     *    translated on the calling thread
+     */
+    bool TryTranslate();
+
+  private:
+
+    std::atomic<D3D11ShaderTranslationStatus> m_status;
+
+    Rc<DxvkDevice>              m_device;
+    DxvkShaderKey               m_shaderKey;
+    DxvkShaderCacheKey          m_cacheKey;
+    std::unique_ptr<DxbcModule> m_module;
+    DxbcModuleInfo              m_moduleInfo;
+    DxbcTessInfo                m_tessInfo;
+
+    std::mutex                  m_mutex;
+    std::condition_variable     m_cond;
+
+    D3D11ShaderData             m_data;
+
+    Rc<DxvkShader> Translate();
+
+    void SetShader(
+      const Rc<DxvkShader>&       Shader);
+
+  };
+
+
   /**
    * \brief Common shader object
    * 
    * Stores the compiled SPIR-V shader and the SHA-1
    * hash of the original DXBC shader, which can be
-   * used to identify the shader.
+   * used to identify the shader. The shader may
+   * still be in the process of being translated.
    */
   class D3D11CommonShader {
     
@@ -32,29 +160,35 @@ namespace dxvk {
     
     D3D11CommonShader();
     D3D11CommonShader(
-            D3D11Device*    pDevice,
-      const DxvkShaderKey*  pShaderKey,
-      const DxbcModuleInfo* pDxbcModuleInfo,
-      const void*           pShaderBytecode,
-            size_t          BytecodeLength);
+      const Rc<D3D11ShaderTranslation>& Translation);
     ~D3D11CommonShader();
 
+    /**
+     * \brief Retrieves the shader
+     *
+     * Blocks until the shader has been
+     * translated, if necessary.
+     * \returns The shader
+     */
     Rc<DxvkShader> GetShader() const {
-      return m_shader;
+      return m_translation != nullptr
+        ? m_translation->GetData().shader
+        : nullptr;
     }
 
     Rc<DxvkBuffer> GetIcb() const {
-      return m_buffer;
+      return m_translation != nullptr
+        ? m_translation->GetData().buffer
+        : nullptr;
     }
     
     std::string GetName() const {
-      return m_shader->debugName();
+      return m_translation->GetShaderKey().toString();
     }
     
   private:
     
-    Rc<DxvkShader> m_shader;
-    Rc<DxvkBuffer> m_buffer;
+    Rc<D3D11ShaderTranslation> m_translation;
     
   };
   
@@ -132,12 +266,17 @@ namespace dxvk {
    * times, so we should cache the resulting shader modules
    * and reuse them rather than creating new ones. This
    * class is thread-safe.
+   *
+   * Shaders are translated on a pool of worker threads, so
+   * that applications creating many shaders at once are not
+   * limited to a single core. Concurrent requests for the
+   * same shader share one translation.
    */
   class D3D11ShaderModuleSet {
     
   public:
     
-    D3D11ShaderModuleSet();
+    D3D11ShaderModuleSet(int32_t NumThreads);
     ~D3D11ShaderModuleSet();
     
     D3D11CommonShader GetShaderModule(
@@ -155,6 +294,22 @@ namespace dxvk {
       DxvkShaderKey,
       D3D11CommonShader,
       DxvkHash, DxvkEq> m_modules;
+
+    std::atomic<bool>                       m_stopThreads = { false };
+
+    std::mutex                              m_queueMutex;
+    std::condition_variable                 m_queueCond;
+    std::queue<Rc<D3D11ShaderTranslation>>  m_queue;
+    std::vector<dxvk::thread>               m_workers;
+
+    Rc<D3D11ShaderTranslation> CreateTranslation(
+            D3D11Device*    pDevice,
+      const DxvkShaderKey*  pShaderKey,
+      const DxbcModuleInfo* pDxbcModuleInfo,
+      const void*           pShaderBytecode,
+            size_t          BytecodeLength);
+
+    void RunWorker();
     
   };
   
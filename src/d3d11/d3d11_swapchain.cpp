@@ -28,6 +28,8 @@ namespace dxvk {
     if (!pDevice->GetOptions()->deferSurfaceCreation)
       CreatePresenter();
     
+    m_fpsLimiter.setTargetFrameRate(pDevice->GetOptions()->maxFrameRate);
+
     CreateBackBuffer();
     CreateHud();
     
@@ -204,9 +206,13 @@ namespace dxvk {
     auto syncEvent = m_dxgiDevice->GetFrameSyncEvent(m_desc.BufferCount);
     syncEvent->wait();
     
-    if (m_hud != nullptr)
+    if (m_hud != nullptr) {
       m_hud->update();
 
+      if (m_fpsLimiter.isEnabled())
+        m_hud->setFpsLimiterStats(m_fpsLimiter.getStats());
+    }
+
     for (uint32_t i = 0; i < SyncInterval || i < 1; i++) {
       SynchronizePresent();
 
@@ -240,17 +246,20 @@ namespace dxvk {
 
       uint32_t imageIndex = 0;
 
-      VkResult status = m_presenter->acquireNextImage(
-        sync.acquire, VK_NULL_HANDLE, imageIndex);
+      { DxvkProfilerZone zone("Acquire image");
 
-      while (status != VK_SUCCESS && status != VK_SUBOPTIMAL_KHR) {
-        RecreateSwapChain(m_vsync);
-        
-        info = m_presenter->info();
-        sync = m_presenter->getSyncSemaphores();
-
-        status = m_presenter->acquireNextImage(
+        VkResult status = m_presenter->acquireNextImage(
           sync.acquire, VK_NULL_HANDLE, imageIndex);
+
+        while (status != VK_SUCCESS && status != VK_SUBOPTIMAL_KHR) {
+          RecreateSwapChain(m_vsync);
+          
+          info = m_presenter->info();
+          sync = m_presenter->getSyncSemaphores();
+
+          status = m_presenter->acquireNextImage(
+            sync.acquire, VK_NULL_HANDLE, imageIndex);
+        }
       }
 
       // Use an appropriate texture filter depending on whether
@@ -309,6 +318,11 @@ namespace dxvk {
         m_context->endRecording(),
         sync.acquire, sync.present);
       
+      // Only limit the first present if the
+      // image gets repeated for vsync purposes
+      if (i == 0)
+        m_fpsLimiter.delay();
+
       m_device->presentImage(m_presenter,
         sync.present, &m_presentStatus);
 
@@ -325,6 +339,8 @@ namespace dxvk {
     
     if (status != VK_SUCCESS)
       RecreateSwapChain(m_vsync);
+    else
+      m_fpsLimiter.notifyPresent(m_presentStatus.presentTime);
   }
 
 
@@ -4,6 +4,8 @@
 
 #include "../dxvk/hud/dxvk_hud.h"
 
+#include "../util/util_fps_limiter.h"
+
 namespace dxvk {
   
   class D3D11Device;
@@ -115,6 +117,8 @@ namespace dxvk {
 
     DxvkSubmitStatus        m_presentStatus;
 
+    FpsLimiter              m_fpsLimiter;
+
     std::vector<Rc<DxvkImageView>> m_imageViews;
 
     bool                    m_dirty = true;
@@ -17,7 +17,8 @@ namespace dxvk {
     const Rc<DxbcIsgn>&       osgn,
     const Rc<DxbcIsgn>&       psgn,
     const DxbcAnalysisInfo&   analysis)
-  : m_moduleInfo (moduleInfo),
+  : m_fileName   (fileName),
+    m_moduleInfo (moduleInfo),
     m_programInfo(programInfo),
     m_isgn       (isgn),
     m_osgn       (osgn),
@@ -252,13 +253,28 @@ namespace dxvk {
         shaderOptions.xfbStrides[i] = m_moduleInfo.xfb->strides[i];
     }
 
+    SpirvCodeBuffer code = m_module.compile();
+
+    if (m_moduleInfo.options.spirvPasses.raw()) {
+      SpirvOptimizer optimizer(m_moduleInfo.options.spirvPasses);
+      code = optimizer.run(code);
+
+      if (Logger::logLevel() <= LogLevel::Debug) {
+        SpirvOptimizerStats stats = optimizer.getStats();
+
+        Logger::debug(str::format(m_fileName, ": Optimized SPIR-V from ",
+          stats.insCountBefore, " to ", stats.insCountAfter, " instructions in ",
+          stats.timeUs, " us"));
+      }
+    }
+
     // Create the shader module object
     return new DxvkShader(
       m_programInfo.shaderStage(),
       m_resourceSlots.size(),
       m_resourceSlots.data(),
       m_interfaceSlots,
-      m_module.compile(),
+      std::move(code),
       shaderOptions,
       std::move(m_immConstData));
   }
@@ -67,6 +67,23 @@ namespace dxvk {
   }
   
   
+  uint32_t DxbcModule::instructionCount() const {
+    if (m_shexChunk == nullptr)
+      return 0;
+    
+    DxbcCodeSlice     slice = m_shexChunk->slice();
+    DxbcDecodeContext decoder;
+    uint32_t          count = 0;
+    
+    while (!slice.atEnd()) {
+      decoder.decodeInstruction(slice);
+      count += 1;
+    }
+    
+    return count;
+  }
+  
+  
   Rc<DxvkShader> DxbcModule::compilePassthroughShader(
     const DxbcModuleInfo& moduleInfo,
     const std::string&    fileName) const {
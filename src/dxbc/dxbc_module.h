@@ -48,6 +48,16 @@ namespace dxvk {
     Rc<DxbcIsgn> isgn() const { return m_isgnChunk; }
     Rc<DxbcIsgn> osgn() const { return m_osgnChunk; }
     
+    /**
+     * \brief Counts shader instructions
+     * 
+     * Decodes the SHDR/SHEX chunk and returns the number
+     * of instructions, including declarations. Only used
+     * for statistics, so this is not particularly fast.
+     * \returns Instruction count
+     */
+    uint32_t instructionCount() const;
+    
     /**
      * \brief Compiles DXBC shader to SPIR-V module
      * 
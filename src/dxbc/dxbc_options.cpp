@@ -40,6 +40,15 @@ namespace dxvk {
     strictDivision           = options.strictDivision;
     zeroInitWorkgroupMemory  = options.zeroInitWorkgroupMemory;
 
+    if (options.spirvPromoteRegisters)
+      spirvPasses.set(SpirvPass::PromoteRegisters);
+    if (options.spirvDedupConstants)
+      spirvPasses.set(SpirvPass::DedupConstants);
+    if (options.spirvFoldBranches)
+      spirvPasses.set(SpirvPass::FoldBranches);
+    if (options.spirvEliminateDeadCode)
+      spirvPasses.set(SpirvPass::EliminateDeadCode);
+
     if (DxvkGpuVendor(devInfo.core.properties.vendorID) != DxvkGpuVendor::Amd)
       constantBufferRangeCheck = options.constantBufferRangeCheck;
     
@@ -2,6 +2,8 @@
 
 #include "../dxvk/dxvk_device.h"
 
+#include "../spirv/spirv_optimizer.h"
+
 namespace dxvk {
 
   struct D3D11Options;
@@ -44,6 +46,10 @@ namespace dxvk {
 
     /// Minimum storage buffer alignment
     VkDeviceSize minSsboAlignment = 0;
+
+    /// SPIR-V optimization passes to run
+    /// on the generated shader code
+    SpirvPassFlags spirvPasses = 0;
   };
   
 }
\ No newline at end of file
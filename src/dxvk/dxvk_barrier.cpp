@@ -4,7 +4,8 @@ namespace dxvk {
   
   DxvkBarrierSet:: DxvkBarrierSet(DxvkCmdBuffer cmdBuffer)
   : m_cmdBuffer(cmdBuffer) {
-
+    m_bufHeads.fill(InvalidIndex);
+    m_imgHeads.fill(InvalidIndex);
   }
 
 
@@ -31,7 +32,7 @@ namespace dxvk {
     m_srcAccess |= srcAccess;
     m_dstAccess |= dstAccess;
 
-    m_bufSlices.push_back({ bufSlice, access });
+    this->insertBufferSlice(bufSlice, access);
   }
   
   
@@ -70,10 +71,10 @@ namespace dxvk {
       barrier.image                       = image->handle();
       barrier.subresourceRange            = subresources;
       barrier.subresourceRange.aspectMask = image->formatInfo()->aspectMask;
-      m_imgBarriers.push_back(barrier);
+      this->insertImageBarrier(barrier);
     }
 
-    m_imgSlices.push_back({ image.ptr(), subresources, access });
+    this->insertImageSlice(image.ptr(), subresources, access);
   }
 
 
@@ -108,8 +109,8 @@ namespace dxvk {
     acquire.m_bufBarriers.push_back(barrier);
 
     DxvkAccessFlags access(DxvkAccess::Read, DxvkAccess::Write);
-    release.m_bufSlices.push_back({ bufSlice, access });
-    acquire.m_bufSlices.push_back({ bufSlice, access });
+    release.insertBufferSlice(bufSlice, access);
+    acquire.insertBufferSlice(bufSlice, access);
   }
 
 
@@ -142,35 +143,36 @@ namespace dxvk {
     barrier.image                       = image->handle();
     barrier.subresourceRange            = subresources;
     barrier.subresourceRange.aspectMask = image->formatInfo()->aspectMask;
-    release.m_imgBarriers.push_back(barrier);
+    release.insertImageBarrier(barrier);
 
     if (srcQueue == dstQueue)
       barrier.oldLayout = dstLayout;
 
     barrier.srcAccessMask               = 0;
     barrier.dstAccessMask               = dstAccess;
-    acquire.m_imgBarriers.push_back(barrier);
+    acquire.insertImageBarrier(barrier);
 
     DxvkAccessFlags access(DxvkAccess::Read, DxvkAccess::Write);
-    release.m_imgSlices.push_back({ image.ptr(), subresources, access });
-    acquire.m_imgSlices.push_back({ image.ptr(), subresources, access });
+    release.insertImageSlice(image.ptr(), subresources, access);
+    acquire.insertImageSlice(image.ptr(), subresources, access);
   }
 
 
   bool DxvkBarrierSet::isBufferDirty(
     const DxvkBufferSliceHandle&    bufSlice,
           DxvkAccessFlags           bufAccess) {
-    bool result = false;
+    VkDeviceSize start = bufSlice.offset;
+    VkDeviceSize end   = bufSlice.offset + bufSlice.length;
 
-    for (uint32_t i = 0; i < m_bufSlices.size() && !result; i++) {
-      const DxvkBufferSliceHandle& dstSlice = m_bufSlices[i].slice;
+    for (uint32_t i = m_bufHeads[getHashIndex(bufSlice.handle)]; i != InvalidIndex; i = m_bufSlices[i].next) {
+      const BufSlice& slice = m_bufSlices[i];
 
-      result = (bufSlice.handle == dstSlice.handle) && (bufAccess | m_bufSlices[i].access).test(DxvkAccess::Write)
-            && (bufSlice.offset + bufSlice.length > dstSlice.offset)
-            && (bufSlice.offset < dstSlice.offset + dstSlice.length);
+      if ((bufSlice.handle == slice.handle) && (bufAccess | slice.access).test(DxvkAccess::Write)
+       && (end > slice.start) && (start < slice.end))
+        return true;
     }
 
-    return result;
+    return false;
   }
 
 
@@ -178,19 +180,15 @@ namespace dxvk {
     const Rc<DxvkImage>&            image,
     const VkImageSubresourceRange&  imgSubres,
           DxvkAccessFlags           imgAccess) {
-    bool result = false;
-
-    for (uint32_t i = 0; i < m_imgSlices.size() && !result; i++) {
-      const VkImageSubresourceRange& dstSubres = m_imgSlices[i].subres;
+    for (uint32_t i = m_imgHeads[getHashIndex(image.ptr())]; i != InvalidIndex; i = m_imgSlices[i].next) {
+      const ImgSlice& slice = m_imgSlices[i];
 
-      result = (image == m_imgSlices[i].image) && (imgAccess | m_imgSlices[i].access).test(DxvkAccess::Write)
-            && (imgSubres.baseArrayLayer < dstSubres.baseArrayLayer + dstSubres.layerCount)
-            && (imgSubres.baseArrayLayer + imgSubres.layerCount     > dstSubres.baseArrayLayer)
-            && (imgSubres.baseMipLevel   < dstSubres.baseMipLevel   + dstSubres.levelCount)
-            && (imgSubres.baseMipLevel   + imgSubres.levelCount     > dstSubres.baseMipLevel);
+      if ((image == slice.image) && (imgAccess | slice.access).test(DxvkAccess::Write)
+       && overlapsSubresources(imgSubres, slice.subres))
+        return true;
     }
 
-    return result;
+    return false;
   }
 
 
@@ -198,13 +196,15 @@ namespace dxvk {
     const DxvkBufferSliceHandle&    bufSlice) {
     DxvkAccessFlags access;
 
-    for (uint32_t i = 0; i < m_bufSlices.size(); i++) {
-      const DxvkBufferSliceHandle& dstSlice = m_bufSlices[i].slice;
+    VkDeviceSize start = bufSlice.offset;
+    VkDeviceSize end   = bufSlice.offset + bufSlice.length;
+
+    for (uint32_t i = m_bufHeads[getHashIndex(bufSlice.handle)]; i != InvalidIndex; i = m_bufSlices[i].next) {
+      const BufSlice& slice = m_bufSlices[i];
 
-      if ((bufSlice.handle == dstSlice.handle)
-       && (bufSlice.offset + bufSlice.length > dstSlice.offset)
-       && (bufSlice.offset < dstSlice.offset + dstSlice.length))
-        access = access | m_bufSlices[i].access;
+      if ((bufSlice.handle == slice.handle)
+       && (end > slice.start) && (start < slice.end))
+        access = access | slice.access;
     }
 
     return access;
@@ -216,15 +216,12 @@ namespace dxvk {
     const VkImageSubresourceRange&  imgSubres) {
     DxvkAccessFlags access;
 
-    for (uint32_t i = 0; i < m_imgSlices.size(); i++) {
-      const VkImageSubresourceRange& dstSubres = m_imgSlices[i].subres;
+    for (uint32_t i = m_imgHeads[getHashIndex(image.ptr())]; i != InvalidIndex; i = m_imgSlices[i].next) {
+      const ImgSlice& slice = m_imgSlices[i];
 
-      if ((image == m_imgSlices[i].image)
-       && (imgSubres.baseArrayLayer < dstSubres.baseArrayLayer + dstSubres.layerCount)
-       && (imgSubres.baseArrayLayer + imgSubres.layerCount     > dstSubres.baseArrayLayer)
-       && (imgSubres.baseMipLevel   < dstSubres.baseMipLevel   + dstSubres.levelCount)
-       && (imgSubres.baseMipLevel   + imgSubres.levelCount     > dstSubres.baseMipLevel))
-        access = access | m_imgSlices[i].access;
+      if ((image == slice.image)
+       && overlapsSubresources(imgSubres, slice.subres))
+        access = access | slice.access;
     }
 
     return access;
@@ -245,9 +242,14 @@ namespace dxvk {
       memBarrier.srcAccessMask = m_srcAccess;
       memBarrier.dstAccessMask = m_dstAccess;
 
+      // Write-after-read hazards only need an execution
+      // dependency, so the memory barrier can be dropped
+      // if none of the pending accesses wrote any data.
       VkMemoryBarrier* pMemBarrier = nullptr;
-      if (m_srcAccess | m_dstAccess)
+      if (getAccessTypes(m_srcAccess).test(DxvkAccess::Write))
         pMemBarrier = &memBarrier;
+      else if (m_srcAccess | m_dstAccess)
+        m_avoidedCount += 1;
       
       commandList->cmdPipelineBarrier(
         m_cmdBuffer, srcFlags, dstFlags, 0,
@@ -257,8 +259,14 @@ namespace dxvk {
         m_imgBarriers.size(),
         m_imgBarriers.data());
       
+      commandList->addStatCtr(DxvkStatCounter::CmdBarrierCount, 1);
       this->reset();
     }
+
+    if (m_avoidedCount) {
+      commandList->addStatCtr(DxvkStatCounter::CmdBarriersAvoided, m_avoidedCount);
+      m_avoidedCount = 0;
+    }
   }
   
   
@@ -272,9 +280,109 @@ namespace dxvk {
     m_bufBarriers.resize(0);
     m_imgBarriers.resize(0);
 
+    m_bufHeads.fill(InvalidIndex);
+    m_imgHeads.fill(InvalidIndex);
+
     m_bufSlices.resize(0);
     m_imgSlices.resize(0);
   }
+
+
+  void DxvkBarrierSet::insertBufferSlice(
+    const DxvkBufferSliceHandle&    bufSlice,
+          DxvkAccessFlags           access) {
+    uint32_t index = getHashIndex(bufSlice.handle);
+
+    VkDeviceSize start = bufSlice.offset;
+    VkDeviceSize end   = bufSlice.offset + bufSlice.length;
+
+    for (uint32_t i = m_bufHeads[index]; i != InvalidIndex; i = m_bufSlices[i].next) {
+      BufSlice& slice = m_bufSlices[i];
+
+      if (slice.handle != bufSlice.handle)
+        continue;
+
+      // The range is already tracked with at least the same
+      // access types, so there is nothing new to synchronize
+      if (start >= slice.start && end <= slice.end
+       && (slice.access | access) == slice.access)
+        return;
+
+      // Extend ranges with identical access types. Since
+      // hazard checks only look at overlapping ranges and
+      // the union of access types, this is conservative.
+      if (slice.access == access && start <= slice.end && end >= slice.start) {
+        slice.start = std::min(slice.start, start);
+        slice.end   = std::max(slice.end,   end);
+        return;
+      }
+    }
+
+    BufSlice slice;
+    slice.handle = bufSlice.handle;
+    slice.start  = start;
+    slice.end    = end;
+    slice.access = access;
+    slice.next   = m_bufHeads[index];
+
+    m_bufHeads[index] = uint32_t(m_bufSlices.size());
+    m_bufSlices.push_back(slice);
+  }
+
+
+  void DxvkBarrierSet::insertImageSlice(
+          DxvkImage*                image,
+    const VkImageSubresourceRange&  subres,
+          DxvkAccessFlags           access) {
+    uint32_t index = getHashIndex(image);
+
+    for (uint32_t i = m_imgHeads[index]; i != InvalidIndex; i = m_imgSlices[i].next) {
+      ImgSlice& slice = m_imgSlices[i];
+
+      if (slice.image != image)
+        continue;
+
+      if (containsSubresources(slice.subres, subres)
+       && (slice.access | access) == slice.access)
+        return;
+
+      if (slice.access == access && mergeSubresources(slice.subres, subres))
+        return;
+    }
+
+    ImgSlice slice;
+    slice.image  = image;
+    slice.subres = subres;
+    slice.access = access;
+    slice.next   = m_imgHeads[index];
+
+    m_imgHeads[index] = uint32_t(m_imgSlices.size());
+    m_imgSlices.push_back(slice);
+  }
+
+
+  void DxvkBarrierSet::insertImageBarrier(
+    const VkImageMemoryBarrier&     barrier) {
+    // Layout transitions of the same image are typically
+    // issued for one subresource at a time, e.g. when
+    // rendering to individual mips or array layers, so
+    // try to fold them into a single barrier.
+    for (auto& entry : m_imgBarriers) {
+      if (entry.image               == barrier.image
+       && entry.oldLayout           == barrier.oldLayout
+       && entry.newLayout           == barrier.newLayout
+       && entry.srcAccessMask       == barrier.srcAccessMask
+       && entry.dstAccessMask       == barrier.dstAccessMask
+       && entry.srcQueueFamilyIndex == barrier.srcQueueFamilyIndex
+       && entry.dstQueueFamilyIndex == barrier.dstQueueFamilyIndex
+       && mergeSubresources(entry.subresourceRange, barrier.subresourceRange)) {
+        m_avoidedCount += 1;
+        return;
+      }
+    }
+
+    m_imgBarriers.push_back(barrier);
+  }
   
   
   DxvkAccessFlags DxvkBarrierSet::getAccessTypes(VkAccessFlags flags) const {
@@ -308,4 +416,63 @@ namespace dxvk {
     return result;
   }
   
+
+
+  bool DxvkBarrierSet::mergeSubresources(
+          VkImageSubresourceRange&  dst,
+    const VkImageSubresourceRange&  src) {
+    if (dst.aspectMask != src.aspectMask)
+      return false;
+
+    // Only merge if the union of both ranges is itself a
+    // range, i.e. one dimension is identical and the other
+    // one is adjacent or overlapping.
+    if (dst.baseMipLevel == src.baseMipLevel
+     && dst.levelCount   == src.levelCount
+     && dst.baseArrayLayer <= src.baseArrayLayer + src.layerCount
+     && src.baseArrayLayer <= dst.baseArrayLayer + dst.layerCount) {
+      uint32_t end = std::max(
+        dst.baseArrayLayer + dst.layerCount,
+        src.baseArrayLayer + src.layerCount);
+      dst.baseArrayLayer = std::min(dst.baseArrayLayer, src.baseArrayLayer);
+      dst.layerCount     = end - dst.baseArrayLayer;
+      return true;
+    }
+
+    if (dst.baseArrayLayer == src.baseArrayLayer
+     && dst.layerCount     == src.layerCount
+     && dst.baseMipLevel <= src.baseMipLevel + src.levelCount
+     && src.baseMipLevel <= dst.baseMipLevel + dst.levelCount) {
+      uint32_t end = std::max(
+        dst.baseMipLevel + dst.levelCount,
+        src.baseMipLevel + src.levelCount);
+      dst.baseMipLevel = std::min(dst.baseMipLevel, src.baseMipLevel);
+      dst.levelCount   = end - dst.baseMipLevel;
+      return true;
+    }
+
+    return false;
+  }
+
+
+  bool DxvkBarrierSet::containsSubresources(
+    const VkImageSubresourceRange&  dst,
+    const VkImageSubresourceRange&  src) {
+    return (dst.aspectMask & src.aspectMask) == src.aspectMask
+        && (src.baseArrayLayer                  >= dst.baseArrayLayer)
+        && (src.baseArrayLayer + src.layerCount <= dst.baseArrayLayer + dst.layerCount)
+        && (src.baseMipLevel                    >= dst.baseMipLevel)
+        && (src.baseMipLevel   + src.levelCount <= dst.baseMipLevel   + dst.levelCount);
+  }
+
+
+  bool DxvkBarrierSet::overlapsSubresources(
+    const VkImageSubresourceRange&  a,
+    const VkImageSubresourceRange&  b) {
+    return (a.baseArrayLayer < b.baseArrayLayer + b.layerCount)
+        && (a.baseArrayLayer + a.layerCount     > b.baseArrayLayer)
+        && (a.baseMipLevel   < b.baseMipLevel   + b.levelCount)
+        && (a.baseMipLevel   + a.levelCount     > b.baseMipLevel);
+  }
+  
 }
\ No newline at end of file
@@ -12,6 +12,14 @@ namespace dxvk {
    * Accumulates memory barriers and provides a
    * method to record all those barriers into a
    * command buffer at once.
+   *
+   * Accessed resource ranges are stored in a small
+   * hash table keyed by the resource, so that hazard
+   * checks only need to look at ranges of the same
+   * resource. Compatible accesses to adjacent or
+   * overlapping ranges are merged into one entry,
+   * and accesses which are already fully covered
+   * by a pending one are dropped.
    */
   class DxvkBarrierSet {
     
@@ -79,6 +87,17 @@ namespace dxvk {
     VkPipelineStageFlags getSrcStages() {
       return m_srcStages;
     }
+
+    /**
+     * \brief Counts an avoided barrier
+     *
+     * Used by the context when a barrier is skipped
+     * because the app allows relaxed synchronization.
+     * The count is reported on the next flush.
+     */
+    void countAvoidedBarrier() {
+      m_avoidedCount += 1;
+    }
     
     void recordCommands(
       const Rc<DxvkCommandList>&      commandList);
@@ -87,15 +106,23 @@ namespace dxvk {
     
   private:
 
+    constexpr static uint32_t HashTableBits = 6;
+    constexpr static uint32_t HashTableSize = 1u << HashTableBits;
+    constexpr static uint32_t InvalidIndex  = ~0u;
+
     struct BufSlice {
-      DxvkBufferSliceHandle   slice;
+      VkBuffer                handle;
+      VkDeviceSize            start;
+      VkDeviceSize            end;
       DxvkAccessFlags         access;
+      uint32_t                next;
     };
 
     struct ImgSlice {
       DxvkImage*              image;
       VkImageSubresourceRange subres;
       DxvkAccessFlags         access;
+      uint32_t                next;
     };
 
     DxvkCmdBuffer m_cmdBuffer;
@@ -109,10 +136,45 @@ namespace dxvk {
     std::vector<VkBufferMemoryBarrier> m_bufBarriers;
     std::vector<VkImageMemoryBarrier>  m_imgBarriers;
 
+    std::array<uint32_t, HashTableSize> m_bufHeads;
+    std::array<uint32_t, HashTableSize> m_imgHeads;
+
     std::vector<BufSlice> m_bufSlices;
     std::vector<ImgSlice> m_imgSlices;
-    
+
+    uint32_t m_avoidedCount = 0;
+
+    void insertBufferSlice(
+      const DxvkBufferSliceHandle&    bufSlice,
+            DxvkAccessFlags           access);
+
+    void insertImageSlice(
+            DxvkImage*                image,
+      const VkImageSubresourceRange&  subres,
+            DxvkAccessFlags           access);
+
+    void insertImageBarrier(
+      const VkImageMemoryBarrier&     barrier);
+
     DxvkAccessFlags getAccessTypes(VkAccessFlags flags) const;
+
+    template<typename T>
+    static uint32_t getHashIndex(T object) {
+      uint64_t hash = uint64_t(std::hash<T>()(object));
+      return uint32_t((hash * 0x9e3779b97f4a7c15ull) >> (64 - HashTableBits));
+    }
+
+    static bool mergeSubresources(
+            VkImageSubresourceRange&  dst,
+      const VkImageSubresourceRange&  src);
+
+    static bool containsSubresources(
+      const VkImageSubresourceRange&  dst,
+      const VkImageSubresourceRange&  src);
+
+    static bool overlapsSubresources(
+      const VkImageSubresourceRange&  a,
+      const VkImageSubresourceRange&  b);
     
   };
   
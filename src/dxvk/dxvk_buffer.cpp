@@ -37,10 +37,62 @@ namespace dxvk {
   DxvkBuffer::~DxvkBuffer() {
     auto vkd = m_device->vkd();
 
+    if (m_registered) {
+      m_device->unregisterRenamedBuffer(this);
+
+      Logger::debug(str::format("DxvkBuffer: ",
+        m_renameCount, " renames, ",
+        m_physSliceTotal, " slices, ",
+        m_trimCount, " buffers trimmed"));
+    }
+
     for (const auto& buffer : m_buffers)
-      vkd->vkDestroyBuffer(vkd->device(), buffer.buffer, nullptr);
+      vkd->vkDestroyBuffer(vkd->device(), buffer.handle.buffer, nullptr);
     vkd->vkDestroyBuffer(vkd->device(), m_buffer.buffer, nullptr);
   }
+
+
+  void DxvkBuffer::updateSlicePool() {
+    // This is called while the device holds its list of renamed
+    // buffers locked, so we must not wait for allocSlice here
+    std::unique_lock<sync::Spinlock> freeLock(m_freeMutex, std::try_to_lock);
+
+    if (!freeLock)
+      return;
+
+    uint32_t frameRenames = uint32_t(m_renameCount - m_renameCountPrev);
+    m_renameCountPrev = m_renameCount;
+
+    m_renameHistory[m_renameFrame % RenameWindowSize] = frameRenames;
+    m_renameHighWater = 0;
+
+    for (uint32_t count : m_renameHistory)
+      m_renameHighWater = std::max(m_renameHighWater, count);
+
+    // Only consider trimming once per window. Buffers with
+    // views are never trimmed since views are cached per
+    // backing buffer handle, which may get reused.
+    if ((++m_renameFrame % RenameWindowSize) || m_hasViews.load())
+      return;
+
+    VkDeviceSize maxSliceCount = VkDeviceSize(m_renameHighWater) * SliceRetainFrames;
+
+    if (m_physSliceTotal > maxSliceCount)
+      this->trimSliceBuffers(maxSliceCount);
+  }
+
+
+  DxvkBufferRenameStats DxvkBuffer::getRenameStats() {
+    std::unique_lock<sync::Spinlock> freeLock(m_freeMutex);
+
+    DxvkBufferRenameStats result;
+    result.renameCount      = m_renameCount;
+    result.renameHighWater  = m_renameHighWater;
+    result.sliceCount       = uint32_t(m_physSliceTotal);
+    result.trimCount        = m_trimCount;
+    result.sliceMemory      = m_physSliceTotal * m_physSliceStride;
+    return result;
+  }
   
   
   DxvkBufferHandle DxvkBuffer::allocBuffer(VkDeviceSize sliceCount) const {
@@ -109,6 +161,92 @@ namespace dxvk {
   }
 
 
+  void DxvkBuffer::addSliceBuffer() {
+    std::unique_lock<sync::Spinlock> swapLock(m_swapMutex);
+
+    // Size the new backing buffer so that it can hold as many
+    // slices as were recently needed per frame, but keep
+    // doubling the size if we run out of slices repeatedly.
+    uint32_t frameRenames = uint32_t(m_renameCount - m_renameCountPrev);
+    VkDeviceSize sliceRate = std::max(m_renameHighWater, frameRenames);
+    VkDeviceSize sliceCount = m_physSliceCount;
+
+    while (sliceCount < sliceRate && sliceCount < m_physSliceMaxCount)
+      sliceCount *= 2;
+
+    sliceCount = std::min(sliceCount, m_physSliceMaxCount);
+
+    DxvkBufferHandle handle = allocBuffer(sliceCount);
+    
+    for (uint32_t i = 0; i < sliceCount; i++) {
+      DxvkBufferSliceHandle slice;
+      slice.handle = handle.buffer;
+      slice.offset = m_physSliceStride * i;
+      slice.length = m_physSliceLength;
+      slice.mapPtr = handle.memory.mapPtr(slice.offset);
+      m_freeSlices.push_back(slice);
+    }
+    
+    m_buffers.push_back({ std::move(handle), sliceCount });
+    m_physSliceCount = std::min(sliceCount * 2, m_physSliceMaxCount);
+    m_physSliceTotal += sliceCount;
+
+    if (!m_registered) {
+      m_device->registerRenamedBuffer(this);
+      m_registered = true;
+    }
+  }
+
+
+  void DxvkBuffer::trimSliceBuffers(
+          VkDeviceSize          maxSliceCount) {
+    std::unique_lock<sync::Spinlock> swapLock(m_swapMutex);
+
+    m_freeSlices.insert(m_freeSlices.end(),
+      m_nextSlices.begin(), m_nextSlices.end());
+    m_nextSlices.clear();
+
+    auto vkd = m_device->vkd();
+
+    // Release the most recently created backing buffers first since
+    // those are typically the largest. A buffer can only be released
+    // if all of its slices are free, which implies that none of them
+    // is the current slice or still in use by the GPU.
+    for (size_t i = m_buffers.size(); i > 0 && m_physSliceTotal > maxSliceCount; i--) {
+      const SliceBuffer& buffer = m_buffers[i - 1];
+
+      VkDeviceSize freeCount = 0;
+
+      for (const auto& slice : m_freeSlices) {
+        if (slice.handle == buffer.handle.buffer)
+          freeCount += 1;
+      }
+
+      if (freeCount != buffer.sliceCount)
+        continue;
+
+      m_freeSlices.erase(std::remove_if(m_freeSlices.begin(), m_freeSlices.end(),
+        [&buffer] (const DxvkBufferSliceHandle& slice) {
+          return slice.handle == buffer.handle.buffer;
+        }), m_freeSlices.end());
+
+      vkd->vkDestroyBuffer(vkd->device(), buffer.handle.buffer, nullptr);
+
+      m_physSliceTotal -= buffer.sliceCount;
+      m_trimCount += 1;
+
+      m_buffers.erase(m_buffers.begin() + (i - 1));
+    }
+
+    // Restart growing from the observed rate
+    m_physSliceCount = 1;
+
+    while (m_physSliceCount < m_renameHighWater && m_physSliceCount < m_physSliceMaxCount)
+      m_physSliceCount *= 2;
+
+    m_physSliceCount = std::min(m_physSliceCount, m_physSliceMaxCount);
+  }
+
   
   DxvkBufferView::DxvkBufferView(
     const Rc<vk::DeviceFn>&         vkd,
@@ -117,7 +255,7 @@ namespace dxvk {
   : m_vkd(vkd), m_info(info), m_buffer(buffer),
     m_bufferSlice (getSliceHandle()),
     m_bufferView  (createBufferView(m_bufferSlice)) {
-    
+    m_buffer->m_hasViews.store(true);
   }
   
   
@@ -63,6 +63,27 @@ namespace dxvk {
   };
   
 
+  /**
+   * \brief Buffer rename statistics
+   * 
+   * Describes how often a buffer has been renamed
+   * and how much memory is used for its slices.
+   */
+  struct DxvkBufferRenameStats {
+    /// Total number of slices allocated
+    uint64_t      renameCount;
+    /// Highest number of slices allocated
+    /// in a single frame within the window
+    uint32_t      renameHighWater;
+    /// Number of slices in backing buffers
+    uint32_t      sliceCount;
+    /// Number of backing buffers released
+    uint32_t      trimCount;
+    /// Memory used by backing buffers
+    VkDeviceSize  sliceMemory;
+  };
+  
+
   /**
    * \brief Buffer slice info
    * 
@@ -101,6 +122,8 @@ namespace dxvk {
    */
   class DxvkBuffer : public DxvkResource {
     friend class DxvkBufferView;
+    constexpr static uint32_t RenameWindowSize  = 16;
+    constexpr static uint32_t SliceRetainFrames = 4;
   public:
     
     DxvkBuffer(
@@ -243,23 +266,11 @@ namespace dxvk {
 
       // If there are still no slices available, create a new
       // backing buffer and add all slices to the free list.
-      if (unlikely(m_freeSlices.size() == 0)) {
-        std::unique_lock<sync::Spinlock> swapLock(m_swapMutex);
-        DxvkBufferHandle handle = allocBuffer(m_physSliceCount);
-        
-        for (uint32_t i = 0; i < m_physSliceCount; i++) {
-          DxvkBufferSliceHandle slice;
-          slice.handle = handle.buffer;
-          slice.offset = m_physSliceStride * i;
-          slice.length = m_physSliceLength;
-          slice.mapPtr = handle.memory.mapPtr(slice.offset);
-          m_freeSlices.push_back(slice);
-        }
-        
-        m_buffers.push_back(std::move(handle));
-        m_physSliceCount = std::min(m_physSliceCount * 2, m_physSliceMaxCount);
-      }
+      if (unlikely(m_freeSlices.size() == 0))
+        this->addSliceBuffer();
       
+      m_renameCount += 1;
+
       // Take the first slice from the queue
       DxvkBufferSliceHandle result = m_freeSlices.back();
       m_freeSlices.pop_back();
@@ -280,6 +291,24 @@ namespace dxvk {
       m_nextSlices.push_back(slice);
     }
     
+    /**
+     * \brief Updates slice pool
+     * 
+     * Called by the device once per frame for buffers
+     * that have allocated additional slices. Tracks the
+     * number of slices allocated per frame, and releases
+     * backing buffers that are entirely unused if the
+     * buffer holds far more slices than it needed over
+     * the last couple of frames.
+     */
+    void updateSlicePool();
+    
+    /**
+     * \brief Queries rename statistics
+     * \returns Rename statistics
+     */
+    DxvkBufferRenameStats getRenameStats();
+    
   private:
 
     DxvkDevice*             m_device;
@@ -295,7 +324,12 @@ namespace dxvk {
     sync::Spinlock m_freeMutex;
     sync::Spinlock m_swapMutex;
     
-    std::vector<DxvkBufferHandle>        m_buffers;
+    struct SliceBuffer {
+      DxvkBufferHandle  handle;
+      VkDeviceSize      sliceCount;
+    };
+
+    std::vector<SliceBuffer>             m_buffers;
     std::vector<DxvkBufferSliceHandle>   m_freeSlices;
     std::vector<DxvkBufferSliceHandle>   m_nextSlices;
     
@@ -303,9 +337,26 @@ namespace dxvk {
     VkDeviceSize m_physSliceStride   = 0;
     VkDeviceSize m_physSliceCount    = 1;
     VkDeviceSize m_physSliceMaxCount = 1;
+    VkDeviceSize m_physSliceTotal    = 0;
+
+    uint64_t m_renameCount      = 0;
+    uint64_t m_renameCountPrev  = 0;
+    uint32_t m_renameHighWater  = 0;
+    uint32_t m_renameFrame      = 0;
+    uint32_t m_trimCount        = 0;
+
+    std::array<uint32_t, RenameWindowSize> m_renameHistory = { };
+
+    std::atomic<bool> m_hasViews    = { false };
+    bool              m_registered  = false;
 
     DxvkBufferHandle allocBuffer(
             VkDeviceSize          sliceCount) const;
+
+    void addSliceBuffer();
+
+    void trimSliceBuffers(
+            VkDeviceSize          maxSliceCount);
     
   };
   
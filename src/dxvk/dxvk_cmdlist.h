@@ -288,6 +288,19 @@ namespace dxvk {
     }
     
     
+    void cmdBindDescriptorSets(
+            VkPipelineBindPoint       pipeline,
+            VkPipelineLayout          pipelineLayout,
+            uint32_t                  descriptorSetCount,
+      const VkDescriptorSet*          pDescriptorSets,
+            uint32_t                  dynamicOffsetCount,
+      const uint32_t*                 pDynamicOffsets) {
+      m_vkd->vkCmdBindDescriptorSets(m_execBuffer,
+        pipeline, pipelineLayout, 0, descriptorSetCount,
+        pDescriptorSets, dynamicOffsetCount, pDynamicOffsets);
+    }
+    
+    
     void cmdBindIndexBuffer(
             VkBuffer                buffer,
             VkDeviceSize            offset,
@@ -62,42 +62,93 @@ namespace dxvk {
   VkPipeline DxvkComputePipeline::getPipelineHandle(
     const DxvkComputePipelineStateInfo& state) {
     DxvkComputePipelineInstance* instance = nullptr;
+    bool isNewInstance = false;
 
     { std::lock_guard<sync::Spinlock> lock(m_mutex);
 
       instance = this->findInstance(state);
 
-      if (instance)
+      if (instance && instance->isReady())
         return instance->pipeline();
     
       // If no pipeline instance exists with the given state
       // vector, create a new one and add it to the list.
-      instance = this->createInstance(state);
+      if (!instance) {
+        instance = this->createInstance(state);
+        isNewInstance = true;
+      }
     }
-    
-    if (!instance)
-      return VK_NULL_HANDLE;
 
-    this->writePipelineStateToCache(state);
+    auto t0 = std::chrono::high_resolution_clock::now();
+
+    if (isNewInstance) {
+      this->compileInstance(instance, state);
+      this->writePipelineStateToCache(state);
+    } else {
+      this->waitForInstance(instance);
+    }
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    auto td = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0);
+
+    m_pipeMgr->m_stallTime += td.count();
     return instance->pipeline();
   }
 
 
   void DxvkComputePipeline::compilePipeline(
     const DxvkComputePipelineStateInfo& state) {
-    std::lock_guard<sync::Spinlock> lock(m_mutex);
+    DxvkComputePipelineInstance* instance = nullptr;
+
+    { std::lock_guard<sync::Spinlock> lock(m_mutex);
+
+      if (this->findInstance(state))
+        return;
+
+      instance = this->createInstance(state);
+    }
 
-    if (!this->findInstance(state))
-      this->createInstance(state);
+    this->compileInstance(instance, state);
   }
   
   
   DxvkComputePipelineInstance* DxvkComputePipeline::createInstance(
     const DxvkComputePipelineStateInfo& state) {
+    return &m_pipelines.emplace_back(state);
+  }
+
+
+  void DxvkComputePipeline::compileInstance(
+          DxvkComputePipelineInstance*  instance,
+    const DxvkComputePipelineStateInfo& state) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+
     VkPipeline newPipelineHandle = this->createPipeline(state);
 
+    auto t1 = std::chrono::high_resolution_clock::now();
+    auto td = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0);
+
+    if (Logger::logLevel() <= LogLevel::Debug)
+      Logger::debug(str::format("DxvkComputePipeline: Finished in ", td.count() / 1000, " ms"));
+
     m_pipeMgr->m_numComputePipelines += 1;
-    return &m_pipelines.emplace_back(state, newPipelineHandle);
+    m_pipeMgr->recordCompileTime(td.count());
+
+    { std::lock_guard<std::mutex> lock(m_compileMutex);
+      instance->setPipeline(newPipelineHandle);
+    }
+
+    m_compileCond.notify_all();
+  }
+
+
+  void DxvkComputePipeline::waitForInstance(
+          DxvkComputePipelineInstance*  instance) {
+    std::unique_lock<std::mutex> lock(m_compileMutex);
+
+    m_compileCond.wait(lock, [instance] () {
+      return instance->isReady();
+    });
   }
 
   
@@ -114,6 +165,8 @@ namespace dxvk {
   
   VkPipeline DxvkComputePipeline::createPipeline(
     const DxvkComputePipelineStateInfo& state) const {
+    DxvkProfilerZone zone("Compile compute pipeline");
+
     std::vector<VkDescriptorSetLayoutBinding> bindings;
 
     if (Logger::logLevel() <= LogLevel::Debug) {
@@ -144,12 +197,6 @@ namespace dxvk {
     info.basePipelineHandle   = VK_NULL_HANDLE;
     info.basePipelineIndex    = -1;
     
-    // Time pipeline compilation for debugging purposes
-    std::chrono::high_resolution_clock::time_point t0, t1;
-
-    if (Logger::logLevel() <= LogLevel::Debug)
-      t0 = std::chrono::high_resolution_clock::now();
-    
     VkPipeline pipeline = VK_NULL_HANDLE;
     if (m_vkd->vkCreateComputePipelines(m_vkd->device(),
           m_pipeMgr->m_cache->handle(), 1, &info, nullptr, &pipeline) != VK_SUCCESS) {
@@ -157,12 +204,6 @@ namespace dxvk {
       Logger::err(str::format("  cs  : ", m_shaders.cs->debugName()));
       return VK_NULL_HANDLE;
     }
-    
-    if (Logger::logLevel() <= LogLevel::Debug) {
-      t1 = std::chrono::high_resolution_clock::now();
-      auto td = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0);
-      Logger::debug(str::format("DxvkComputePipeline: Finished in ", td.count(), " ms"));
-    }
 
     return pipeline;
   }
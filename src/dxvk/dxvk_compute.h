@@ -1,6 +1,9 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <vector>
 
 #include "dxvk_bind_mask.h"
@@ -44,20 +47,19 @@ namespace dxvk {
 
   /**
    * \brief Compute pipeline instance
+   * 
+   * Added to the pipeline before compilation
+   * starts, so that other threads can wait for
+   * the pipeline to become available.
    */
   class DxvkComputePipelineInstance {
 
   public:
 
-    DxvkComputePipelineInstance()
-    : m_stateVector (),
-      m_pipeline    (VK_NULL_HANDLE) { }
-
     DxvkComputePipelineInstance(
-      const DxvkComputePipelineStateInfo& state,
-            VkPipeline                    pipe)
+      const DxvkComputePipelineStateInfo& state)
     : m_stateVector (state),
-      m_pipeline    (pipe) { }
+      m_pipeline    (VK_NULL_HANDLE) { }
 
     /**
      * \brief Checks for matching pipeline state
@@ -70,6 +72,23 @@ namespace dxvk {
       return m_stateVector == state;
     }
 
+    /**
+     * \brief Checks whether the pipeline is compiled
+     * \returns \c true if compilation has finished
+     */
+    bool isReady() const {
+      return m_ready.load(std::memory_order_acquire);
+    }
+
+    /**
+     * \brief Sets pipeline handle
+     * \param [in] pipe The pipeline handle
+     */
+    void setPipeline(VkPipeline pipe) {
+      m_pipeline = pipe;
+      m_ready.store(true, std::memory_order_release);
+    }
+
     /**
      * \brief Retrieves pipeline
      * \returns The pipeline handle
@@ -82,6 +101,7 @@ namespace dxvk {
 
     DxvkComputePipelineStateInfo m_stateVector;
     VkPipeline                   m_pipeline;
+    std::atomic<bool>            m_ready = { false };
 
   };
   
@@ -119,6 +139,8 @@ namespace dxvk {
     /**
      * \brief Retrieves pipeline handle
      * 
+     * If another thread is currently compiling a
+     * pipeline for the given state, this will wait.
      * \param [in] state Pipeline state
      * \returns Pipeline handle
      */
@@ -146,11 +168,21 @@ namespace dxvk {
     Rc<DxvkPipelineLayout>      m_layout;
     
     sync::Spinlock                           m_mutex;
-    std::vector<DxvkComputePipelineInstance> m_pipelines;
+    std::deque<DxvkComputePipelineInstance>  m_pipelines;
+
+    std::mutex                               m_compileMutex;
+    std::condition_variable                  m_compileCond;
     
     DxvkComputePipelineInstance* createInstance(
       const DxvkComputePipelineStateInfo& state);
     
+    void compileInstance(
+            DxvkComputePipelineInstance*  instance,
+      const DxvkComputePipelineStateInfo& state);
+    
+    void waitForInstance(
+            DxvkComputePipelineInstance*  instance);
+    
     DxvkComputePipelineInstance* findInstance(
       const DxvkComputePipelineStateInfo& state);
     
@@ -29,9 +29,16 @@ namespace dxvk {
     m_cmd = cmdList;
     m_cmd->beginRecording();
 
+    if (unlikely(DxvkProfiler::enabled()))
+      this->beginGpuProfilerZone();
+
     // Mark all resources as untracked
     m_vbTracked.clear();
     m_rcTracked.clear();
+
+    // Descriptor sets from the previous command
+    // list may be reset at any time from now on
+    m_descCache.reset();
     
     // The current state of the internal command buffer is
     // undefined, so we have to bind and set up everything
@@ -67,12 +74,17 @@ namespace dxvk {
     m_initBarriers.recordCommands(m_cmd);
     m_execBarriers.recordCommands(m_cmd);
 
+    if (unlikely(DxvkProfiler::enabled()))
+      this->endGpuProfilerZone();
+
     m_cmd->endRecording();
     return std::exchange(m_cmd, nullptr);
   }
 
 
   void DxvkContext::flushCommandList() {
+    DxvkProfilerZone zone("Flush command list");
+
     m_device->submitCommandList(
       this->endRecording(),
       VK_NULL_HANDLE,
@@ -156,9 +168,12 @@ namespace dxvk {
       needsUpdate = m_rc[slot].bufferSlice.length() != buffer.length();
 
     if (likely(needsUpdate)) {
+      m_rcDirtyGp.set(slot);
+      m_rcDirtyCp.set(slot);
+
       m_flags.set(
-        DxvkContextFlag::CpDirtyResources,
-        DxvkContextFlag::GpDirtyResources);
+        DxvkContextFlag::CpDirtyResourceSlots,
+        DxvkContextFlag::GpDirtyResourceSlots);
     } else {
       m_flags.set(
         DxvkContextFlag::CpDirtyDescriptorOffsets,
@@ -179,10 +194,12 @@ namespace dxvk {
       ? bufferView->slice()
       : DxvkBufferSlice();
     m_rcTracked.clr(slot);
+    m_rcDirtyGp.set(slot);
+    m_rcDirtyCp.set(slot);
 
     m_flags.set(
-      DxvkContextFlag::CpDirtyResources,
-      DxvkContextFlag::GpDirtyResources);
+      DxvkContextFlag::CpDirtyResourceSlots,
+      DxvkContextFlag::GpDirtyResourceSlots);
   }
   
   
@@ -191,10 +208,12 @@ namespace dxvk {
     const Rc<DxvkSampler>&      sampler) {
     m_rc[slot].sampler = sampler;
     m_rcTracked.clr(slot);
+    m_rcDirtyGp.set(slot);
+    m_rcDirtyCp.set(slot);
 
     m_flags.set(
-      DxvkContextFlag::CpDirtyResources,
-      DxvkContextFlag::GpDirtyResources);
+      DxvkContextFlag::CpDirtyResourceSlots,
+      DxvkContextFlag::GpDirtyResourceSlots);
   }
   
   
@@ -1368,6 +1387,9 @@ namespace dxvk {
 
   void DxvkContext::discardBuffer(
     const Rc<DxvkBuffer>&       buffer) {
+    if (m_barrierControl.test(DxvkBarrierControl::IgnoreImplicitRename))
+      return;
+
     if (m_execBarriers.isBufferDirty(buffer->getSliceHandle(), DxvkAccess::Write))
       this->invalidateBuffer(buffer, buffer->allocSlice());
   }
@@ -1883,7 +1905,8 @@ namespace dxvk {
     const void*                     data) {
     bool replaceBuffer = (size == buffer->info().size)
                       && (size <= (1 << 20)) /* 1 MB */
-                      && (m_flags.test(DxvkContextFlag::GpRenderPassBound));
+                      && (m_flags.test(DxvkContextFlag::GpRenderPassBound))
+                      && (!m_barrierControl.test(DxvkBarrierControl::IgnoreImplicitRename));
     
     DxvkBufferSliceHandle bufferSlice;
     DxvkCmdBuffer         cmdBuffer;
@@ -1950,6 +1973,82 @@ namespace dxvk {
   }
   
   
+  void DxvkContext::updateBufferRegions(
+    const Rc<DxvkBuffer>&           dstBuffer,
+    const Rc<DxvkBuffer>&           srcBuffer,
+          uint32_t                  regionCount,
+    const VkBufferCopy*             pRegions) {
+    // Same as updateBuffer, replace the buffer if it
+    // gets overwritten entirely within a render pass
+    bool replaceBuffer = (regionCount == 1)
+                      && (pRegions[0].dstOffset == 0)
+                      && (pRegions[0].size == dstBuffer->info().size)
+                      && (pRegions[0].size <= (1 << 20)) /* 1 MB */
+                      && (m_flags.test(DxvkContextFlag::GpRenderPassBound))
+                      && (!m_barrierControl.test(DxvkBarrierControl::IgnoreImplicitRename));
+    
+    DxvkBufferSliceHandle dstSlice;
+    DxvkCmdBuffer         cmdBuffer;
+
+    if (replaceBuffer) {
+      dstSlice  = dstBuffer->allocSlice();
+      cmdBuffer = DxvkCmdBuffer::InitBuffer;
+
+      this->invalidateBuffer(dstBuffer, dstSlice);
+    } else {
+      this->spillRenderPass();
+
+      dstSlice  = dstBuffer->getSliceHandle();
+      cmdBuffer = DxvkCmdBuffer::ExecBuffer;
+
+      bool isDirty = false;
+
+      for (uint32_t i = 0; i < regionCount && !isDirty; i++) {
+        isDirty = m_execBarriers.isBufferDirty(
+          dstBuffer->getSliceHandle(pRegions[i].dstOffset, pRegions[i].size),
+          DxvkAccess::Write);
+      }
+
+      if (isDirty)
+        m_execBarriers.recordCommands(m_cmd);
+    }
+
+    // The staging buffer is only ever written by the host,
+    // so we do not need to check it for pending accesses
+    auto srcSlice = srcBuffer->getSliceHandle();
+
+    auto& barriers = replaceBuffer
+      ? m_initBarriers
+      : m_execBarriers;
+
+    std::array<VkBufferCopy, 16> regions;
+
+    for (uint32_t i = 0; i < regionCount; i += regions.size()) {
+      uint32_t count = std::min<uint32_t>(regionCount - i, regions.size());
+
+      for (uint32_t j = 0; j < count; j++) {
+        regions[j].srcOffset = srcSlice.offset + pRegions[i + j].srcOffset;
+        regions[j].dstOffset = dstSlice.offset + pRegions[i + j].dstOffset;
+        regions[j].size      = pRegions[i + j].size;
+
+        barriers.accessBuffer(
+          dstBuffer->getSliceHandle(pRegions[i + j].dstOffset, pRegions[i + j].size),
+          VK_PIPELINE_STAGE_TRANSFER_BIT,
+          VK_ACCESS_TRANSFER_WRITE_BIT,
+          dstBuffer->info().stages,
+          dstBuffer->info().access);
+      }
+
+      m_cmd->cmdCopyBuffer(cmdBuffer,
+        srcSlice.handle, dstSlice.handle,
+        count, regions.data());
+    }
+
+    m_cmd->trackResource<DxvkAccess::Write>(dstBuffer);
+    m_cmd->trackResource<DxvkAccess::Read>(srcBuffer);
+  }
+  
+  
   void DxvkContext::updateImage(
     const Rc<DxvkImage>&            image,
     const VkImageSubresourceLayers& subresources,
@@ -3650,10 +3749,25 @@ namespace dxvk {
       ? DxvkContextFlag::GpDynamicStencilRef
       : DxvkContextFlag::GpDirtyStencilRef);
     
-    // Retrieve and bind actual Vulkan pipeline handle
-    m_gpActivePipeline = m_state.gp.pipeline != nullptr && m_state.om.framebuffer != nullptr
-      ? m_state.gp.pipeline->getPipelineHandle(m_state.gp.state, m_state.om.framebuffer->getRenderPass())
-      : VK_NULL_HANDLE;
+    // Retrieve and bind actual Vulkan pipeline handle. In async
+    // mode, skip draws until the pipeline becomes available, and
+    // keep the pipeline state dirty so that we check again on the
+    // next draw. Transform feedback must not skip any draws.
+    m_gpActivePipeline = VK_NULL_HANDLE;
+
+    if (m_state.gp.pipeline != nullptr && m_state.om.framebuffer != nullptr) {
+      auto renderPass = m_state.om.framebuffer->getRenderPass();
+
+      if (m_device->config().enableAsyncPipelines
+       && !m_state.gp.flags.test(DxvkGraphicsPipelineFlag::HasTransformFeedback)) {
+        if (!m_state.gp.pipeline->tryGetPipelineHandle(m_state.gp.state, renderPass, m_gpActivePipeline)) {
+          m_flags.set(DxvkContextFlag::GpDirtyPipelineState);
+          m_cmd->addStatCtr(DxvkStatCounter::CmdDrawsSkipped, 1);
+        }
+      } else {
+        m_gpActivePipeline = m_state.gp.pipeline->getPipelineHandle(m_state.gp.state, renderPass);
+      }
+    }
     
     if (m_gpActivePipeline != VK_NULL_HANDLE) {
       m_cmd->cmdBindPipeline(
@@ -3667,14 +3781,33 @@ namespace dxvk {
     if (m_state.cp.pipeline == nullptr)
       return;
 
-    if ((m_flags.test(DxvkContextFlag::CpDirtyResources))
-     || (m_flags.test(DxvkContextFlag::CpDirtyDescriptorOffsets)
-      && m_state.cp.pipeline->layout()->hasStaticBufferBindings())) {
-      m_flags.clr(DxvkContextFlag::CpDirtyResources);
+    const DxvkPipelineLayout* layout = m_state.cp.pipeline->layout();
 
-      if (this->updateShaderResources<VK_PIPELINE_BIND_POINT_COMPUTE>(m_state.cp.pipeline->layout()))
+    uint32_t dirtySets = 0;
+
+    if (m_flags.test(DxvkContextFlag::CpDirtyResources)) {
+      dirtySets = layout->setMask();
+    } else {
+      if (m_flags.test(DxvkContextFlag::CpDirtyResourceSlots))
+        dirtySets |= this->getDirtyDescriptorSets(layout, m_rcDirtyCp);
+
+      if (m_flags.test(DxvkContextFlag::CpDirtyDescriptorOffsets))
+        dirtySets |= layout->staticBufferSetMask();
+    }
+
+    if (m_flags.test(DxvkContextFlag::CpDirtyResourceSlots))
+      m_rcDirtyCp.clear();
+
+    m_flags.clr(
+      DxvkContextFlag::CpDirtyResources,
+      DxvkContextFlag::CpDirtyResourceSlots);
+
+    if (dirtySets) {
+      if (this->updateShaderResources<VK_PIPELINE_BIND_POINT_COMPUTE>(layout, dirtySets))
         m_flags.set(DxvkContextFlag::CpDirtyPipelineState);
 
+      m_cpDirtySets |= dirtySets;
+
       m_flags.set(
         DxvkContextFlag::CpDirtyDescriptorSet,
         DxvkContextFlag::CpDirtyDescriptorOffsets);
@@ -3687,13 +3820,15 @@ namespace dxvk {
       return;
 
     if (m_flags.test(DxvkContextFlag::CpDirtyDescriptorSet)) {
-      m_cpSet = this->updateShaderDescriptors(
-        m_state.cp.pipeline->layout());
+      this->updateShaderDescriptors(
+        m_state.cp.pipeline->layout(),
+        m_cpDirtySets, m_cpSets.data());
+      m_cpDirtySets = 0;
     }
 
     if (m_flags.test(DxvkContextFlag::CpDirtyDescriptorOffsets)) {
       this->updateShaderDescriptorSetBinding<VK_PIPELINE_BIND_POINT_COMPUTE>(
-        m_cpSet, m_state.cp.pipeline->layout());
+        m_cpSets.data(), m_state.cp.pipeline->layout());
     }
 
     m_flags.clr(
@@ -3706,14 +3841,35 @@ namespace dxvk {
     if (m_state.gp.pipeline == nullptr)
       return;
     
-    if ((m_flags.test(DxvkContextFlag::GpDirtyResources))
-     || (m_flags.test(DxvkContextFlag::GpDirtyDescriptorOffsets)
-      && m_state.gp.pipeline->layout()->hasStaticBufferBindings())) {
-      m_flags.clr(DxvkContextFlag::GpDirtyResources);
+    const DxvkPipelineLayout* layout = m_state.gp.pipeline->layout();
+
+    // Only rewrite descriptor sets for stages that
+    // actually use any of the resources that changed
+    uint32_t dirtySets = 0;
 
-      if (this->updateShaderResources<VK_PIPELINE_BIND_POINT_GRAPHICS>(m_state.gp.pipeline->layout()))
+    if (m_flags.test(DxvkContextFlag::GpDirtyResources)) {
+      dirtySets = layout->setMask();
+    } else {
+      if (m_flags.test(DxvkContextFlag::GpDirtyResourceSlots))
+        dirtySets |= this->getDirtyDescriptorSets(layout, m_rcDirtyGp);
+
+      if (m_flags.test(DxvkContextFlag::GpDirtyDescriptorOffsets))
+        dirtySets |= layout->staticBufferSetMask();
+    }
+
+    if (m_flags.test(DxvkContextFlag::GpDirtyResourceSlots))
+      m_rcDirtyGp.clear();
+
+    m_flags.clr(
+      DxvkContextFlag::GpDirtyResources,
+      DxvkContextFlag::GpDirtyResourceSlots);
+
+    if (dirtySets) {
+      if (this->updateShaderResources<VK_PIPELINE_BIND_POINT_GRAPHICS>(layout, dirtySets))
         m_flags.set(DxvkContextFlag::GpDirtyPipelineState);
 
+      m_gpDirtySets |= dirtySets;
+
       m_flags.set(
         DxvkContextFlag::GpDirtyDescriptorSet,
         DxvkContextFlag::GpDirtyDescriptorOffsets);
@@ -3726,13 +3882,15 @@ namespace dxvk {
       return;
 
     if (m_flags.test(DxvkContextFlag::GpDirtyDescriptorSet)) {
-      m_gpSet = this->updateShaderDescriptors(
-        m_state.gp.pipeline->layout());
+      this->updateShaderDescriptors(
+        m_state.gp.pipeline->layout(),
+        m_gpDirtySets, m_gpSets.data());
+      m_gpDirtySets = 0;
     }
 
     if (m_flags.test(DxvkContextFlag::GpDirtyDescriptorOffsets)) {
       this->updateShaderDescriptorSetBinding<VK_PIPELINE_BIND_POINT_GRAPHICS>(
-        m_gpSet, m_state.gp.pipeline->layout());
+        m_gpSets.data(), m_state.gp.pipeline->layout());
     }
 
     m_flags.clr(
@@ -3743,9 +3901,15 @@ namespace dxvk {
   
   template<VkPipelineBindPoint BindPoint>
   bool DxvkContext::updateShaderResources(
-    const DxvkPipelineLayout* layout) {
-    DxvkBindingMask bindMask;
-    bindMask.setFirst(layout->bindingCount());
+    const DxvkPipelineLayout* layout,
+          uint32_t            dirtySets) {
+    // Select the active binding mask to update
+    auto& refMask = BindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS
+      ? m_state.gp.state.bsBindingMask
+      : m_state.cp.state.bsBindingMask;
+
+    // Bindings in sets that are not dirty keep their state
+    DxvkBindingMask bindMask = refMask;
 
     // If the depth attachment is also bound as a shader
     // resource, we have to use the appropriate layout
@@ -3765,6 +3929,11 @@ namespace dxvk {
       const auto& binding = layout->binding(i);
       const auto& res     = m_rc[binding.slot];
       
+      if (!(dirtySets & (1u << binding.set)))
+        continue;
+      
+      bindMask.set(i);
+      
       switch (binding.type) {
         case VK_DESCRIPTOR_TYPE_SAMPLER:
           if (res.sampler != nullptr) {
@@ -3914,11 +4083,6 @@ namespace dxvk {
       }
     }
 
-    // Select the active binding mask to update
-    auto& refMask = BindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS
-      ? m_state.gp.state.bsBindingMask
-      : m_state.cp.state.bsBindingMask;
-
     // If some resources are not bound, we may need to
     // update spec constants and rebind the pipeline
     bool updatePipelineState = refMask != bindMask;
@@ -3930,28 +4094,41 @@ namespace dxvk {
   }
   
   
-  VkDescriptorSet DxvkContext::updateShaderDescriptors(
-    const DxvkPipelineLayout* layout) {
-    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+  void DxvkContext::updateShaderDescriptors(
+    const DxvkPipelineLayout* layout,
+          uint32_t            dirtySets,
+          VkDescriptorSet*    sets) {
+    dirtySets &= layout->setMask();
 
-    if (layout->bindingCount() != 0) {
-      descriptorSet = allocateDescriptorSet(
-        layout->descriptorSetLayout());
-      
-      m_cmd->updateDescriptorSetWithTemplate(
-        descriptorSet, layout->descriptorTemplate(),
-        m_descInfos.data());
-    }
+    while (dirtySets) {
+      uint32_t set = bit::tzcnt(dirtySets);
+      dirtySets &= dirtySets - 1;
+
+      // Reuse a set with identical contents if one was
+      // already written during this command list
+      size_t hash = 0;
 
-    return descriptorSet;
+      sets[set] = m_descCache.lookup(layout, set, m_descInfos.data(), hash);
+
+      if (sets[set] == VK_NULL_HANDLE) {
+        sets[set] = allocateDescriptorSet(
+          layout->descriptorSetLayout(set));
+
+        m_cmd->updateDescriptorSetWithTemplate(
+          sets[set], layout->descriptorTemplate(set),
+          m_descInfos.data());
+
+        m_descCache.insert(layout, set, m_descInfos.data(), hash, sets[set]);
+      }
+    }
   }
 
 
   template<VkPipelineBindPoint BindPoint>
   void DxvkContext::updateShaderDescriptorSetBinding(
-          VkDescriptorSet         set,
+    const VkDescriptorSet*        sets,
     const DxvkPipelineLayout*     layout) {
-    if (set != VK_NULL_HANDLE) {
+    if (layout->setCount() != 0) {
       for (uint32_t i = 0; i < layout->dynamicBindingCount(); i++) {
         const auto& binding = layout->dynamicBinding(i);
         const auto& res     = m_rc[binding.slot];
@@ -3961,12 +4138,29 @@ namespace dxvk {
           : 0;
       }
       
-      m_cmd->cmdBindDescriptorSet(BindPoint,
-        layout->pipelineLayout(), set,
+      m_cmd->cmdBindDescriptorSets(BindPoint,
+        layout->pipelineLayout(),
+        layout->setCount(), sets,
         layout->dynamicBindingCount(),
         m_descOffsets.data());
     }
   }
+
+
+  uint32_t DxvkContext::getDirtyDescriptorSets(
+    const DxvkPipelineLayout*     layout,
+    const DxvkBindingSet<MaxNumResourceSlots>& dirtySlots) const {
+    uint32_t dirtySets = 0;
+
+    for (uint32_t i = 0; i < layout->bindingCount(); i++) {
+      const auto& binding = layout->binding(i);
+
+      if (dirtySlots.test(binding.slot))
+        dirtySets |= 1u << binding.set;
+    }
+
+    return dirtySets;
+  }
   
   
   void DxvkContext::updateFramebuffer() {
@@ -4186,6 +4380,7 @@ namespace dxvk {
     
     if (m_flags.any(
           DxvkContextFlag::CpDirtyResources,
+          DxvkContextFlag::CpDirtyResourceSlots,
           DxvkContextFlag::CpDirtyDescriptorOffsets))
       this->updateComputeShaderResources();
 
@@ -4221,6 +4416,7 @@ namespace dxvk {
     
     if (m_flags.any(
           DxvkContextFlag::GpDirtyResources,
+          DxvkContextFlag::GpDirtyResourceSlots,
           DxvkContextFlag::GpDirtyDescriptorOffsets))
       this->updateGraphicsShaderResources();
     
@@ -4255,6 +4451,7 @@ namespace dxvk {
     auto layout = m_state.cp.pipeline->layout();
 
     bool requiresBarrier = false;
+    bool ignoredBarrier  = false;
 
     for (uint32_t i = 0; i < layout->bindingCount() && !requiresBarrier; i++) {
       if (m_state.cp.state.bsBindingMask.test(i)) {
@@ -4310,8 +4507,10 @@ namespace dxvk {
         if ((m_barrierControl.test(DxvkBarrierControl::IgnoreWriteAfterWrite))
          && (m_execBarriers.getSrcStages() == VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT)
          && (srcAccess.test(DxvkAccess::Write))
-         && (dstAccess.test(DxvkAccess::Write)))
+         && (dstAccess.test(DxvkAccess::Write))) {
+          ignoredBarrier = true;
           continue;
+        }
 
         requiresBarrier = (srcAccess | dstAccess).test(DxvkAccess::Write);
       }
@@ -4319,6 +4518,8 @@ namespace dxvk {
 
     if (requiresBarrier)
       m_execBarriers.recordCommands(m_cmd);
+    else if (ignoredBarrier)
+      m_execBarriers.countAvoidedBarrier();
   }
   
 
@@ -4442,6 +4643,8 @@ namespace dxvk {
     
     VkDescriptorSet set = m_descPool->alloc(layout);
 
+    m_cmd->addStatCtr(DxvkStatCounter::DescriptorSetCount, 1);
+
     if (set == VK_NULL_HANDLE) {
       m_cmd->trackDescriptorPool(std::move(m_descPool));
 
@@ -4464,5 +4667,52 @@ namespace dxvk {
         m_cmd->trackResource<DxvkAccess::Read>(m_state.id.cntBuffer.buffer());
     }
   }
-  
-}
\ No newline at end of file
+
+
+  void DxvkContext::beginGpuProfilerZone() {
+    this->resolveGpuProfilerZones();
+
+    m_gpuZoneBegin = m_device->createGpuQuery(VK_QUERY_TYPE_TIMESTAMP, 0, 0);
+    m_queryManager.writeTimestamp(m_cmd, m_gpuZoneBegin);
+  }
+
+
+  void DxvkContext::endGpuProfilerZone() {
+    DxvkGpuProfilerZone zone;
+    zone.begin   = std::move(m_gpuZoneBegin);
+    zone.end     = m_device->createGpuQuery(VK_QUERY_TYPE_TIMESTAMP, 0, 0);
+    zone.cpuTime = DxvkProfiler::now();
+
+    m_queryManager.writeTimestamp(m_cmd, zone.end);
+    m_gpuZones.push(std::move(zone));
+  }
+
+
+  void DxvkContext::resolveGpuProfilerZones() {
+    const double period = m_device->properties().core.properties.limits.timestampPeriod;
+
+    while (!m_gpuZones.empty()) {
+      const DxvkGpuProfilerZone& zone = m_gpuZones.front();
+
+      DxvkQueryData beginData = { };
+      DxvkQueryData endData   = { };
+
+      DxvkGpuQueryStatus beginStatus = zone.begin->getData(beginData);
+      DxvkGpuQueryStatus endStatus   = zone.end->getData(endData);
+
+      if (beginStatus == DxvkGpuQueryStatus::Pending
+       || endStatus   == DxvkGpuQueryStatus::Pending)
+        break;
+
+      if (beginStatus == DxvkGpuQueryStatus::Available
+       && endStatus   == DxvkGpuQueryStatus::Available) {
+        DxvkProfiler::recordGpuZone("Command list", zone.cpuTime,
+          uint64_t(double(beginData.timestamp.time) * period),
+          uint64_t(double(endData.timestamp.time)   * period));
+      }
+
+      m_gpuZones.pop();
+    }
+  }
+
+}
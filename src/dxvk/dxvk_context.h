@@ -6,6 +6,7 @@
 #include "dxvk_context_state.h"
 #include "dxvk_data.h"
 #include "dxvk_objects.h"
+#include "dxvk_profiler.h"
 #include "dxvk_util.h"
 
 namespace dxvk {
@@ -19,6 +20,19 @@ namespace dxvk {
    */
   class DxvkContext : public RcObject {
     
+    /**
+     * \brief GPU profiler zone
+     *
+     * Timestamp queries written at the start and
+     * end of a command list, along with the CPU
+     * time at which recording has ended.
+     */
+    struct DxvkGpuProfilerZone {
+      Rc<DxvkGpuQuery> begin;
+      Rc<DxvkGpuQuery> end;
+      uint64_t         cpuTime;
+    };
+
   public:
     
     DxvkContext(const Rc<DxvkDevice>& device);
@@ -729,6 +743,26 @@ namespace dxvk {
             VkDeviceSize              size,
       const void*                     data);
     
+    /**
+     * \brief Updates buffer ranges from a staging buffer
+     * 
+     * Copies data that has already been written to a
+     * host-visible staging buffer into one or more
+     * ranges of the destination buffer, using a single
+     * copy command. Offsets are relative to the current
+     * slices of the two buffers, and destination ranges
+     * must not overlap each other.
+     * \param [in] dstBuffer Destination buffer
+     * \param [in] srcBuffer Staging buffer
+     * \param [in] regionCount Number of ranges to copy
+     * \param [in] pRegions Ranges to copy
+     */
+    void updateBufferRegions(
+      const Rc<DxvkBuffer>&           dstBuffer,
+      const Rc<DxvkBuffer>&           srcBuffer,
+            uint32_t                  regionCount,
+      const VkBufferCopy*             pRegions);
+    
     /**
      * \brief Updates an image
      * 
@@ -1021,11 +1055,18 @@ namespace dxvk {
     VkPipeline m_gpActivePipeline = VK_NULL_HANDLE;
     VkPipeline m_cpActivePipeline = VK_NULL_HANDLE;
 
-    VkDescriptorSet m_gpSet = VK_NULL_HANDLE;
-    VkDescriptorSet m_cpSet = VK_NULL_HANDLE;
+    std::array<VkDescriptorSet, MaxNumDescriptorSets> m_gpSets = { };
+    std::array<VkDescriptorSet, MaxNumDescriptorSets> m_cpSets = { };
+
+    uint32_t m_gpDirtySets = 0;
+    uint32_t m_cpDirtySets = 0;
+
+    DxvkDescriptorSetCache  m_descCache;
 
     DxvkBindingSet<MaxNumVertexBindings + 1>  m_vbTracked;
     DxvkBindingSet<MaxNumResourceSlots>       m_rcTracked;
+    DxvkBindingSet<MaxNumResourceSlots>       m_rcDirtyGp;
+    DxvkBindingSet<MaxNumResourceSlots>       m_rcDirtyCp;
 
     std::array<DxvkShaderResourceSlot, MaxNumResourceSlots>  m_rc;
     std::array<DxvkDescriptorInfo,     MaxNumActiveBindings> m_descInfos;
@@ -1036,6 +1077,9 @@ namespace dxvk {
       DxvkGpuQueryHandle,
       DxvkHash, DxvkEq>     m_predicateWrites;
     
+    Rc<DxvkGpuQuery>                  m_gpuZoneBegin;
+    std::queue<DxvkGpuProfilerZone>   m_gpuZones;
+    
     void clearImageViewFb(
       const Rc<DxvkImageView>&    imageView,
             VkOffset3D            offset,
@@ -1131,15 +1175,22 @@ namespace dxvk {
 
     template<VkPipelineBindPoint BindPoint>
     bool updateShaderResources(
-      const DxvkPipelineLayout*     layout);
+      const DxvkPipelineLayout*     layout,
+            uint32_t                dirtySets);
     
-    VkDescriptorSet updateShaderDescriptors(
-      const DxvkPipelineLayout*     layout);
+    void updateShaderDescriptors(
+      const DxvkPipelineLayout*     layout,
+            uint32_t                dirtySets,
+            VkDescriptorSet*        sets);
     
     template<VkPipelineBindPoint BindPoint>
     void updateShaderDescriptorSetBinding(
-            VkDescriptorSet         set,
+      const VkDescriptorSet*        sets,
       const DxvkPipelineLayout*     layout);
+    
+    uint32_t getDirtyDescriptorSets(
+      const DxvkPipelineLayout*     layout,
+      const DxvkBindingSet<MaxNumResourceSlots>& dirtySlots) const;
 
     void updateFramebuffer();
     
@@ -1180,6 +1231,11 @@ namespace dxvk {
 
     void trackDrawBuffer();
 
+    void beginGpuProfilerZone();
+    void endGpuProfilerZone();
+
+    void resolveGpuProfilerZones();
+
   };
   
 }
\ No newline at end of file
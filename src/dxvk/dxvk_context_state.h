@@ -20,7 +20,7 @@ namespace dxvk {
    * of the graphics and compute pipelines
    * has changed and/or needs to be updated.
    */
-  enum class DxvkContextFlag : uint32_t  {
+  enum class DxvkContextFlag : uint64_t  {
     GpRenderPassBound,          ///< Render pass is currently bound
     GpCondActive,               ///< Conditional rendering is enabled
     GpXfbActive,                ///< Transform feedback is enabled
@@ -29,6 +29,7 @@ namespace dxvk {
     GpDirtyPipeline,            ///< Graphics pipeline binding is out of date
     GpDirtyPipelineState,       ///< Graphics pipeline needs to be recompiled
     GpDirtyResources,           ///< Graphics pipeline resource bindings are out of date
+    GpDirtyResourceSlots,       ///< Some graphics resource slots are out of date
     GpDirtyDescriptorOffsets,   ///< Graphics descriptor set needs to be rebound
     GpDirtyDescriptorSet,       ///< Graphics descriptor set needs to be updated
     GpDirtyVertexBuffers,       ///< Vertex buffer bindings are out of date
@@ -49,6 +50,7 @@ namespace dxvk {
     CpDirtyPipeline,            ///< Compute pipeline binding are out of date
     CpDirtyPipelineState,       ///< Compute pipeline needs to be recompiled
     CpDirtyResources,           ///< Compute pipeline resource bindings are out of date
+    CpDirtyResourceSlots,       ///< Some compute resource slots are out of date
     CpDirtyDescriptorOffsets,   ///< Compute descriptor set needs to be rebound
     CpDirtyDescriptorSet,       ///< Compute descriptor set needs to be updated
     
@@ -63,10 +65,14 @@ namespace dxvk {
    * \brief Barrier control flags
    * 
    * These flags specify what (not) to
-   * synchronize implicitly.
+   * synchronize implicitly. Contexts that
+   * share buffers with other contexts which
+   * record commands concurrently must not
+   * rename buffers implicitly.
    */
   enum class DxvkBarrierControl : uint32_t {
     IgnoreWriteAfterWrite       = 1,
+    IgnoreImplicitRename        = 2,
   };
 
   using DxvkBarrierControlFlags  = Flags<DxvkBarrierControl>;
@@ -0,0 +1,197 @@
+#include <cmath>
+#include <cstring>
+
+#include "dxvk_cpu.h"
+
+namespace dxvk {
+
+  DxvkCpuSampler::DxvkCpuSampler()
+  : m_coreCount(dxvk::thread::hardware_concurrency()) {
+    m_prevTimes.resize(m_coreCount + 1);
+    m_currTimes.resize(m_coreCount + 1);
+
+    for (auto& snapshot : m_snapshots)
+      snapshot.resize(m_coreCount + 1, 0.0f);
+
+    m_file = std::fopen("/proc/stat", "r");
+
+    if (m_file) {
+      // We parse the file in our own buffer, and stdio
+      // buffering would only get in the way of rewinding
+      std::setvbuf(m_file, nullptr, _IONBF, 0);
+    } else {
+      Logger::warn("DXVK: Failed to open /proc/stat, CPU load not available");
+    }
+
+    m_thread = dxvk::thread([this] () { threadFunc(); });
+    m_thread.set_priority(ThreadPriority::Lowest);
+  }
+
+
+  DxvkCpuSampler::~DxvkCpuSampler() {
+    { std::lock_guard<std::mutex> lock(m_mutex);
+      m_stopped.store(true);
+      m_cond.notify_one();
+    }
+
+    m_thread.join();
+
+    if (m_file)
+      std::fclose(m_file);
+  }
+
+
+  void DxvkCpuSampler::getLoad(std::vector<float>& loads) const {
+    loads.resize(m_coreCount + 1);
+
+    uint64_t snapshotId;
+
+    do {
+      snapshotId = m_snapshotId.load(std::memory_order_acquire);
+
+      const auto& snapshot = m_snapshots[snapshotId & 1];
+
+      for (uint32_t i = 0; i <= m_coreCount; i++)
+        loads[i] = snapshot[i];
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while (m_snapshotId.load(std::memory_order_relaxed) != snapshotId);
+  }
+
+
+  float DxvkCpuSampler::getTotalLoad() const {
+    uint64_t snapshotId;
+    float    load;
+
+    do {
+      snapshotId = m_snapshotId.load(std::memory_order_acquire);
+      load = m_snapshots[snapshotId & 1][0];
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while (m_snapshotId.load(std::memory_order_relaxed) != snapshotId);
+
+    return load;
+  }
+
+
+  bool DxvkCpuSampler::readTimes() {
+    if (!m_file)
+      return false;
+
+    std::rewind(m_file);
+
+    size_t size = std::fread(m_buffer.data(), 1, m_buffer.size(), m_file);
+
+    // The per-CPU lines are at the start of the
+    // file, we can ignore everything after them
+    const char* ptr = m_buffer.data();
+    const char* end = m_buffer.data() + size;
+
+    bool found = false;
+
+    while (end - ptr > 3 && !std::strncmp(ptr, "cpu", 3)) {
+      ptr += 3;
+
+      // The first line contains the accumulated times
+      // of all cores and has no index after 'cpu'
+      uint32_t index = 0;
+
+      if (*ptr >= '0' && *ptr <= '9') {
+        while (ptr < end && *ptr >= '0' && *ptr <= '9')
+          index = 10 * index + uint32_t(*(ptr++) - '0');
+        index += 1;
+      }
+
+      CpuTimes times;
+      ptr = parseTimes(ptr, end, times);
+
+      if (index <= m_coreCount) {
+        m_currTimes[index] = times;
+        found = true;
+      }
+
+      while (ptr < end && *ptr != '\n')
+        ptr++;
+
+      if (ptr < end)
+        ptr++;
+    }
+
+    return found;
+  }
+
+
+  void DxvkCpuSampler::publishLoad() {
+    uint64_t snapshotId = m_snapshotId.load(std::memory_order_relaxed) + 1;
+
+    auto& snapshot = m_snapshots[snapshotId & 1];
+
+    for (uint32_t i = 0; i <= m_coreCount; i++) {
+      uint64_t active = m_currTimes[i].active - m_prevTimes[i].active;
+      uint64_t idle   = m_currTimes[i].idle   - m_prevTimes[i].idle;
+      uint64_t total  = active + idle;
+
+      snapshot[i] = total
+        ? std::trunc(100.0f * float(active) / float(total))
+        : 0.0f;
+    }
+
+    m_snapshotId.store(snapshotId, std::memory_order_release);
+  }
+
+
+  void DxvkCpuSampler::threadFunc() {
+    env::setThreadName("dxvk-cpu-load");
+
+    // Take an initial sample so that the first
+    // published load value is meaningful
+    if (readTimes())
+      std::swap(m_prevTimes, m_currTimes);
+
+    while (!m_stopped.load()) {
+      { std::unique_lock<std::mutex> lock(m_mutex);
+
+        m_cond.wait_for(lock, std::chrono::milliseconds(SampleInterval), [this] () {
+          return m_stopped.load();
+        });
+      }
+
+      if (m_stopped.load())
+        break;
+
+      if (readTimes()) {
+        publishLoad();
+        std::swap(m_prevTimes, m_currTimes);
+      }
+    }
+  }
+
+
+  const char* DxvkCpuSampler::parseTimes(
+    const char*                 ptr,
+    const char*                 end,
+          CpuTimes&             times) {
+    // Fields are: user, nice, system, idle, iowait,
+    // irq, softirq, steal, guest, guest_nice
+    for (uint32_t i = 0; i < 10; i++) {
+      while (ptr < end && *ptr == ' ')
+        ptr++;
+
+      if (ptr == end || *ptr < '0' || *ptr > '9')
+        break;
+
+      uint64_t value = 0;
+
+      while (ptr < end && *ptr >= '0' && *ptr <= '9')
+        value = 10 * value + uint64_t(*(ptr++) - '0');
+
+      if (i == 3 || i == 4)
+        times.idle += value;
+      else
+        times.active += value;
+    }
+
+    return ptr;
+  }
+
+}
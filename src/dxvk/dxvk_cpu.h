@@ -1,172 +1,99 @@
-#include <cmath>
-#include <iomanip>
+#pragma once
+
 #include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
 #include <vector>
-#include <algorithm>
-#include <iterator>
-#include <thread>
-#include <sstream>
-#include <fstream>
-using namespace std;
-
-const int NUM_CPU_STATES = 10;
-
-struct Cpus{
-  size_t num;
-  string name;
-  float value;
-  string output;
-};
-
-size_t numCpuCores = dxvk::thread::hardware_concurrency();
-size_t arraySize = numCpuCores + 1;
-std::vector<Cpus> cpuArray;
-
-void coreCounting(){
-  cpuArray.push_back({0, "CPU:"});
-  for (size_t i = 0; i < arraySize; i++) {
-    size_t offset = i;
-    stringstream ss;
-    ss << "CPU" << offset << ":";
-    string cpuNameString = ss.str();
-    cpuArray.push_back({i+1 , cpuNameString});
-  }
-}
-
-std::string m_cpuUtilizationString;
-
-enum CPUStates
-{
-	S_USER = 0,
-	S_NICE,
-	S_SYSTEM,
-	S_IDLE,
-	S_IOWAIT,
-	S_IRQ,
-	S_SOFTIRQ,
-	S_STEAL,
-	S_GUEST,
-	S_GUEST_NICE
-};
-
-typedef struct CPUData
-{
-	std::string cpu;
-	size_t times[NUM_CPU_STATES];
-} CPUData;
-
-void ReadStatsCPU(std::vector<CPUData> & entries)
-{
-	std::ifstream fileStat("/proc/stat");
-
-	std::string line;
-
-	const std::string STR_CPU("cpu");
-	const std::size_t LEN_STR_CPU = STR_CPU.size();
-	const std::string STR_TOT("tot");
-
-	while(std::getline(fileStat, line))
-	{
-		// cpu stats line found
-		if(!line.compare(0, LEN_STR_CPU, STR_CPU))
-		{
-			std::istringstream ss(line);
-
-			// store entry
-			entries.emplace_back(CPUData());
-			CPUData & entry = entries.back();
-
-			// read cpu label
-			ss >> entry.cpu;
-
-			if(entry.cpu.size() > LEN_STR_CPU)
-				entry.cpu.erase(0, LEN_STR_CPU);
-			else
-				entry.cpu = STR_TOT;
-
-			// read times
-			for(int i = 0; i < NUM_CPU_STATES; ++i)
-				ss >> entry.times[i];
-		}
-	}
-}
-
-size_t GetIdleTime(const CPUData & e)
-{
-	return	e.times[S_IDLE] +
-			e.times[S_IOWAIT];
-}
-
-size_t GetActiveTime(const CPUData & e)
-{
-	return	e.times[S_USER] +
-			e.times[S_NICE] +
-			e.times[S_SYSTEM] +
-			e.times[S_IRQ] +
-			e.times[S_SOFTIRQ] +
-			e.times[S_STEAL] +
-			e.times[S_GUEST] +
-			e.times[S_GUEST_NICE];
-}
-
-void PrintStats(const std::vector<CPUData> & entries1, const std::vector<CPUData> & entries2)
-{
-	const size_t NUM_ENTRIES = entries1.size();
-
-	for(size_t i = 0; i < NUM_ENTRIES; ++i)
-	{
-		const CPUData & e1 = entries1[i];
-		const CPUData & e2 = entries2[i];
 
-		const float ACTIVE_TIME	= static_cast<float>(GetActiveTime(e2) - GetActiveTime(e1));
-		const float IDLE_TIME	= static_cast<float>(GetIdleTime(e2) - GetIdleTime(e1));
-		const float TOTAL_TIME	= ACTIVE_TIME + IDLE_TIME;
+#include "dxvk_include.h"
+
+namespace dxvk {
+
+  /**
+   * \brief CPU load sampler
+   *
+   * Periodically reads \c /proc/stat on a dedicated
+   * thread and computes the load of each CPU core
+   * from the difference to the previous sample.
+   * The file is kept open and parsed in place, so
+   * sampling does not allocate any memory.
+   *
+   * Results are published through a pair of
+   * snapshot buffers, which can be read from
+   * any thread without taking a lock.
+   */
+  class DxvkCpuSampler {
+    constexpr static size_t  BufferSize     = 65536;
+    constexpr static int64_t SampleInterval = 500;
+  public:
+
+    DxvkCpuSampler();
+    ~DxvkCpuSampler();
+
+    DxvkCpuSampler             (const DxvkCpuSampler&) = delete;
+    DxvkCpuSampler& operator = (const DxvkCpuSampler&) = delete;
+
+    /**
+     * \brief Number of CPU cores
+     * \returns Number of cores that are sampled
+     */
+    uint32_t coreCount() const {
+      return m_coreCount;
+    }
+
+    /**
+     * \brief Retrieves most recent CPU load
+     *
+     * Writes the total CPU load to the first entry
+     * of the array, followed by the load of each
+     * individual core, in percent. The array will
+     * only be resized on the first call.
+     * \param [out] loads CPU load values
+     */
+    void getLoad(std::vector<float>& loads) const;
+
+    /**
+     * \brief Retrieves most recent total CPU load
+     * \returns Total CPU load, in percent
+     */
+    float getTotalLoad() const;
+
+  private:
+
+    struct CpuTimes {
+      uint64_t active = 0;
+      uint64_t idle   = 0;
+    };
+
+    const uint32_t                m_coreCount;
+
+    std::FILE*                    m_file = nullptr;
+    std::array<char, BufferSize>  m_buffer;
+
+    std::vector<CpuTimes>         m_prevTimes;
+    std::vector<CpuTimes>         m_currTimes;
+
+    std::array<std::vector<float>, 2> m_snapshots;
+    std::atomic<uint64_t>         m_snapshotId = { 0ull };
+
+    std::atomic<bool>             m_stopped = { false };
+    std::mutex                    m_mutex;
+    std::condition_variable       m_cond;
+    dxvk::thread                  m_thread;
+
+    bool readTimes();
+
+    void publishLoad();
+
+    void threadFunc();
+
+    static const char* parseTimes(
+      const char*                 ptr,
+      const char*                 end,
+            CpuTimes&             times);
+
+  };
 
-    cpuArray[i].value = (truncf(100.f * ACTIVE_TIME / TOTAL_TIME) * 10 / 10);
-	}
 }
-
-int getCpuUsage()
-{
-	std::vector<CPUData> entries1;
-	std::vector<CPUData> entries2;
-
-	// snapshot 1
-	ReadStatsCPU(entries1);
-
-	// 100ms pause
-	std::this_thread::sleep_for(std::chrono::milliseconds(100));
-
-	// snapshot 2
-	ReadStatsCPU(entries2);
-
-	// print output
-	PrintStats(entries1, entries2);
-
-	return 0;
-}
-
-
-void updateCpuStrings(){
-  for (size_t i = 0; i < arraySize; i++) {
-    size_t spacing = 10;
-    string value = to_string(cpuArray[i].value);
-    value.erase( value.find_last_not_of('0') + 1, std::string::npos );
-    size_t correctionValue = (spacing - cpuArray[i].name.length()) - value.length();
-    string correction = "";
-    for (size_t i = 0; i < correctionValue; i++) {
-          correction.append(" ");
-        }
-        stringstream ss;
-        if (i < 11) {
-          if (i == 0) {
-            ss << cpuArray[i].name << correction << cpuArray[i].value << "%";
-          } else {
-            ss << cpuArray[i].name << correction << cpuArray[i].value << "%";
-          }
-        } else {
-          ss << cpuArray[i].name << correction << cpuArray[i].value << "%";
-        }
-        cpuArray[i].output = ss.str();
-      }
-    }
\ No newline at end of file
@@ -111,21 +111,37 @@ namespace dxvk {
   }
   
   
-  void DxvkCsThread::dispatchChunk(DxvkCsChunkRef&& chunk) {
-    { std::unique_lock<std::mutex> lock(m_mutex);
-      m_chunksQueued.push(std::move(chunk));
-      m_chunksPending += 1;
+  uint64_t DxvkCsThread::dispatchChunk(DxvkCsChunkRef&& chunk) {
+    // Chunks are only dispatched from one thread at a time, but
+    // the sequence number is read by other threads without a lock
+    uint64_t seq = m_chunksDispatched.load(std::memory_order_relaxed) + 1;
+    m_chunksDispatched.store(seq, std::memory_order_release);
+
+    if (unlikely(!m_chunksQueued.tryPush(std::move(chunk)))) {
+      // The consumer is way behind, wait for it to
+      // make room and wake it up in case it's parked
+      notifyConsumer();
+
+      waitForConsumer([this, &chunk] {
+        return m_chunksQueued.tryPush(std::move(chunk));
+      });
     }
-    
-    m_condOnAdd.notify_one();
+
+    notifyConsumer();
+    return seq;
   }
   
   
   void DxvkCsThread::synchronize() {
-    std::unique_lock<std::mutex> lock(m_mutex);
-    
-    m_condOnSync.wait(lock, [this] {
-      return !m_chunksPending.load();
+    synchronize(m_chunksDispatched.load(std::memory_order_acquire));
+  }
+  
+  
+  void DxvkCsThread::synchronize(uint64_t seq) {
+    seq = std::min(seq, m_chunksDispatched.load(std::memory_order_acquire));
+
+    waitForConsumer([this, seq] {
+      return isExecuted(seq);
     });
   }
   
@@ -136,30 +152,93 @@ namespace dxvk {
     DxvkCsChunkRef chunk;
     
     while (!m_stopped.load()) {
-      { std::unique_lock<std::mutex> lock(m_mutex);
-        if (chunk) {
-          if (--m_chunksPending == 0)
-            m_condOnSync.notify_one();
-          
-          chunk = DxvkCsChunkRef();
-        }
-        
-        if (m_chunksQueued.size() == 0) {
-          m_condOnAdd.wait(lock, [this] {
-            return (m_chunksQueued.size() != 0)
-                || (m_stopped.load());
-          });
-        }
-        
-        if (m_chunksQueued.size() != 0) {
-          chunk = std::move(m_chunksQueued.front());
-          m_chunksQueued.pop();
-        }
-      }
+      if (!waitForChunk(chunk))
+        break;
       
-      if (chunk)
+      { DxvkProfilerZone zone("Execute CS chunk");
         chunk->executeAll(m_context.ptr());
+      }
+
+      chunk = DxvkCsChunkRef();
+
+      m_chunksExecuted.fetch_add(1, std::memory_order_release);
+      notifyProducer();
+    }
+  }
+
+
+  bool DxvkCsThread::waitForChunk(DxvkCsChunkRef& chunk) {
+    // Busy-wait for a while since the app is likely to
+    // dispatch more chunks soon. Adapt the spin count
+    // based on whether spinning has paid off recently.
+    for (uint32_t i = 0; i < m_spinCount; i++) {
+      if (m_chunksQueued.tryPop(chunk)) {
+        if (i && m_spinCount < MaxSpinCount)
+          m_spinCount *= 2;
+        return true;
+      }
+
+      _mm_pause();
+    }
+
+    if (m_spinCount > MinSpinCount)
+      m_spinCount /= 2;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    m_consumerParked.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    m_condOnAdd.wait(lock, [this] {
+      return !m_chunksQueued.empty()
+          || m_stopped.load();
+    });
+
+    m_consumerParked.store(false, std::memory_order_relaxed);
+    return m_chunksQueued.tryPop(chunk);
+  }
+
+
+  template<typename Pred>
+  void DxvkCsThread::waitForConsumer(const Pred& pred) {
+    for (uint32_t i = 0; i < MinSpinCount; i++) {
+      if (pred())
+        return;
+
+      _mm_pause();
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    m_producersParked.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    m_condOnSync.wait(lock, pred);
+
+    m_producersParked.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+
+  void DxvkCsThread::notifyConsumer() {
+    // Only take the lock if the consumer is actually
+    // parked, so that we don't need any system calls
+    // for as long as the worker keeps up with us.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (m_consumerParked.load(std::memory_order_relaxed)) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_condOnAdd.notify_one();
+    }
+  }
+
+
+  void DxvkCsThread::notifyProducer() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (m_producersParked.load(std::memory_order_relaxed)) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_condOnSync.notify_all();
     }
   }
   
-}
\ No newline at end of file
+}
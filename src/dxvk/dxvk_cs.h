@@ -3,9 +3,11 @@
 #include <atomic>
 #include <condition_variable>
 #include <mutex>
-#include <queue>
 
 #include "../util/thread.h"
+
+#include "../util/sync/sync_ringbuffer.h"
+
 #include "dxvk_context.h"
 
 namespace dxvk {
@@ -374,12 +376,19 @@ namespace dxvk {
    * \brief Command stream thread
    * 
    * Spawns a thread that will execute
-   * commands on a DXVK context. 
+   * commands on a DXVK context. Chunks are
+   * passed to the thread through a lock-free
+   * ring buffer. Only one thread may dispatch
+   * chunks or synchronize at any given time.
    */
   class DxvkCsThread {
-    
+    constexpr static size_t   QueueSize    = 4096;
+    constexpr static uint32_t MinSpinCount = 64;
+    constexpr static uint32_t MaxSpinCount = 4096;
   public:
     
+    constexpr static uint64_t SynchronizeAll = ~0ull;
+    
     DxvkCsThread(const Rc<DxvkContext>& context);
     ~DxvkCsThread();
     
@@ -389,8 +398,9 @@ namespace dxvk {
      * Can be used to efficiently play back large
      * command lists recorded on another thread.
      * \param [in] chunk The chunk to dispatch
+     * \returns Sequence number of the chunk
      */
-    void dispatchChunk(DxvkCsChunkRef&& chunk);
+    uint64_t dispatchChunk(DxvkCsChunkRef&& chunk);
     
     /**
      * \brief Synchronizes with the thread
@@ -402,6 +412,36 @@ namespace dxvk {
      */
     void synchronize();
     
+    /**
+     * \brief Synchronizes with a given chunk
+     * 
+     * Waits until the chunk with the given sequence
+     * number has been executed. Chunks dispatched
+     * after that one may still be pending. Passing
+     * \c SynchronizeAll waits for all chunks.
+     * \param [in] seq Sequence number to wait for
+     */
+    void synchronize(uint64_t seq);
+    
+    /**
+     * \brief Checks whether a chunk has been executed
+     * 
+     * \param [in] seq Chunk sequence number
+     * \returns \c true if the chunk and all chunks
+     *    dispatched before it have been executed
+     */
+    bool isExecuted(uint64_t seq) const {
+      return m_chunksExecuted.load(std::memory_order_acquire) >= seq;
+    }
+    
+    /**
+     * \brief Sequence number of the last chunk
+     * \returns Last dispatched sequence number
+     */
+    uint64_t lastSequenceNumber() const {
+      return m_chunksDispatched.load(std::memory_order_acquire);
+    }
+    
     /**
      * \brief Checks whether the worker thread is busy
      * 
@@ -411,7 +451,7 @@ namespace dxvk {
      * \returns \c true if there is still work to do
      */
     bool isBusy() const {
-      return m_chunksPending.load() != 0;
+      return !isExecuted(m_chunksDispatched.load(std::memory_order_acquire));
     }
     
   private:
@@ -419,14 +459,37 @@ namespace dxvk {
     const Rc<DxvkContext>       m_context;
     
     std::atomic<bool>           m_stopped = { false };
+    std::atomic<uint64_t>       m_chunksExecuted = { 0ull };
+    std::atomic<uint64_t>       m_chunksDispatched = { 0ull };
+
+    sync::RingBuffer<DxvkCsChunkRef, QueueSize> m_chunksQueued;
+
+    // Spinning is pointless if the worker would
+    // only steal time from the producer thread
+    uint32_t                    m_spinCount = dxvk::thread::hardware_concurrency() > 1 ? MinSpinCount : 0;
+
+    std::atomic<bool>           m_consumerParked = { false };
+    // Multiple threads may synchronize with
+    // the worker, so count parked producers
+    std::atomic<uint32_t>       m_producersParked = { 0u };
+
     std::mutex                  m_mutex;
     std::condition_variable     m_condOnAdd;
     std::condition_variable     m_condOnSync;
-    std::queue<DxvkCsChunkRef>  m_chunksQueued;
-    std::atomic<uint32_t>       m_chunksPending = { 0u };
     dxvk::thread                m_thread;
     
     void threadFunc();
+
+    bool waitForChunk(
+            DxvkCsChunkRef&       chunk);
+
+    template<typename Pred>
+    void waitForConsumer(
+      const Pred&                 pred);
+
+    void notifyConsumer();
+
+    void notifyProducer();
     
   };
   
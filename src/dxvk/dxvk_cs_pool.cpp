@@ -0,0 +1,168 @@
+#include "dxvk_cs_pool.h"
+
+namespace dxvk {
+
+  DxvkCsBatch::DxvkCsBatch() {
+
+  }
+
+
+  DxvkCsBatch::~DxvkCsBatch() {
+
+  }
+
+
+  bool DxvkCsBatch::addCommandList(
+    const std::vector<DxvkCsChunkRef>&     chunks,
+    const std::unordered_set<DxvkBuffer*>& renamedBuffers,
+    const std::unordered_set<DxvkBuffer*>& usedBuffers) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_sealed)
+      return false;
+
+    // Renamed buffers are also part of the used set, so
+    // this catches two lists renaming the same buffer too
+    for (DxvkBuffer* buffer : renamedBuffers) {
+      if (m_usedBuffers.find(buffer) != m_usedBuffers.end())
+        return false;
+    }
+
+    for (DxvkBuffer* buffer : usedBuffers) {
+      if (m_renamedBuffers.find(buffer) != m_renamedBuffers.end())
+        return false;
+    }
+
+    m_commandLists.push_back(chunks);
+    m_renamedBuffers.insert(renamedBuffers.begin(), renamedBuffers.end());
+    m_usedBuffers.insert(usedBuffers.begin(), usedBuffers.end());
+    return true;
+  }
+
+
+  std::vector<std::vector<DxvkCsChunkRef>> DxvkCsBatch::seal() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_sealed = true;
+    m_renamedBuffers.clear();
+    m_usedBuffers.clear();
+    return std::move(m_commandLists);
+  }
+
+
+  DxvkCsWorkerPool::DxvkCsWorkerPool(
+    const Rc<DxvkDevice>&             device,
+          uint32_t                    workerCount,
+          DxvkBarrierControlFlags     barrierControl)
+  : m_device(device), m_barrierControl(barrierControl) {
+    for (uint32_t i = 0; i < workerCount; i++)
+      m_workers.emplace_back([this, i] () { workerFunc(i); });
+
+    Logger::info(str::format("DXVK: Using ", workerCount, " command list workers"));
+  }
+
+
+  DxvkCsWorkerPool::~DxvkCsWorkerPool() {
+    { std::lock_guard<std::mutex> lock(m_mutex);
+      m_stopped = true;
+      m_condOnAdd.notify_all();
+    }
+
+    for (auto& worker : m_workers)
+      worker.join();
+  }
+
+
+  void DxvkCsWorkerPool::executeBatch(
+          DxvkContext*                ctx,
+    const Rc<DxvkCsBatch>&            batch) {
+    auto commandLists = batch->seal();
+
+    if (commandLists.empty())
+      return;
+
+    // Submit everything that the calling context has recorded
+    // so far, so that worker command lists execute after it.
+    // This also makes the context re-apply all its bindings,
+    // which may refer to buffers invalidated by the workers.
+    ctx->flushCommandList();
+
+    std::vector<Job> jobs(commandLists.size());
+
+    { std::lock_guard<std::mutex> lock(m_mutex);
+
+      for (size_t i = 0; i < jobs.size(); i++) {
+        jobs[i].chunks = &commandLists[i];
+        m_jobs.push(&jobs[i]);
+      }
+
+      m_condOnAdd.notify_all();
+    }
+
+    // Submit command lists in order as soon as they
+    // are done, so that the GPU can start working
+    // while the remaining ones are being recorded
+    for (auto& job : jobs) {
+      Rc<DxvkCommandList> cmdList;
+
+      { std::unique_lock<std::mutex> lock(m_mutex);
+
+        m_condOnDone.wait(lock, [&job] {
+          return job.cmdList != nullptr;
+        });
+
+        cmdList = std::move(job.cmdList);
+      }
+
+      m_device->submitCommandList(cmdList,
+        VK_NULL_HANDLE, VK_NULL_HANDLE);
+    }
+  }
+
+
+  void DxvkCsWorkerPool::workerFunc(uint32_t workerId) {
+    env::setThreadName(str::format("dxvk-cs-worker-", workerId));
+
+    // Other contexts may use the same buffers concurrently,
+    // so we cannot replace their backing storage implicitly
+    DxvkBarrierControlFlags barrierControl = m_barrierControl;
+    barrierControl.set(DxvkBarrierControl::IgnoreImplicitRename);
+
+    Rc<DxvkContext> context = m_device->createContext();
+    context->setBarrierControl(barrierControl);
+
+    while (true) {
+      Job* job = nullptr;
+
+      { std::unique_lock<std::mutex> lock(m_mutex);
+
+        m_condOnAdd.wait(lock, [this] {
+          return !m_jobs.empty() || m_stopped;
+        });
+
+        if (m_jobs.empty())
+          break;
+
+        job = m_jobs.front();
+        m_jobs.pop();
+      }
+
+      Rc<DxvkCommandList> cmdList;
+
+      { DxvkProfilerZone zone("Record command list");
+
+        context->beginRecording(m_device->createCommandList());
+
+        for (const auto& chunk : *job->chunks)
+          chunk->executeAll(context.ptr());
+
+        cmdList = context->endRecording();
+      }
+
+      std::lock_guard<std::mutex> lock(m_mutex);
+      job->cmdList = std::move(cmdList);
+      m_condOnDone.notify_all();
+    }
+  }
+
+}
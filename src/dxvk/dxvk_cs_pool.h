@@ -0,0 +1,126 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <unordered_set>
+#include <vector>
+
+#include "../util/thread.h"
+
+#include "dxvk_cs.h"
+#include "dxvk_device.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Command stream batch
+   *
+   * Stores the chunks of one or more independent
+   * command lists which can be recorded in parallel
+   * and must be submitted in the order they were
+   * added. Command lists can be added from the
+   * application thread until the batch gets
+   * sealed by the CS thread.
+   */
+  class DxvkCsBatch : public RcObject {
+
+  public:
+
+    DxvkCsBatch();
+    ~DxvkCsBatch();
+
+    /**
+     * \brief Adds a command list to the batch
+     *
+     * Fails if the batch has already been sealed, or if
+     * one command list replaces the backing storage of a
+     * buffer that another command list in the batch uses.
+     * Buffer invalidation is not thread-safe, and commands
+     * using the buffer must see the correct slice.
+     * \param [in] chunks Chunks of the command list
+     * \param [in] renamedBuffers Buffers invalidated by the command list
+     * \param [in] usedBuffers Buffers used by the command list
+     * \returns \c true if the command list was added
+     */
+    bool addCommandList(
+      const std::vector<DxvkCsChunkRef>&     chunks,
+      const std::unordered_set<DxvkBuffer*>& renamedBuffers,
+      const std::unordered_set<DxvkBuffer*>& usedBuffers);
+
+    /**
+     * \brief Seals the batch
+     *
+     * No more command lists can be added after this.
+     * \returns Chunks of all command lists in the batch
+     */
+    std::vector<std::vector<DxvkCsChunkRef>> seal();
+
+  private:
+
+    std::mutex                                m_mutex;
+    bool                                      m_sealed = false;
+
+    std::vector<std::vector<DxvkCsChunkRef>>  m_commandLists;
+    std::unordered_set<DxvkBuffer*>           m_renamedBuffers;
+    std::unordered_set<DxvkBuffer*>           m_usedBuffers;
+
+  };
+
+
+  /**
+   * \brief Command stream worker pool
+   *
+   * Spawns worker threads with their own DXVK contexts,
+   * which record the command lists of a batch into
+   * separate Vulkan command lists in parallel. The
+   * command lists are submitted in batch order.
+   */
+  class DxvkCsWorkerPool {
+
+  public:
+
+    DxvkCsWorkerPool(
+      const Rc<DxvkDevice>&             device,
+            uint32_t                    workerCount,
+            DxvkBarrierControlFlags     barrierControl);
+
+    ~DxvkCsWorkerPool();
+
+    /**
+     * \brief Executes a batch of command lists
+     *
+     * Must be called from the CS thread. Submits any
+     * commands recorded so far by the given context,
+     * records all command lists of the batch on the
+     * worker threads and submits them in order.
+     * \param [in] ctx The calling CS thread's context
+     * \param [in] batch The batch to execute
+     */
+    void executeBatch(
+            DxvkContext*                ctx,
+      const Rc<DxvkCsBatch>&            batch);
+
+  private:
+
+    struct Job {
+      const std::vector<DxvkCsChunkRef>*  chunks  = nullptr;
+      Rc<DxvkCommandList>                 cmdList = nullptr;
+    };
+
+    const Rc<DxvkDevice>          m_device;
+    const DxvkBarrierControlFlags m_barrierControl;
+
+    std::mutex                    m_mutex;
+    std::condition_variable       m_condOnAdd;
+    std::condition_variable       m_condOnDone;
+    std::queue<Job*>              m_jobs;
+    bool                          m_stopped = false;
+
+    std::vector<dxvk::thread>     m_workers;
+
+    void workerFunc(uint32_t workerId);
+
+  };
+
+}
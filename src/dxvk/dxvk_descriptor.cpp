@@ -1,29 +1,37 @@
+#include <cstring>
+
 #include "dxvk_descriptor.h"
 #include "dxvk_device.h"
+#include "dxvk_hash.h"
 
 namespace dxvk {
   
-  DxvkDescriptorPool::DxvkDescriptorPool(const Rc<vk::DeviceFn>& vkd)
-  : m_vkd(vkd) {
-    constexpr uint32_t MaxSets = 2048;
+  DxvkDescriptorPool::DxvkDescriptorPool(
+    const Rc<vk::DeviceFn>& vkd,
+          uint32_t          maxSets)
+  : m_vkd(vkd), m_maxSets(maxSets) {
+    // Descriptor counts are sized for sets covering all shader
+    // stages, but sets are usually allocated per stage, so we
+    // allow for more sets than the descriptor counts imply.
+    const uint32_t numSets = maxSets / 2;
 
     std::array<VkDescriptorPoolSize, 10> pools = {{
-      { VK_DESCRIPTOR_TYPE_SAMPLER,                MaxSets * 2 },
-      { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,          MaxSets * 3 },
-      { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,          MaxSets / 8 },
-      { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         MaxSets * 3 },
-      { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         MaxSets / 8 },
-      { VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER,   MaxSets * 3 },
-      { VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER,   MaxSets / 8 },
-      { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, MaxSets * 3 },
-      { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, MaxSets / 8 },
-      { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MaxSets * 2 } }};
+      { VK_DESCRIPTOR_TYPE_SAMPLER,                numSets * 2 },
+      { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,          numSets * 3 },
+      { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,          numSets / 8 },
+      { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         numSets * 3 },
+      { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         numSets / 8 },
+      { VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER,   numSets * 3 },
+      { VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER,   numSets / 8 },
+      { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, numSets * 3 },
+      { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, numSets / 8 },
+      { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, numSets * 2 } }};
     
     VkDescriptorPoolCreateInfo info;
     info.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     info.pNext         = nullptr;
     info.flags         = 0;
-    info.maxSets       = MaxSets;
+    info.maxSets       = maxSets;
     info.poolSizeCount = pools.size();
     info.pPoolSizes    = pools.data();
     
@@ -86,4 +94,120 @@ namespace dxvk {
     m_pools.clear();
   }
   
+
+
+
+  DxvkDescriptorSetCache::DxvkDescriptorSetCache() {
+
+  }
+
+
+  DxvkDescriptorSetCache::~DxvkDescriptorSetCache() {
+
+  }
+
+
+  VkDescriptorSet DxvkDescriptorSetCache::lookup(
+    const DxvkPipelineLayout*     layout,
+          uint32_t                set,
+    const DxvkDescriptorInfo*     infos,
+          size_t&                 hash) {
+    this->normalize(layout, set, infos);
+
+    DxvkHashState state;
+    state.add(size_t(layout->descriptorSetLayout(set)));
+
+    for (const auto& info : m_scratch) {
+      state.add(size_t(info.buffer.buffer));
+      state.add(size_t(info.buffer.offset));
+      state.add(size_t(info.buffer.range));
+    }
+
+    hash = state;
+
+    auto range = m_entries.equal_range(hash);
+
+    for (auto e = range.first; e != range.second; e++) {
+      const Entry& entry = e->second;
+
+      if (entry.layout    == layout->descriptorSetLayout(set)
+       && entry.infoCount == m_scratch.size()
+       && !std::memcmp(&m_infos[entry.infoIndex], m_scratch.data(),
+            sizeof(DxvkDescriptorInfo) * m_scratch.size()))
+        return entry.set;
+    }
+
+    return VK_NULL_HANDLE;
+  }
+
+
+  void DxvkDescriptorSetCache::insert(
+    const DxvkPipelineLayout*     layout,
+          uint32_t                set,
+    const DxvkDescriptorInfo*     infos,
+          size_t                  hash,
+          VkDescriptorSet         descriptorSet) {
+    // Keep the cache small, most sets are
+    // reused shortly after being written
+    if (m_entries.size() >= MaxEntries)
+      this->reset();
+
+    this->normalize(layout, set, infos);
+
+    Entry entry;
+    entry.layout    = layout->descriptorSetLayout(set);
+    entry.infoIndex = m_infos.size();
+    entry.infoCount = m_scratch.size();
+    entry.set       = descriptorSet;
+
+    m_infos.insert(m_infos.end(), m_scratch.begin(), m_scratch.end());
+    m_entries.insert({ hash, entry });
+  }
+
+
+  void DxvkDescriptorSetCache::reset() {
+    m_entries.clear();
+    m_infos.clear();
+  }
+
+
+  void DxvkDescriptorSetCache::normalize(
+    const DxvkPipelineLayout*     layout,
+          uint32_t                set,
+    const DxvkDescriptorInfo*     infos) {
+    // Only copy the members that are relevant for the
+    // descriptor type, since the remaining bytes of the
+    // union may contain stale data from other bindings.
+    uint32_t count = layout->setBindingCount(set);
+    m_scratch.resize(count);
+
+    for (uint32_t i = 0; i < count; i++) {
+      uint32_t id = layout->setBinding(set, i);
+
+      DxvkDescriptorInfo& dst = m_scratch[i];
+      std::memset(&dst, 0, sizeof(dst));
+
+      switch (layout->binding(id).type) {
+        case VK_DESCRIPTOR_TYPE_SAMPLER:
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+          dst.image.sampler     = infos[id].image.sampler;
+          dst.image.imageView   = infos[id].image.imageView;
+          dst.image.imageLayout = infos[id].image.imageLayout;
+          break;
+
+        case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+        case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+          dst.texelBuffer = infos[id].texelBuffer;
+          break;
+
+        default:
+          dst.buffer.buffer = infos[id].buffer.buffer;
+          dst.buffer.offset = infos[id].buffer.offset;
+          dst.buffer.range  = infos[id].buffer.range;
+      }
+    }
+  }
+
 }
\ No newline at end of file
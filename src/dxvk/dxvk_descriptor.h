@@ -1,8 +1,10 @@
 #pragma once
 
+#include <unordered_map>
 #include <vector>
 
 #include "dxvk_include.h"
+#include "dxvk_pipelayout.h"
 
 namespace dxvk {
 
@@ -32,9 +34,18 @@ namespace dxvk {
   public:
     
     DxvkDescriptorPool(
-      const Rc<vk::DeviceFn>& vkd);
+      const Rc<vk::DeviceFn>& vkd,
+            uint32_t          maxSets);
     ~DxvkDescriptorPool();
     
+    /**
+     * \brief Maximum number of descriptor sets
+     * \returns Number of sets the pool can hold
+     */
+    uint32_t maxSets() const {
+      return m_maxSets;
+    }
+    
     /**
      * \brief Allocates a descriptor set
      * 
@@ -56,6 +67,7 @@ namespace dxvk {
     
     Rc<vk::DeviceFn> m_vkd;
     VkDescriptorPool m_pool;
+    uint32_t         m_maxSets;
     
   };
 
@@ -97,4 +109,82 @@ namespace dxvk {
 
   };
   
+
+
+  /**
+   * \brief Descriptor set cache
+   * 
+   * Maps descriptor contents to descriptor sets that have
+   * already been written with those exact descriptors, so
+   * that they can be bound again instead of allocating and
+   * writing a new set. Only descriptor sets that remain
+   * valid for the lifetime of the current command list may
+   * be added, so the cache must be reset whenever recording
+   * into a new command list starts.
+   */
+  class DxvkDescriptorSetCache {
+    constexpr static uint32_t MaxEntries = 4096;
+  public:
+
+    DxvkDescriptorSetCache();
+    ~DxvkDescriptorSetCache();
+
+    /**
+     * \brief Looks up a descriptor set
+     * 
+     * \param [in] layout Pipeline layout
+     * \param [in] set Descriptor set index
+     * \param [in] infos Descriptor infos for all bindings
+     *    of the layout, indexed by binding index
+     * \param [out] hash Hash of the descriptor contents,
+     *    to be passed to \ref insert on a cache miss
+     * \returns Descriptor set, or \c VK_NULL_HANDLE
+     */
+    VkDescriptorSet lookup(
+      const DxvkPipelineLayout*     layout,
+            uint32_t                set,
+      const DxvkDescriptorInfo*     infos,
+            size_t&                 hash);
+
+    /**
+     * \brief Adds a descriptor set to the cache
+     * 
+     * \param [in] layout Pipeline layout
+     * \param [in] set Descriptor set index
+     * \param [in] infos Descriptor infos the set was written with
+     * \param [in] hash Hash returned by \ref lookup
+     * \param [in] descriptorSet The descriptor set
+     */
+    void insert(
+      const DxvkPipelineLayout*     layout,
+            uint32_t                set,
+      const DxvkDescriptorInfo*     infos,
+            size_t                  hash,
+            VkDescriptorSet         descriptorSet);
+
+    /**
+     * \brief Removes all descriptor sets
+     */
+    void reset();
+
+  private:
+
+    struct Entry {
+      VkDescriptorSetLayout layout;
+      uint32_t              infoIndex;
+      uint32_t              infoCount;
+      VkDescriptorSet       set;
+    };
+
+    std::unordered_multimap<size_t, Entry>  m_entries;
+    std::vector<DxvkDescriptorInfo>         m_infos;
+    std::vector<DxvkDescriptorInfo>         m_scratch;
+
+    void normalize(
+      const DxvkPipelineLayout*     layout,
+            uint32_t                set,
+      const DxvkDescriptorInfo*     infos);
+
+  };
+  
 }
\ No newline at end of file
@@ -53,6 +53,7 @@ namespace dxvk {
     DxvkDeviceOptions options;
     options.maxNumDynamicUniformBuffers = m_properties.core.properties.limits.maxDescriptorSetUniformBuffersDynamic;
     options.maxNumDynamicStorageBuffers = m_properties.core.properties.limits.maxDescriptorSetStorageBuffersDynamic;
+    options.maxNumDescriptorSets        = m_properties.core.properties.limits.maxBoundDescriptorSets;
     return options;
   }
   
@@ -69,9 +70,14 @@ namespace dxvk {
 
   Rc<DxvkDescriptorPool> DxvkDevice::createDescriptorPool() {
     Rc<DxvkDescriptorPool> pool = m_recycledDescriptorPools.retrieveObject();
+    uint32_t poolSize = m_descriptorPoolSize.load();
 
-    if (pool == nullptr)
-      pool = new DxvkDescriptorPool(m_vkd);
+    // Pools that are too small for the current workload
+    // are dropped so that they get replaced over time
+    if (pool == nullptr || pool->maxSets() < poolSize) {
+      pool = new DxvkDescriptorPool(m_vkd, poolSize);
+      m_descriptorPoolsCreated += 1;
+    }
     
     return pool;
   }
@@ -105,7 +111,7 @@ namespace dxvk {
     auto renderPassFormat = DxvkFramebuffer::getRenderPassFormat(renderTargets);
     auto renderPassObject = m_objects.renderPassPool().getRenderPass(renderPassFormat);
     
-    return new DxvkFramebuffer(m_vkd,
+    return new DxvkFramebuffer(&m_objects.framebufferCache(),
       renderPassObject, renderTargets, defaultSize);
   }
   
@@ -160,14 +166,26 @@ namespace dxvk {
   DxvkStatCounters DxvkDevice::getStatCounters() {
     DxvkMemoryStats mem = m_objects.memoryManager().getMemoryStats();
     DxvkPipelineCount pipe = m_objects.pipelineManager().getPipelineCount();
+    DxvkPipelineCompileStats compile = m_objects.pipelineManager().getCompileStats();
+    DxvkFramebufferCacheStats fb = m_objects.framebufferCache().getStats();
     
     DxvkStatCounters result;
     result.setCtr(DxvkStatCounter::MemoryAllocated,   mem.memoryAllocated);
     result.setCtr(DxvkStatCounter::MemoryUsed,        mem.memoryUsed);
+    result.setCtr(DxvkStatCounter::MemoryFragmented,  mem.memoryFragmented);
+    result.setCtr(DxvkStatCounter::MemoryLargestFree, mem.largestFreeBlock);
     result.setCtr(DxvkStatCounter::PipeCountGraphics, pipe.numGraphicsPipelines);
     result.setCtr(DxvkStatCounter::PipeCountCompute,  pipe.numComputePipelines);
     result.setCtr(DxvkStatCounter::PipeCompilerBusy,  m_objects.pipelineManager().isCompilingShaders());
+    result.setCtr(DxvkStatCounter::PipeCompileTime,   compile.compileTime);
+    result.setCtr(DxvkStatCounter::PipeCompileMaxTime, compile.maxCompileTime);
+    result.setCtr(DxvkStatCounter::PipeStallTime,     compile.stallTime);
     result.setCtr(DxvkStatCounter::GpuIdleTicks,      m_submissionQueue.gpuIdleTicks());
+    result.setCtr(DxvkStatCounter::DescriptorPoolCount,  m_descriptorPoolsCreated.load());
+    result.setCtr(DxvkStatCounter::DescriptorPoolResets, m_descriptorPoolResets.load());
+    result.setCtr(DxvkStatCounter::DescriptorPoolSize,   m_descriptorPoolSize.load());
+    result.setCtr(DxvkStatCounter::FramebufferCount,     fb.createCount);
+    result.setCtr(DxvkStatCounter::FramebufferCacheHits, fb.hitCount);
 
     std::lock_guard<sync::Spinlock> lock(m_statLock);
     result.merge(m_statCounters);
@@ -188,6 +206,16 @@ namespace dxvk {
   void DxvkDevice::registerShader(const Rc<DxvkShader>& shader) {
     m_objects.pipelineManager().registerShader(shader);
   }
+
+
+  Rc<DxvkShader> DxvkDevice::lookupShader(const DxvkShaderCacheKey& key) {
+    return m_objects.pipelineManager().lookupShader(key);
+  }
+
+
+  void DxvkDevice::addShader(const DxvkShaderCacheKey& key, const Rc<DxvkShader>& shader) {
+    m_objects.pipelineManager().addShader(key, shader);
+  }
   
   
   void DxvkDevice::presentImage(
@@ -200,9 +228,15 @@ namespace dxvk {
     presentInfo.presenter = presenter;
     presentInfo.waitSync  = semaphore;
     m_submissionQueue.present(presentInfo, status);
+
+    DxvkProfiler::endFrame();
     
+    this->updateRenamedBuffers();
+
     std::lock_guard<sync::Spinlock> statLock(m_statLock);
     m_statCounters.addCtr(DxvkStatCounter::QueuePresentCount, 1);
+
+    this->updateDescriptorPoolSize();
   }
 
 
@@ -257,6 +291,60 @@ namespace dxvk {
 
   void DxvkDevice::recycleDescriptorPool(const Rc<DxvkDescriptorPool>& pool) {
     m_recycledDescriptorPools.returnObject(pool);
+    m_descriptorPoolResets += 1;
+  }
+
+
+  void DxvkDevice::registerRenamedBuffer(
+          DxvkBuffer*               buffer) {
+    std::lock_guard<std::mutex> lock(m_renamedBufferLock);
+    m_renamedBuffers.push_back(buffer);
+  }
+
+
+  void DxvkDevice::unregisterRenamedBuffer(
+          DxvkBuffer*               buffer) {
+    std::lock_guard<std::mutex> lock(m_renamedBufferLock);
+
+    for (size_t i = 0; i < m_renamedBuffers.size(); i++) {
+      if (m_renamedBuffers[i] == buffer) {
+        m_renamedBuffers[i] = m_renamedBuffers.back();
+        m_renamedBuffers.pop_back();
+        return;
+      }
+    }
+  }
+
+
+  void DxvkDevice::updateDescriptorPoolSize() {
+    // Keep a short history of per-frame descriptor set
+    // counts and size new pools for the busiest frame.
+    // Only called with the stat lock held.
+    uint64_t setCount = m_statCounters.getCtr(DxvkStatCounter::DescriptorSetCount);
+    uint64_t frameId  = m_statCounters.getCtr(DxvkStatCounter::QueuePresentCount);
+
+    m_descriptorSetHistory[frameId % m_descriptorSetHistory.size()] = setCount - m_descriptorSetsPrev;
+    m_descriptorSetsPrev = setCount;
+
+    uint32_t maxSetCount = 0;
+
+    for (uint32_t count : m_descriptorSetHistory)
+      maxSetCount = std::max(maxSetCount, count);
+
+    uint32_t poolSize = 1024;
+
+    while (poolSize < maxSetCount && poolSize < 16384)
+      poolSize *= 2;
+
+    m_descriptorPoolSize.store(poolSize);
+  }
+
+
+  void DxvkDevice::updateRenamedBuffers() {
+    std::lock_guard<std::mutex> lock(m_renamedBufferLock);
+
+    for (DxvkBuffer* buffer : m_renamedBuffers)
+      buffer->updateSlicePool();
   }
 
 
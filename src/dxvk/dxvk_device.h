@@ -14,6 +14,7 @@
 #include "dxvk_options.h"
 #include "dxvk_pipecache.h"
 #include "dxvk_pipemanager.h"
+#include "dxvk_profiler.h"
 #include "dxvk_queue.h"
 #include "dxvk_recycler.h"
 #include "dxvk_renderpass.h"
@@ -34,6 +35,7 @@ namespace dxvk {
   struct DxvkDeviceOptions {
     uint32_t maxNumDynamicUniformBuffers = 0;
     uint32_t maxNumDynamicStorageBuffers = 0;
+    uint32_t maxNumDescriptorSets        = 0;
   };
 
   /**
@@ -215,7 +217,10 @@ namespace dxvk {
      * 
      * Returns a previously recycled pool, or creates
      * a new one if necessary. The context should take
-     * ownership of the returned pool.
+     * ownership of the returned pool. The pool size
+     * is chosen based on the number of descriptor sets
+     * allocated during recent frames, so that ideally
+     * each context needs about one pool per frame.
      * \returns Descriptor pool
      */
     Rc<DxvkDescriptorPool> createDescriptorPool();
@@ -252,7 +257,9 @@ namespace dxvk {
      * \brief Creates framebuffer for a set of render targets
      * 
      * Automatically deduces framebuffer dimensions
-     * from the supplied render target views.
+     * from the supplied render target views. The Vulkan
+     * framebuffer is reused if the same set of views was
+     * bound with the same render pass before.
      * \param [in] renderTargets Render targets
      * \returns The framebuffer object
      */
@@ -360,6 +367,25 @@ namespace dxvk {
     void registerShader(
       const Rc<DxvkShader>&         shader);
     
+    /**
+     * \brief Looks up a shader in the shader cache
+     * 
+     * \param [in] key Shader cache key
+     * \returns Cached shader, or \c nullptr
+     */
+    Rc<DxvkShader> lookupShader(
+      const DxvkShaderCacheKey&     key);
+    
+    /**
+     * \brief Adds a shader to the shader cache
+     * 
+     * \param [in] key Shader cache key
+     * \param [in] shader Newly compiled shader
+     */
+    void addShader(
+      const DxvkShaderCacheKey&     key,
+      const Rc<DxvkShader>&         shader);
+    
     /**
      * \brief Presents a swap chain image
      * 
@@ -440,6 +466,26 @@ namespace dxvk {
      */
     void waitForIdle();
     
+    /**
+     * \brief Registers a renamed buffer
+     * 
+     * Called by buffers that have allocated additional
+     * slices, so that their slice pool can be updated
+     * and trimmed once per frame.
+     * \param [in] buffer The buffer
+     */
+    void registerRenamedBuffer(
+            DxvkBuffer*               buffer);
+    
+    /**
+     * \brief Unregisters a renamed buffer
+     * 
+     * Must be called when the buffer is destroyed.
+     * \param [in] buffer The buffer
+     */
+    void unregisterRenamedBuffer(
+            DxvkBuffer*               buffer);
+    
   private:
     
     std::string                 m_clientApi;
@@ -457,6 +503,16 @@ namespace dxvk {
 
     sync::Spinlock              m_statLock;
     DxvkStatCounters            m_statCounters;
+
+    std::atomic<uint32_t>       m_descriptorPoolSize     = { 4096 };
+    std::atomic<uint64_t>       m_descriptorPoolsCreated = { 0 };
+    std::atomic<uint64_t>       m_descriptorPoolResets   = { 0 };
+
+    std::array<uint32_t, 8>     m_descriptorSetHistory   = { };
+    uint64_t                    m_descriptorSetsPrev     = 0;
+
+    std::mutex                  m_renamedBufferLock;
+    std::vector<DxvkBuffer*>    m_renamedBuffers;
     
     DxvkDeviceQueueSet          m_queues;
     
@@ -467,6 +523,10 @@ namespace dxvk {
 
     DxvkDevicePerfHints getPerfHints();
     
+    void updateDescriptorPoolSize();
+    
+    void updateRenamedBuffers();
+    
     void recycleCommandList(
       const Rc<DxvkCommandList>& cmdList);
     
@@ -1,50 +1,186 @@
+#include "dxvk_device.h"
 #include "dxvk_framebuffer.h"
 
 namespace dxvk {
   
-  DxvkFramebuffer::DxvkFramebuffer(
-    const Rc<vk::DeviceFn>&       vkd,
+  bool DxvkFramebufferKey::eq(const DxvkFramebufferKey& other) const {
+    bool eq = this->renderPass == other.renderPass
+           && this->depth      == other.depth;
+
+    for (uint32_t i = 0; i < MaxNumRenderTargets && eq; i++)
+      eq &= this->color[i] == other.color[i];
+
+    return eq;
+  }
+
+
+  size_t DxvkFramebufferKey::hash() const {
+    std::hash<const void*> phash;
+
+    DxvkHashState result;
+    result.add(phash(this->renderPass));
+    result.add(phash(this->depth));
+
+    for (uint32_t i = 0; i < MaxNumRenderTargets; i++)
+      result.add(phash(this->color[i]));
+
+    return result;
+  }
+
+
+  bool DxvkFramebufferKey::usesView(const DxvkImageView* view) const {
+    bool result = this->depth == view;
+
+    for (uint32_t i = 0; i < MaxNumRenderTargets && !result; i++)
+      result = this->color[i] == view;
+
+    return result;
+  }
+
+
+  DxvkFramebufferCache::DxvkFramebufferCache(const DxvkDevice* device)
+  : m_vkd(device->vkd()) {
+
+  }
+
+
+  DxvkFramebufferCache::~DxvkFramebufferCache() {
+    for (const auto& pair : m_framebuffers) {
+      m_vkd->vkDestroyFramebuffer(m_vkd->device(), pair.second, nullptr);
+
+      // Views that outlive the cache must not call back into it
+      if (pair.first.depth != nullptr)
+        const_cast<DxvkImageView*>(pair.first.depth)->setFramebufferCache(nullptr);
+
+      for (uint32_t i = 0; i < MaxNumRenderTargets; i++) {
+        if (pair.first.color[i] != nullptr)
+          const_cast<DxvkImageView*>(pair.first.color[i])->setFramebufferCache(nullptr);
+      }
+    }
+  }
+
+
+  VkFramebuffer DxvkFramebufferCache::getHandle(
           DxvkRenderPass*         renderPass,
     const DxvkRenderTargets&      renderTargets,
-    const DxvkFramebufferSize&    defaultSize)
-  : m_vkd           (vkd),
-    m_renderPass    (renderPass),
-    m_renderTargets (renderTargets),
-    m_renderSize    (computeRenderSize(defaultSize)) {
-    std::array<VkImageView, MaxNumRenderTargets + 1> views;
-    
+    const DxvkFramebufferSize&    size) {
+    DxvkFramebufferKey key;
+    key.renderPass = renderPass;
+    key.depth      = renderTargets.depth.view.ptr();
+
+    for (uint32_t i = 0; i < MaxNumRenderTargets; i++)
+      key.color[i] = renderTargets.color[i].view.ptr();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto entry = m_framebuffers.find(key);
+
+    if (entry != m_framebuffers.end()) {
+      m_hitCount += 1;
+      return entry->second;
+    }
+
+    VkFramebuffer framebuffer = this->createFramebuffer(renderPass, renderTargets, size);
+
+    if (framebuffer == VK_NULL_HANDLE)
+      return VK_NULL_HANDLE;
+
+    if (renderTargets.depth.view != nullptr)
+      renderTargets.depth.view->setFramebufferCache(this);
+
     for (uint32_t i = 0; i < MaxNumRenderTargets; i++) {
-      if (m_renderTargets.color[i].view != nullptr) {
-        views[m_attachmentCount] = m_renderTargets.color[i].view->handle();
-        m_attachments[m_attachmentCount] = &m_renderTargets.color[i];
-        m_attachmentCount += 1;
+      if (renderTargets.color[i].view != nullptr)
+        renderTargets.color[i].view->setFramebufferCache(this);
+    }
+
+    m_framebuffers.insert({ key, framebuffer });
+    m_createCount += 1;
+    return framebuffer;
+  }
+
+
+  void DxvkFramebufferCache::evictView(
+    const DxvkImageView*          view) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (auto entry = m_framebuffers.begin(); entry != m_framebuffers.end(); ) {
+      if (entry->first.usesView(view)) {
+        m_vkd->vkDestroyFramebuffer(m_vkd->device(), entry->second, nullptr);
+        entry = m_framebuffers.erase(entry);
+      } else {
+        entry++;
       }
     }
-    
-    if (m_renderTargets.depth.view != nullptr) {
-      views[m_attachmentCount] = m_renderTargets.depth.view->handle();
-      m_attachments[m_attachmentCount] = &m_renderTargets.depth;
-      m_attachmentCount += 1;
+  }
+
+
+  DxvkFramebufferCacheStats DxvkFramebufferCache::getStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    DxvkFramebufferCacheStats result;
+    result.createCount = m_createCount;
+    result.hitCount    = m_hitCount;
+    return result;
+  }
+
+
+  VkFramebuffer DxvkFramebufferCache::createFramebuffer(
+          DxvkRenderPass*         renderPass,
+    const DxvkRenderTargets&      renderTargets,
+    const DxvkFramebufferSize&    size) const {
+    std::array<VkImageView, MaxNumRenderTargets + 1> views;
+    uint32_t viewCount = 0;
+
+    for (uint32_t i = 0; i < MaxNumRenderTargets; i++) {
+      if (renderTargets.color[i].view != nullptr)
+        views[viewCount++] = renderTargets.color[i].view->handle();
     }
-    
+
+    if (renderTargets.depth.view != nullptr)
+      views[viewCount++] = renderTargets.depth.view->handle();
+
     VkFramebufferCreateInfo info;
     info.sType                = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
     info.pNext                = nullptr;
     info.flags                = 0;
-    info.renderPass           = m_renderPass->getDefaultHandle();
-    info.attachmentCount      = m_attachmentCount;
+    info.renderPass           = renderPass->getDefaultHandle();
+    info.attachmentCount      = viewCount;
     info.pAttachments         = views.data();
-    info.width                = m_renderSize.width;
-    info.height               = m_renderSize.height;
-    info.layers               = m_renderSize.layers;
-    
-    if (m_vkd->vkCreateFramebuffer(m_vkd->device(), &info, nullptr, &m_handle) != VK_SUCCESS)
+    info.width                = size.width;
+    info.height               = size.height;
+    info.layers               = size.layers;
+
+    VkFramebuffer framebuffer = VK_NULL_HANDLE;
+
+    if (m_vkd->vkCreateFramebuffer(m_vkd->device(), &info, nullptr, &framebuffer) != VK_SUCCESS)
       Logger::err("DxvkFramebuffer: Failed to create framebuffer object");
+
+    return framebuffer;
+  }
+
+
+  DxvkFramebuffer::DxvkFramebuffer(
+          DxvkFramebufferCache*   cache,
+          DxvkRenderPass*         renderPass,
+    const DxvkRenderTargets&      renderTargets,
+    const DxvkFramebufferSize&    defaultSize)
+  : m_renderPass    (renderPass),
+    m_renderTargets (renderTargets),
+    m_renderSize    (computeRenderSize(defaultSize)) {
+    for (uint32_t i = 0; i < MaxNumRenderTargets; i++) {
+      if (m_renderTargets.color[i].view != nullptr)
+        m_attachments[m_attachmentCount++] = &m_renderTargets.color[i];
+    }
+    
+    if (m_renderTargets.depth.view != nullptr)
+      m_attachments[m_attachmentCount++] = &m_renderTargets.depth;
+    
+    m_handle = cache->getHandle(m_renderPass, m_renderTargets, m_renderSize);
   }
   
   
   DxvkFramebuffer::~DxvkFramebuffer() {
-    m_vkd->vkDestroyFramebuffer(m_vkd->device(), m_handle, nullptr);
+    // The framebuffer handle is owned by the cache
   }
   
   
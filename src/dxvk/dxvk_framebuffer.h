@@ -1,5 +1,9 @@
 #pragma once
 
+#include <mutex>
+#include <unordered_map>
+
+#include "dxvk_hash.h"
 #include "dxvk_image.h"
 #include "dxvk_renderpass.h"
 
@@ -41,6 +45,104 @@ namespace dxvk {
     DxvkAttachment depth;
     DxvkAttachment color[MaxNumRenderTargets];
   };
+
+
+  /**
+   * \brief Framebuffer cache key
+   *
+   * Identifies a Vulkan framebuffer by the render
+   * pass, which implies the attachment formats, and
+   * the image views bound to each attachment slot.
+   */
+  struct DxvkFramebufferKey {
+    const DxvkRenderPass* renderPass;
+    const DxvkImageView*  depth;
+    const DxvkImageView*  color[MaxNumRenderTargets];
+
+    bool eq(const DxvkFramebufferKey& other) const;
+
+    size_t hash() const;
+
+    bool usesView(const DxvkImageView* view) const;
+  };
+
+
+  /**
+   * \brief Framebuffer cache statistics
+   */
+  struct DxvkFramebufferCacheStats {
+    uint64_t createCount;
+    uint64_t hitCount;
+  };
+
+
+  /**
+   * \brief Framebuffer cache
+   *
+   * Owns Vulkan framebuffer objects so that binding the
+   * same set of render targets again does not create a
+   * new framebuffer. Cached framebuffers do not keep the
+   * image views alive; instead, views notify the cache
+   * when they are destroyed, at which point no command
+   * buffer can use any framebuffer referencing them.
+   */
+  class DxvkFramebufferCache {
+
+  public:
+
+    DxvkFramebufferCache(const DxvkDevice* device);
+    ~DxvkFramebufferCache();
+
+    /**
+     * \brief Retrieves framebuffer handle
+     *
+     * Creates a new framebuffer if no framebuffer
+     * with the given render pass and views exists.
+     * \param [in] renderPass Render pass
+     * \param [in] renderTargets Render targets
+     * \param [in] size Framebuffer size
+     * \returns Framebuffer handle
+     */
+    VkFramebuffer getHandle(
+            DxvkRenderPass*         renderPass,
+      const DxvkRenderTargets&      renderTargets,
+      const DxvkFramebufferSize&    size);
+
+    /**
+     * \brief Destroys framebuffers using a view
+     *
+     * Called when the given image view is destroyed.
+     * \param [in] view The image view
+     */
+    void evictView(
+      const DxvkImageView*          view);
+
+    /**
+     * \brief Queries framebuffer statistics
+     * \returns Create and hit counts
+     */
+    DxvkFramebufferCacheStats getStats();
+
+  private:
+
+    Rc<vk::DeviceFn>  m_vkd;
+
+    std::mutex        m_mutex;
+
+    std::unordered_map<
+      DxvkFramebufferKey,
+      VkFramebuffer,
+      DxvkHash, DxvkEq> m_framebuffers;
+
+    uint64_t          m_createCount = 0;
+    uint64_t          m_hitCount    = 0;
+
+    VkFramebuffer createFramebuffer(
+            DxvkRenderPass*         renderPass,
+      const DxvkRenderTargets&      renderTargets,
+      const DxvkFramebufferSize&    size) const;
+
+  };
   
   
   /**
@@ -55,7 +157,7 @@ namespace dxvk {
   public:
     
     DxvkFramebuffer(
-      const Rc<vk::DeviceFn>&       vkd,
+            DxvkFramebufferCache*   cache,
             DxvkRenderPass*         renderPass,
       const DxvkRenderTargets&      renderTargets,
       const DxvkFramebufferSize&    defaultSize);
@@ -203,7 +305,6 @@ namespace dxvk {
     
   private:
     
-    const Rc<vk::DeviceFn>    m_vkd;
           DxvkRenderPass*     m_renderPass;
     const DxvkRenderTargets   m_renderTargets;
     const DxvkFramebufferSize m_renderSize;
@@ -12,7 +12,7 @@ namespace dxvk {
           VkQueryControlFlags flags,
           uint32_t            index)
   : m_vkd(vkd), m_type(type), m_flags(flags),
-    m_index(index), m_ended(false) {
+    m_index(index), m_status(DxvkGpuQueryStatus::Invalid) {
     
   }
   
@@ -34,19 +34,32 @@ namespace dxvk {
   DxvkGpuQueryStatus DxvkGpuQuery::getData(DxvkQueryData& queryData) const {
     queryData = DxvkQueryData();
 
-    if (!m_ended)
-      return DxvkGpuQueryStatus::Invalid;
+    // The acquire pairs with the release in end(), which
+    // makes the query handles visible to this thread
+    DxvkGpuQueryStatus prevStatus = m_status.load(std::memory_order_acquire);
+
+    if (prevStatus == DxvkGpuQueryStatus::Invalid
+     || prevStatus == DxvkGpuQueryStatus::Failed)
+      return prevStatus;
     
     // Empty begin/end pair
     if (!m_handle.queryPool)
       return DxvkGpuQueryStatus::Available;
     
     // Get query data from all associated handles
-    DxvkGpuQueryStatus status = getDataForHandle(queryData, m_handle);
+    bool available = prevStatus == DxvkGpuQueryStatus::Available;
+
+    DxvkGpuQueryStatus status = getDataForHandle(queryData, m_handle, available);
 
     for (size_t i = 0; i < m_handles.size()
         && status == DxvkGpuQueryStatus::Available; i++)
-      status = getDataForHandle(queryData, m_handles[i]);
+      status = getDataForHandle(queryData, m_handles[i], available);
+    
+    // Publish the final status so that subsequent polls can
+    // skip the reset events. This fails if the query got
+    // restarted in the meantime, which is what we want.
+    if (status != prevStatus && status != DxvkGpuQueryStatus::Pending)
+      m_status.compare_exchange_strong(prevStatus, status, std::memory_order_relaxed);
     
     // Treat non-precise occlusion queries as available
     // if we already know the result will be non-zero
@@ -61,7 +74,7 @@ namespace dxvk {
 
 
   void DxvkGpuQuery::begin(const Rc<DxvkCommandList>& cmd) {
-    m_ended = false;
+    m_status.store(DxvkGpuQueryStatus::Invalid, std::memory_order_relaxed);
 
     cmd->trackGpuQuery(m_handle);
     m_handle = DxvkGpuQueryHandle();
@@ -73,7 +86,7 @@ namespace dxvk {
 
   
   void DxvkGpuQuery::end() {
-    m_ended = true;
+    m_status.store(DxvkGpuQueryStatus::Pending, std::memory_order_release);
   }
 
 
@@ -87,13 +100,14 @@ namespace dxvk {
 
   DxvkGpuQueryStatus DxvkGpuQuery::getDataForHandle(
           DxvkQueryData&      queryData,
-    const DxvkGpuQueryHandle& handle) const {
+    const DxvkGpuQueryHandle& handle,
+          bool                available) const {
     DxvkQueryData tmpData;
 
     // Wait for the query to be reset first
     VkResult result;
     
-    if (handle.resetEvent) {
+    if (handle.resetEvent && !available) {
       result = m_vkd->vkGetEventStatus(
         m_vkd->device(), handle.resetEvent);
     
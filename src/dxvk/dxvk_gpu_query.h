@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <mutex>
 #include <vector>
 
@@ -223,7 +224,11 @@ namespace dxvk {
     VkQueryType         m_type;
     VkQueryControlFlags m_flags;
     uint32_t            m_index;
-    bool                m_ended;
+
+    // Written by the thread recording the query, read by
+    // threads polling it. Set to Pending when the query
+    // ends, and to Available once results are complete.
+    mutable std::atomic<DxvkGpuQueryStatus> m_status;
 
     DxvkGpuQueryHandle  m_handle;
     
@@ -231,7 +236,8 @@ namespace dxvk {
     
     DxvkGpuQueryStatus getDataForHandle(
             DxvkQueryData&      queryData,
-      const DxvkGpuQueryHandle& handle) const;
+      const DxvkGpuQueryHandle& handle,
+            bool                available) const;
 
   };
 
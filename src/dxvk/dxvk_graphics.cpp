@@ -35,8 +35,175 @@ namespace dxvk {
   bool DxvkGraphicsPipelineStateInfo::operator != (const DxvkGraphicsPipelineStateInfo& other) const {
     return std::memcmp(this, &other, sizeof(DxvkGraphicsPipelineStateInfo)) != 0;
   }
+
+
+  size_t DxvkGraphicsPipelineStateInfo::hash() const {
+    constexpr size_t WordCount = sizeof(*this) / sizeof(uint64_t);
+    constexpr size_t TailSize  = sizeof(*this) % sizeof(uint64_t);
+
+    auto data = reinterpret_cast<const char*>(this);
+
+    // Hash four interleaved streams so that the
+    // multiplications do not form one long chain
+    std::array<uint64_t, 4> lanes = { };
+
+    for (size_t i = 0; i < WordCount; i++) {
+      uint64_t word;
+      std::memcpy(&word, data + i * sizeof(word), sizeof(word));
+      lanes[i & 3] = (lanes[i & 3] ^ word) * 0x9e3779b97f4a7c15ull;
+    }
+
+    if (TailSize) {
+      uint64_t word = 0;
+      std::memcpy(&word, data + WordCount * sizeof(word), TailSize);
+      lanes[3] = (lanes[3] ^ word) * 0x9e3779b97f4a7c15ull;
+    }
+
+    DxvkHashState result;
+
+    for (uint64_t lane : lanes)
+      result.add(size_t(lane ^ (lane >> 32)));
+
+    return result;
+  }
+
+
+  void DxvkGraphicsPipelineStateInfo::normalize(const DxvkRenderPassFormat& format) {
+    // Primitive restart is only valid for strip topologies,
+    // and the patch size is only used for patch lists
+    switch (iaPrimitiveTopology) {
+      case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+      case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP:
+      case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN:
+      case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY:
+      case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP_WITH_ADJACENCY:
+        break;
+
+      default:
+        iaPrimitiveRestart = VK_FALSE;
+    }
+
+    if (iaPrimitiveTopology != VK_PRIMITIVE_TOPOLOGY_PATCH_LIST)
+      iaPatchVertexCount = 0;
+
+    // Divisors are only used for per-instance data
+    for (uint32_t i = 0; i < ilBindingCount; i++) {
+      if (ilBindings[i].inputRate != VK_VERTEX_INPUT_RATE_INSTANCE)
+        ilDivisors[i] = 0;
+    }
+
+    // Only the sample mask bits for existing samples matter
+    VkSampleCountFlags sampleCount = VK_SAMPLE_COUNT_1_BIT;
+
+    if (msSampleCount)
+      sampleCount = msSampleCount;
+    else if (rsSampleCount)
+      sampleCount = rsSampleCount;
+
+    if (sampleCount < 32)
+      msSampleMask &= (1u << sampleCount) - 1;
+
+    // Depth and stencil tests always pass if the
+    // render pass has no matching attachment aspect
+    VkImageAspectFlags dsAspects = 0;
+
+    if (format.depth.format != VK_FORMAT_UNDEFINED)
+      dsAspects = imageFormatInfo(format.depth.format)->aspectMask;
+
+    if (!(dsAspects & VK_IMAGE_ASPECT_DEPTH_BIT)) {
+      dsEnableDepthTest       = VK_FALSE;
+      dsEnableDepthBoundsTest = VK_FALSE;
+    }
+
+    if (!(dsAspects & VK_IMAGE_ASPECT_STENCIL_BIT))
+      dsEnableStencilTest = VK_FALSE;
+
+    if (!dsEnableDepthTest || util::isDepthReadOnlyLayout(format.depth.layout))
+      dsEnableDepthWrite = VK_FALSE;
+
+    if (!dsEnableDepthTest)
+      dsDepthCompareOp = VK_COMPARE_OP_ALWAYS;
+
+    if (!dsEnableStencilTest) {
+      dsStencilOpFront = VkStencilOpState();
+      dsStencilOpBack  = VkStencilOpState();
+    }
+
+    // Blending is implicitly disabled when logic ops are
+    // used, and has no effect on attachments not written
+    if (!omEnableLogicOp)
+      omLogicOp = VK_LOGIC_OP_NO_OP;
+
+    for (uint32_t i = 0; i < MaxNumRenderTargets; i++) {
+      auto& attachment = omBlendAttachments[i];
+
+      if (format.color[i].format == VK_FORMAT_UNDEFINED)
+        attachment.colorWriteMask = 0;
+
+      if (!attachment.colorWriteMask)
+        omComponentMapping[i] = VkComponentMapping();
+
+      if (!attachment.colorWriteMask || omEnableLogicOp)
+        attachment.blendEnable = VK_FALSE;
+
+      if (!attachment.blendEnable) {
+        attachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+        attachment.colorBlendOp        = VK_BLEND_OP_ADD;
+        attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+        attachment.alphaBlendOp        = VK_BLEND_OP_ADD;
+      }
+    }
+  }
   
   
+  DxvkGraphicsPipelineInstanceSet::DxvkGraphicsPipelineInstanceSet() {
+    for (auto& bucket : m_buckets)
+      bucket.store(nullptr, std::memory_order_relaxed);
+  }
+
+
+  size_t DxvkGraphicsPipelineInstanceSet::computeHash(
+    const DxvkGraphicsPipelineStateInfo&  state,
+    const DxvkRenderPass*                 rp) {
+    DxvkHashState result;
+    result.add(state.hash());
+    result.add(std::hash<const DxvkRenderPass*>()(rp));
+    return result;
+  }
+
+
+  DxvkGraphicsPipelineInstance* DxvkGraphicsPipelineInstanceSet::find(
+    const DxvkGraphicsPipelineStateInfo&  state,
+    const DxvkRenderPass*                 rp,
+          size_t                          hash) const {
+    auto instance = m_buckets[getBucketIndex(hash)].load(std::memory_order_acquire);
+
+    while (instance && !instance->isCompatible(state, rp, hash))
+      instance = instance->m_next;
+
+    return instance;
+  }
+
+
+  DxvkGraphicsPipelineInstance* DxvkGraphicsPipelineInstanceSet::insert(
+    const DxvkGraphicsPipelineStateInfo&  state,
+    const DxvkRenderPass*                 rp,
+          size_t                          hash,
+          DxvkGraphicsPipelineInstanceStatus status) {
+    auto& bucket = m_buckets[getBucketIndex(hash)];
+
+    // Fully initialize the instance before publishing it,
+    // readers may access it as soon as the bucket changes
+    auto instance = &m_instances.emplace_back(state, rp, hash, status);
+    instance->m_next = bucket.load(std::memory_order_relaxed);
+
+    bucket.store(instance, std::memory_order_release);
+    return instance;
+  }
+
+
   DxvkGraphicsPipeline::DxvkGraphicsPipeline(
           DxvkPipelineManager*        pipeMgr,
           DxvkGraphicsPipelineShaders shaders)
@@ -52,6 +219,9 @@ namespace dxvk {
       pipeMgr->m_device->options().maxNumDynamicUniformBuffers,
       pipeMgr->m_device->options().maxNumDynamicStorageBuffers);
     
+    m_slotMapping.splitDescriptorSets(
+      pipeMgr->m_device->options().maxNumDescriptorSets);
+    
     m_layout = new DxvkPipelineLayout(m_vkd,
       m_slotMapping, VK_PIPELINE_BIND_POINT_GRAPHICS);
     
@@ -97,66 +267,197 @@ namespace dxvk {
   VkPipeline DxvkGraphicsPipeline::getPipelineHandle(
     const DxvkGraphicsPipelineStateInfo& state,
     const DxvkRenderPass*                renderPass) {
-    DxvkGraphicsPipelineInstance* instance = nullptr;
+    DxvkGraphicsPipelineStateInfo normalized = this->normalizePipelineState(state, renderPass);
+    size_t hash = DxvkGraphicsPipelineInstanceSet::computeHash(normalized, renderPass);
 
-    { std::lock_guard<sync::Spinlock> lock(m_mutex);
-    
-      instance = this->findInstance(state, renderPass);
-      
-      if (instance)
-        return instance->pipeline();
-      
-      instance = this->createInstance(state, renderPass);
+    DxvkGraphicsPipelineInstance* instance = this->findInstance(normalized, renderPass, hash);
+    bool isNewInstance = false;
+    bool isClaimed     = false;
+
+    if (instance && instance->isReady())
+      return instance->pipeline();
+
+    if (!instance) {
+      std::lock_guard<sync::Spinlock> lock(m_mutex);
+
+      // Another thread may have added the
+      // instance since we last checked
+      instance = this->findInstance(normalized, renderPass, hash);
+
+      if (!instance) {
+        instance = this->createInstance(normalized, renderPass, hash,
+          DxvkGraphicsPipelineInstanceStatus::Compiling);
+        isNewInstance = true;
+        isClaimed     = true;
+      }
     }
-    
+
     if (!instance)
       return VK_NULL_HANDLE;
 
-    this->writePipelineStateToCache(state, renderPass->format());
+    // If the pipeline is queued but no compiler thread
+    // has picked it up yet, compile it right away
+    if (!isClaimed)
+      isClaimed = instance->tryClaim();
+
+    // Any time spent here is time the renderer is stalled
+    auto t0 = std::chrono::high_resolution_clock::now();
+
+    if (isNewInstance) {
+      // The state cache may have queued more state vectors
+      // for this pipeline, and we'll likely need them soon
+      m_pipeMgr->m_compiler->prioritize(this);
+    }
+
+    if (isClaimed)
+      this->compileInstance(instance, normalized, renderPass);
+    else
+      this->waitForInstance(instance);
+
+    if (isNewInstance)
+      this->writePipelineStateToCache(normalized, renderPass->format());
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    auto td = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0);
+
+    m_pipeMgr->m_stallTime += td.count();
     return instance->pipeline();
   }
 
 
+  bool DxvkGraphicsPipeline::tryGetPipelineHandle(
+    const DxvkGraphicsPipelineStateInfo& state,
+    const DxvkRenderPass*                renderPass,
+          VkPipeline&                    pipeline) {
+    DxvkGraphicsPipelineStateInfo normalized = this->normalizePipelineState(state, renderPass);
+    size_t hash = DxvkGraphicsPipelineInstanceSet::computeHash(normalized, renderPass);
+
+    pipeline = VK_NULL_HANDLE;
+
+    DxvkGraphicsPipelineInstance* instance = this->findInstance(normalized, renderPass, hash);
+
+    if (!instance) {
+      std::lock_guard<sync::Spinlock> lock(m_mutex);
+
+      instance = this->findInstance(normalized, renderPass, hash);
+
+      if (!instance) {
+        // Invalid pipelines are never compiled, so
+        // the draw gets skipped either way
+        if (!this->createInstance(normalized, renderPass, hash, DxvkGraphicsPipelineInstanceStatus::Queued))
+          return true;
+      }
+    }
+
+    if (instance) {
+      if (!instance->isReady())
+        return false;
+
+      pipeline = instance->pipeline();
+      return true;
+    }
+
+    m_pipeMgr->m_compiler->prioritize(this);
+    m_pipeMgr->m_compiler->queueCompilation(this,
+      normalized, renderPass, DxvkPipelinePriority::Renderer);
+
+    this->writePipelineStateToCache(normalized, renderPass->format());
+    return false;
+  }
+
+
   void DxvkGraphicsPipeline::compilePipeline(
     const DxvkGraphicsPipelineStateInfo& state,
     const DxvkRenderPass*                renderPass) {
-    std::lock_guard<sync::Spinlock> lock(m_mutex);
+    DxvkGraphicsPipelineStateInfo normalized = this->normalizePipelineState(state, renderPass);
+    size_t hash = DxvkGraphicsPipelineInstanceSet::computeHash(normalized, renderPass);
+
+    DxvkGraphicsPipelineInstance* instance = this->findInstance(normalized, renderPass, hash);
+
+    if (instance) {
+      if (!instance->tryClaim())
+        return;
+    } else {
+      std::lock_guard<sync::Spinlock> lock(m_mutex);
 
-    if (!this->findInstance(state, renderPass))
-      this->createInstance(state, renderPass);
+      instance = this->findInstance(normalized, renderPass, hash);
+
+      if (instance) {
+        if (!instance->tryClaim())
+          return;
+      } else {
+        instance = this->createInstance(normalized, renderPass, hash,
+          DxvkGraphicsPipelineInstanceStatus::Compiling);
+      }
+    }
+
+    if (instance)
+      this->compileInstance(instance, normalized, renderPass);
   }
 
 
   DxvkGraphicsPipelineInstance* DxvkGraphicsPipeline::createInstance(
     const DxvkGraphicsPipelineStateInfo& state,
-    const DxvkRenderPass*                renderPass) {
+    const DxvkRenderPass*                renderPass,
+          size_t                         hash,
+          DxvkGraphicsPipelineInstanceStatus status) {
     // If the pipeline state vector is invalid, don't try
     // to create a new pipeline, it won't work anyway.
     if (!this->validatePipelineState(state))
       return nullptr;
 
+    return m_pipelines.insert(state, renderPass, hash, status);
+  }
+
+
+  void DxvkGraphicsPipeline::compileInstance(
+          DxvkGraphicsPipelineInstance*  instance,
+    const DxvkGraphicsPipelineStateInfo& state,
+    const DxvkRenderPass*                renderPass) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+
     VkPipeline newPipelineHandle = this->createPipeline(state, renderPass);
 
+    auto t1 = std::chrono::high_resolution_clock::now();
+    auto td = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0);
+
+    if (Logger::logLevel() <= LogLevel::Debug)
+      Logger::debug(str::format("DxvkGraphicsPipeline: Finished in ", td.count() / 1000, " ms"));
+
     m_pipeMgr->m_numGraphicsPipelines += 1;
-    return &m_pipelines.emplace_back(state, renderPass, newPipelineHandle);
+    m_pipeMgr->recordCompileTime(td.count());
+
+    { std::lock_guard<std::mutex> lock(m_compileMutex);
+      instance->setPipeline(newPipelineHandle);
+    }
+
+    m_compileCond.notify_all();
+  }
+
+
+  void DxvkGraphicsPipeline::waitForInstance(
+          DxvkGraphicsPipelineInstance*  instance) {
+    std::unique_lock<std::mutex> lock(m_compileMutex);
+
+    m_compileCond.wait(lock, [instance] () {
+      return instance->isReady();
+    });
   }
   
   
   DxvkGraphicsPipelineInstance* DxvkGraphicsPipeline::findInstance(
     const DxvkGraphicsPipelineStateInfo& state,
-    const DxvkRenderPass*                renderPass) {
-    for (auto& instance : m_pipelines) {
-      if (instance.isCompatible(state, renderPass))
-        return &instance;
-    }
-    
-    return nullptr;
+    const DxvkRenderPass*                renderPass,
+          size_t                         hash) const {
+    return m_pipelines.find(state, renderPass, hash);
   }
   
   
   VkPipeline DxvkGraphicsPipeline::createPipeline(
     const DxvkGraphicsPipelineStateInfo& state,
     const DxvkRenderPass*                renderPass) const {
+    DxvkProfilerZone zone("Compile graphics pipeline");
+
     if (Logger::logLevel() <= LogLevel::Debug) {
       Logger::debug("Compiling graphics pipeline...");
       this->logPipelineState(LogLevel::Debug, state);
@@ -438,12 +739,6 @@ namespace dxvk {
     if (tsInfo.patchControlPoints == 0)
       info.pTessellationState = nullptr;
     
-    // Time pipeline compilation for debugging purposes
-    std::chrono::high_resolution_clock::time_point t0, t1;
-
-    if (Logger::logLevel() <= LogLevel::Debug)
-      t0 = std::chrono::high_resolution_clock::now();
-    
     VkPipeline pipeline = VK_NULL_HANDLE;
     if (m_vkd->vkCreateGraphicsPipelines(m_vkd->device(),
           m_pipeMgr->m_cache->handle(), 1, &info, nullptr, &pipeline) != VK_SUCCESS) {
@@ -451,12 +746,6 @@ namespace dxvk {
       this->logPipelineState(LogLevel::Error, state);
       return VK_NULL_HANDLE;
     }
-    
-    if (Logger::logLevel() <= LogLevel::Debug) {
-      t1 = std::chrono::high_resolution_clock::now();
-      auto td = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0);
-      Logger::debug(str::format("DxvkGraphicsPipeline: Finished in ", td.count(), " ms"));
-    }
 
     return pipeline;
   }
@@ -476,6 +765,23 @@ namespace dxvk {
   }
 
 
+  DxvkGraphicsPipelineStateInfo DxvkGraphicsPipeline::normalizePipelineState(
+    const DxvkGraphicsPipelineStateInfo& state,
+    const DxvkRenderPass*                renderPass) const {
+    DxvkGraphicsPipelineStateInfo result = state;
+
+    // Attachments that the fragment shader does not
+    // write are masked out when creating the pipeline
+    for (uint32_t i = 0; i < MaxNumRenderTargets; i++) {
+      if (!(m_fsOut & (1u << i)))
+        result.omBlendAttachments[i].colorWriteMask = 0;
+    }
+
+    result.normalize(renderPass->format());
+    return result;
+  }
+
+
   bool DxvkGraphicsPipeline::validatePipelineState(
     const DxvkGraphicsPipelineStateInfo& state) const {
     // Validate vertex input - each input slot consumed by the
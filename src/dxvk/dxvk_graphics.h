@@ -1,5 +1,9 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <mutex>
 
 #include "dxvk_bind_mask.h"
@@ -59,6 +63,26 @@ namespace dxvk {
     bool operator == (const DxvkGraphicsPipelineStateInfo& other) const;
     bool operator != (const DxvkGraphicsPipelineStateInfo& other) const;
 
+    /**
+     * \brief Normalizes the state vector
+     *
+     * Resets state that has no effect on rendering with
+     * the given render pass format to default values, so
+     * that state vectors which only differ in ignored
+     * state map to the same pipeline.
+     * \param [in] format Render pass format
+     */
+    void normalize(const DxvkRenderPassFormat& format);
+
+    /**
+     * \brief Computes hash of the state vector
+     *
+     * State vectors are always fully initialized, so
+     * the raw data can be hashed, including padding.
+     * \returns Hash of the state vector
+     */
+    size_t hash() const;
+
     bool useDynamicStencilRef() const {
       return dsEnableStencilTest;
     }
@@ -138,43 +162,95 @@ namespace dxvk {
   };
   
   
+  /**
+   * \brief Graphics pipeline instance status
+   */
+  enum class DxvkGraphicsPipelineInstanceStatus : uint32_t {
+    Queued    = 0,  ///< Waiting for a compiler thread
+    Compiling = 1,  ///< Being compiled by some thread
+    Ready     = 2,  ///< Compilation has finished
+  };
+
+
   /**
    * \brief Graphics pipeline instance
    * 
-   * Stores a state vector and the
-   * corresponding pipeline handle.
+   * Stores a state vector and the corresponding
+   * pipeline handle. Instances are added to the
+   * pipeline before compilation starts, so that
+   * other threads can wait for the pipeline to
+   * become available instead of compiling it
+   * a second time.
    */
   class DxvkGraphicsPipelineInstance {
 
   public:
 
-    DxvkGraphicsPipelineInstance()
-    : m_stateVector (),
-      m_renderPass  (VK_NULL_HANDLE),
-      m_pipeline    (VK_NULL_HANDLE) { }
-
     DxvkGraphicsPipelineInstance(
       const DxvkGraphicsPipelineStateInfo&  state,
       const DxvkRenderPass*                 rp,
-            VkPipeline                      pipe)
+            size_t                          hash,
+            DxvkGraphicsPipelineInstanceStatus status)
     : m_stateVector (state),
       m_renderPass  (rp),
-      m_pipeline    (pipe) { }
+      m_hash        (hash),
+      m_pipeline    (VK_NULL_HANDLE),
+      m_status      (status) { }
 
     /**
      * \brief Checks for matching pipeline state
      * 
      * \param [in] stateVector Graphics pipeline state
      * \param [in] renderPass Render pass handle
+     * \param [in] hash Hash of state and render pass
      * \returns \c true if the specialization is compatible
      */
     bool isCompatible(
       const DxvkGraphicsPipelineStateInfo&  state,
-      const DxvkRenderPass*                 rp) {
-      return m_renderPass  == rp
+      const DxvkRenderPass*                 rp,
+            size_t                          hash) const {
+      return m_hash        == hash
+          && m_renderPass  == rp
           && m_stateVector == state;
     }
 
+    /**
+     * \brief Checks whether the pipeline is compiled
+     * 
+     * \returns \c true if compilation has finished,
+     *    even if it did not succeed.
+     */
+    bool isReady() const {
+      return m_status.load(std::memory_order_acquire)
+          == DxvkGraphicsPipelineInstanceStatus::Ready;
+    }
+
+    /**
+     * \brief Claims a queued pipeline for compilation
+     * 
+     * Only one thread can successfully claim a
+     * pipeline, and that thread must compile it.
+     * \returns \c true if the calling thread
+     *    must compile the pipeline.
+     */
+    bool tryClaim() {
+      auto expected = DxvkGraphicsPipelineInstanceStatus::Queued;
+      return m_status.compare_exchange_strong(expected,
+        DxvkGraphicsPipelineInstanceStatus::Compiling);
+    }
+
+    /**
+     * \brief Sets pipeline handle
+     * 
+     * Must be called once compilation has finished.
+     * \param [in] pipe The pipeline handle
+     */
+    void setPipeline(VkPipeline pipe) {
+      m_pipeline = pipe;
+      m_status.store(DxvkGraphicsPipelineInstanceStatus::Ready,
+        std::memory_order_release);
+    }
+
     /**
      * \brief Retrieves pipeline
      * \returns The pipeline handle
@@ -185,10 +261,96 @@ namespace dxvk {
 
   private:
 
+    friend class DxvkGraphicsPipelineInstanceSet;
+
     DxvkGraphicsPipelineStateInfo m_stateVector;
     const DxvkRenderPass*         m_renderPass;
+    size_t                        m_hash;
     VkPipeline                    m_pipeline;
 
+    std::atomic<DxvkGraphicsPipelineInstanceStatus> m_status;
+
+    DxvkGraphicsPipelineInstance* m_next = nullptr;
+
+  };
+
+
+  /**
+   * \brief Graphics pipeline instance set
+   *
+   * Append-only hash table of pipeline instances. Each
+   * bucket is a singly linked list which new instances
+   * are prepended to, so that lookups can walk the list
+   * without taking a lock while another thread adds a
+   * new instance. Instances are never moved or removed.
+   */
+  class DxvkGraphicsPipelineInstanceSet {
+    constexpr static uint32_t HashTableBits = 6;
+    constexpr static uint32_t HashTableSize = 1u << HashTableBits;
+  public:
+
+    DxvkGraphicsPipelineInstanceSet();
+
+    /**
+     * \brief Computes lookup hash
+     *
+     * \param [in] state Pipeline state vector
+     * \param [in] rp Render pass
+     * \returns Hash to pass to \ref find and \ref insert
+     */
+    static size_t computeHash(
+      const DxvkGraphicsPipelineStateInfo&  state,
+      const DxvkRenderPass*                 rp);
+
+    /**
+     * \brief Looks up a pipeline instance
+     *
+     * Safe to call concurrently with \ref insert.
+     * \param [in] state Pipeline state vector
+     * \param [in] rp Render pass
+     * \param [in] hash Lookup hash
+     * \returns Matching instance, or \c nullptr
+     */
+    DxvkGraphicsPipelineInstance* find(
+      const DxvkGraphicsPipelineStateInfo&  state,
+      const DxvkRenderPass*                 rp,
+            size_t                          hash) const;
+
+    /**
+     * \brief Adds a pipeline instance
+     *
+     * Calls to this function must be synchronized
+     * with each other, but not with lookups.
+     * \param [in] state Pipeline state vector
+     * \param [in] rp Render pass
+     * \param [in] hash Lookup hash
+     * \param [in] status Initial instance status
+     * \returns The newly created instance
+     */
+    DxvkGraphicsPipelineInstance* insert(
+      const DxvkGraphicsPipelineStateInfo&  state,
+      const DxvkRenderPass*                 rp,
+            size_t                          hash,
+            DxvkGraphicsPipelineInstanceStatus status);
+
+    std::deque<DxvkGraphicsPipelineInstance>::const_iterator begin() const {
+      return m_instances.begin();
+    }
+
+    std::deque<DxvkGraphicsPipelineInstance>::const_iterator end() const {
+      return m_instances.end();
+    }
+
+  private:
+
+    std::deque<DxvkGraphicsPipelineInstance> m_instances;
+
+    std::array<std::atomic<DxvkGraphicsPipelineInstance*>, HashTableSize> m_buckets;
+
+    static uint32_t getBucketIndex(size_t hash) {
+      return uint32_t((uint64_t(hash) * 0x9e3779b97f4a7c15ull) >> (64 - HashTableBits));
+    }
+
   };
 
   
@@ -245,6 +407,8 @@ namespace dxvk {
      * 
      * Retrieves a pipeline handle for the given pipeline
      * state. If necessary, a new pipeline will be created.
+     * If another thread is currently compiling a pipeline
+     * for the given state, this will wait for it.
      * \param [in] state Pipeline state vector
      * \param [in] renderPass The render pass
      * \returns Pipeline handle
@@ -253,11 +417,31 @@ namespace dxvk {
       const DxvkGraphicsPipelineStateInfo&    state,
       const DxvkRenderPass*                   renderPass);
     
+    /**
+     * \brief Pipeline handle, if available
+     * 
+     * Never blocks. If no pipeline exists for the given
+     * state yet, the pipeline will be compiled on the
+     * pipeline compiler threads, ahead of pipelines
+     * prefetched from the state cache.
+     * \param [in] state Pipeline state vector
+     * \param [in] renderPass The render pass
+     * \param [out] pipeline Pipeline handle
+     * \returns \c false if the pipeline is not
+     *    available yet, \c true otherwise.
+     */
+    bool tryGetPipelineHandle(
+      const DxvkGraphicsPipelineStateInfo&    state,
+      const DxvkRenderPass*                   renderPass,
+            VkPipeline&                       pipeline);
+    
     /**
      * \brief Compiles a pipeline
      * 
      * Asynchronously compiles the given pipeline
-     * and stores the result for future use.
+     * and stores the result for future use. Does
+     * nothing if the pipeline is already compiled
+     * or being compiled on another thread.
      * \param [in] state Pipeline state vector
      * \param [in] renderPass The render pass
      */
@@ -281,17 +465,33 @@ namespace dxvk {
     DxvkGraphicsPipelineFlags           m_flags;
     DxvkGraphicsCommonPipelineStateInfo m_common;
     
-    // List of pipeline instances, shared between threads
+    // Set of pipeline instances, shared between threads. Only
+    // adding new instances requires the lock to be held.
     alignas(CACHE_LINE_SIZE) sync::Spinlock   m_mutex;
-    std::vector<DxvkGraphicsPipelineInstance> m_pipelines;
+    DxvkGraphicsPipelineInstanceSet           m_pipelines;
+
+    // Used to wait for pipelines compiled by other threads
+    std::mutex                                m_compileMutex;
+    std::condition_variable                   m_compileCond;
     
     DxvkGraphicsPipelineInstance* createInstance(
       const DxvkGraphicsPipelineStateInfo& state,
+      const DxvkRenderPass*                renderPass,
+            size_t                         hash,
+            DxvkGraphicsPipelineInstanceStatus status);
+    
+    void compileInstance(
+            DxvkGraphicsPipelineInstance*  instance,
+      const DxvkGraphicsPipelineStateInfo& state,
       const DxvkRenderPass*                renderPass);
     
+    void waitForInstance(
+            DxvkGraphicsPipelineInstance*  instance);
+    
     DxvkGraphicsPipelineInstance* findInstance(
       const DxvkGraphicsPipelineStateInfo& state,
-      const DxvkRenderPass*                renderPass);
+      const DxvkRenderPass*                renderPass,
+            size_t                         hash) const;
     
     VkPipeline createPipeline(
       const DxvkGraphicsPipelineStateInfo& state,
@@ -304,6 +504,10 @@ namespace dxvk {
       const Rc<DxvkShader>&                shader,
       const DxvkShaderModuleCreateInfo&    info) const;
     
+    DxvkGraphicsPipelineStateInfo normalizePipelineState(
+      const DxvkGraphicsPipelineStateInfo& state,
+      const DxvkRenderPass*                renderPass) const;
+
     bool validatePipelineState(
       const DxvkGraphicsPipelineStateInfo& state) const;
     
@@ -1,3 +1,4 @@
+#include "dxvk_framebuffer.h"
 #include "dxvk_image.h"
 
 namespace dxvk {
@@ -176,6 +177,11 @@ namespace dxvk {
   
   
   DxvkImageView::~DxvkImageView() {
+    DxvkFramebufferCache* fbCache = m_fbCache.load(std::memory_order_acquire);
+
+    if (fbCache != nullptr)
+      fbCache->evictView(this);
+
     for (uint32_t i = 0; i < ViewCount; i++)
       m_vkd->vkDestroyImageView(m_vkd->device(), m_views[i], nullptr);
   }
@@ -7,6 +7,8 @@
 #include "dxvk_util.h"
 
 namespace dxvk {
+
+  class DxvkFramebufferCache;
   
   /**
    * \brief Image create info
@@ -442,6 +444,18 @@ namespace dxvk {
       return result;
     }
 
+    /**
+     * \brief Sets framebuffer cache
+     *
+     * The framebuffer cache is notified when the view
+     * is destroyed, so that it can destroy any cached
+     * framebuffers which use this view.
+     * \param [in] cache The framebuffer cache
+     */
+    void setFramebufferCache(DxvkFramebufferCache* cache) {
+      m_fbCache.store(cache, std::memory_order_release);
+    }
+
   private:
     
     Rc<vk::DeviceFn>  m_vkd;
@@ -450,6 +464,8 @@ namespace dxvk {
     DxvkImageViewCreateInfo m_info;
     VkImageView             m_views[ViewCount];
 
+    std::atomic<DxvkFramebufferCache*> m_fbCache = { nullptr };
+
     void createView(VkImageViewType type, uint32_t numLayers);
     
   };
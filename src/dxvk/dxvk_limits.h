@@ -13,6 +13,7 @@ namespace dxvk {
     MaxNumViewports             =    16,
     MaxNumResourceSlots         =  1216,
     MaxNumActiveBindings        =   128,
+    MaxNumDescriptorSets        =     6,
     MaxNumQueuedCommandBuffers  =    12,
     MaxNumQueryCountPerPool     =   128,
     MaxNumSpecConstants         =     8,
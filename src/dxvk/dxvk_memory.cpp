@@ -59,9 +59,9 @@ namespace dxvk {
           DxvkMemoryAllocator*  alloc,
           DxvkMemoryType*       type,
           DxvkDeviceMemory      memory)
-  : m_alloc(alloc), m_type(type), m_memory(memory) {
-    // Mark the entire chunk as free
-    m_freeList.push_back(FreeSlice { 0, memory.memSize });
+  : m_alloc(alloc), m_type(type), m_memory(memory),
+    m_allocator(memory.memSize) {
+
   }
   
   
@@ -83,72 +83,21 @@ namespace dxvk {
      || m_memory.priority != priority)
       return DxvkMemory();
     
-    // If the chunk is full, return
-    if (m_freeList.size() == 0)
-      return DxvkMemory();
-    
-    // Select the slice to allocate from in a worst-fit
-    // manner. This may help keep fragmentation low.
-    auto bestSlice = m_freeList.begin();
-    
-    for (auto slice = m_freeList.begin(); slice != m_freeList.end(); slice++) {
-      if (slice->length == size) {
-        bestSlice = slice;
-        break;
-      } else if (slice->length > bestSlice->length) {
-        bestSlice = slice;
-      }
-    }
-    
-    // We need to align the allocation to the requested alignment
-    const VkDeviceSize sliceStart = bestSlice->offset;
-    const VkDeviceSize sliceEnd   = bestSlice->offset + bestSlice->length;
-    
-    const VkDeviceSize allocStart = dxvk::align(sliceStart,        align);
-    const VkDeviceSize allocEnd   = dxvk::align(allocStart + size, align);
-    
-    if (allocEnd > sliceEnd)
+    VkDeviceSize length = 0;
+    VkDeviceSize offset = m_allocator.alloc(size, align, length);
+
+    if (offset == DxvkTlsfAllocator::InvalidOffset)
       return DxvkMemory();
     
-    // We can use this slice, but we'll have to add
-    // the unused parts of it back to the free list.
-    m_freeList.erase(bestSlice);
-    
-    if (allocStart != sliceStart)
-      m_freeList.push_back({ sliceStart, allocStart - sliceStart });
-    
-    if (allocEnd != sliceEnd)
-      m_freeList.push_back({ allocEnd, sliceEnd - allocEnd });
-    
-    // Create the memory object with the aligned slice
     return DxvkMemory(m_alloc, this, m_type,
-      m_memory.memHandle, allocStart, allocEnd - allocStart,
-      reinterpret_cast<char*>(m_memory.memPointer) + allocStart);
+      m_memory.memHandle, offset, length,
+      reinterpret_cast<char*>(m_memory.memPointer) + offset);
   }
   
   
   void DxvkMemoryChunk::free(
-          VkDeviceSize  offset,
-          VkDeviceSize  length) {
-    // Remove adjacent entries from the free list and then add
-    // a new slice that covers all those entries. Without doing
-    // so, the slice could not be reused for larger allocations.
-    auto curr = m_freeList.begin();
-    
-    while (curr != m_freeList.end()) {
-      if (curr->offset == offset + length) {
-        length += curr->length;
-        curr = m_freeList.erase(curr);
-      } else if (curr->offset + curr->length == offset) {
-        offset -= curr->length;
-        length += curr->length;
-        curr = m_freeList.erase(curr);
-      } else {
-        curr++;
-      }
-    }
-    
-    m_freeList.push_back({ offset, length });
+          VkDeviceSize  offset) {
+    m_allocator.free(offset);
   }
   
   
@@ -157,10 +106,8 @@ namespace dxvk {
     m_device          (device),
     m_devProps        (device->adapter()->deviceProperties()),
     m_memProps        (device->adapter()->memoryProperties()) {
-    for (uint32_t i = 0; i < m_memProps.memoryHeapCount; i++) {
+    for (uint32_t i = 0; i < m_memProps.memoryHeapCount; i++)
       m_memHeaps[i].properties = m_memProps.memoryHeaps[i];
-      m_memHeaps[i].stats      = DxvkMemoryStats { 0, 0 };
-    }
     
     for (uint32_t i = 0; i < m_memProps.memoryTypeCount; i++) {
       m_memTypes[i].heap       = &m_memHeaps[m_memProps.memoryTypes[i].heapIndex];
@@ -183,8 +130,6 @@ namespace dxvk {
     const VkMemoryDedicatedAllocateInfoKHR& dedAllocInfo,
           VkMemoryPropertyFlags             flags,
           float                             priority) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-
     // Try to allocate from a memory type which supports the given flags exactly
     auto dedAllocPtr = dedAllocReq.prefersDedicatedAllocation ? &dedAllocInfo : nullptr;
     DxvkMemory result = this->tryAlloc(req, dedAllocPtr, flags, priority);
@@ -214,8 +159,8 @@ namespace dxvk {
 
       for (uint32_t i = 0; i < m_memProps.memoryHeapCount; i++) {
         Logger::err(str::format("Heap ", i, ": ",
-          (m_memHeaps[i].stats.memoryAllocated >> 20), " MB allocated, ",
-          (m_memHeaps[i].stats.memoryUsed      >> 20), " MB used, ",
+          (m_memHeaps[i].memoryAllocated.load() >> 20), " MB allocated, ",
+          (m_memHeaps[i].memoryUsed.load()      >> 20), " MB used, ",
           m_device->extensions().extMemoryBudget
             ? str::format(
                 (memHeapInfo.heaps[i].memoryAllocated >> 20), " MB allocated (driver), ",
@@ -233,13 +178,22 @@ namespace dxvk {
   
   
   DxvkMemoryStats DxvkMemoryAllocator::getMemoryStats() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-
     DxvkMemoryStats totalStats;
     
     for (size_t i = 0; i < m_memProps.memoryHeapCount; i++) {
-      totalStats.memoryAllocated += m_memHeaps[i].stats.memoryAllocated;
-      totalStats.memoryUsed      += m_memHeaps[i].stats.memoryUsed;
+      totalStats.memoryAllocated += m_memHeaps[i].memoryAllocated.load();
+      totalStats.memoryUsed      += m_memHeaps[i].memoryUsed.load();
+    }
+
+    for (size_t i = 0; i < m_memProps.memoryTypeCount; i++) {
+      std::lock_guard<std::mutex> lock(m_memTypes[i].mutex);
+
+      for (const auto& chunk : m_memTypes[i].chunks) {
+        DxvkTlsfStats chunkStats = chunk->getFreeStats();
+
+        totalStats.memoryFragmented += chunkStats.freeSize - chunkStats.largestFreeBlock;
+        totalStats.largestFreeBlock = std::max(totalStats.largestFreeBlock, chunkStats.largestFreeBlock);
+      }
     }
       
     return totalStats;
@@ -289,6 +243,8 @@ namespace dxvk {
       if (devMem.memHandle != VK_NULL_HANDLE)
         memory = DxvkMemory(this, nullptr, type, devMem.memHandle, 0, size, devMem.memPointer);
     } else {
+      std::lock_guard<std::mutex> lock(type->mutex);
+
       for (uint32_t i = 0; i < type->chunks.size() && !memory; i++)
         memory = type->chunks[i]->alloc(flags, size, align, priority);
       
@@ -308,7 +264,7 @@ namespace dxvk {
     }
 
     if (memory)
-      type->heap->stats.memoryUsed += memory.m_length;
+      type->heap->memoryUsed += memory.m_length;
 
     return memory;
   }
@@ -352,7 +308,7 @@ namespace dxvk {
       }
     }
 
-    type->heap->stats.memoryAllocated += size;
+    type->heap->memoryAllocated += size;
     m_device->adapter()->notifyHeapMemoryAlloc(type->heapId, size);
     return result;
   }
@@ -360,15 +316,13 @@ namespace dxvk {
 
   void DxvkMemoryAllocator::free(
     const DxvkMemory&           memory) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    memory.m_type->heap->stats.memoryUsed -= memory.m_length;
+    memory.m_type->heap->memoryUsed -= memory.m_length;
 
     if (memory.m_chunk != nullptr) {
       this->freeChunkMemory(
         memory.m_type,
         memory.m_chunk,
-        memory.m_offset,
-        memory.m_length);
+        memory.m_offset);
     } else {
       DxvkDeviceMemory devMem;
       devMem.memHandle  = memory.m_memory;
@@ -382,9 +336,9 @@ namespace dxvk {
   void DxvkMemoryAllocator::freeChunkMemory(
           DxvkMemoryType*       type,
           DxvkMemoryChunk*      chunk,
-          VkDeviceSize          offset,
-          VkDeviceSize          length) {
-    chunk->free(offset, length);
+          VkDeviceSize          offset) {
+    std::lock_guard<std::mutex> lock(type->mutex);
+    chunk->free(offset);
   }
   
 
@@ -392,7 +346,7 @@ namespace dxvk {
           DxvkMemoryType*       type,
           DxvkDeviceMemory      memory) {
     m_vkd->vkFreeMemory(m_vkd->device(), memory.memHandle, nullptr);
-    type->heap->stats.memoryAllocated -= memory.memSize;
+    type->heap->memoryAllocated -= memory.memSize;
     m_device->adapter()->notifyHeapMemoryFree(type->heapId, memory.memSize);
   }
 
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <atomic>
+#include <mutex>
+
 #include "dxvk_adapter.h"
+#include "dxvk_tlsf.h"
 
 namespace dxvk {
   
@@ -12,10 +16,16 @@ namespace dxvk {
    * 
    * Reports the amount of device memory
    * allocated and used by the application.
+   * Fragmented memory is free memory within
+   * chunks that is not part of the largest
+   * free block of its chunk, and therefore
+   * cannot be used for large allocations.
    */
   struct DxvkMemoryStats {
-    VkDeviceSize memoryAllocated = 0;
-    VkDeviceSize memoryUsed      = 0;
+    VkDeviceSize memoryAllocated  = 0;
+    VkDeviceSize memoryUsed       = 0;
+    VkDeviceSize memoryFragmented = 0;
+    VkDeviceSize largestFreeBlock = 0;
   };
   
   
@@ -40,10 +50,13 @@ namespace dxvk {
    * 
    * Corresponds to a Vulkan memory heap and stores
    * its properties as well as allocation statistics.
+   * Memory types sharing a heap are locked separately,
+   * so the statistics are updated atomically.
    */
   struct DxvkMemoryHeap {
-    VkMemoryHeap      properties;
-    DxvkMemoryStats   stats;
+    VkMemoryHeap              properties;
+    std::atomic<VkDeviceSize> memoryAllocated = { 0ull };
+    std::atomic<VkDeviceSize> memoryUsed      = { 0ull };
   };
 
 
@@ -63,6 +76,7 @@ namespace dxvk {
 
     VkDeviceSize      chunkSize;
 
+    std::mutex        mutex;
     std::vector<Rc<DxvkMemoryChunk>> chunks;
   };
   
@@ -151,7 +165,9 @@ namespace dxvk {
    * \brief Memory chunk
    * 
    * A single chunk of memory that provides a
-   * sub-allocator. This is not thread-safe.
+   * sub-allocator. This is not thread-safe,
+   * chunks are protected by the lock of the
+   * memory type they were allocated from.
    */
   class DxvkMemoryChunk : public RcObject {
     
@@ -188,24 +204,25 @@ namespace dxvk {
      * Called automatically when a memory
      * slice runs out of scope.
      * \param [in] offset Slice offset
-     * \param [in] length Slice length
      */
     void free(
-            VkDeviceSize  offset,
-            VkDeviceSize  length);
+            VkDeviceSize  offset);
     
-  private:
+    /**
+     * \brief Queries free block statistics
+     * \returns Free block statistics
+     */
+    DxvkTlsfStats getFreeStats() const {
+      return m_allocator.getStats();
+    }
     
-    struct FreeSlice {
-      VkDeviceSize offset;
-      VkDeviceSize length;
-    };
+  private:
     
     DxvkMemoryAllocator*  m_alloc;
     DxvkMemoryType*       m_type;
     DxvkDeviceMemory      m_memory;
     
-    std::vector<FreeSlice> m_freeList;
+    DxvkTlsfAllocator     m_allocator;
     
   };
   
@@ -258,6 +275,9 @@ namespace dxvk {
      * 
      * Returns the total amount of device memory
      * allocated and used by all available heaps.
+     * Computing fragmentation statistics requires
+     * locking every memory type, so this should
+     * not be called more than once per frame.
      * \returns Global memory stats
      */
     DxvkMemoryStats getMemoryStats();
@@ -269,7 +289,6 @@ namespace dxvk {
     const VkPhysicalDeviceProperties       m_devProps;
     const VkPhysicalDeviceMemoryProperties m_memProps;
     
-    std::mutex                                      m_mutex;
     std::array<DxvkMemoryHeap, VK_MAX_MEMORY_HEAPS> m_memHeaps;
     std::array<DxvkMemoryType, VK_MAX_MEMORY_TYPES> m_memTypes;
     
@@ -300,8 +319,7 @@ namespace dxvk {
     void freeChunkMemory(
             DxvkMemoryType*       type,
             DxvkMemoryChunk*      chunk,
-            VkDeviceSize          offset,
-            VkDeviceSize          length);
+            VkDeviceSize          offset);
     
     void freeDeviceMemory(
             DxvkMemoryType*       type,
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "dxvk_framebuffer.h"
 #include "dxvk_gpu_event.h"
 #include "dxvk_gpu_query.h"
 #include "dxvk_memory.h"
@@ -24,6 +25,7 @@ namespace dxvk {
     : m_device          (device),
       m_memoryManager   (device),
       m_renderPassPool  (device),
+      m_framebufferCache(device),
       m_pipelineManager (device, &m_renderPassPool),
       m_eventPool       (device),
       m_queryPool       (device),
@@ -39,6 +41,10 @@ namespace dxvk {
       return m_renderPassPool;
     }
 
+    DxvkFramebufferCache& framebufferCache() {
+      return m_framebufferCache;
+    }
+
     DxvkPipelineManager& pipelineManager() {
       return m_pipelineManager;
     }
@@ -81,6 +87,7 @@ namespace dxvk {
 
     DxvkMemoryAllocator           m_memoryManager;
     DxvkRenderPassPool            m_renderPassPool;
+    DxvkFramebufferCache          m_framebufferCache;
     DxvkPipelineManager           m_pipelineManager;
 
     DxvkGpuEventPool              m_eventPool;
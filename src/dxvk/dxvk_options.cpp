@@ -4,6 +4,8 @@ namespace dxvk {
 
   DxvkOptions::DxvkOptions(const Config& config) {
     enableStateCache      = config.getOption<bool>    ("dxvk.enableStateCache",       true);
+    enableShaderCache     = config.getOption<bool>    ("dxvk.enableShaderCache",      true);
+    enableAsyncPipelines  = config.getOption<bool>    ("dxvk.enableAsyncPipelines",   false);
     enableTransferQueue   = config.getOption<bool>    ("dxvk.enableTransferQueue",    true);
     numCompilerThreads    = config.getOption<int32_t> ("dxvk.numCompilerThreads",     0);
     asyncPresent          = config.getOption<Tristate>("dxvk.asyncPresent",           Tristate::Auto);
@@ -11,11 +11,17 @@ namespace dxvk {
     /// Enable state cache
     bool enableStateCache;
 
+    /// Enable shader cache
+    bool enableShaderCache;
+
+    /// Skip draws while their pipelines
+    /// are compiled in the background
+    bool enableAsyncPipelines;
+
     /// Use transfer queue if available
     bool enableTransferQueue;
 
-    /// Number of compiler threads
-    /// when using the state cache
+    /// Number of pipeline compiler threads
     int32_t numCompilerThreads;
 
     /// Asynchronous presentation
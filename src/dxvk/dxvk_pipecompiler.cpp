@@ -0,0 +1,168 @@
+#include "dxvk_device.h"
+#include "dxvk_pipecompiler.h"
+
+namespace dxvk {
+
+  DxvkPipelineCompiler::DxvkPipelineCompiler(
+    const DxvkDevice*                     device) {
+    // Use half the available CPU cores for pipeline compilation
+    uint32_t numCpuCores = dxvk::thread::hardware_concurrency();
+    uint32_t numWorkers  = numCpuCores > 8
+      ? numCpuCores * 3 / 4
+      : numCpuCores * 1 / 2;
+
+    if (numWorkers <  1) numWorkers =  1;
+    if (numWorkers > 16) numWorkers = 16;
+
+    if (device->config().numCompilerThreads > 0)
+      numWorkers = device->config().numCompilerThreads;
+
+    Logger::info(str::format("DXVK: Using ", numWorkers, " compiler threads"));
+
+    for (uint32_t i = 0; i < numWorkers; i++) {
+      m_workers.emplace_back([this] () { runWorker(); });
+      m_workers[i].set_priority(ThreadPriority::Lowest);
+    }
+  }
+
+
+  DxvkPipelineCompiler::~DxvkPipelineCompiler() {
+    { std::lock_guard<std::mutex> lock(m_mutex);
+      m_stopThreads.store(true);
+      m_cond.notify_all();
+    }
+
+    for (auto& worker : m_workers)
+      worker.join();
+  }
+
+
+  void DxvkPipelineCompiler::queueCompilation(
+          DxvkGraphicsPipeline*           pipeline,
+    const DxvkGraphicsPipelineStateInfo&  state,
+    const DxvkRenderPass*                 renderPass,
+          DxvkPipelinePriority            priority) {
+    Job job;
+    job.graphicsPipeline = pipeline;
+    job.computePipeline  = nullptr;
+    job.graphicsState    = state;
+    job.renderPass       = renderPass;
+
+    queueJob(std::move(job), priority);
+  }
+
+
+  void DxvkPipelineCompiler::queueCompilation(
+          DxvkComputePipeline*            pipeline,
+    const DxvkComputePipelineStateInfo&   state,
+          DxvkPipelinePriority            priority) {
+    Job job;
+    job.graphicsPipeline = nullptr;
+    job.computePipeline  = pipeline;
+    job.computeState     = state;
+    job.renderPass       = nullptr;
+
+    queueJob(std::move(job), priority);
+  }
+
+
+  void DxvkPipelineCompiler::prioritize(
+    const DxvkGraphicsPipeline*           pipeline) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto entry = m_prefetchMap.find(pipeline);
+
+    if (entry == m_prefetchMap.end())
+      return;
+
+    m_prefetchJobs.splice(m_prefetchJobs.begin(),
+      m_prefetchJobs, entry->second);
+  }
+
+
+  void DxvkPipelineCompiler::queueJob(
+          Job&&                       job,
+          DxvkPipelinePriority        priority) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_jobsPending += 1;
+
+    if (priority == DxvkPipelinePriority::Renderer) {
+      m_rendererJobs.push_back(std::move(job));
+    } else {
+      const void* pipeline = getPipeline(job);
+      auto entry = m_prefetchMap.find(pipeline);
+
+      if (entry == m_prefetchMap.end()) {
+        entry = m_prefetchMap.emplace(pipeline, m_prefetchJobs.insert(
+          m_prefetchJobs.end(), PrefetchJobs { pipeline })).first;
+      }
+
+      entry->second->jobs.push_back(std::move(job));
+    }
+
+    m_cond.notify_one();
+  }
+
+
+  DxvkPipelineCompiler::Job DxvkPipelineCompiler::dequeueJob() {
+    if (!m_rendererJobs.empty()) {
+      Job job = std::move(m_rendererJobs.front());
+      m_rendererJobs.pop_front();
+      return job;
+    }
+
+    PrefetchJobs& entry = m_prefetchJobs.front();
+
+    Job job = std::move(entry.jobs.front());
+    entry.jobs.pop_front();
+
+    if (entry.jobs.empty()) {
+      m_prefetchMap.erase(entry.pipeline);
+      m_prefetchJobs.pop_front();
+    }
+
+    return job;
+  }
+
+
+  const void* DxvkPipelineCompiler::getPipeline(
+    const Job&                        job) {
+    return job.graphicsPipeline
+      ? static_cast<const void*>(job.graphicsPipeline)
+      : static_cast<const void*>(job.computePipeline);
+  }
+
+
+  void DxvkPipelineCompiler::runWorker() {
+    env::setThreadName("dxvk-shader");
+
+    while (true) {
+      Job job;
+
+      { std::unique_lock<std::mutex> lock(m_mutex);
+
+        m_cond.wait(lock, [this] () {
+          return m_stopThreads.load()
+              || !m_rendererJobs.empty()
+              || !m_prefetchJobs.empty();
+        });
+
+        if (m_stopThreads.load())
+          break;
+
+        job = dequeueJob();
+      }
+
+      // If the pipeline has already been compiled, or if another
+      // thread is compiling it right now, this will return early.
+      if (job.graphicsPipeline)
+        job.graphicsPipeline->compilePipeline(job.graphicsState, job.renderPass);
+      else
+        job.computePipeline->compilePipeline(job.computeState);
+
+      m_jobsPending -= 1;
+    }
+  }
+
+}
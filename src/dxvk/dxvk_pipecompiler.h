@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "../util/thread.h"
+
+#include "dxvk_compute.h"
+#include "dxvk_graphics.h"
+
+namespace dxvk {
+
+  class DxvkDevice;
+
+  /**
+   * \brief Pipeline compile priority
+   *
+   * Pipelines that the renderer asked for are
+   * compiled before any prefetched pipelines.
+   */
+  enum class DxvkPipelinePriority : uint32_t {
+    Prefetch  = 0,  ///< Pipeline from the state cache
+    Renderer  = 1,  ///< Pipeline needed for rendering
+  };
+
+
+  /**
+   * \brief Pipeline compiler
+   *
+   * Compiles pipelines on a set of worker threads. Jobs
+   * are processed in order of priority, and in the order
+   * in which they were queued within the same priority.
+   * Prefetch jobs are grouped by pipeline object, so that
+   * the jobs of one pipeline can be prioritized at once.
+   *
+   * Jobs only reference pipeline objects, which track
+   * the pipelines that are currently being compiled.
+   * Queuing a pipeline that has already been compiled
+   * or that is being compiled on another thread is
+   * therefore harmless, and threads that need a queued
+   * pipeline immediately can compile it themselves
+   * rather than waiting for the workers to get to it.
+   */
+  class DxvkPipelineCompiler : public RcObject {
+
+  public:
+
+    DxvkPipelineCompiler(
+      const DxvkDevice*                     device);
+
+    ~DxvkPipelineCompiler();
+
+    /**
+     * \brief Queues a graphics pipeline for compilation
+     *
+     * \param [in] pipeline The pipeline object
+     * \param [in] state Pipeline state vector
+     * \param [in] renderPass The render pass
+     * \param [in] priority Compile priority
+     */
+    void queueCompilation(
+            DxvkGraphicsPipeline*           pipeline,
+      const DxvkGraphicsPipelineStateInfo&  state,
+      const DxvkRenderPass*                 renderPass,
+            DxvkPipelinePriority            priority);
+
+    /**
+     * \brief Queues a compute pipeline for compilation
+     *
+     * \param [in] pipeline The pipeline object
+     * \param [in] state Pipeline state vector
+     * \param [in] priority Compile priority
+     */
+    void queueCompilation(
+            DxvkComputePipeline*            pipeline,
+      const DxvkComputePipelineStateInfo&   state,
+            DxvkPipelinePriority            priority);
+
+    /**
+     * \brief Raises priority of queued jobs
+     *
+     * Moves all prefetch jobs for the given pipeline
+     * object to the front of the prefetch queue, but
+     * keeps them behind jobs queued by the renderer.
+     * Used when the renderer starts using a pipeline,
+     * since the remaining state vectors will likely
+     * be needed soon as well.
+     * \param [in] pipeline The pipeline object
+     */
+    void prioritize(
+      const DxvkGraphicsPipeline*           pipeline);
+
+    /**
+     * \brief Checks whether compiler threads are busy
+     * \returns \c true if pipelines are being compiled
+     */
+    bool isBusy() const {
+      return m_jobsPending.load() != 0;
+    }
+
+  private:
+
+    struct Job {
+      DxvkGraphicsPipeline*         graphicsPipeline;
+      DxvkComputePipeline*          computePipeline;
+      DxvkGraphicsPipelineStateInfo graphicsState;
+      DxvkComputePipelineStateInfo  computeState;
+      const DxvkRenderPass*         renderPass;
+    };
+
+    struct PrefetchJobs {
+      const void*                   pipeline;
+      std::deque<Job>               jobs;
+    };
+
+    using PrefetchList = std::list<PrefetchJobs>;
+
+    std::atomic<bool>                 m_stopThreads = { false };
+    std::atomic<uint32_t>             m_jobsPending = { 0u };
+
+    std::mutex                        m_mutex;
+    std::condition_variable           m_cond;
+    std::deque<Job>                   m_rendererJobs;
+    PrefetchList                      m_prefetchJobs;
+    std::unordered_map<const void*,
+      PrefetchList::iterator>         m_prefetchMap;
+    std::vector<dxvk::thread>         m_workers;
+
+    void queueJob(
+            Job&&                       job,
+            DxvkPipelinePriority        priority);
+
+    Job dequeueJob();
+
+    static const void* getPipeline(
+      const Job&                        job);
+
+    void runWorker();
+
+  };
+
+}
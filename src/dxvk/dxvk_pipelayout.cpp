@@ -20,6 +20,7 @@ namespace dxvk {
     } else {
       DxvkDescriptorSlot slotInfo;
       slotInfo.slot   = desc.slot;
+      slotInfo.set    = 0;
       slotInfo.type   = desc.type;
       slotInfo.view   = desc.view;
       slotInfo.stages = stage;
@@ -52,6 +53,41 @@ namespace dxvk {
   }
   
   
+  uint32_t DxvkDescriptorSlotMapping::getSetId(uint32_t slot) const {
+    uint32_t bindingId = this->getBindingId(slot);
+
+    return bindingId != InvalidBinding
+      ? m_descriptorSlots[bindingId].set
+      : 0;
+  }
+
+
+  void DxvkDescriptorSlotMapping::splitDescriptorSets(
+          uint32_t              maxSets) {
+    // Assign set indices to stages in pipeline order. Since
+    // stage bits are ordered the same way, the first stage
+    // of a binding is its lowest stage bit.
+    VkShaderStageFlags usedStages = 0;
+
+    for (const auto& slot : m_descriptorSlots)
+      usedStages |= slot.stages & -slot.stages;
+
+    uint32_t setCount = bit::popcnt(usedStages);
+
+    if (setCount < 2 || setCount > std::min<uint32_t>(maxSets, MaxNumDescriptorSets)) {
+      m_setCount = 1;
+      return;
+    }
+
+    for (auto& slot : m_descriptorSlots) {
+      VkShaderStageFlags firstStage = slot.stages & -slot.stages;
+      slot.set = bit::popcnt(usedStages & (firstStage - 1));
+    }
+
+    m_setCount = setCount;
+  }
+
+
   void DxvkDescriptorSlotMapping::makeDescriptorsDynamic(
           uint32_t              uniformBuffers,
           uint32_t              storageBuffers) {
@@ -98,33 +134,44 @@ namespace dxvk {
     for (uint32_t i = 0; i < bindingCount; i++)
       m_bindingSlots[i] = bindingInfos[i];
     
-    std::vector<VkDescriptorSetLayoutBinding>       bindings(bindingCount);
-    std::vector<VkDescriptorUpdateTemplateEntryKHR> tEntries(bindingCount);
+    // We do not need to create any descriptor
+    // sets if there are no active resource bindings.
+    if (bindingCount > 0)
+      m_setCount = slotMapping.setCount();
     
     for (uint32_t i = 0; i < bindingCount; i++) {
-      bindings[i].binding            = i;
-      bindings[i].descriptorType     = bindingInfos[i].type;
-      bindings[i].descriptorCount    = 1;
-      bindings[i].stageFlags         = bindingInfos[i].stages;
-      bindings[i].pImmutableSamplers = nullptr;
-      
-      tEntries[i].dstBinding      = i;
-      tEntries[i].dstArrayElement = 0;
-      tEntries[i].descriptorCount = 1;
-      tEntries[i].descriptorType  = bindingInfos[i].type;
-      tEntries[i].offset          = sizeof(DxvkDescriptorInfo) * i;
-      tEntries[i].stride          = 0;
-
-      if (bindingInfos[i].type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC
-       || bindingInfos[i].type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)
-        m_dynamicSlots.push_back(i);
-      
+      m_sets[bindingInfos[i].set].bindings.push_back(i);
       m_descriptorTypes.set(bindingInfos[i].type);
+
+      if (bindingInfos[i].type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
+       || bindingInfos[i].type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+        m_staticBufferSets |= 1u << bindingInfos[i].set;
     }
     
-    // Create descriptor set layout. We do not need to
-    // create one if there are no active resource bindings.
-    if (bindingCount > 0) {
+    // Create one descriptor set layout per set. Binding numbers
+    // are the same as the binding index within the pipeline
+    // layout, so that shaders only need their set index patched.
+    std::array<VkDescriptorSetLayout, MaxNumDescriptorSets> setLayouts;
+    
+    for (uint32_t s = 0; s < m_setCount; s++) {
+      const auto& setBindings = m_sets[s].bindings;
+
+      std::vector<VkDescriptorSetLayoutBinding> bindings(setBindings.size());
+
+      for (uint32_t i = 0; i < setBindings.size(); i++) {
+        uint32_t id = setBindings[i];
+
+        bindings[i].binding            = id;
+        bindings[i].descriptorType     = bindingInfos[id].type;
+        bindings[i].descriptorCount    = 1;
+        bindings[i].stageFlags         = bindingInfos[id].stages;
+        bindings[i].pImmutableSamplers = nullptr;
+
+        if (bindingInfos[id].type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC
+         || bindingInfos[id].type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)
+          m_dynamicSlots.push_back(id);
+      }
+      
       VkDescriptorSetLayoutCreateInfo dsetInfo;
       dsetInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
       dsetInfo.pNext        = nullptr;
@@ -133,17 +180,21 @@ namespace dxvk {
       dsetInfo.pBindings    = bindings.data();
       
       if (m_vkd->vkCreateDescriptorSetLayout(m_vkd->device(),
-            &dsetInfo, nullptr, &m_descriptorSetLayout) != VK_SUCCESS)
+            &dsetInfo, nullptr, &m_sets[s].layout) != VK_SUCCESS) {
+        this->destroyObjects();
         throw DxvkError("DxvkPipelineLayout: Failed to create descriptor set layout");
+      }
+
+      setLayouts[s] = m_sets[s].layout;
     }
     
-    // Create pipeline layout with the given descriptor set layout
+    // Create pipeline layout with the given descriptor set layouts
     VkPipelineLayoutCreateInfo pipeInfo;
     pipeInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipeInfo.pNext                  = nullptr;
     pipeInfo.flags                  = 0;
-    pipeInfo.setLayoutCount         = bindingCount > 0 ? 1 : 0;
-    pipeInfo.pSetLayouts            = &m_descriptorSetLayout;
+    pipeInfo.setLayoutCount         = m_setCount;
+    pipeInfo.pSetLayouts            = setLayouts.data();
     pipeInfo.pushConstantRangeCount = 0;
     pipeInfo.pPushConstantRanges    = nullptr;
 
@@ -154,13 +205,28 @@ namespace dxvk {
     
     if (m_vkd->vkCreatePipelineLayout(m_vkd->device(),
         &pipeInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
-      m_vkd->vkDestroyDescriptorSetLayout(m_vkd->device(), m_descriptorSetLayout, nullptr);
+      this->destroyObjects();
       throw DxvkError("DxvkPipelineLayout: Failed to create pipeline layout");
     }
     
-    // Create descriptor update template. If there are no active
-    // resource bindings, there won't be any descriptors to update.
-    if (bindingCount > 0) {
+    // Create descriptor update templates. All templates read from
+    // the same array of descriptor infos, indexed by binding index.
+    for (uint32_t s = 0; s < m_setCount; s++) {
+      const auto& setBindings = m_sets[s].bindings;
+
+      std::vector<VkDescriptorUpdateTemplateEntryKHR> tEntries(setBindings.size());
+
+      for (uint32_t i = 0; i < setBindings.size(); i++) {
+        uint32_t id = setBindings[i];
+
+        tEntries[i].dstBinding      = id;
+        tEntries[i].dstArrayElement = 0;
+        tEntries[i].descriptorCount = 1;
+        tEntries[i].descriptorType  = bindingInfos[id].type;
+        tEntries[i].offset          = sizeof(DxvkDescriptorInfo) * id;
+        tEntries[i].stride          = 0;
+      }
+
       VkDescriptorUpdateTemplateCreateInfoKHR templateInfo;
       templateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO_KHR;
       templateInfo.pNext = nullptr;
@@ -168,15 +234,14 @@ namespace dxvk {
       templateInfo.descriptorUpdateEntryCount = tEntries.size();
       templateInfo.pDescriptorUpdateEntries   = tEntries.data();
       templateInfo.templateType               = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET_KHR;
-      templateInfo.descriptorSetLayout        = m_descriptorSetLayout;
+      templateInfo.descriptorSetLayout        = m_sets[s].layout;
       templateInfo.pipelineBindPoint          = pipelineBindPoint;
       templateInfo.pipelineLayout             = m_pipelineLayout;
-      templateInfo.set                        = 0;
+      templateInfo.set                        = s;
       
       if (m_vkd->vkCreateDescriptorUpdateTemplateKHR(
-          m_vkd->device(), &templateInfo, nullptr, &m_descriptorTemplate) != VK_SUCCESS) {
-        m_vkd->vkDestroyDescriptorSetLayout(m_vkd->device(), m_descriptorSetLayout, nullptr);
-        m_vkd->vkDestroyPipelineLayout(m_vkd->device(), m_pipelineLayout, nullptr);
+          m_vkd->device(), &templateInfo, nullptr, &m_sets[s].updateTemplate) != VK_SUCCESS) {
+        this->destroyObjects();
         throw DxvkError("DxvkPipelineLayout: Failed to create descriptor update template");
       }
     }
@@ -184,14 +249,23 @@ namespace dxvk {
   
   
   DxvkPipelineLayout::~DxvkPipelineLayout() {
-    m_vkd->vkDestroyDescriptorUpdateTemplateKHR(
-      m_vkd->device(), m_descriptorTemplate, nullptr);
+    this->destroyObjects();
+  }
+  
+  
+  void DxvkPipelineLayout::destroyObjects() {
+    for (uint32_t s = 0; s < m_setCount; s++) {
+      m_vkd->vkDestroyDescriptorUpdateTemplateKHR(
+        m_vkd->device(), m_sets[s].updateTemplate, nullptr);
+    }
     
     m_vkd->vkDestroyPipelineLayout(
       m_vkd->device(), m_pipelineLayout, nullptr);
     
-    m_vkd->vkDestroyDescriptorSetLayout(
-      m_vkd->device(), m_descriptorSetLayout, nullptr);
+    for (uint32_t s = 0; s < m_setCount; s++) {
+      m_vkd->vkDestroyDescriptorSetLayout(
+        m_vkd->device(), m_sets[s].layout, nullptr);
+    }
   }
   
 }
\ No newline at end of file
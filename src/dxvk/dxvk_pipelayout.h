@@ -1,8 +1,10 @@
 #pragma once
 
+#include <array>
 #include <vector>
 
 #include "dxvk_include.h"
+#include "dxvk_limits.h"
 
 namespace dxvk {
 
@@ -28,6 +30,7 @@ namespace dxvk {
    */
   struct DxvkDescriptorSlot {
     uint32_t           slot;    ///< Resource slot index for the context
+    uint32_t           set;     ///< Descriptor set index
     VkDescriptorType   type;    ///< Descriptor type (aka resource type)
     VkImageViewType    view;    ///< Compatible image view type
     VkShaderStageFlags stages;  ///< Stages that can use the resource
@@ -66,6 +69,14 @@ namespace dxvk {
       return m_descriptorSlots.data();
     }
 
+    /**
+     * \brief Number of descriptor sets
+     * \returns Descriptor set count
+     */
+    uint32_t setCount() const {
+      return m_setCount;
+    }
+
     /**
      * \brief Push constant range
      * \returns Push constant range
@@ -109,6 +120,30 @@ namespace dxvk {
     uint32_t getBindingId(
             uint32_t              slot) const;
     
+    /**
+     * \brief Gets descriptor set ID for a slot
+     * 
+     * \param [in] slot Resource slot
+     * \returns Descriptor set index
+     */
+    uint32_t getSetId(
+            uint32_t              slot) const;
+    
+    /**
+     * \brief Assigns bindings to per-stage descriptor sets
+     * 
+     * Each shader stage that uses any resources gets its
+     * own descriptor set, so that changing the resources
+     * of one stage does not require rewriting descriptors
+     * for all other stages. Bindings used by more than one
+     * stage go into the set of the first stage. If there
+     * are more stages than the device can bind sets, all
+     * bindings remain in a single set.
+     * \param [in] maxSets Max number of descriptor sets
+     */
+    void splitDescriptorSets(
+            uint32_t              maxSets);
+    
     /**
      * \brief Makes static descriptors dynamic
      * 
@@ -127,6 +162,7 @@ namespace dxvk {
     
     std::vector<DxvkDescriptorSlot> m_descriptorSlots;
     VkPushConstantRange             m_pushConstRange = { };
+    uint32_t                        m_setCount       = 1;
 
     uint32_t countDescriptors(
             VkDescriptorType      type) const;
@@ -189,12 +225,54 @@ namespace dxvk {
       return m_pushConstRange;
     }
     
+    /**
+     * \brief Number of descriptor sets
+     * 
+     * Zero if the pipeline does not use
+     * any resources at all.
+     * \returns Descriptor set count
+     */
+    uint32_t setCount() const {
+      return m_setCount;
+    }
+    
+    /**
+     * \brief Mask of all descriptor sets
+     * \returns Bit mask of valid set indices
+     */
+    uint32_t setMask() const {
+      return (1u << m_setCount) - 1;
+    }
+    
+    /**
+     * \brief Number of bindings in a descriptor set
+     * 
+     * \param [in] set Descriptor set index
+     * \returns Binding count for that set
+     */
+    uint32_t setBindingCount(uint32_t set) const {
+      return m_sets[set].bindings.size();
+    }
+    
+    /**
+     * \brief Binding index of a descriptor in a set
+     * 
+     * \param [in] set Descriptor set index
+     * \param [in] id Descriptor index within the set
+     * \returns Binding index in this layout
+     */
+    uint32_t setBinding(uint32_t set, uint32_t id) const {
+      return m_sets[set].bindings[id];
+    }
+    
     /**
      * \brief Descriptor set layout handle
+     * 
+     * \param [in] set Descriptor set index
      * \returns Descriptor set layout handle
      */
-    VkDescriptorSetLayout descriptorSetLayout() const {
-      return m_descriptorSetLayout;
+    VkDescriptorSetLayout descriptorSetLayout(uint32_t set) const {
+      return m_sets[set].layout;
     }
     
     /**
@@ -207,10 +285,15 @@ namespace dxvk {
     
     /**
      * \brief Descriptor update template
+     * 
+     * The template for each set reads the descriptor
+     * infos for all bindings of the layout, indexed by
+     * binding index, but only writes those in the set.
+     * \param [in] set Descriptor set index
      * \returns Descriptor update template
      */
-    VkDescriptorUpdateTemplateKHR descriptorTemplate() const {
-      return m_descriptorTemplate;
+    VkDescriptorUpdateTemplateKHR descriptorTemplate(uint32_t set) const {
+      return m_sets[set].updateTemplate;
     }
 
     /**
@@ -224,6 +307,9 @@ namespace dxvk {
     /**
      * \brief Returns a dynamic binding
      * 
+     * Dynamic bindings are ordered by descriptor
+     * set first, which is the order in which the
+     * dynamic offsets must be passed to Vulkan.
      * \param [in] id Dynamic binding ID
      * \returns Reference to that binding
      */
@@ -231,6 +317,17 @@ namespace dxvk {
       return this->binding(m_dynamicSlots[id]);
     }
     
+    /**
+     * \brief Descriptor sets with static buffer bindings
+     * 
+     * Sets in this mask need to be rewritten when the
+     * offset of a bound uniform or storage buffer changes.
+     * \returns Bit mask of descriptor set indices
+     */
+    uint32_t staticBufferSetMask() const {
+      return m_staticBufferSets;
+    }
+    
     /**
      * \brief Checks for static buffer bindings
      * 
@@ -265,18 +362,28 @@ namespace dxvk {
 
   private:
     
+    struct SetInfo {
+      VkDescriptorSetLayout         layout          = VK_NULL_HANDLE;
+      VkDescriptorUpdateTemplateKHR updateTemplate  = VK_NULL_HANDLE;
+      std::vector<uint32_t>         bindings;
+    };
+    
     Rc<vk::DeviceFn> m_vkd;
     
     VkPushConstantRange             m_pushConstRange      = { };
-    VkDescriptorSetLayout           m_descriptorSetLayout = VK_NULL_HANDLE;
     VkPipelineLayout                m_pipelineLayout      = VK_NULL_HANDLE;
-    VkDescriptorUpdateTemplateKHR   m_descriptorTemplate  = VK_NULL_HANDLE;
+    
+    uint32_t                        m_setCount            = 0;
+    uint32_t                        m_staticBufferSets    = 0;
+    std::array<SetInfo, MaxNumDescriptorSets> m_sets;
     
     std::vector<DxvkDescriptorSlot> m_bindingSlots;
     std::vector<uint32_t>           m_dynamicSlots;
 
     Flags<VkDescriptorType>         m_descriptorTypes;
     
+    void destroyObjects();
+    
   };
   
 }
\ No newline at end of file
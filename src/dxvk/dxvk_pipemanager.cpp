@@ -43,16 +43,25 @@ namespace dxvk {
     const DxvkDevice*         device,
           DxvkRenderPassPool* passManager)
   : m_device    (device),
-    m_cache     (new DxvkPipelineCache(device->vkd())) {
+    m_cache     (new DxvkPipelineCache(device->vkd())),
+    m_compiler  (new DxvkPipelineCompiler(device)) {
     std::string useStateCache = env::getEnvVar("DXVK_STATE_CACHE");
     
     if (useStateCache != "0" && device->config().enableStateCache)
       m_stateCache = new DxvkStateCache(device, this, passManager);
+
+    std::string useShaderCache = env::getEnvVar("DXVK_SHADER_CACHE");
+
+    if (useShaderCache != "0" && device->config().enableShaderCache)
+      m_shaderCache = new DxvkShaderCache();
   }
   
   
   DxvkPipelineManager::~DxvkPipelineManager() {
-    
+    // Stop all threads that may still access
+    // pipeline objects before destroying them
+    m_stateCache = nullptr;
+    m_compiler = nullptr;
   }
   
   
@@ -101,6 +110,23 @@ namespace dxvk {
   }
 
 
+  Rc<DxvkShader> DxvkPipelineManager::lookupShader(
+    const DxvkShaderCacheKey&     key) {
+    if (m_shaderCache == nullptr)
+      return nullptr;
+    
+    return m_shaderCache->lookupShader(key);
+  }
+
+
+  void DxvkPipelineManager::addShader(
+    const DxvkShaderCacheKey&     key,
+    const Rc<DxvkShader>&         shader) {
+    if (m_shaderCache != nullptr)
+      m_shaderCache->addShader(key, shader);
+  }
+
+
   DxvkPipelineCount DxvkPipelineManager::getPipelineCount() const {
     DxvkPipelineCount result;
     result.numComputePipelines  = m_numComputePipelines.load();
@@ -109,9 +135,29 @@ namespace dxvk {
   }
 
 
+  DxvkPipelineCompileStats DxvkPipelineManager::getCompileStats() const {
+    DxvkPipelineCompileStats result;
+    result.compileTime    = m_compileTime.load();
+    result.maxCompileTime = m_maxCompileTime.load();
+    result.stallTime      = m_stallTime.load();
+    return result;
+  }
+
+
   bool DxvkPipelineManager::isCompilingShaders() const {
-    return m_stateCache != nullptr
-        && m_stateCache->isCompilingShaders();
+    return m_compiler->isBusy() || (m_stateCache != nullptr
+        && m_stateCache->isCompilingShaders());
   }
-  
+
+
+  void DxvkPipelineManager::recordCompileTime(
+          uint64_t                time) {
+    m_compileTime += time;
+
+    uint64_t maxTime = m_maxCompileTime.load();
+
+    while (time > maxTime && !m_maxCompileTime.compare_exchange_weak(maxTime, time))
+      continue;
+  }
+
 }
@@ -6,6 +6,8 @@
 
 #include "dxvk_compute.h"
 #include "dxvk_graphics.h"
+#include "dxvk_pipecompiler.h"
+#include "dxvk_shader_cache.h"
 
 namespace dxvk {
 
@@ -21,6 +23,21 @@ namespace dxvk {
     uint32_t numGraphicsPipelines;
     uint32_t numComputePipelines;
   };
+
+
+  /**
+   * \brief Pipeline compile statistics
+   * 
+   * Stores the total time spent compiling pipelines
+   * on any thread, the longest time spent compiling
+   * a single pipeline, as well as the time the renderer
+   * spent waiting for pipelines, in microseconds.
+   */
+  struct DxvkPipelineCompileStats {
+    uint64_t compileTime;
+    uint64_t maxCompileTime;
+    uint64_t stallTime;
+  };
   
   
   struct DxvkPipelineKeyHash {
@@ -47,6 +64,7 @@ namespace dxvk {
   class DxvkPipelineManager {
     friend class DxvkComputePipeline;
     friend class DxvkGraphicsPipeline;
+    friend class DxvkStateCache;
   public:
     
     DxvkPipelineManager(
@@ -90,12 +108,39 @@ namespace dxvk {
     void registerShader(
       const Rc<DxvkShader>&         shader);
     
+    /**
+     * \brief Looks up a shader in the shader cache
+     * 
+     * \param [in] key Shader cache key
+     * \returns Cached shader, or \c nullptr if the
+     *    shader cache is disabled or has no entry
+     */
+    Rc<DxvkShader> lookupShader(
+      const DxvkShaderCacheKey&     key);
+    
+    /**
+     * \brief Adds a shader to the shader cache
+     * 
+     * Does nothing if the shader cache is disabled.
+     * \param [in] key Shader cache key
+     * \param [in] shader Newly compiled shader
+     */
+    void addShader(
+      const DxvkShaderCacheKey&     key,
+      const Rc<DxvkShader>&         shader);
+    
     /**
      * \brief Retrieves total pipeline count
      * \returns Number of compute/graphics pipelines
      */
     DxvkPipelineCount getPipelineCount() const;
 
+    /**
+     * \brief Retrieves pipeline compile statistics
+     * \returns Compile, slowest compile and stall times
+     */
+    DxvkPipelineCompileStats getCompileStats() const;
+
     /**
      * \brief Checks whether async compiler is busy
      * \returns \c true if shaders are being compiled
@@ -106,10 +151,16 @@ namespace dxvk {
     
     const DxvkDevice*         m_device;
     Rc<DxvkPipelineCache>     m_cache;
+    Rc<DxvkPipelineCompiler>  m_compiler;
     Rc<DxvkStateCache>        m_stateCache;
+    Rc<DxvkShaderCache>       m_shaderCache;
 
     std::atomic<uint32_t>     m_numComputePipelines  = { 0 };
     std::atomic<uint32_t>     m_numGraphicsPipelines = { 0 };
+
+    std::atomic<uint64_t>     m_compileTime     = { 0ull };
+    std::atomic<uint64_t>     m_maxCompileTime  = { 0ull };
+    std::atomic<uint64_t>     m_stallTime       = { 0ull };
     
     std::mutex m_mutex;
     
@@ -125,6 +176,9 @@ namespace dxvk {
       DxvkPipelineKeyHash,
       DxvkPipelineKeyEq> m_graphicsPipelines;
     
+    void recordCompileTime(
+            uint64_t                time);
+    
   };
   
 }
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include <fstream>
+
+#include "dxvk_profiler.h"
+
+namespace dxvk {
+
+  DxvkProfiler DxvkProfiler::s_instance;
+
+  DxvkProfiler::DxvkProfiler() {
+
+  }
+
+
+  DxvkProfiler::~DxvkProfiler() {
+
+  }
+
+
+  void DxvkProfiler::recordZone(
+    const char*                 name,
+          uint64_t              begin,
+          uint64_t              end) {
+    s_instance.recordEvent({ name, begin, end, false });
+  }
+
+
+  void DxvkProfiler::recordGpuZone(
+    const char*                 name,
+          uint64_t              cpuTime,
+          uint64_t              gpuBegin,
+          uint64_t              gpuEnd) {
+    // The GPU cannot start executing commands before they
+    // were submitted, so the largest difference between
+    // the CPU and GPU time we've seen so far is the best
+    // estimate for the offset between the two timelines.
+    int64_t offset = int64_t(cpuTime) - int64_t(gpuBegin);
+    int64_t current = s_instance.m_gpuOffset.load();
+
+    while (offset > current && !s_instance.m_gpuOffset.compare_exchange_weak(current, offset))
+      continue;
+
+    s_instance.recordEvent({ name, gpuBegin, gpuEnd, true });
+  }
+
+
+  void DxvkProfiler::endFrame() {
+    if (!enabled())
+      return;
+
+    uint64_t time = now();
+    recordZone("Present", time, time);
+
+    bool keyPressed = GetAsyncKeyState(VK_F10) & 0x8000;
+
+    if (keyPressed && !s_instance.m_keyPressed)
+      s_instance.writeTrace();
+
+    s_instance.m_keyPressed = keyPressed;
+    s_instance.m_frameId += 1;
+  }
+
+
+  bool DxvkProfiler::initialize() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    State state = m_state.load(std::memory_order_acquire);
+
+    if (state == State::Unknown) {
+      bool enable = env::getEnvVar("DXVK_PROFILE") == "1";
+
+      if (enable)
+        Logger::info("DXVK: Profiler enabled, press F10 to write a trace");
+
+      m_startTime = Clock::now();
+
+      state = enable ? State::Enabled : State::Disabled;
+      m_state.store(state, std::memory_order_release);
+    }
+
+    return state == State::Enabled;
+  }
+
+
+  DxvkProfiler::ThreadBuffer* DxvkProfiler::getThreadBuffer() {
+    static thread_local ThreadBuffer* t_buffer = nullptr;
+
+    if (unlikely(!t_buffer)) {
+      // Buffers stay alive until the profiler is destroyed
+      // so that we can still write events of dead threads
+      std::lock_guard<std::mutex> lock(s_instance.m_mutex);
+
+      auto buffer = std::make_unique<ThreadBuffer>();
+      buffer->threadId = GetCurrentThreadId();
+
+      t_buffer = buffer.get();
+      s_instance.m_threads.push_back(std::move(buffer));
+    }
+
+    return t_buffer;
+  }
+
+
+  void DxvkProfiler::recordEvent(
+    const DxvkProfilerEvent&    event) {
+    ThreadBuffer* buffer = getThreadBuffer();
+
+    uint64_t index = buffer->eventCount.load(std::memory_order_relaxed);
+    EventSlot& slot = buffer->events[index % EventCount];
+
+    slot.seq.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.event = event;
+
+    slot.seq.store(2 * index + 2, std::memory_order_release);
+    buffer->eventCount.store(index + 1, std::memory_order_release);
+  }
+
+
+  void DxvkProfiler::writeTrace() {
+    std::string fileName = getFileName(m_traceId++);
+    std::ofstream file(fileName);
+
+    if (!file) {
+      Logger::err(str::format("DXVK: Failed to write trace file ", fileName));
+      return;
+    }
+
+    int64_t gpuOffset = m_gpuOffset.load();
+
+    file << "{\"traceEvents\":[\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}";
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (const auto& buffer : m_threads) {
+      uint64_t last  = buffer->eventCount.load(std::memory_order_acquire);
+      uint64_t first = last > EventCount ? last - EventCount : 0;
+
+      for (uint64_t i = first; i < last; i++) {
+        // Threads keep recording while we write the trace,
+        // so skip any event that got overwritten while we
+        // were copying it
+        const EventSlot& slot = buffer->events[i % EventCount];
+
+        uint64_t seq = slot.seq.load(std::memory_order_acquire);
+        DxvkProfilerEvent e = slot.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (seq != 2 * i + 2 || slot.seq.load(std::memory_order_relaxed) != seq)
+          continue;
+
+        if (e.gpu && gpuOffset == INT64_MIN)
+          continue;
+
+        int64_t  offset = e.gpu ? gpuOffset : 0;
+        uint32_t tid    = e.gpu ? 0 : buffer->threadId;
+
+        // Trace event timestamps are in microseconds
+        double ts  = double(int64_t(e.begin) + offset) / 1000.0;
+        double dur = double(e.end - e.begin) / 1000.0;
+
+        file << ",\n{\"name\":\"" << e.name << "\",\"pid\":1,\"tid\":" << tid
+             << ",\"ts\":" << std::fixed << ts;
+
+        if (e.end != e.begin)
+          file << ",\"ph\":\"X\",\"dur\":" << dur << "}";
+        else
+          file << ",\"ph\":\"i\",\"s\":\"p\"}";
+      }
+    }
+
+    file << "\n]}\n";
+
+    Logger::info(str::format("DXVK: Wrote trace file ", fileName));
+  }
+
+
+  std::string DxvkProfiler::getFileName(
+          uint32_t              traceId) {
+    std::string path = env::getEnvVar("DXVK_LOG_PATH");
+
+    if (!path.empty() && *path.rbegin() != '/')
+      path += '/';
+
+    std::string exeName = env::getExeName();
+    auto extp = exeName.find_last_of('.');
+
+    if (extp != std::string::npos && exeName.substr(extp + 1) == "exe")
+      exeName.erase(extp);
+
+    path += str::format(exeName, "_trace_", traceId, ".json");
+    return path;
+  }
+
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "dxvk_include.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Profiler event
+   *
+   * A single zone on the profiler timeline. Times
+   * are in nanoseconds. For CPU zones, they are
+   * relative to the start of the profiler, for
+   * GPU zones, they are raw GPU timestamps.
+   */
+  struct DxvkProfilerEvent {
+    const char* name;
+    uint64_t    begin;
+    uint64_t    end;
+    bool        gpu;
+  };
+
+
+  /**
+   * \brief Timeline profiler
+   *
+   * Records CPU zones into per-thread ring buffers,
+   * as well as GPU zones resolved from timestamp
+   * queries, and writes the most recent events to
+   * a Chrome trace file when \c F10 is pressed.
+   *
+   * Enabled by setting \c DXVK_PROFILE to \c 1.
+   * When disabled, recording a zone costs a
+   * single well-predicted branch. The variable is
+   * read on first use rather than during static
+   * initialization, since the logger may not have
+   * been constructed yet at that point.
+   */
+  class DxvkProfiler {
+    constexpr static size_t EventCount = 16384;
+
+    enum class State : uint32_t {
+      Unknown   = 0,
+      Disabled  = 1,
+      Enabled   = 2,
+    };
+  public:
+
+    DxvkProfiler();
+    ~DxvkProfiler();
+
+    /**
+     * \brief Checks whether profiling is enabled
+     * \returns \c true if events are recorded
+     */
+    static bool enabled() {
+      State state = s_instance.m_state.load(std::memory_order_acquire);
+
+      if (likely(state == State::Disabled))
+        return false;
+
+      return state == State::Enabled
+          || s_instance.initialize();
+    }
+
+    /**
+     * \brief Current CPU time
+     * \returns Time since profiler start, in ns
+     */
+    static uint64_t now() {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now() - s_instance.m_startTime).count();
+    }
+
+    /**
+     * \brief Records a CPU zone
+     *
+     * \param [in] name Zone name, must be a string literal
+     * \param [in] begin Start time, as returned by \ref now
+     * \param [in] end End time, as returned by \ref now
+     */
+    static void recordZone(
+      const char*                 name,
+            uint64_t              begin,
+            uint64_t              end);
+
+    /**
+     * \brief Records a GPU zone
+     *
+     * The CPU time is used to map GPU timestamps
+     * onto the CPU timeline, and must be taken
+     * before the GPU could have started executing
+     * the commands within the zone.
+     * \param [in] name Zone name, must be a string literal
+     * \param [in] cpuTime CPU time before submission
+     * \param [in] gpuBegin GPU start time, in ns
+     * \param [in] gpuEnd GPU end time, in ns
+     */
+    static void recordGpuZone(
+      const char*                 name,
+            uint64_t              cpuTime,
+            uint64_t              gpuBegin,
+            uint64_t              gpuEnd);
+
+    /**
+     * \brief Marks the end of a frame
+     *
+     * Called in the present path. Records a frame
+     * marker and checks whether the trace should be
+     * written to a file.
+     */
+    static void endFrame();
+
+  private:
+
+    using Clock = std::chrono::high_resolution_clock;
+
+    /**
+     * \brief Event slot
+     *
+     * The sequence number is odd while the event is
+     * being written, and twice the event index plus
+     * two once it is complete, so that readers can
+     * detect slots that were overwritten.
+     */
+    struct EventSlot {
+      std::atomic<uint64_t>                     seq = { 0ull };
+      DxvkProfilerEvent                         event;
+    };
+
+    struct ThreadBuffer {
+      uint32_t                                  threadId;
+      std::atomic<uint64_t>                     eventCount = { 0ull };
+      std::array<EventSlot, EventCount>         events;
+    };
+
+    static DxvkProfiler s_instance;
+
+    std::atomic<State>          m_state     = { State::Unknown };
+    Clock::time_point           m_startTime;
+
+    std::atomic<int64_t>        m_gpuOffset = { INT64_MIN };
+
+    std::mutex                  m_mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_threads;
+
+    uint64_t                    m_frameId     = 0;
+    uint32_t                    m_traceId     = 0;
+    bool                        m_keyPressed  = false;
+
+    bool initialize();
+
+    static ThreadBuffer* getThreadBuffer();
+
+    void recordEvent(
+      const DxvkProfilerEvent&    event);
+
+    void writeTrace();
+
+    static std::string getFileName(
+            uint32_t              traceId);
+
+  };
+
+
+  /**
+   * \brief Scoped profiler zone
+   *
+   * Records a CPU zone covering the lifetime
+   * of the object if profiling is enabled.
+   */
+  class DxvkProfilerZone {
+
+  public:
+
+    DxvkProfilerZone(const char* name)
+    : m_name(name) {
+      if (unlikely(DxvkProfiler::enabled()))
+        m_begin = DxvkProfiler::now();
+    }
+
+    ~DxvkProfilerZone() {
+      if (unlikely(DxvkProfiler::enabled()))
+        DxvkProfiler::recordZone(m_name, m_begin, DxvkProfiler::now());
+    }
+
+    DxvkProfilerZone             (const DxvkProfilerZone&) = delete;
+    DxvkProfilerZone& operator = (const DxvkProfilerZone&) = delete;
+
+  private:
+
+    const char* m_name;
+    uint64_t    m_begin = 0;
+
+  };
+
+}
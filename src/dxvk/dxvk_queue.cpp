@@ -60,7 +60,9 @@ namespace dxvk {
         return m_submitQueue.empty();
       });
 
+      DxvkProfilerZone zone("Queue present");
       VkResult result = presentInfo.presenter->presentImage(presentInfo.waitSync);
+      status->presentTime = std::chrono::high_resolution_clock::now();
       status->result.store(result);
     }
   }
@@ -118,12 +120,17 @@ namespace dxvk {
         std::lock_guard<std::mutex> lock(m_mutexQueue);
 
         if (entry.submit.cmdList != nullptr) {
+          DxvkProfilerZone zone("Queue submit");
           status = entry.submit.cmdList->submit(
             entry.submit.waitSync,
             entry.submit.wakeSync);
         } else if (entry.present.presenter != nullptr) {
+          DxvkProfilerZone zone("Queue present");
           status = entry.present.presenter->presentImage(
             entry.present.waitSync);
+
+          if (entry.status)
+            entry.status->presentTime = std::chrono::high_resolution_clock::now();
         }
       } else {
         // Don't submit anything after device loss
@@ -177,8 +184,10 @@ namespace dxvk {
       
       VkResult status = m_lastError.load();
       
-      if (status != VK_ERROR_DEVICE_LOST)
+      if (status != VK_ERROR_DEVICE_LOST) {
+        DxvkProfilerZone zone("Wait for command list");
         status = entry.submit.cmdList->synchronize();
+      }
       
       if (status != VK_SUCCESS) {
         Logger::err(str::format("DxvkSubmissionQueue: Failed to sync fence: ", status));
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <queue>
@@ -22,6 +23,9 @@ namespace dxvk {
    */
   struct DxvkSubmitStatus {
     std::atomic<VkResult> result = { VK_SUCCESS };
+    /// Time at which the image got presented. Only
+    /// valid for present operations that completed.
+    std::chrono::high_resolution_clock::time_point presentTime;
   };
 
 
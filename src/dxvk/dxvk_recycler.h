@@ -1,63 +1,101 @@
 #pragma once
 
-#include <mutex>
-#include <vector>
+#include <array>
+#include <atomic>
 
 namespace dxvk {
-  
+
   /**
    * \brief Object recycler
-   * 
+   *
    * Implements a thread-safe buffer that can store up to
    * a given number of objects of a certain type. This way,
    * DXVK can efficiently reuse and reset objects instead
    * of destroying them and creating them anew.
+   *
+   * Each slot holds one object and is claimed or filled
+   * with a single atomic operation, so that objects can
+   * be returned from the submission thread and retrieved
+   * from any number of contexts without taking a lock.
    * \tparam T Type of the objects to store
    * \tparam N Maximum number of objects to store
    */
   template<typename T, size_t N>
   class DxvkRecycler {
-    
+
   public:
-    
+
+    DxvkRecycler() {
+      for (auto& object : m_objects)
+        object.store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~DxvkRecycler() {
+      for (auto& object : m_objects) {
+        T* ptr = object.exchange(nullptr, std::memory_order_acquire);
+
+        if (ptr != nullptr && !ptr->decRef())
+          delete ptr;
+      }
+    }
+
+    DxvkRecycler             (const DxvkRecycler&) = delete;
+    DxvkRecycler& operator = (const DxvkRecycler&) = delete;
+
     /**
      * \brief Retrieves an object if possible
-     * 
+     *
      * Returns an object that was returned to the recycler
      * earier. In case no objects are available, this will
      * return \c nullptr and a new object has to be created.
      * \return An object, or \c nullptr
      */
     Rc<T> retrieveObject() {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      
-      if (m_objectId == 0)
-        return nullptr;
-      
-      return m_objects.at(--m_objectId);
+      for (auto& object : m_objects) {
+        if (object.load(std::memory_order_relaxed) == nullptr)
+          continue;
+
+        T* ptr = object.exchange(nullptr, std::memory_order_acquire);
+
+        if (ptr != nullptr) {
+          // Transfer the reference held by the recycler
+          Rc<T> result = ptr;
+          ptr->decRef();
+          return result;
+        }
+      }
+
+      return nullptr;
     }
-    
+
     /**
      * \brief Returns an object to the recycler
-     * 
+     *
      * If the buffer is full, the object will be destroyed
      * once the last reference runs out of scope. No further
      * action needs to be taken in this case.
      * \param [in] object The object to return
      */
     void returnObject(const Rc<T>& object) {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      
-      if (m_objectId < N)
-        m_objects.at(m_objectId++) = object;
+      T* ptr = object.ptr();
+      ptr->incRef();
+
+      for (auto& slot : m_objects) {
+        T* expected = nullptr;
+
+        if (slot.compare_exchange_strong(expected, ptr,
+            std::memory_order_release, std::memory_order_relaxed))
+          return;
+      }
+
+      // The caller still holds a reference
+      ptr->decRef();
     }
-    
+
   private:
-    
-    std::mutex           m_mutex;
-    std::array<Rc<T>, N> m_objects;
-    size_t               m_objectId = 0;
-    
+
+    std::array<std::atomic<T*>, N> m_objects;
+
   };
-  
+
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "dxvk_shader.h"
 
 #include <algorithm>
+#include <unordered_map>
 
 namespace dxvk {
   
@@ -111,6 +112,9 @@ namespace dxvk {
     // Gather the offsets where the binding IDs
     // are stored so we can quickly remap them.
     uint32_t o1VarId = 0;
+
+    std::unordered_map<uint32_t, size_t> bindingOffsets;
+    std::unordered_map<uint32_t, size_t> setOffsets;
     
     for (auto ins : code) {
       if (ins.opCode() == spv::OpDecorate) {
@@ -118,6 +122,12 @@ namespace dxvk {
          || ins.arg(2) == spv::DecorationSpecId)
           m_idOffsets.push_back(ins.offset() + 3);
         
+        if (ins.arg(2) == spv::DecorationBinding)
+          bindingOffsets.insert({ ins.arg(1), ins.offset() + 3 });
+        
+        if (ins.arg(2) == spv::DecorationDescriptorSet)
+          setOffsets.insert({ ins.arg(1), ins.offset() + 3 });
+        
         if (ins.arg(2) == spv::DecorationLocation && ins.arg(3) == 1) {
           m_o1LocOffset = ins.offset() + 3;
           o1VarId = ins.arg(1);
@@ -130,6 +140,15 @@ namespace dxvk {
       if (ins.opCode() == spv::OpCapability)
         m_capabilities.push_back(spv::Capability(ins.arg(1)));
     }
+
+    // Descriptor set indices depend on the resource slot,
+    // so we need to know which binding belongs to which set
+    for (const auto& set : setOffsets) {
+      auto binding = bindingOffsets.find(set.first);
+
+      if (binding != bindingOffsets.end())
+        m_setOffsets.push_back({ binding->second, set.second });
+    }
   }
   
   
@@ -167,6 +186,14 @@ namespace dxvk {
     SpirvCodeBuffer spirvCode = m_code.decompress();
     uint32_t* code = spirvCode.data();
     
+    // Remap descriptor set indices. This must be done
+    // before remapping binding IDs since it needs the
+    // original resource slot numbers.
+    for (const auto& ofs : m_setOffsets) {
+      if (code[ofs.first] < MaxNumResourceSlots)
+        code[ofs.second] = mapping.getSetId(code[ofs.first]);
+    }
+
     // Remap resource binding IDs
     for (uint32_t ofs : m_idOffsets) {
       if (code[ofs] < MaxNumResourceSlots)
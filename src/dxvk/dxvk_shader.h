@@ -178,6 +178,17 @@ namespace dxvk {
       const DxvkDescriptorSlotMapping& mapping,
       const DxvkShaderModuleCreateInfo& info);
     
+    /**
+     * \brief Resource slots
+     * 
+     * Retrieves the resource slot infos
+     * that the shader was created with.
+     * \returns Resource slot infos
+     */
+    const std::vector<DxvkResourceSlot>& resourceSlots() const {
+      return m_slots;
+    }
+
     /**
      * \brief Inter-stage interface slots
      * 
@@ -209,6 +220,17 @@ namespace dxvk {
       return m_constData;
     }
     
+    /**
+     * \brief Retrieves SPIR-V code
+     * 
+     * Returns an uncompressed copy of the SPIR-V code,
+     * with binding IDs referring to resource slots.
+     * \returns SPIR-V code
+     */
+    SpirvCodeBuffer getCode() const {
+      return m_code.decompress();
+    }
+
     /**
      * \brief Dumps SPIR-V shader
      * 
@@ -248,6 +270,7 @@ namespace dxvk {
     
     std::vector<DxvkResourceSlot> m_slots;
     std::vector<size_t>           m_idOffsets;
+    std::vector<std::pair<size_t, size_t>> m_setOffsets;
     DxvkInterfaceSlots            m_interface;
     DxvkShaderOptions             m_options;
     DxvkShaderConstData           m_constData;
@@ -0,0 +1,371 @@
+#include <version.h>
+
+#include "dxvk_shader_cache.h"
+
+namespace dxvk {
+
+  static const Sha1Hash g_nullHash = Sha1Hash::compute(nullptr, 0);
+
+
+  bool DxvkShaderCacheKey::eq(const DxvkShaderCacheKey& key) const {
+    return this->shader.eq(key.shader)
+        && this->variant == key.variant;
+  }
+
+
+  size_t DxvkShaderCacheKey::hash() const {
+    DxvkHashState hash;
+    hash.add(this->shader.hash());
+    hash.add(this->variant.dword(0));
+    return hash;
+  }
+
+
+  DxvkShaderCache::DxvkShaderCache() {
+    if (!readCacheFile()) {
+      Logger::warn("DXVK: Creating new shader cache file");
+
+      m_file.close();
+      m_entryMap.clear();
+      m_entrySet.clear();
+
+      std::ofstream file(getCacheFileName(),
+        std::ios_base::binary |
+        std::ios_base::trunc);
+
+      if (!file && env::createDirectory(getCacheDir())) {
+        file = std::ofstream(getCacheFileName(),
+          std::ios_base::binary |
+          std::ios_base::trunc);
+      }
+
+      DxvkShaderCacheHeader header;
+      header.dxvkVersion = getVersionHash();
+
+      file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    m_writerThread = dxvk::thread([this] () { writerFunc(); });
+  }
+
+
+  DxvkShaderCache::~DxvkShaderCache() {
+    { std::lock_guard<std::mutex> lock(m_writerLock);
+      m_writerStop = true;
+      m_writerCond.notify_one();
+    }
+
+    m_writerThread.join();
+  }
+
+
+  Rc<DxvkShader> DxvkShaderCache::lookupShader(
+    const DxvkShaderCacheKey&         key) {
+    size_t offset = 0;
+
+    { std::lock_guard<std::mutex> lock(m_entryLock);
+
+      auto entry = m_entryMap.find(key);
+
+      if (entry == m_entryMap.end())
+        return nullptr;
+
+      offset = entry->second;
+    }
+
+    // The mapped file contents never change, so we
+    // can read the entry without holding the lock
+    Rc<DxvkShader> shader = readCacheEntry(offset);
+
+    if (shader == nullptr) {
+      Logger::warn(str::format("DXVK: Invalid shader cache entry for ", key.shader.toString()));
+
+      // Drop the entry so that the shader gets
+      // written to the cache file once again
+      std::lock_guard<std::mutex> lock(m_entryLock);
+      m_entryMap.erase(key);
+      m_entrySet.erase(key);
+    }
+
+    return shader;
+  }
+
+
+  void DxvkShaderCache::addShader(
+    const DxvkShaderCacheKey&         key,
+    const Rc<DxvkShader>&             shader) {
+    { std::lock_guard<std::mutex> lock(m_entryLock);
+
+      if (!m_entrySet.insert(key).second)
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_writerLock);
+    m_writerQueue.push({ key, shader });
+    m_writerCond.notify_one();
+  }
+
+
+  bool DxvkShaderCache::readCacheFile() {
+    if (!m_file.open(getCacheFileName())) {
+      Logger::warn("DXVK: No shader cache file found");
+      return false;
+    }
+
+    DxvkShaderCacheHeader newHeader;
+    DxvkShaderCacheHeader curHeader;
+    newHeader.dxvkVersion = getVersionHash();
+
+    if (m_file.size() < sizeof(curHeader)) {
+      Logger::warn("DXVK: Failed to read shader cache header");
+      return false;
+    }
+
+    std::memcpy(&curHeader, m_file.data(), sizeof(curHeader));
+
+    if (std::memcmp(curHeader.magic, newHeader.magic, sizeof(newHeader.magic))
+     || curHeader.version != newHeader.version) {
+      Logger::warn("DXVK: Shader cache version not supported");
+      return false;
+    }
+
+    // Shaders compiled by a different DXVK build may
+    // be outdated, so there is no point in keeping them
+    if (!(curHeader.dxvkVersion == newHeader.dxvkVersion)) {
+      Logger::warn("DXVK: Shader cache created by different DXVK version");
+      return false;
+    }
+
+    // Cut off incomplete entries at the end of the file, which
+    // may be the result of the process being killed while the
+    // writer thread was appending an entry
+    size_t validSize = indexCacheFile();
+
+    if (validSize < m_file.size()) {
+      Logger::warn(str::format("DXVK: Discarding ", m_file.size() - validSize, " bytes of shader cache data"));
+      rewriteCacheFile(validSize);
+    }
+
+    Logger::info(str::format("DXVK: Found ", m_entryMap.size(), " shaders in shader cache"));
+    return true;
+  }
+
+
+  size_t DxvkShaderCache::indexCacheFile() {
+    size_t offset = sizeof(DxvkShaderCacheHeader);
+
+    while (offset + sizeof(DxvkShaderCacheEntryHeader) <= m_file.size()) {
+      DxvkShaderCacheEntryHeader header;
+      std::memcpy(&header, m_file.data() + offset, sizeof(header));
+
+      size_t entrySize = sizeof(header) + header.size;
+
+      if (offset + entrySize > m_file.size())
+        break;
+
+      // If a shader was written multiple times, e.g. because a
+      // previous entry got corrupted, the last entry is used.
+      m_entryMap[header.key] = offset;
+      m_entrySet.insert(header.key);
+
+      offset += entrySize;
+    }
+
+    return offset;
+  }
+
+
+  void DxvkShaderCache::rewriteCacheFile(
+          size_t                      validSize) {
+    std::vector<char> data(m_file.data(), m_file.data() + validSize);
+    m_file.close();
+
+    std::ofstream file(getCacheFileName(),
+      std::ios_base::binary |
+      std::ios_base::trunc);
+
+    file.write(data.data(), data.size());
+    file.close();
+
+    // Offsets of all indexed entries remain valid
+    if (!file || !m_file.open(getCacheFileName())) {
+      Logger::err("DXVK: Failed to rewrite shader cache file");
+
+      m_entryMap.clear();
+      m_entrySet.clear();
+    }
+  }
+
+
+  Rc<DxvkShader> DxvkShaderCache::readCacheEntry(
+          size_t                      offset) {
+    DxvkShaderCacheEntryHeader header;
+    std::memcpy(&header, m_file.data() + offset, sizeof(header));
+
+    const char* data = m_file.data() + offset + sizeof(header);
+
+    // Verify the checksum now rather than when reading the
+    // file, since most shaders will not be used in any
+    // given session and hashing all of them is expensive
+    Sha1Hash expectedHash = std::exchange(header.hash, g_nullHash);
+
+    std::array<Sha1Data, 2> chunks = {{
+      { &header, sizeof(header) },
+      { data,    header.size    },
+    }};
+
+    if (!(Sha1Hash::compute(chunks.size(), chunks.data()) == expectedHash))
+      return nullptr;
+
+    DxvkShaderCacheEntryInfo info;
+
+    if (header.size < sizeof(info))
+      return nullptr;
+
+    std::memcpy(&info, data, sizeof(info));
+
+    size_t slotOffset  = sizeof(info);
+    size_t constOffset = slotOffset  + sizeof(DxvkResourceSlot) * info.slotCount;
+    size_t codeOffset  = constOffset + sizeof(uint32_t) * info.constDwordCount;
+    size_t dataSize    = codeOffset  + sizeof(uint32_t) * info.codeDwordCount;
+
+    if (header.size != dataSize)
+      return nullptr;
+
+    std::vector<DxvkResourceSlot> slots(info.slotCount);
+    std::memcpy(slots.data(), data + slotOffset, sizeof(DxvkResourceSlot) * info.slotCount);
+
+    // All entries are a multiple of four bytes in size,
+    // so the constant data and code are dword-aligned
+    DxvkShaderConstData constData;
+
+    if (info.constDwordCount) {
+      constData = DxvkShaderConstData(info.constDwordCount,
+        reinterpret_cast<const uint32_t*>(data + constOffset));
+    }
+
+    SpirvCodeBuffer code(info.codeDwordCount,
+      reinterpret_cast<const uint32_t*>(data + codeOffset));
+
+    Rc<DxvkShader> shader = new DxvkShader(info.stage,
+      info.slotCount, slots.data(), info.iface, std::move(code),
+      info.options, std::move(constData));
+
+    shader->setShaderKey(header.key.shader);
+    return shader;
+  }
+
+
+  void DxvkShaderCache::writeCacheEntry(
+          std::ostream&               stream,
+    const WriterItem&                 item) {
+    const DxvkShader* shader = item.shader.ptr();
+
+    SpirvCodeBuffer code = shader->getCode();
+    const auto& slots = shader->resourceSlots();
+    const auto& constData = shader->shaderConstants();
+
+    DxvkShaderCacheEntryInfo info;
+    info.stage           = shader->stage();
+    info.slotCount       = slots.size();
+    info.constDwordCount = constData.sizeInBytes() / sizeof(uint32_t);
+    info.codeDwordCount  = code.dwords();
+    info.iface           = shader->interfaceSlots();
+    info.options         = shader->shaderOptions();
+
+    std::vector<char> data;
+    data.reserve(sizeof(info)
+      + sizeof(DxvkResourceSlot) * slots.size()
+      + constData.sizeInBytes() + code.size());
+
+    auto append = [&data] (const void* src, size_t size) {
+      auto bytes = reinterpret_cast<const char*>(src);
+      data.insert(data.end(), bytes, bytes + size);
+    };
+
+    append(&info, sizeof(info));
+    append(slots.data(), sizeof(DxvkResourceSlot) * slots.size());
+    append(constData.data(), constData.sizeInBytes());
+    append(code.data(), code.size());
+
+    DxvkShaderCacheEntryHeader header;
+    header.key  = item.key;
+    header.size = data.size();
+    header.hash = g_nullHash;
+
+    std::array<Sha1Data, 2> chunks = {{
+      { &header,     sizeof(header) },
+      { data.data(), data.size()    },
+    }};
+
+    header.hash = Sha1Hash::compute(chunks.size(), chunks.data());
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(data.data(), data.size());
+    stream.flush();
+  }
+
+
+  void DxvkShaderCache::writerFunc() {
+    env::setThreadName("dxvk-shader-writer");
+
+    std::ofstream file;
+
+    while (true) {
+      WriterItem item;
+
+      { std::unique_lock<std::mutex> lock(m_writerLock);
+
+        m_writerCond.wait(lock, [this] () {
+          return m_writerQueue.size()
+              || m_writerStop;
+        });
+
+        // Drain the queue before exiting so that
+        // shaders compiled late don't get lost
+        if (m_writerQueue.size() == 0)
+          break;
+
+        item = std::move(m_writerQueue.front());
+        m_writerQueue.pop();
+      }
+
+      if (!file.is_open()) {
+        file = std::ofstream(getCacheFileName(),
+          std::ios_base::binary |
+          std::ios_base::app);
+      }
+
+      writeCacheEntry(file, item);
+    }
+  }
+
+
+  std::string DxvkShaderCache::getCacheFileName() const {
+    std::string path = getCacheDir();
+
+    if (!path.empty() && *path.rbegin() != '/')
+      path += '/';
+
+    std::string exeName = env::getExeName();
+    auto extp = exeName.find_last_of('.');
+
+    if (extp != std::string::npos && exeName.substr(extp + 1) == "exe")
+      exeName.erase(extp);
+
+    path += exeName + ".dxvk-shaders";
+    return path;
+  }
+
+
+  std::string DxvkShaderCache::getCacheDir() const {
+    return env::getEnvVar("DXVK_STATE_CACHE_PATH");
+  }
+
+
+  Sha1Hash DxvkShaderCache::getVersionHash() {
+    std::string version = DXVK_VERSION;
+    return Sha1Hash::compute(version.data(), version.size());
+  }
+
+}
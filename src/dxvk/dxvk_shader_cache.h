@@ -0,0 +1,179 @@
+#pragma once
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "../util/thread.h"
+#include "../util/util_file.h"
+
+#include "dxvk_hash.h"
+#include "dxvk_shader.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Shader cache key
+   *
+   * The shader key identifies the shader code, but
+   * the compiled SPIR-V may also depend on options
+   * that the client API passes to its compiler. The
+   * client API must therefore provide a hash of all
+   * such options, which must differ between variants
+   * of the same shader.
+   */
+  struct DxvkShaderCacheKey {
+    DxvkShaderKey shader;
+    Sha1Hash      variant;
+
+    bool eq(const DxvkShaderCacheKey& key) const;
+
+    size_t hash() const;
+  };
+
+
+  /**
+   * \brief Shader cache file header
+   *
+   * Stores a hash of the DXVK version string, since
+   * any change to the shader compiler may change the
+   * generated code. Files with a different version
+   * hash are discarded.
+   */
+  struct DxvkShaderCacheHeader {
+    char     magic[4]   = { 'D', 'X', 'V', 'S' };
+    uint32_t version    = 1;
+    Sha1Hash dxvkVersion;
+  };
+
+  static_assert(sizeof(DxvkShaderCacheHeader) == 28);
+
+
+  /**
+   * \brief Shader cache entry header
+   *
+   * Precedes the shader data in the cache file. The
+   * hash is computed over the entry header with the
+   * hash field set to the SHA-1 of an empty string,
+   * as well as the shader data that follows it.
+   */
+  struct DxvkShaderCacheEntryHeader {
+    DxvkShaderCacheKey key;
+    uint32_t           size;
+    Sha1Hash           hash;
+  };
+
+  static_assert(sizeof(DxvkShaderCacheEntryHeader) == 68);
+
+
+  /**
+   * \brief Shader cache entry info
+   *
+   * Stored at the start of the shader data, and followed
+   * by the resource slots, the constant data and the
+   * SPIR-V code, in that order.
+   */
+  struct DxvkShaderCacheEntryInfo {
+    VkShaderStageFlagBits stage;
+    uint32_t              slotCount;
+    uint32_t              constDwordCount;
+    uint32_t              codeDwordCount;
+    DxvkInterfaceSlots    iface;
+    DxvkShaderOptions     options;
+  };
+
+
+  /**
+   * \brief Shader cache
+   *
+   * Stores compiled shaders on disk so that client APIs
+   * can skip shader translation for shaders that were
+   * already used in a previous run. The cache file is
+   * mapped into memory and indexed on creation, while
+   * individual entries are only validated when they
+   * are actually looked up. New shaders are appended
+   * to the file on a background thread.
+   */
+  class DxvkShaderCache : public RcObject {
+
+  public:
+
+    DxvkShaderCache();
+
+    ~DxvkShaderCache();
+
+    /**
+     * \brief Looks up a shader
+     *
+     * \param [in] key Shader cache key
+     * \returns The shader, or \c nullptr if the cache
+     *    does not contain a valid entry for the key
+     */
+    Rc<DxvkShader> lookupShader(
+      const DxvkShaderCacheKey&         key);
+
+    /**
+     * \brief Adds a shader to the cache
+     *
+     * If the shader is not already cached, this will
+     * write the shader to the cache file.
+     * \param [in] key Shader cache key
+     * \param [in] shader The compiled shader
+     */
+    void addShader(
+      const DxvkShaderCacheKey&         key,
+      const Rc<DxvkShader>&             shader);
+
+  private:
+
+    struct WriterItem {
+      DxvkShaderCacheKey  key;
+      Rc<DxvkShader>      shader;
+    };
+
+    MappedFile                        m_file;
+
+    std::mutex                        m_entryLock;
+
+    std::unordered_map<
+      DxvkShaderCacheKey, size_t,
+      DxvkHash, DxvkEq>               m_entryMap;
+
+    std::unordered_set<
+      DxvkShaderCacheKey,
+      DxvkHash, DxvkEq>               m_entrySet;
+
+    std::mutex                        m_writerLock;
+    std::condition_variable           m_writerCond;
+    std::queue<WriterItem>            m_writerQueue;
+    bool                              m_writerStop = false;
+    dxvk::thread                      m_writerThread;
+
+    bool readCacheFile();
+
+    size_t indexCacheFile();
+
+    void rewriteCacheFile(
+            size_t                      validSize);
+
+    Rc<DxvkShader> readCacheEntry(
+            size_t                      offset);
+
+    void writeCacheEntry(
+            std::ostream&               stream,
+      const WriterItem&                 item);
+
+    void writerFunc();
+
+    std::string getCacheFileName() const;
+
+    std::string getCacheDir() const;
+
+    static Sha1Hash getVersionHash();
+
+  };
+
+}
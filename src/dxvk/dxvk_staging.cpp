@@ -67,4 +67,111 @@ namespace dxvk {
       VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
   }
   
+
+
+  DxvkUploadRing::DxvkUploadRing(const Rc<DxvkDevice>& device)
+  : m_device(device) {
+
+  }
+
+
+  DxvkUploadRing::~DxvkUploadRing() {
+
+  }
+
+
+  DxvkBufferSlice DxvkUploadRing::alloc(VkDeviceSize align, VkDeviceSize size) {
+    if (size > ChunkSize)
+      return DxvkBufferSlice(createBuffer(size));
+
+    uint64_t state = m_state.load(std::memory_order_acquire);
+
+    while (true) {
+      // Texel sizes of three-component formats are not a power
+      // of two, so we cannot use the usual bit mask alignment
+      uint32_t     chunk  = uint32_t(state >> 48);
+      VkDeviceSize offset = state & OffsetMask;
+      offset += (align - offset % align) % align;
+
+      if (likely(chunk != InvalidChunk && offset + size <= ChunkSize)) {
+        uint64_t next = (state & ~OffsetMask) | (offset + size);
+
+        if (m_state.compare_exchange_weak(state, next,
+            std::memory_order_acq_rel, std::memory_order_acquire))
+          return DxvkBufferSlice(m_chunks[chunk], offset, size);
+      } else {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // Another thread may have switched chunks already
+        if (m_state.load(std::memory_order_acquire) == state) {
+          uint32_t next = this->advance(chunk);
+
+          if (next == InvalidChunk)
+            return DxvkBufferSlice(createBuffer(size));
+
+          m_state.store(uint64_t(next) << 48, std::memory_order_release);
+        }
+
+        state = m_state.load(std::memory_order_acquire);
+      }
+    }
+  }
+
+
+  std::vector<Rc<DxvkBuffer>> DxvkUploadRing::takeRetiredChunks() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::vector<Rc<DxvkBuffer>> result;
+    result.swap(m_retired);
+
+    m_retiredCount.store(0, std::memory_order_release);
+    return result;
+  }
+
+
+  uint32_t DxvkUploadRing::advance(uint32_t chunk) {
+    uint32_t next = InvalidChunk;
+
+    // Pick the next chunk in ring order that is no
+    // longer in use, or create one if there is none
+    uint32_t first = chunk != InvalidChunk ? chunk + 1 : 0;
+
+    for (uint32_t i = 0; i < m_chunkCount && next == InvalidChunk; i++) {
+      uint32_t index = (first + i) % m_chunkCount;
+
+      if (index != chunk && !m_chunks[index]->isInUse())
+        next = index;
+    }
+
+    if (next == InvalidChunk) {
+      if (m_chunkCount == MaxChunkCount)
+        return InvalidChunk;
+
+      next = m_chunkCount++;
+      m_chunks[next] = createBuffer(ChunkSize);
+    }
+
+    m_chunks[next]->acquire(DxvkAccess::Read);
+
+    if (chunk != InvalidChunk) {
+      m_retired.push_back(m_chunks[chunk]);
+      m_retiredCount.store(m_retired.size(), std::memory_order_release);
+    }
+
+    return next;
+  }
+
+
+  Rc<DxvkBuffer> DxvkUploadRing::createBuffer(VkDeviceSize size) {
+    DxvkBufferCreateInfo info;
+    info.size   = size;
+    info.usage  = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    info.stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    info.access = VK_ACCESS_TRANSFER_READ_BIT;
+
+    return m_device->createBuffer(info,
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+      VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  }
+  
 }
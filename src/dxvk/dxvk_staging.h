@@ -1,6 +1,10 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <mutex>
 #include <queue>
+#include <vector>
 
 #include "dxvk_buffer.h"
 
@@ -53,4 +57,84 @@ namespace dxvk {
 
   };
   
+
+
+  /**
+   * \brief Upload ring
+   *
+   * Persistently mapped ring of staging buffer chunks
+   * that the application thread can write upload data
+   * to directly. Allocations from the current chunk are
+   * made with a single atomic operation, only switching
+   * to another chunk takes a lock.
+   *
+   * The ring holds a use on the current chunk. Once a
+   * chunk is retired, the owner must release that use
+   * after all commands reading from the chunk have been
+   * recorded, see \ref takeRetiredChunks. The chunk can
+   * then be reused as soon as all command lists that
+   * accessed it have completed execution.
+   */
+  class DxvkUploadRing : public RcObject {
+    constexpr static VkDeviceSize ChunkSize     = 1 << 22; // 4 MiB
+    constexpr static uint32_t     MaxChunkCount = 16;
+    constexpr static uint32_t     InvalidChunk  = 0xFFFF;
+    constexpr static uint64_t     OffsetMask    = (1ull << 48) - 1;
+  public:
+
+    DxvkUploadRing(const Rc<DxvkDevice>& device);
+
+    ~DxvkUploadRing();
+
+    /**
+     * \brief Allocates a staging buffer slice
+     *
+     * The returned slice is mapped and can be written
+     * to immediately. Allocations larger than a chunk,
+     * or made while all chunks are in use, get their
+     * own buffer which is freed once no longer used.
+     * \param [in] align Alignment of the allocation,
+     *    which does not need to be a power of two
+     * \param [in] size Size of the allocation
+     * \returns Staging buffer slice
+     */
+    DxvkBufferSlice alloc(VkDeviceSize align, VkDeviceSize size);
+
+    /**
+     * \brief Checks for retired chunks
+     * \returns \c true if any chunks have been retired
+     */
+    bool hasRetiredChunks() const {
+      return m_retiredCount.load(std::memory_order_acquire) != 0;
+    }
+
+    /**
+     * \brief Retrieves retired chunks
+     *
+     * The caller must call \c release on each returned
+     * chunk once all commands that read from the chunk
+     * have been recorded into a command list.
+     * \returns Chunks retired since the last call
+     */
+    std::vector<Rc<DxvkBuffer>> takeRetiredChunks();
+
+  private:
+
+    Rc<DxvkDevice>          m_device;
+
+    std::mutex              m_mutex;
+    std::atomic<uint64_t>   m_state = { uint64_t(InvalidChunk) << 48 };
+
+    std::array<Rc<DxvkBuffer>, MaxChunkCount> m_chunks;
+    uint32_t                m_chunkCount = 0;
+
+    std::vector<Rc<DxvkBuffer>> m_retired;
+    std::atomic<uint32_t>   m_retiredCount = { 0u };
+
+    uint32_t advance(uint32_t chunk);
+
+    Rc<DxvkBuffer> createBuffer(VkDeviceSize size);
+
+  };
+  
 }
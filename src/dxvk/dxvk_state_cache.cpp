@@ -7,20 +7,6 @@ namespace dxvk {
   static const Sha1Hash       g_nullHash      = Sha1Hash::compute(nullptr, 0);
   static const DxvkShaderKey  g_nullShaderKey = DxvkShaderKey();
 
-  template<typename T>
-  bool readCacheEntryTyped(std::istream& stream, T& entry) {
-    auto data = reinterpret_cast<char*>(&entry);
-    auto size = sizeof(entry);
-
-    if (!stream.read(data, size))
-      return false;
-    
-    Sha1Hash expectedHash = std::exchange(entry.hash, g_nullHash);
-    Sha1Hash computedHash = Sha1Hash::compute(entry);
-    return expectedHash == computedHash;
-  }
-
-
   bool DxvkStateCacheKey::eq(const DxvkStateCacheKey& key) const {
     return this->vs.eq(key.vs)
         && this->tcs.eq(key.tcs)
@@ -49,58 +35,23 @@ namespace dxvk {
           DxvkRenderPassPool*   passManager)
   : m_pipeManager(pipeManager),
     m_passManager(passManager) {
-    bool newFile = !readCacheFile();
-
-    if (newFile) {
+    if (!readCacheFile()) {
       Logger::warn("DXVK: Creating new state cache file");
 
-      // Start with an empty file
-      std::ofstream file(getCacheFileName(),
-        std::ios_base::binary |
-        std::ios_base::trunc);
+      m_file.close();
+      m_entries.clear();
+      m_entryMap.clear();
+      m_pipelineMap.clear();
 
-      if (!file && env::createDirectory(getCacheDir())) {
-        file = std::ofstream(getCacheFileName(),
-          std::ios_base::binary |
-          std::ios_base::trunc);
-      }
-
-      // Write header with the current version number
-      DxvkStateCacheHeader header;
-
-      auto data = reinterpret_cast<const char*>(&header);
-      auto size = sizeof(header);
-
-      file.write(data, size);
-
-      // Write all valid entries to the cache file in
-      // case we're recovering a corrupted cache file
-      for (auto& e : m_entries)
-        writeCacheEntry(file, e);
+      createCacheFile({ });
     }
 
-    // Use half the available CPU cores for pipeline compilation
-    uint32_t numCpuCores = dxvk::thread::hardware_concurrency();
-    uint32_t numWorkers  = numCpuCores > 8
-      ? numCpuCores * 3 / 4
-      : numCpuCores * 1 / 2;
-
-    if (numWorkers <  1) numWorkers =  1;
-    if (numWorkers > 16) numWorkers = 16;
-
-    if (device->config().numCompilerThreads > 0)
-      numWorkers = device->config().numCompilerThreads;
-    
-    Logger::info(str::format("DXVK: Using ", numWorkers, " compiler threads"));
-    
-    // Start the worker threads and the file writer
-    m_workerBusy.store(numWorkers);
+    // Pipelines are compiled by the pipeline compiler, the
+    // worker thread only looks up shaders and state vectors
+    m_workerBusy.store(1);
+    m_workerThread = dxvk::thread([this] () { workerFunc(); });
+    m_workerThread.set_priority(ThreadPriority::Lowest);
 
-    for (uint32_t i = 0; i < numWorkers; i++) {
-      m_workerThreads.emplace_back([this] () { workerFunc(); });
-      m_workerThreads[i].set_priority(ThreadPriority::Lowest);
-    }
-    
     m_writerThread = dxvk::thread([this] () { writerFunc(); });
   }
   
@@ -115,8 +66,7 @@ namespace dxvk {
       m_writerCond.notify_all();
     }
 
-    for (auto& worker : m_workerThreads)
-      worker.join();
+    m_workerThread.join();
     
     m_writerThread.join();
   }
@@ -130,10 +80,26 @@ namespace dxvk {
       return;
     
     // Do not add an entry that is already in the cache
+    DxvkStateCacheEntryRange range = m_file.findEntries(shaders);
+
+    for (uint32_t i = 0; i < range.count; i++) {
+      DxvkStateCacheEntry entry;
+
+      if (!m_file.readIndexedEntry(range.first + i, entry))
+        continue;
+
+      // Entries may have been written before normalization
+      entry.gpState.normalize(entry.format);
+
+      if (entry.format.eq(format) && entry.gpState == state)
+        return;
+    }
+
     auto entries = m_entryMap.equal_range(shaders);
 
     for (auto e = entries.first; e != entries.second; e++) {
-      const DxvkStateCacheEntry& entry = m_entries[e->second];
+      DxvkStateCacheEntry entry = m_entries[e->second];
+      entry.gpState.normalize(entry.format);
 
       if (entry.format.eq(format) && entry.gpState == state)
         return;
@@ -156,6 +122,16 @@ namespace dxvk {
       return;
 
     // Do not add an entry that is already in the cache
+    DxvkStateCacheEntryRange range = m_file.findEntries(shaders);
+
+    for (uint32_t i = 0; i < range.count; i++) {
+      DxvkStateCacheEntry entry;
+
+      if (m_file.readIndexedEntry(range.first + i, entry)
+       && entry.cpState == state)
+        return;
+    }
+
     auto entries = m_entryMap.equal_range(shaders);
 
     for (auto e = entries.first; e != entries.second; e++) {
@@ -186,24 +162,29 @@ namespace dxvk {
     // Deferred lock, don't stall workers unless we have to
     std::unique_lock<std::mutex> workerLock;
 
-    auto pipelines = m_pipelineMap.equal_range(key);
-
-    for (auto p = pipelines.first; p != pipelines.second; p++) {
+    auto queuePipeline = [&] (const DxvkStateCacheKey& pipeline) {
       WorkerItem item;
 
-      if (!getShaderByKey(p->second.vs,  item.gp.vs)
-       || !getShaderByKey(p->second.tcs, item.gp.tcs)
-       || !getShaderByKey(p->second.tes, item.gp.tes)
-       || !getShaderByKey(p->second.gs,  item.gp.gs)
-       || !getShaderByKey(p->second.fs,  item.gp.fs)
-       || !getShaderByKey(p->second.cs,  item.cp.cs))
-        continue;
+      if (!getShaderByKey(pipeline.vs,  item.gp.vs)
+       || !getShaderByKey(pipeline.tcs, item.gp.tcs)
+       || !getShaderByKey(pipeline.tes, item.gp.tes)
+       || !getShaderByKey(pipeline.gs,  item.gp.gs)
+       || !getShaderByKey(pipeline.fs,  item.gp.fs)
+       || !getShaderByKey(pipeline.cs,  item.cp.cs))
+        return;
       
       if (!workerLock)
         workerLock = std::unique_lock<std::mutex>(m_workerLock);
       
       m_workerQueue.push(item);
-    }
+    };
+
+    m_file.findPipelines(key, queuePipeline);
+
+    auto pipelines = m_pipelineMap.equal_range(key);
+
+    for (auto p = pipelines.first; p != pipelines.second; p++)
+      queuePipeline(p->second);
 
     if (workerLock)
       m_workerCond.notify_all();
@@ -254,256 +235,127 @@ namespace dxvk {
     key.fs  = getShaderKey(item.gp.fs);
     key.cs  = getShaderKey(item.cp.cs);
 
+    // Indexed entries are only validated at this point
+    std::vector<DxvkStateCacheEntry> indexedEntries;
+
+    DxvkStateCacheEntryRange range = m_file.findEntries(key);
+
+    for (uint32_t i = 0; i < range.count; i++) {
+      DxvkStateCacheEntry entry;
+
+      if (m_file.readIndexedEntry(range.first + i, entry))
+        indexedEntries.push_back(entry);
+      else
+        Logger::warn("DXVK: Skipping invalid state cache entry");
+    }
+
+    auto& compiler = m_pipeManager->m_compiler;
+    auto priority = DxvkPipelinePriority::Prefetch;
+
     if (item.cp.cs == nullptr) {
       auto pipeline = m_pipeManager->createGraphicsPipeline(item.gp);
       auto entries = m_entryMap.equal_range(key);
 
-      for (auto e = entries.first; e != entries.second; e++) {
-        const auto& entry = m_entries[e->second];
+      for (auto e = entries.first; e != entries.second; e++)
+        indexedEntries.push_back(m_entries[e->second]);
+
+      // State vectors that only differ in state which does not
+      // affect rendering result in the same pipeline, so there
+      // is no need to queue them for compilation more than once
+      std::vector<DxvkStateCacheEntry> uniqueEntries;
+
+      for (auto entry : indexedEntries) {
+        entry.gpState.normalize(entry.format);
+
+        bool isUnique = std::find_if(uniqueEntries.begin(), uniqueEntries.end(),
+          [&entry] (const DxvkStateCacheEntry& e) {
+            return e.format.eq(entry.format) && e.gpState == entry.gpState;
+          }) == uniqueEntries.end();
+
+        if (isUnique)
+          uniqueEntries.push_back(entry);
+      }
 
+      for (const auto& entry : uniqueEntries) {
         auto rp = m_passManager->getRenderPass(entry.format);
-        pipeline->compilePipeline(entry.gpState, rp);
+        compiler->queueCompilation(pipeline, entry.gpState, rp, priority);
       }
+
+      m_graphicsEntryCount  += indexedEntries.size();
+      m_graphicsUniqueCount += uniqueEntries.size();
     } else {
       auto pipeline = m_pipeManager->createComputePipeline(item.cp);
       auto entries = m_entryMap.equal_range(key);
 
+      for (const auto& entry : indexedEntries)
+        compiler->queueCompilation(pipeline, entry.cpState, priority);
+
       for (auto e = entries.first; e != entries.second; e++) {
         const auto& entry = m_entries[e->second];
-        pipeline->compilePipeline(entry.cpState);
+        compiler->queueCompilation(pipeline, entry.cpState, priority);
       }
     }
   }
 
 
   bool DxvkStateCache::readCacheFile() {
-    // Open state file and just fail if it doesn't exist
-    std::ifstream ifile(getCacheFileName(), std::ios_base::binary);
-
-    if (!ifile) {
-      Logger::warn("DXVK: No state cache file found");
-      return false;
-    }
-
-    // The header stores the state cache version,
-    // we need to regenerate it if it's outdated
-    DxvkStateCacheHeader newHeader;
-    DxvkStateCacheHeader curHeader;
-
-    if (!readCacheHeader(ifile, curHeader)) {
-      Logger::warn("DXVK: Failed to read state cache header");
+    if (!m_file.open(getCacheFileName()))
       return false;
-    }
 
-    // Struct size hasn't changed between v2 and v4
-    size_t expectedSize = newHeader.entrySize;
+    // Rewrite the file if it uses an outdated format or
+    // if it contains many entries that are not indexed,
+    // so that the next run can benefit from the index
+    if (m_file.needsCompaction()) {
+      Logger::info("DXVK: Compacting state cache file");
 
-    if (curHeader.version <= 4)
-      expectedSize = sizeof(DxvkStateCacheEntryV4);
-    else if (curHeader.version <= 5)
-      expectedSize = sizeof(DxvkStateCacheEntryV5);
+      std::vector<DxvkStateCacheEntry> entries = m_file.readAllEntries();
+      m_file.close();
 
-    if (curHeader.entrySize != expectedSize) {
-      Logger::warn("DXVK: State cache entry size changed");
-      return false;
+      if (!createCacheFile(entries) || !m_file.open(getCacheFileName()))
+        return false;
     }
 
-    // Discard caches of unsupported versions
-    if (curHeader.version < 2 || curHeader.version > newHeader.version) {
-      Logger::warn("DXVK: State cache version not supported");
-      return false;
-    }
+    // Entries that were appended to the file after the
+    // index was built need to be looked up in memory
+    for (const auto& entry : m_file.unindexedEntries()) {
+      bool isNewPipeline = m_entryMap.find(entry.shaders) == m_entryMap.end()
+                        && m_file.findEntries(entry.shaders).count == 0;
 
-    // Notify user about format conversion
-    if (curHeader.version != newHeader.version)
-      Logger::warn(str::format("DXVK: Updating state cache version to v", newHeader.version));
+      size_t entryId = m_entries.size();
+      m_entries.push_back(entry);
 
-    // Read actual cache entries from the file.
-    // If we encounter invalid entries, we should
-    // regenerate the entire state cache file.
-    uint32_t numInvalidEntries = 0;
-
-    while (ifile) {
-      DxvkStateCacheEntry entry;
-
-      if (readCacheEntry(curHeader.version, ifile, entry)) {
-        size_t entryId = m_entries.size();
-        m_entries.push_back(entry);
-
-        mapPipelineToEntry(entry.shaders, entryId);
+      mapPipelineToEntry(entry.shaders, entryId);
 
+      if (isNewPipeline) {
         mapShaderToPipeline(entry.shaders.vs,  entry.shaders);
         mapShaderToPipeline(entry.shaders.tcs, entry.shaders);
         mapShaderToPipeline(entry.shaders.tes, entry.shaders);
         mapShaderToPipeline(entry.shaders.gs,  entry.shaders);
         mapShaderToPipeline(entry.shaders.fs,  entry.shaders);
         mapShaderToPipeline(entry.shaders.cs,  entry.shaders);
-      } else if (ifile) {
-        numInvalidEntries += 1;
       }
     }
 
-    Logger::info(str::format(
-      "DXVK: Read ", m_entries.size(),
-      " valid state cache entries"));
-
-    if (numInvalidEntries) {
-      Logger::warn(str::format(
-        "DXVK: Skipped ", numInvalidEntries,
-        " invalid state cache entries"));
-      return false;
-    }
-    
-    // Rewrite entire state cache if it is outdated
-    return curHeader.version == newHeader.version;
-  }
-
-
-  bool DxvkStateCache::readCacheHeader(
-          std::istream&             stream,
-          DxvkStateCacheHeader&     header) const {
-    DxvkStateCacheHeader expected;
-
-    auto data = reinterpret_cast<char*>(&header);
-    auto size = sizeof(header);
-
-    if (!stream.read(data, size))
-      return false;
-    
-    for (uint32_t i = 0; i < 4; i++) {
-      if (expected.magic[i] != header.magic[i])
-        return false;
-    }
-    
     return true;
   }
 
 
-  bool DxvkStateCache::readCacheEntry(
-          uint32_t                  version,
-          std::istream&             stream, 
-          DxvkStateCacheEntry&      entry) const {
-    if (version <= 4) {
-      DxvkStateCacheEntryV4 v4;
+  bool DxvkStateCache::createCacheFile(
+    const std::vector<DxvkStateCacheEntry>& entries) {
+    bool success = DxvkStateCacheFile::writeFile(getCacheFileName(), entries);
 
-      if (!readCacheEntryTyped(stream, v4))
-        return false;
-      
-      if (version == 2)
-        convertEntryV2(v4);
-      
-      return convertEntryV4(v4, entry);
-    } else if (version <= 5) {
-      DxvkStateCacheEntryV5 v5;
+    if (!success && env::createDirectory(getCacheDir()))
+      success = DxvkStateCacheFile::writeFile(getCacheFileName(), entries);
 
-      if (!readCacheEntryTyped(stream, v5))
-        return false;
+    if (!success)
+      Logger::err("DXVK: Failed to write state cache file");
 
-      return convertEntryV5(v5, entry);
-    } else {
-      return readCacheEntryTyped(stream, entry);
-    }
-  }
-
-
-  void DxvkStateCache::writeCacheEntry(
-          std::ostream&             stream, 
-          DxvkStateCacheEntry&      entry) const {
-    entry.hash = Sha1Hash::compute(entry);
-
-    auto data = reinterpret_cast<const char*>(&entry);
-    auto size = sizeof(DxvkStateCacheEntry);
-
-    stream.write(data, size);
-    stream.flush();
-  }
-
-
-  bool DxvkStateCache::convertEntryV2(
-          DxvkStateCacheEntryV4&    entry) const {
-    // Semantics changed:
-    // v2: rsDepthClampEnable
-    // v3: rsDepthClipEnable
-    entry.gpState.rsDepthClipEnable = !entry.gpState.rsDepthClipEnable;
-
-    // Frontend changed: Depth bias
-    // will typically be disabled
-    entry.gpState.rsDepthBiasEnable = VK_FALSE;
-    return true;
-  }
-
-
-  bool DxvkStateCache::convertEntryV4(
-    const DxvkStateCacheEntryV4&    in,
-          DxvkStateCacheEntry&      out) const {
-    out.shaders = in.shaders;
-    out.format  = in.format;
-    out.hash    = in.hash;
-
-    out.cpState.bsBindingMask           = in.cpState.bsBindingMask;
-    out.gpState.bsBindingMask           = in.gpState.bsBindingMask;
-    
-    out.gpState.iaPrimitiveTopology     = in.gpState.iaPrimitiveTopology;
-    out.gpState.iaPrimitiveRestart      = in.gpState.iaPrimitiveRestart;
-    out.gpState.iaPatchVertexCount      = in.gpState.iaPatchVertexCount;
-    
-    out.gpState.ilAttributeCount        = in.gpState.ilAttributeCount;
-    out.gpState.ilBindingCount          = in.gpState.ilBindingCount;
-
-    for (uint32_t i = 0; i < in.gpState.ilAttributeCount; i++)
-      out.gpState.ilAttributes[i]       = in.gpState.ilAttributes[i];
-
-    for (uint32_t i = 0; i < in.gpState.ilBindingCount; i++) {
-      out.gpState.ilBindings[i]         = in.gpState.ilBindings[i];
-      out.gpState.ilDivisors[i]         = in.gpState.ilDivisors[i];
-    }
-    
-    out.gpState.rsDepthClipEnable       = in.gpState.rsDepthClipEnable;
-    out.gpState.rsDepthBiasEnable       = in.gpState.rsDepthBiasEnable;
-    out.gpState.rsPolygonMode           = in.gpState.rsPolygonMode;
-    out.gpState.rsCullMode              = in.gpState.rsCullMode;
-    out.gpState.rsFrontFace             = in.gpState.rsFrontFace;
-    out.gpState.rsViewportCount         = in.gpState.rsViewportCount;
-    out.gpState.rsSampleCount           = in.gpState.rsSampleCount;
-    
-    out.gpState.msSampleCount           = in.gpState.msSampleCount;
-    out.gpState.msSampleMask            = in.gpState.msSampleMask;
-    out.gpState.msEnableAlphaToCoverage = in.gpState.msEnableAlphaToCoverage;
-    
-    out.gpState.dsEnableDepthTest       = in.gpState.dsEnableDepthTest;
-    out.gpState.dsEnableDepthWrite      = in.gpState.dsEnableDepthWrite;
-    out.gpState.dsEnableStencilTest     = in.gpState.dsEnableStencilTest;
-    out.gpState.dsDepthCompareOp        = in.gpState.dsDepthCompareOp;
-    out.gpState.dsStencilOpFront        = in.gpState.dsStencilOpFront;
-    out.gpState.dsStencilOpBack         = in.gpState.dsStencilOpBack;
-    
-    out.gpState.omEnableLogicOp         = in.gpState.omEnableLogicOp;
-    out.gpState.omLogicOp               = in.gpState.omLogicOp;
-
-    for (uint32_t i = 0; i < MaxNumRenderTargets; i++) {
-      out.gpState.omBlendAttachments[i] = in.gpState.omBlendAttachments[i];
-      out.gpState.omComponentMapping[i] = in.gpState.omComponentMapping[i];
-    }
-
-    return true;
-  }
-
-
-  bool DxvkStateCache::convertEntryV5(
-    const DxvkStateCacheEntryV5&    in,
-          DxvkStateCacheEntry&      out) const {
-    out.shaders = in.shaders;
-    out.gpState = in.gpState;
-    out.format  = in.format;
-    out.hash    = in.hash;
-
-    out.cpState.bsBindingMask = in.cpState.bsBindingMask;
-    return true;
+    return success;
   }
 
 
   void DxvkStateCache::workerFunc() {
-    env::setThreadName("dxvk-shader");
+    env::setThreadName("dxvk-state-cache");
 
     while (!m_stopThreads.load()) {
       WorkerItem item;
@@ -511,6 +363,8 @@ namespace dxvk {
       { std::unique_lock<std::mutex> lock(m_workerLock);
 
         if (m_workerQueue.empty()) {
+          reportPipelineCount();
+
           m_workerBusy -= 1;
           m_workerCond.wait(lock, [this] () {
             return m_workerQueue.size()
@@ -555,17 +409,29 @@ namespace dxvk {
         m_writerQueue.pop();
       }
 
-      if (!file) {
+      if (!file.is_open()) {
         file = std::ofstream(getCacheFileName(),
           std::ios_base::binary |
           std::ios_base::app);
       }
 
-      writeCacheEntry(file, entry);
+      DxvkStateCacheFile::writeEntry(file, entry);
     }
   }
 
 
+  void DxvkStateCache::reportPipelineCount() {
+    if (m_graphicsEntryCount == m_graphicsReportedCount)
+      return;
+
+    Logger::info(str::format("DXVK: Found ", m_graphicsEntryCount,
+      " graphics pipelines in state cache, ", m_graphicsUniqueCount,
+      " unique after normalization"));
+
+    m_graphicsReportedCount = m_graphicsEntryCount;
+  }
+
+
   std::string DxvkStateCache::getCacheFileName() const {
     std::string path = getCacheDir();
 
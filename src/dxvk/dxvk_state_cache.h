@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
 #include <fstream>
@@ -8,7 +9,7 @@
 #include <unordered_map>
 #include <vector>
 
-#include "dxvk_state_cache_types.h"
+#include "dxvk_state_cache_file.h"
 
 namespace dxvk {
 
@@ -72,8 +73,12 @@ namespace dxvk {
       const Rc<DxvkShader>&                 shader);
     
     /**
-     * \brief Checks whether compiler threads are busy
-     * \returns \c true if we're compiling shaders
+     * \brief Checks whether the worker is busy
+     * 
+     * Pipelines found in the cache are passed on to
+     * the pipeline compiler, so this only indicates
+     * that more pipelines may be queued soon.
+     * \returns \c true if we're processing shaders
      */
     bool isCompilingShaders() {
       return m_workerBusy.load() > 0;
@@ -91,6 +96,7 @@ namespace dxvk {
     DxvkPipelineManager*              m_pipeManager;
     DxvkRenderPassPool*               m_passManager;
 
+    DxvkStateCacheFile                m_file;
     std::vector<DxvkStateCacheEntry>  m_entries;
     std::atomic<bool>                 m_stopThreads = { false };
 
@@ -112,7 +118,11 @@ namespace dxvk {
     std::condition_variable           m_workerCond;
     std::queue<WorkerItem>            m_workerQueue;
     std::atomic<uint32_t>             m_workerBusy;
-    std::vector<dxvk::thread>         m_workerThreads;
+    dxvk::thread                      m_workerThread;
+
+    size_t                            m_graphicsEntryCount    = 0;
+    size_t                            m_graphicsUniqueCount   = 0;
+    size_t                            m_graphicsReportedCount = 0;
 
     std::mutex                        m_writerLock;
     std::condition_variable           m_writerCond;
@@ -137,32 +147,13 @@ namespace dxvk {
     void compilePipelines(
       const WorkerItem&               item);
 
+    void reportPipelineCount();
+
     bool readCacheFile();
 
-    bool readCacheHeader(
-            std::istream&             stream,
-            DxvkStateCacheHeader&     header) const;
+    bool createCacheFile(
+      const std::vector<DxvkStateCacheEntry>& entries);
 
-    bool readCacheEntry(
-            uint32_t                  version,
-            std::istream&             stream, 
-            DxvkStateCacheEntry&      entry) const;
-    
-    void writeCacheEntry(
-            std::ostream&             stream, 
-            DxvkStateCacheEntry&      entry) const;
-    
-    bool convertEntryV2(
-            DxvkStateCacheEntryV4&    entry) const;
-    
-    bool convertEntryV4(
-      const DxvkStateCacheEntryV4&    in,
-            DxvkStateCacheEntry&      out) const;
-    
-    bool convertEntryV5(
-      const DxvkStateCacheEntryV5&    in,
-            DxvkStateCacheEntry&      out) const;
-    
     void workerFunc();
 
     void writerFunc();
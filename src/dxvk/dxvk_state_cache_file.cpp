@@ -0,0 +1,655 @@
+#include <fstream>
+#include <unordered_map>
+
+#include "dxvk_state_cache_file.h"
+
+namespace dxvk {
+
+  static const Sha1Hash       g_nullHash      = Sha1Hash::compute(nullptr, 0);
+  static const DxvkShaderKey  g_nullShaderKey = DxvkShaderKey();
+
+  // Maximum number of entries that can be appended to an
+  // indexed file before the file gets rewritten on startup
+  constexpr size_t MaxUnindexedEntries = 1024;
+
+  template<typename T>
+  bool readCacheEntryTyped(const char* data, T& entry) {
+    std::memcpy(static_cast<void*>(&entry), data, sizeof(entry));
+
+    Sha1Hash expectedHash = std::exchange(entry.hash, g_nullHash);
+    Sha1Hash computedHash = Sha1Hash::compute(entry);
+    return expectedHash == computedHash;
+  }
+
+
+  DxvkStateCacheFile::DxvkStateCacheFile() {
+
+  }
+
+
+  DxvkStateCacheFile::~DxvkStateCacheFile() {
+
+  }
+
+
+  bool DxvkStateCacheFile::open(const std::string& path) {
+    close();
+
+    if (!m_file.open(path)) {
+      Logger::warn("DXVK: No state cache file found");
+      return false;
+    }
+
+    // The header stores the state cache version,
+    // we need to regenerate it if it's outdated
+    DxvkStateCacheHeader newHeader;
+    DxvkStateCacheHeader curHeader;
+
+    if (m_file.size() < sizeof(curHeader)) {
+      Logger::warn("DXVK: Failed to read state cache header");
+      return false;
+    }
+
+    std::memcpy(&curHeader, m_file.data(), sizeof(curHeader));
+
+    for (uint32_t i = 0; i < 4; i++) {
+      if (curHeader.magic[i] != newHeader.magic[i]) {
+        Logger::warn("DXVK: Failed to read state cache header");
+        return false;
+      }
+    }
+
+    // Struct size hasn't changed between v2 and v4
+    size_t expectedSize = newHeader.entrySize;
+
+    if (curHeader.version <= 4)
+      expectedSize = sizeof(DxvkStateCacheEntryV4);
+    else if (curHeader.version <= 5)
+      expectedSize = sizeof(DxvkStateCacheEntryV5);
+
+    if (curHeader.entrySize != expectedSize) {
+      Logger::warn("DXVK: State cache entry size changed");
+      return false;
+    }
+
+    // Discard caches of unsupported versions
+    if (curHeader.version < 2 || curHeader.version > newHeader.version) {
+      Logger::warn("DXVK: State cache version not supported");
+      return false;
+    }
+
+    // Notify user about format conversion
+    if (curHeader.version != newHeader.version)
+      Logger::warn(str::format("DXVK: Updating state cache version to v", newHeader.version));
+
+    m_version = curHeader.version;
+
+    size_t offset = sizeof(curHeader);
+
+    if (m_version >= 7) {
+      size_t indexOffset = offset;
+
+      if (!readIndex(offset)) {
+        // Entries carry their own checksums, so we can still
+        // read them as unindexed entries and rebuild the index
+        Logger::warn("DXVK: Failed to read state cache index, rebuilding");
+
+        resetIndex();
+        m_invalidIndex = true;
+
+        // If only the contents of the index are corrupted, the
+        // offset points to the start of the indexed entries, and
+        // all entries, including those appended later, follow.
+        // Otherwise, look for the first entry with a valid checksum.
+        DxvkStateCacheEntry entry;
+
+        if (offset + expectedSize > m_file.size()
+         || !readEntry(m_file.data() + offset, entry))
+          offset = findFirstEntry(indexOffset, expectedSize);
+      }
+    }
+
+    readUnindexedEntries(offset, expectedSize);
+
+    Logger::info(str::format(
+      "DXVK: Read ", m_index.entryCount, " indexed and ",
+      m_unindexedEntries.size(), " unindexed state cache entries"));
+
+    if (m_invalidEntries) {
+      Logger::warn(str::format(
+        "DXVK: Skipped ", m_invalidEntries,
+        " invalid state cache entries"));
+    }
+
+    return true;
+  }
+
+
+  void DxvkStateCacheFile::close() {
+    m_file.close();
+    m_version = 0;
+
+    resetIndex();
+
+    m_unindexedEntries.clear();
+    m_invalidEntries = 0;
+    m_invalidIndex   = false;
+  }
+
+
+  bool DxvkStateCacheFile::needsCompaction() const {
+    return m_version != DxvkStateCacheHeader().version
+        || m_invalidEntries != 0
+        || m_invalidIndex
+        || m_unindexedEntries.size() > MaxUnindexedEntries;
+  }
+
+
+  bool DxvkStateCacheFile::readIndexedEntry(
+          uint32_t                  index,
+          DxvkStateCacheEntry&      entry) const {
+    return readCacheEntryTyped(reinterpret_cast<const char*>(&m_entries[index]), entry);
+  }
+
+
+  DxvkStateCacheEntryRange DxvkStateCacheFile::findEntries(
+    const DxvkStateCacheKey&        key) const {
+    DxvkStateCacheEntryRange result;
+
+    if (!m_index.pipelineBucketCount)
+      return result;
+
+    uint32_t keyHash = computeKeyHash(&key, sizeof(key));
+    uint32_t mask    = m_index.pipelineBucketCount - 1;
+
+    for (uint32_t i = 0; i < m_index.pipelineBucketCount; i++) {
+      const auto& bucket = m_pipelineBuckets[(keyHash + i) & mask];
+
+      if (!bucket.entryCount)
+        break;
+
+      if (bucket.keyHash == keyHash && m_entries[bucket.entryIndex].shaders.eq(key)) {
+        result.first = bucket.entryIndex;
+        result.count = bucket.entryCount;
+        break;
+      }
+    }
+
+    return result;
+  }
+
+
+  std::vector<DxvkStateCacheEntry> DxvkStateCacheFile::readAllEntries() const {
+    std::vector<DxvkStateCacheEntry> result;
+    result.reserve(m_index.entryCount + m_unindexedEntries.size());
+
+    uint32_t numInvalidEntries = 0;
+
+    for (uint32_t i = 0; i < m_index.entryCount; i++) {
+      DxvkStateCacheEntry entry;
+
+      if (readIndexedEntry(i, entry))
+        result.push_back(entry);
+      else
+        numInvalidEntries += 1;
+    }
+
+    if (numInvalidEntries) {
+      Logger::warn(str::format(
+        "DXVK: Skipped ", numInvalidEntries,
+        " invalid indexed state cache entries"));
+    }
+
+    result.insert(result.end(),
+      m_unindexedEntries.begin(),
+      m_unindexedEntries.end());
+    return result;
+  }
+
+
+  bool DxvkStateCacheFile::writeFile(
+    const std::string&                      path,
+    const std::vector<DxvkStateCacheEntry>& entries) {
+    // Group entries by pipeline, in the order in which
+    // pipelines first appear, and drop duplicates
+    std::unordered_map<DxvkStateCacheKey, uint32_t, DxvkHash, DxvkEq> pipelineMap;
+    std::vector<std::vector<const DxvkStateCacheEntry*>> pipelines;
+
+    size_t entryCount = 0;
+
+    for (const auto& entry : entries) {
+      auto insert = pipelineMap.insert({ entry.shaders, uint32_t(pipelines.size()) });
+
+      if (insert.second)
+        pipelines.emplace_back();
+
+      auto& list = pipelines[insert.first->second];
+      bool duplicate = false;
+
+      for (auto e : list) {
+        duplicate = e->format.eq(entry.format)
+                 && e->gpState == entry.gpState
+                 && e->cpState == entry.cpState;
+
+        if (duplicate)
+          break;
+      }
+
+      if (!duplicate) {
+        list.push_back(&entry);
+        entryCount += 1;
+      }
+    }
+
+    // Build pipeline hash table, and gather the pipelines
+    // that use each shader while we're at it
+    DxvkStateCacheIndexHeader index = { };
+    index.entryCount          = entryCount;
+    index.pipelineBucketCount = computeBucketCount(pipelines.size());
+
+    std::vector<DxvkStateCachePipelineBucket> pipelineBuckets(index.pipelineBucketCount);
+    std::vector<DxvkShaderKey> shaderKeys;
+    std::unordered_map<DxvkShaderKey, std::vector<uint32_t>, DxvkHash, DxvkEq> shaderMap;
+
+    uint32_t entryIndex = 0;
+
+    for (const auto& list : pipelines) {
+      const DxvkStateCacheKey& key = list.front()->shaders;
+
+      uint32_t keyHash = computeKeyHash(&key, sizeof(key));
+      uint32_t mask    = index.pipelineBucketCount - 1;
+      uint32_t bucket  = keyHash & mask;
+
+      while (pipelineBuckets[bucket].entryCount)
+        bucket = (bucket + 1) & mask;
+
+      pipelineBuckets[bucket].keyHash    = keyHash;
+      pipelineBuckets[bucket].entryIndex = entryIndex;
+      pipelineBuckets[bucket].entryCount = list.size();
+
+      for (const auto& shader : { key.vs, key.tcs, key.tes, key.gs, key.fs, key.cs }) {
+        if (shader.eq(g_nullShaderKey))
+          continue;
+
+        auto& refs = shaderMap[shader];
+
+        if (refs.empty())
+          shaderKeys.push_back(shader);
+
+        refs.push_back(bucket);
+      }
+
+      entryIndex += list.size();
+    }
+
+    // Build shader hash table and the pipeline reference list
+    index.shaderBucketCount = computeBucketCount(shaderKeys.size());
+
+    std::vector<DxvkStateCacheShaderBucket> shaderBuckets(index.shaderBucketCount);
+    std::vector<uint32_t> shaderRefs;
+
+    for (const auto& shader : shaderKeys) {
+      const auto& refs = shaderMap[shader];
+
+      uint32_t keyHash = computeKeyHash(&shader, sizeof(shader));
+      uint32_t mask    = index.shaderBucketCount - 1;
+      uint32_t bucket  = keyHash & mask;
+
+      while (shaderBuckets[bucket].refCount)
+        bucket = (bucket + 1) & mask;
+
+      shaderBuckets[bucket].key      = shader;
+      shaderBuckets[bucket].keyHash  = keyHash;
+      shaderBuckets[bucket].refIndex = shaderRefs.size();
+      shaderBuckets[bucket].refCount = refs.size();
+
+      shaderRefs.insert(shaderRefs.end(), refs.begin(), refs.end());
+    }
+
+    index.shaderRefCount = shaderRefs.size();
+    index.hash           = g_nullHash;
+
+    std::array<Sha1Data, 4> chunks = {{
+      { &index,                 sizeof(index) },
+      { pipelineBuckets.data(), sizeof(DxvkStateCachePipelineBucket) * pipelineBuckets.size() },
+      { shaderBuckets.data(),   sizeof(DxvkStateCacheShaderBucket)   * shaderBuckets.size() },
+      { shaderRefs.data(),      sizeof(uint32_t)                     * shaderRefs.size() },
+    }};
+
+    index.hash = Sha1Hash::compute(chunks.size(), chunks.data());
+
+    // Write the actual file
+    std::ofstream file(path,
+      std::ios_base::binary |
+      std::ios_base::trunc);
+
+    if (!file)
+      return false;
+
+    DxvkStateCacheHeader header;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(&index),  sizeof(index));
+
+    for (uint32_t i = 1; i < chunks.size(); i++)
+      file.write(reinterpret_cast<const char*>(chunks[i].data), chunks[i].size);
+
+    for (const auto& list : pipelines) {
+      for (auto e : list) {
+        DxvkStateCacheEntry entry = *e;
+        writeEntry(file, entry);
+      }
+    }
+
+    return bool(file);
+  }
+
+
+  void DxvkStateCacheFile::writeEntry(
+          std::ostream&             stream,
+          DxvkStateCacheEntry&      entry) {
+    entry.hash = g_nullHash;
+    entry.hash = Sha1Hash::compute(entry);
+
+    auto data = reinterpret_cast<const char*>(&entry);
+    auto size = sizeof(DxvkStateCacheEntry);
+
+    stream.write(data, size);
+    stream.flush();
+  }
+
+
+  bool DxvkStateCacheFile::readIndex(
+          size_t&                   offset) {
+    if (offset + sizeof(m_index) > m_file.size())
+      return false;
+
+    std::memcpy(&m_index, m_file.data() + offset, sizeof(m_index));
+    offset += sizeof(m_index);
+
+    // Bucket counts must be powers of two
+    if ((m_index.pipelineBucketCount & (m_index.pipelineBucketCount - 1))
+     || (m_index.shaderBucketCount   & (m_index.shaderBucketCount   - 1)))
+      return false;
+
+    // Check the total size with 64-bit math first, so that
+    // corrupted counts cannot wrap around on 32-bit platforms
+    uint64_t indexSize = uint64_t(sizeof(DxvkStateCachePipelineBucket)) * m_index.pipelineBucketCount
+                       + uint64_t(sizeof(DxvkStateCacheShaderBucket))   * m_index.shaderBucketCount
+                       + uint64_t(sizeof(uint32_t))                     * m_index.shaderRefCount
+                       + uint64_t(sizeof(DxvkStateCacheEntry))          * m_index.entryCount;
+
+    if (uint64_t(offset) + indexSize > m_file.size())
+      return false;
+
+    size_t pipelineBucketSize = sizeof(DxvkStateCachePipelineBucket) * m_index.pipelineBucketCount;
+    size_t shaderBucketSize   = sizeof(DxvkStateCacheShaderBucket)   * m_index.shaderBucketCount;
+    size_t shaderRefSize      = sizeof(uint32_t)                     * m_index.shaderRefCount;
+    size_t entrySize          = sizeof(DxvkStateCacheEntry)          * m_index.entryCount;
+
+    // All structures are a multiple of four bytes in size,
+    // so we can access everything in place.
+    const char* data = m_file.data() + offset;
+
+    m_pipelineBuckets = reinterpret_cast<const DxvkStateCachePipelineBucket*>(data);
+    m_shaderBuckets   = reinterpret_cast<const DxvkStateCacheShaderBucket*>  (data + pipelineBucketSize);
+    m_shaderRefs      = reinterpret_cast<const uint32_t*>                    (data + pipelineBucketSize + shaderBucketSize);
+    m_entries         = reinterpret_cast<const DxvkStateCacheEntry*>         (data + pipelineBucketSize + shaderBucketSize + shaderRefSize);
+
+    // Leave the offset at the start of the entry table until
+    // the index is verified, so that the caller can read the
+    // entries as unindexed entries if verification fails
+    offset += pipelineBucketSize + shaderBucketSize + shaderRefSize;
+
+    // Verify the index, which is small compared to the
+    // entries, so that lookups can trust its contents
+    Sha1Hash expectedHash = std::exchange(m_index.hash, g_nullHash);
+
+    std::array<Sha1Data, 4> chunks = {{
+      { &m_index,         sizeof(m_index)    },
+      { m_pipelineBuckets, pipelineBucketSize },
+      { m_shaderBuckets,   shaderBucketSize   },
+      { m_shaderRefs,      shaderRefSize      },
+    }};
+
+    if (!(Sha1Hash::compute(chunks.size(), chunks.data()) == expectedHash))
+      return false;
+
+    for (uint32_t i = 0; i < m_index.pipelineBucketCount; i++) {
+      const auto& bucket = m_pipelineBuckets[i];
+
+      if (uint64_t(bucket.entryIndex) + bucket.entryCount > m_index.entryCount)
+        return false;
+    }
+
+    for (uint32_t i = 0; i < m_index.shaderBucketCount; i++) {
+      const auto& bucket = m_shaderBuckets[i];
+
+      if (uint64_t(bucket.refIndex) + bucket.refCount > m_index.shaderRefCount)
+        return false;
+    }
+
+    for (uint32_t i = 0; i < m_index.shaderRefCount; i++) {
+      if (m_shaderRefs[i] >= m_index.pipelineBucketCount)
+        return false;
+    }
+
+    offset += entrySize;
+    return true;
+  }
+
+
+  void DxvkStateCacheFile::resetIndex() {
+    m_index = DxvkStateCacheIndexHeader();
+
+    m_pipelineBuckets = nullptr;
+    m_shaderBuckets   = nullptr;
+    m_shaderRefs      = nullptr;
+    m_entries         = nullptr;
+  }
+
+
+  size_t DxvkStateCacheFile::findFirstEntry(
+          size_t                    offset,
+          size_t                    entrySize) const {
+    // All index structures are a multiple of four bytes
+    // in size, so entries start at a four-byte boundary
+    DxvkStateCacheEntry entry;
+
+    while (offset + entrySize <= m_file.size()) {
+      if (readEntry(m_file.data() + offset, entry))
+        return offset;
+
+      offset += sizeof(uint32_t);
+    }
+
+    return m_file.size();
+  }
+
+
+  void DxvkStateCacheFile::readUnindexedEntries(
+          size_t                    offset,
+          size_t                    entrySize) {
+    while (offset < m_file.size()) {
+      DxvkStateCacheEntry entry;
+
+      // A partially written entry at the end of
+      // the file counts as an invalid entry
+      if (offset + entrySize > m_file.size()) {
+        m_invalidEntries += 1;
+        break;
+      }
+
+      if (readEntry(m_file.data() + offset, entry))
+        m_unindexedEntries.push_back(entry);
+      else
+        m_invalidEntries += 1;
+
+      offset += entrySize;
+    }
+  }
+
+
+  const DxvkStateCacheShaderBucket* DxvkStateCacheFile::findShaderBucket(
+    const DxvkShaderKey&            key) const {
+    if (!m_index.shaderBucketCount)
+      return nullptr;
+
+    uint32_t keyHash = computeKeyHash(&key, sizeof(key));
+    uint32_t mask    = m_index.shaderBucketCount - 1;
+
+    for (uint32_t i = 0; i < m_index.shaderBucketCount; i++) {
+      const auto& bucket = m_shaderBuckets[(keyHash + i) & mask];
+
+      if (!bucket.refCount)
+        break;
+
+      if (bucket.keyHash == keyHash && bucket.key.eq(key))
+        return &bucket;
+    }
+
+    return nullptr;
+  }
+
+
+  bool DxvkStateCacheFile::readEntry(
+    const char*                     data,
+          DxvkStateCacheEntry&      entry) const {
+    if (m_version <= 4) {
+      DxvkStateCacheEntryV4 v4;
+
+      if (!readCacheEntryTyped(data, v4))
+        return false;
+
+      if (m_version == 2)
+        convertEntryV2(v4);
+
+      return convertEntryV4(v4, entry);
+    } else if (m_version <= 5) {
+      DxvkStateCacheEntryV5 v5;
+
+      if (!readCacheEntryTyped(data, v5))
+        return false;
+
+      return convertEntryV5(v5, entry);
+    } else {
+      return readCacheEntryTyped(data, entry);
+    }
+  }
+
+
+  bool DxvkStateCacheFile::convertEntryV2(
+          DxvkStateCacheEntryV4&    entry) {
+    // Semantics changed:
+    // v2: rsDepthClampEnable
+    // v3: rsDepthClipEnable
+    entry.gpState.rsDepthClipEnable = !entry.gpState.rsDepthClipEnable;
+
+    // Frontend changed: Depth bias
+    // will typically be disabled
+    entry.gpState.rsDepthBiasEnable = VK_FALSE;
+    return true;
+  }
+
+
+  bool DxvkStateCacheFile::convertEntryV4(
+    const DxvkStateCacheEntryV4&    in,
+          DxvkStateCacheEntry&      out) {
+    out.shaders = in.shaders;
+    out.format  = in.format;
+    out.hash    = in.hash;
+
+    out.cpState.bsBindingMask           = in.cpState.bsBindingMask;
+    out.gpState.bsBindingMask           = in.gpState.bsBindingMask;
+
+    out.gpState.iaPrimitiveTopology     = in.gpState.iaPrimitiveTopology;
+    out.gpState.iaPrimitiveRestart      = in.gpState.iaPrimitiveRestart;
+    out.gpState.iaPatchVertexCount      = in.gpState.iaPatchVertexCount;
+
+    out.gpState.ilAttributeCount        = in.gpState.ilAttributeCount;
+    out.gpState.ilBindingCount          = in.gpState.ilBindingCount;
+
+    for (uint32_t i = 0; i < in.gpState.ilAttributeCount; i++)
+      out.gpState.ilAttributes[i]       = in.gpState.ilAttributes[i];
+
+    for (uint32_t i = 0; i < in.gpState.ilBindingCount; i++) {
+      out.gpState.ilBindings[i]         = in.gpState.ilBindings[i];
+      out.gpState.ilDivisors[i]         = in.gpState.ilDivisors[i];
+    }
+
+    out.gpState.rsDepthClipEnable       = in.gpState.rsDepthClipEnable;
+    out.gpState.rsDepthBiasEnable       = in.gpState.rsDepthBiasEnable;
+    out.gpState.rsPolygonMode           = in.gpState.rsPolygonMode;
+    out.gpState.rsCullMode              = in.gpState.rsCullMode;
+    out.gpState.rsFrontFace             = in.gpState.rsFrontFace;
+    out.gpState.rsViewportCount         = in.gpState.rsViewportCount;
+    out.gpState.rsSampleCount           = in.gpState.rsSampleCount;
+
+    out.gpState.msSampleCount           = in.gpState.msSampleCount;
+    out.gpState.msSampleMask            = in.gpState.msSampleMask;
+    out.gpState.msEnableAlphaToCoverage = in.gpState.msEnableAlphaToCoverage;
+
+    out.gpState.dsEnableDepthTest       = in.gpState.dsEnableDepthTest;
+    out.gpState.dsEnableDepthWrite      = in.gpState.dsEnableDepthWrite;
+    out.gpState.dsEnableStencilTest     = in.gpState.dsEnableStencilTest;
+    out.gpState.dsDepthCompareOp        = in.gpState.dsDepthCompareOp;
+    out.gpState.dsStencilOpFront        = in.gpState.dsStencilOpFront;
+    out.gpState.dsStencilOpBack         = in.gpState.dsStencilOpBack;
+
+    out.gpState.omEnableLogicOp         = in.gpState.omEnableLogicOp;
+    out.gpState.omLogicOp               = in.gpState.omLogicOp;
+
+    for (uint32_t i = 0; i < MaxNumRenderTargets; i++) {
+      out.gpState.omBlendAttachments[i] = in.gpState.omBlendAttachments[i];
+      out.gpState.omComponentMapping[i] = in.gpState.omComponentMapping[i];
+    }
+
+    return true;
+  }
+
+
+  bool DxvkStateCacheFile::convertEntryV5(
+    const DxvkStateCacheEntryV5&    in,
+          DxvkStateCacheEntry&      out) {
+    out.shaders = in.shaders;
+    out.gpState = in.gpState;
+    out.format  = in.format;
+    out.hash    = in.hash;
+
+    out.cpState.bsBindingMask = in.cpState.bsBindingMask;
+    return true;
+  }
+
+
+  uint32_t DxvkStateCacheFile::computeKeyHash(
+    const void*                     data,
+          size_t                    size) {
+    // Keys are hashed with FNV-1a rather than DxvkHashState
+    // so that the index does not depend on the word size
+    auto bytes = reinterpret_cast<const uint8_t*>(data);
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < size; i++) {
+      hash ^= bytes[i];
+      hash *= 16777619u;
+    }
+
+    return hash;
+  }
+
+
+  uint32_t DxvkStateCacheFile::computeBucketCount(
+          size_t                    itemCount) {
+    if (!itemCount)
+      return 0;
+
+    // Keep the load factor at or below 50%
+    uint32_t count = 1;
+
+    while (count < 2 * itemCount)
+      count *= 2;
+
+    return count;
+  }
+
+}
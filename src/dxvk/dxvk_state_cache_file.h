@@ -0,0 +1,230 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "../util/util_file.h"
+
+#include "dxvk_state_cache_types.h"
+
+namespace dxvk {
+
+  /**
+   * \brief State cache entry range
+   *
+   * Range of indexed entries that
+   * belong to the same pipeline.
+   */
+  struct DxvkStateCacheEntryRange {
+    uint32_t first = 0;
+    uint32_t count = 0;
+  };
+
+
+  /**
+   * \brief State cache file
+   *
+   * Maps a state cache file into memory and provides
+   * lookups into its index without copying the indexed
+   * entries. The checksum of an indexed entry is only
+   * verified when the entry is read. Entries appended
+   * to the file after the index was built, as well as
+   * entries of files written by older versions, which
+   * do not have an index, are read into memory when
+   * the file is opened.
+   */
+  class DxvkStateCacheFile {
+
+  public:
+
+    DxvkStateCacheFile();
+    ~DxvkStateCacheFile();
+
+    DxvkStateCacheFile             (const DxvkStateCacheFile&) = delete;
+    DxvkStateCacheFile& operator = (const DxvkStateCacheFile&) = delete;
+
+    /**
+     * \brief Opens a state cache file
+     *
+     * Fails if the file does not exist or if it cannot be
+     * used at all, e.g. because it was written by an
+     * unsupported version. If the index is corrupted,
+     * all entries are read as unindexed entries and
+     * the file is marked for compaction.
+     * \param [in] path Path to the cache file
+     * \returns \c true on success
+     */
+    bool open(const std::string& path);
+
+    /**
+     * \brief Closes the file
+     */
+    void close();
+
+    /**
+     * \brief Checks whether the file should be rewritten
+     *
+     * This is the case if the file uses an older format,
+     * contains invalid entries or an invalid index, or if
+     * too many entries were added after the index was built.
+     * \returns \c true if the file should be compacted
+     */
+    bool needsCompaction() const;
+
+    /**
+     * \brief Number of indexed entries
+     * \returns Indexed entry count
+     */
+    uint32_t indexedEntryCount() const {
+      return m_index.entryCount;
+    }
+
+    /**
+     * \brief Reads an indexed entry
+     *
+     * \param [in] index Entry index
+     * \param [out] entry The entry
+     * \returns \c false if the checksum does not match
+     */
+    bool readIndexedEntry(
+            uint32_t                  index,
+            DxvkStateCacheEntry&      entry) const;
+
+    /**
+     * \brief Looks up indexed entries for a pipeline
+     *
+     * \param [in] key Pipeline shader keys
+     * \returns Range of indexed entries for the
+     *    pipeline, which may be empty
+     */
+    DxvkStateCacheEntryRange findEntries(
+      const DxvkStateCacheKey&        key) const;
+
+    /**
+     * \brief Looks up indexed pipelines for a shader
+     *
+     * \param [in] key Shader key
+     * \param [in] proc Function to call with the key
+     *    of each indexed pipeline using the shader
+     */
+    template<typename Proc>
+    void findPipelines(
+      const DxvkShaderKey&            key,
+      const Proc&                     proc) const {
+      const DxvkStateCacheShaderBucket* bucket = findShaderBucket(key);
+
+      if (!bucket)
+        return;
+
+      for (uint32_t i = 0; i < bucket->refCount; i++) {
+        const auto& pipeline = m_pipelineBuckets[m_shaderRefs[bucket->refIndex + i]];
+
+        if (pipeline.entryCount)
+          proc(m_entries[pipeline.entryIndex].shaders);
+      }
+    }
+
+    /**
+     * \brief Entries that are not indexed
+     *
+     * Entries appended to the file after the index was
+     * built, or all entries of an older cache file. These
+     * entries are validated and converted to the current
+     * format when the file is opened.
+     * \returns Unindexed entries
+     */
+    const std::vector<DxvkStateCacheEntry>& unindexedEntries() const {
+      return m_unindexedEntries;
+    }
+
+    /**
+     * \brief Reads all valid entries
+     *
+     * Verifies the checksums of all indexed entries and
+     * returns them along with all unindexed entries.
+     * \returns All valid entries in the file
+     */
+    std::vector<DxvkStateCacheEntry> readAllEntries() const;
+
+    /**
+     * \brief Writes an indexed state cache file
+     *
+     * Removes duplicate entries and builds the index.
+     * \param [in] path Path to the cache file
+     * \param [in] entries Entries to write
+     * \returns \c true on success
+     */
+    static bool writeFile(
+      const std::string&                      path,
+      const std::vector<DxvkStateCacheEntry>& entries);
+
+    /**
+     * \brief Writes a single entry
+     *
+     * Computes the checksum and appends the
+     * entry to a stream, without indexing it.
+     * \param [in] stream Output stream
+     * \param [in] entry The entry to write
+     */
+    static void writeEntry(
+            std::ostream&             stream,
+            DxvkStateCacheEntry&      entry);
+
+  private:
+
+    MappedFile                          m_file;
+    uint32_t                            m_version = 0;
+
+    DxvkStateCacheIndexHeader           m_index = { };
+
+    const DxvkStateCachePipelineBucket* m_pipelineBuckets = nullptr;
+    const DxvkStateCacheShaderBucket*   m_shaderBuckets   = nullptr;
+    const uint32_t*                     m_shaderRefs      = nullptr;
+    const DxvkStateCacheEntry*          m_entries         = nullptr;
+
+    std::vector<DxvkStateCacheEntry>    m_unindexedEntries;
+    uint32_t                            m_invalidEntries = 0;
+    bool                                m_invalidIndex   = false;
+
+    bool readIndex(
+            size_t&                   offset);
+
+    void resetIndex();
+
+    size_t findFirstEntry(
+            size_t                    offset,
+            size_t                    entrySize) const;
+
+    void readUnindexedEntries(
+            size_t                    offset,
+            size_t                    entrySize);
+
+    const DxvkStateCacheShaderBucket* findShaderBucket(
+      const DxvkShaderKey&            key) const;
+
+    bool readEntry(
+      const char*                     data,
+            DxvkStateCacheEntry&      entry) const;
+
+    static bool convertEntryV2(
+            DxvkStateCacheEntryV4&    entry);
+
+    static bool convertEntryV4(
+      const DxvkStateCacheEntryV4&    in,
+            DxvkStateCacheEntry&      out);
+
+    static bool convertEntryV5(
+      const DxvkStateCacheEntryV5&    in,
+            DxvkStateCacheEntry&      out);
+
+    static uint32_t computeKeyHash(
+      const void*                     data,
+            size_t                    size);
+
+    static uint32_t computeBucketCount(
+            size_t                    itemCount);
+
+  };
+
+}
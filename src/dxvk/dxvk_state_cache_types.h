@@ -52,13 +52,68 @@ namespace dxvk {
    */
   struct DxvkStateCacheHeader {
     char     magic[4]   = { 'D', 'X', 'V', 'K' };
-    uint32_t version    = 6;
+    uint32_t version    = 7;
     uint32_t entrySize  = sizeof(DxvkStateCacheEntry);
   };
 
   static_assert(sizeof(DxvkStateCacheHeader) == 12);
 
 
+  /**
+   * \brief State cache index header
+   * 
+   * Follows the file header as of version 7. The index
+   * consists of two open-addressing hash tables, one
+   * which maps pipeline keys to a range of entries and
+   * one which maps shader keys to the pipelines using
+   * them, followed by the list of pipeline references
+   * and the indexed entries themselves. Entries that
+   * were appended after the index was built follow
+   * the indexed entries. The hash is computed over
+   * the index header with the hash field set to the
+   * SHA-1 of an empty string and the hash tables.
+   */
+  struct DxvkStateCacheIndexHeader {
+    uint32_t entryCount;
+    uint32_t pipelineBucketCount;
+    uint32_t shaderBucketCount;
+    uint32_t shaderRefCount;
+    Sha1Hash hash;
+  };
+
+  static_assert(sizeof(DxvkStateCacheIndexHeader) == 36);
+
+
+  /**
+   * \brief State cache pipeline bucket
+   * 
+   * Stores the range of entries that belong to one
+   * pipeline. The pipeline key is stored in the first
+   * entry. Buckets with an entry count of zero are empty.
+   */
+  struct DxvkStateCachePipelineBucket {
+    uint32_t keyHash;
+    uint32_t entryIndex;
+    uint32_t entryCount;
+  };
+
+
+  /**
+   * \brief State cache shader bucket
+   * 
+   * Stores a range in the pipeline reference list, where
+   * each reference is the index of a pipeline bucket for
+   * a pipeline that uses the shader. Buckets with a
+   * reference count of zero are empty.
+   */
+  struct DxvkStateCacheShaderBucket {
+    DxvkShaderKey key;
+    uint32_t      keyHash;
+    uint32_t      refIndex;
+    uint32_t      refCount;
+  };
+
+
   /**
    * \brief Version 4 graphics pipeline state
    */
@@ -12,14 +12,28 @@ namespace dxvk {
    */
   enum class DxvkStatCounter : uint32_t {
     CmdDrawCalls,             ///< Number of draw calls
+    CmdDrawsSkipped,          ///< Number of draws skipped due to pending pipelines
     CmdDispatchCalls,         ///< Number of compute calls
     CmdRenderPassCount,       ///< Number of render passes
+    CmdBarrierCount,          ///< Number of pipeline barriers
+    CmdBarriersAvoided,       ///< Number of barriers merged or skipped
+    DescriptorSetCount,       ///< Number of descriptor sets allocated
+    DescriptorPoolCount,      ///< Number of descriptor pools created
+    DescriptorPoolResets,     ///< Number of descriptor pool resets
+    DescriptorPoolSize,       ///< Current descriptor pool size, in sets
+    FramebufferCount,         ///< Number of framebuffers created
+    FramebufferCacheHits,     ///< Number of framebuffers found in the cache
     MemoryAllocationCount,    ///< Number of memory allocations
     MemoryAllocated,          ///< Amount of memory allocated
     MemoryUsed,               ///< Amount of memory used
+    MemoryFragmented,         ///< Amount of free memory outside the largest free block of each chunk
+    MemoryLargestFree,        ///< Largest free block in any memory chunk
     PipeCountGraphics,        ///< Number of graphics pipelines
     PipeCountCompute,         ///< Number of compute pipelines
     PipeCompilerBusy,         ///< Boolean indicating compiler activity
+    PipeCompileTime,          ///< Pipeline compile time in microseconds
+    PipeCompileMaxTime,       ///< Longest single pipeline compile time in microseconds
+    PipeStallTime,            ///< Time spent waiting for pipelines in microseconds
     QueueSubmitCount,         ///< Number of command buffer submissions
     QueuePresentCount,        ///< Number of present calls / frames
     GpuIdleTicks,             ///< GPU idle time in microseconds
@@ -0,0 +1,288 @@
+#include "dxvk_tlsf.h"
+
+namespace dxvk {
+
+  DxvkTlsfAllocator::DxvkTlsfAllocator(VkDeviceSize size)
+  : m_size(size) {
+    m_freeLists.fill(NullBlock);
+
+    if (size)
+      insertFreeBlock(createBlock(0, size));
+  }
+
+
+  DxvkTlsfAllocator::~DxvkTlsfAllocator() {
+
+  }
+
+
+  VkDeviceSize DxvkTlsfAllocator::alloc(
+          VkDeviceSize          size,
+          VkDeviceSize          align,
+          VkDeviceSize&         length) {
+    size  = std::max<VkDeviceSize>(size,  1);
+    align = std::max<VkDeviceSize>(align, 1);
+
+    // Any block in the list we find is large enough to hold
+    // the allocation, but may not be if we need to add some
+    // padding at the start. In that case, look for a block
+    // that is guaranteed to be large enough instead.
+    uint32_t block = findFreeBlock(size);
+
+    if (block != NullBlock) {
+      const Block& b = m_blocks[block];
+
+      if (dxvk::align(b.offset, align) + size > b.offset + b.size)
+        block = NullBlock;
+    }
+
+    if (block == NullBlock && align > 1)
+      block = findFreeBlock(size + align - 1);
+
+    if (block == NullBlock)
+      return InvalidOffset;
+
+    removeFreeBlock(block);
+
+    const VkDeviceSize blockStart = m_blocks[block].offset;
+    const VkDeviceSize blockEnd   = m_blocks[block].offset + m_blocks[block].size;
+
+    const VkDeviceSize allocStart = dxvk::align(blockStart, align);
+    const VkDeviceSize allocEnd   = std::min(dxvk::align(allocStart + size, align), blockEnd);
+
+    // Return the padding at the start of the block back to
+    // the free list, as well as any unused space at the end
+    if (allocStart != blockStart) {
+      uint32_t next = splitBlock(block, allocStart - blockStart);
+      insertFreeBlock(block);
+      block = next;
+    }
+
+    if (allocEnd != blockEnd)
+      insertFreeBlock(splitBlock(block, allocEnd - allocStart));
+
+    m_allocated.insert({ allocStart, block });
+
+    length = allocEnd - allocStart;
+    return allocStart;
+  }
+
+
+  void DxvkTlsfAllocator::free(
+          VkDeviceSize          offset) {
+    auto entry = m_allocated.find(offset);
+
+    if (entry == m_allocated.end()) {
+      Logger::err(str::format("DxvkTlsfAllocator: Invalid offset ", offset));
+      return;
+    }
+
+    uint32_t block = entry->second;
+    m_allocated.erase(entry);
+
+    // Merge the block with adjacent free blocks so
+    // that the space can be used for larger ranges
+    uint32_t prev = m_blocks[block].prevPhys;
+    uint32_t next = m_blocks[block].nextPhys;
+
+    if (next != NullBlock && m_blocks[next].isFree) {
+      removeFreeBlock(next);
+      block = mergeBlocks(block, next);
+    }
+
+    if (prev != NullBlock && m_blocks[prev].isFree) {
+      removeFreeBlock(prev);
+      block = mergeBlocks(prev, block);
+    }
+
+    insertFreeBlock(block);
+  }
+
+
+  DxvkTlsfStats DxvkTlsfAllocator::getStats() const {
+    DxvkTlsfStats stats;
+
+    for (uint32_t head : m_freeLists) {
+      for (uint32_t b = head; b != NullBlock; b = m_blocks[b].nextFree) {
+        stats.freeSize += m_blocks[b].size;
+        stats.freeBlockCount += 1;
+        stats.largestFreeBlock = std::max(stats.largestFreeBlock, m_blocks[b].size);
+      }
+    }
+
+    return stats;
+  }
+
+
+  uint32_t DxvkTlsfAllocator::createBlock(
+          VkDeviceSize          offset,
+          VkDeviceSize          size) {
+    uint32_t index;
+
+    if (!m_unusedBlocks.empty()) {
+      index = m_unusedBlocks.back();
+      m_unusedBlocks.pop_back();
+    } else {
+      index = m_blocks.size();
+      m_blocks.emplace_back();
+    }
+
+    Block& b = m_blocks[index];
+    b.offset   = offset;
+    b.size     = size;
+    b.prevPhys = NullBlock;
+    b.nextPhys = NullBlock;
+    b.prevFree = NullBlock;
+    b.nextFree = NullBlock;
+    b.isFree   = false;
+    return index;
+  }
+
+
+  void DxvkTlsfAllocator::destroyBlock(
+          uint32_t              block) {
+    m_unusedBlocks.push_back(block);
+  }
+
+
+  void DxvkTlsfAllocator::insertFreeBlock(
+          uint32_t              block) {
+    uint32_t fl, sl;
+    mapSize(m_blocks[block].size, fl, sl);
+
+    uint32_t& head = m_freeLists[fl * SlCount + sl];
+
+    Block& b = m_blocks[block];
+    b.prevFree = NullBlock;
+    b.nextFree = head;
+    b.isFree   = true;
+
+    if (head != NullBlock)
+      m_blocks[head].prevFree = block;
+
+    head = block;
+
+    m_slBitmaps[fl] |= 1u << sl;
+    m_flBitmap |= uint64_t(1) << fl;
+  }
+
+
+  void DxvkTlsfAllocator::removeFreeBlock(
+          uint32_t              block) {
+    uint32_t fl, sl;
+    mapSize(m_blocks[block].size, fl, sl);
+
+    uint32_t& head = m_freeLists[fl * SlCount + sl];
+
+    Block& b = m_blocks[block];
+
+    if (b.prevFree != NullBlock)
+      m_blocks[b.prevFree].nextFree = b.nextFree;
+
+    if (b.nextFree != NullBlock)
+      m_blocks[b.nextFree].prevFree = b.prevFree;
+
+    if (head == block)
+      head = b.nextFree;
+
+    b.prevFree = NullBlock;
+    b.nextFree = NullBlock;
+    b.isFree   = false;
+
+    if (head == NullBlock) {
+      m_slBitmaps[fl] &= ~(1u << sl);
+
+      if (!m_slBitmaps[fl])
+        m_flBitmap &= ~(uint64_t(1) << fl);
+    }
+  }
+
+
+  uint32_t DxvkTlsfAllocator::findFreeBlock(
+          VkDeviceSize          size) const {
+    // Round the size up to the next size class boundary, so
+    // that every block in the list we pick is large enough.
+    VkDeviceSize granularity = size < (VkDeviceSize(1) << FlShift)
+      ? VkDeviceSize(1) << (FlShift - SlBits)
+      : VkDeviceSize(1) << (bit::bsr64(size) - SlBits);
+
+    if (size + (granularity - 1) < size)
+      return NullBlock;
+
+    uint32_t fl, sl;
+    mapSize(size + (granularity - 1), fl, sl);
+
+    uint32_t slMap = m_slBitmaps[fl] & (~0u << sl);
+
+    if (!slMap) {
+      if (fl + 1 >= FlCount)
+        return NullBlock;
+
+      uint64_t flMap = m_flBitmap & (~uint64_t(0) << (fl + 1));
+
+      if (!flMap)
+        return NullBlock;
+
+      fl    = bit::tzcnt64(flMap);
+      slMap = m_slBitmaps[fl];
+    }
+
+    sl = bit::tzcnt(slMap);
+    return m_freeLists[fl * SlCount + sl];
+  }
+
+
+  uint32_t DxvkTlsfAllocator::splitBlock(
+          uint32_t              block,
+          VkDeviceSize          size) {
+    uint32_t tail = createBlock(
+      m_blocks[block].offset + size,
+      m_blocks[block].size   - size);
+
+    Block& b = m_blocks[block];
+    Block& t = m_blocks[tail];
+
+    t.prevPhys = block;
+    t.nextPhys = b.nextPhys;
+
+    if (b.nextPhys != NullBlock)
+      m_blocks[b.nextPhys].prevPhys = tail;
+
+    b.nextPhys = tail;
+    b.size     = size;
+    return tail;
+  }
+
+
+  uint32_t DxvkTlsfAllocator::mergeBlocks(
+          uint32_t              first,
+          uint32_t              second) {
+    Block& a = m_blocks[first];
+    Block& b = m_blocks[second];
+
+    a.size    += b.size;
+    a.nextPhys = b.nextPhys;
+
+    if (b.nextPhys != NullBlock)
+      m_blocks[b.nextPhys].prevPhys = first;
+
+    destroyBlock(second);
+    return first;
+  }
+
+
+  void DxvkTlsfAllocator::mapSize(
+          VkDeviceSize          size,
+          uint32_t&             fl,
+          uint32_t&             sl) {
+    if (size < (VkDeviceSize(1) << FlShift)) {
+      fl = 0;
+      sl = uint32_t(size >> (FlShift - SlBits));
+    } else {
+      uint32_t msb = bit::bsr64(size);
+      fl = msb - FlShift + 1;
+      sl = uint32_t(size >> (msb - SlBits)) - SlCount;
+    }
+  }
+
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+#include "dxvk_include.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Free block statistics
+   *
+   * Describes the free space in a single
+   * range managed by a TLSF allocator.
+   */
+  struct DxvkTlsfStats {
+    VkDeviceSize freeSize         = 0;
+    VkDeviceSize largestFreeBlock = 0;
+    uint32_t     freeBlockCount   = 0;
+  };
+
+
+  /**
+   * \brief TLSF range allocator
+   *
+   * Sub-allocates ranges from a contiguous address range
+   * using a two-level segregated fit scheme. Free blocks
+   * are kept in lists indexed by size class, the first
+   * level being the power of two and the second level
+   * splitting that range into linear sub-classes. Bit
+   * masks over both levels allow finding a suitable free
+   * block in constant time, and adjacent free blocks are
+   * merged in constant time on free.
+   *
+   * Does not access the memory it manages, so this
+   * can be used for any kind of address space. This
+   * class is not thread-safe.
+   */
+  class DxvkTlsfAllocator {
+    constexpr static uint32_t SlBits  = 4;
+    constexpr static uint32_t SlCount = 1u << SlBits;
+    constexpr static uint32_t FlShift = 8;
+    constexpr static uint32_t FlCount = 64 - FlShift + 1;
+
+    constexpr static uint32_t NullBlock = ~0u;
+  public:
+
+    constexpr static VkDeviceSize InvalidOffset = ~VkDeviceSize(0);
+
+    DxvkTlsfAllocator(VkDeviceSize size);
+    ~DxvkTlsfAllocator();
+
+    /**
+     * \brief Total size of the managed range
+     * \returns Size, in bytes
+     */
+    VkDeviceSize size() const {
+      return m_size;
+    }
+
+    /**
+     * \brief Allocates a range
+     *
+     * The start of the allocated range will be aligned
+     * to the given alignment. The end is aligned too,
+     * unless that would exceed the free block used.
+     * \param [in] size Number of bytes to allocate
+     * \param [in] align Required alignment, must be
+     *    a power of two
+     * \param [out] length Actual allocation size
+     * \returns Offset of the allocated range, or
+     *    \c InvalidOffset if no block is large enough
+     */
+    VkDeviceSize alloc(
+            VkDeviceSize          size,
+            VkDeviceSize          align,
+            VkDeviceSize&         length);
+
+    /**
+     * \brief Frees a range
+     *
+     * \param [in] offset Offset of a range
+     *    previously returned by \ref alloc
+     */
+    void free(
+            VkDeviceSize          offset);
+
+    /**
+     * \brief Checks whether the allocator is empty
+     * \returns \c true if nothing is allocated
+     */
+    bool isEmpty() const {
+      return m_allocated.empty();
+    }
+
+    /**
+     * \brief Computes free block statistics
+     *
+     * This is not constant-time and should
+     * not be called on hot paths.
+     * \returns Free block statistics
+     */
+    DxvkTlsfStats getStats() const;
+
+  private:
+
+    struct Block {
+      VkDeviceSize offset;
+      VkDeviceSize size;
+      uint32_t     prevPhys;
+      uint32_t     nextPhys;
+      uint32_t     prevFree;
+      uint32_t     nextFree;
+      bool         isFree;
+    };
+
+    VkDeviceSize                    m_size;
+
+    std::vector<Block>              m_blocks;
+    std::vector<uint32_t>           m_unusedBlocks;
+
+    uint64_t                        m_flBitmap = 0;
+    std::array<uint32_t, FlCount>   m_slBitmaps = { };
+    std::array<uint32_t, FlCount * SlCount> m_freeLists;
+
+    std::unordered_map<VkDeviceSize, uint32_t> m_allocated;
+
+    uint32_t createBlock(
+            VkDeviceSize          offset,
+            VkDeviceSize          size);
+
+    void destroyBlock(
+            uint32_t              block);
+
+    void insertFreeBlock(
+            uint32_t              block);
+
+    void removeFreeBlock(
+            uint32_t              block);
+
+    uint32_t findFreeBlock(
+            VkDeviceSize          size) const;
+
+    uint32_t splitBlock(
+            uint32_t              block,
+            VkDeviceSize          size);
+
+    uint32_t mergeBlocks(
+            uint32_t              first,
+            uint32_t              second);
+
+    static void mapSize(
+            VkDeviceSize          size,
+            uint32_t&             fl,
+            uint32_t&             sl);
+
+  };
+
+}
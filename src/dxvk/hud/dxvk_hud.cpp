@@ -18,7 +18,8 @@ namespace dxvk::hud {
     m_renderer      (device),
     m_hudDeviceInfo (device),
     m_hudFramerate  (config.elements),
-    m_hudStats      (config.elements) {
+    m_hudStats      (config.elements),
+    m_costUpdate    (Clock::now()) {
     // Set up constant state
     m_rsState.polygonMode       = VK_POLYGON_MODE_FILL;
     m_rsState.cullMode          = VK_CULL_MODE_BACK_BIT;
@@ -47,18 +48,36 @@ namespace dxvk::hud {
   
   
   void Hud::update() {
+    auto t0 = Clock::now();
+
     m_hudFramerate.update();
     m_hudStats.update(m_device);
+
+    if (m_config.elements.test(HudElement::HudCost))
+      m_costCpuNs += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
   }
   
   
   void Hud::render(const Rc<DxvkContext>& ctx, VkExtent2D surfaceSize) {
+    auto t0 = Clock::now();
+    bool measureCost = m_config.elements.test(HudElement::HudCost);
+
+    if (measureCost)
+      this->beginTimestamp(ctx);
+
     m_uniformData.surfaceSize = surfaceSize;
     
     this->updateUniformBuffer(ctx, m_uniformData);
 
     this->setupRendererState(ctx);
     this->renderHudElements(ctx);
+
+    m_renderer.endFrame(ctx);
+
+    if (measureCost) {
+      this->endTimestamp(ctx);
+      this->updateCost(Clock::now() - t0);
+    }
   }
   
   
@@ -132,8 +151,71 @@ namespace dxvk::hud {
       }
       position = m_hudFramerate.render(ctx, m_renderer, position);
       position = m_hudStats    .render(ctx, m_renderer, position);
+
+      if (m_config.elements.test(HudElement::HudCost)) {
+        m_renderer.drawText(ctx, 16.0f,
+          { position.x, position.y },
+          { 1.0f, 1.0f, 1.0f, 1.0f },
+          m_costString);
+        position.y += 24.0f;
+      }
     }
   }
+
+
+  void Hud::beginTimestamp(const Rc<DxvkContext>& ctx) {
+    HudTimestamps& timestamps = m_timestamps[m_timestampId];
+
+    if (timestamps.begin == nullptr) {
+      timestamps.begin = m_device->createGpuQuery(VK_QUERY_TYPE_TIMESTAMP, 0, 0);
+      timestamps.end   = m_device->createGpuQuery(VK_QUERY_TYPE_TIMESTAMP, 0, 0);
+    } else {
+      // Queries are reused a few frames later, so the results
+      // are usually available. Skip the sample otherwise.
+      DxvkQueryData beginData = { };
+      DxvkQueryData endData   = { };
+
+      if (timestamps.begin->getData(beginData) == DxvkGpuQueryStatus::Available
+       && timestamps.end  ->getData(endData)   == DxvkGpuQueryStatus::Available) {
+        const double period = m_device->properties().core.properties.limits.timestampPeriod;
+
+        m_costGpuNs += uint64_t(period * double(endData.timestamp.time - beginData.timestamp.time));
+        m_costGpuFrames += 1;
+      }
+    }
+
+    ctx->writeTimestamp(timestamps.begin);
+  }
+
+
+  void Hud::endTimestamp(const Rc<DxvkContext>& ctx) {
+    ctx->writeTimestamp(m_timestamps[m_timestampId].end);
+    m_timestampId = (m_timestampId + 1) % QueryCount;
+  }
+
+
+  void Hud::updateCost(Clock::duration cpuTime) {
+    m_costCpuNs  += std::chrono::duration_cast<std::chrono::nanoseconds>(cpuTime).count();
+    m_costFrames += 1;
+
+    auto now = Clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - m_costUpdate);
+
+    if (elapsed.count() < UpdateInterval)
+      return;
+
+    // Report the average per-frame cost in microseconds
+    m_costString = str::format("HUD: ", m_costCpuNs / (1000 * m_costFrames), " us CPU");
+
+    if (m_costGpuFrames)
+      m_costString += str::format(", ", m_costGpuNs / (1000 * m_costGpuFrames), " us GPU");
+
+    m_costUpdate    = now;
+    m_costFrames    = 0;
+    m_costCpuNs     = 0;
+    m_costGpuNs     = 0;
+    m_costGpuFrames = 0;
+  }
   
   
   void Hud::updateUniformBuffer(const Rc<DxvkContext>& ctx, const HudUniformData& data) {
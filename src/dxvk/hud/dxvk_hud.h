@@ -19,6 +19,17 @@ namespace dxvk::hud {
   struct HudUniformData {
     VkExtent2D surfaceSize;
   };
+
+  /**
+   * \brief HUD timestamp queries
+   *
+   * Timestamps written before and after
+   * the HUD draws of a single frame.
+   */
+  struct HudTimestamps {
+    Rc<DxvkGpuQuery> begin;
+    Rc<DxvkGpuQuery> end;
+  };
   
   /**
    * \brief DXVK HUD
@@ -27,7 +38,10 @@ namespace dxvk::hud {
    * display performance and driver information.
    */
   class Hud : public RcObject {
-    
+    using Clock = std::chrono::high_resolution_clock;
+
+    constexpr static uint32_t QueryCount     = 4;
+    constexpr static int64_t  UpdateInterval = 500'000;
   public:
     static float offset_x_float;
     static float offset_y_float;
@@ -46,6 +60,16 @@ namespace dxvk::hud {
      */
     void update();
 
+    /**
+     * \brief Sets frame rate limiter statistics
+     *
+     * Displayed with the frame time graph.
+     * \param [in] stats Limiter statistics
+     */
+    void setFpsLimiterStats(const FpsLimiterStats& stats) {
+      m_hudFramerate.setLimiterStats(stats);
+    }
+
     /**
      * \brief Render HUD
      * 
@@ -84,12 +108,31 @@ namespace dxvk::hud {
     HudFps                m_hudFramerate;
     HudStats              m_hudStats;
 
+    std::array<HudTimestamps, QueryCount> m_timestamps;
+    uint32_t              m_timestampId = 0;
+
+    Clock::time_point     m_costUpdate;
+    uint64_t              m_costFrames  = 0;
+    uint64_t              m_costCpuNs   = 0;
+    uint64_t              m_costGpuNs   = 0;
+    uint64_t              m_costGpuFrames = 0;
+    std::string           m_costString  = "HUD:";
+
     void setupRendererState(
       const Rc<DxvkContext>&  ctx);
 
     void renderHudElements(
       const Rc<DxvkContext>&  ctx);
 
+    void beginTimestamp(
+      const Rc<DxvkContext>&  ctx);
+
+    void endTimestamp(
+      const Rc<DxvkContext>&  ctx);
+
+    void updateCost(
+            Clock::duration   cpuTime);
+
     void updateUniformBuffer(
       const Rc<DxvkContext>&  ctx,
       const HudUniformData&   data);
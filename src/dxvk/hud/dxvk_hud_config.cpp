@@ -12,6 +12,7 @@ namespace dxvk::hud {
     { "submissions",  HudElement::StatSubmissions   },
     { "pipelines",    HudElement::StatPipelines     },
     { "memory",       HudElement::StatMemory        },
+    { "descriptors",  HudElement::StatDescriptors   },
     { "gpuload",      HudElement::StatGpuLoad       },
     { "version",      HudElement::DxvkVersion       },
     { "api",          HudElement::DxvkClientApi     },
@@ -19,6 +20,7 @@ namespace dxvk::hud {
     { "mangogpuload", HudElement::GpuLoad           },
     { "mangocpuload", HudElement::CpuLoad           },
     { "mangocpuload", HudElement::Logging           },
+    { "hudcost",      HudElement::HudCost           },
   }};
   
   
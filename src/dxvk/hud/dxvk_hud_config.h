@@ -25,6 +25,8 @@ namespace dxvk::hud {
     GpuLoad           = 11,
     CpuLoad           = 12,
     Logging           = 13,
+    StatDescriptors   = 14,
+    HudCost           = 15,
   };
   
   using HudElements = Flags<HudElement>;
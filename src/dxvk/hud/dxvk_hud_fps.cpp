@@ -1,6 +1,5 @@
 #include "dxvk_hud_fps.h"
 #include "dxvk_hud_stats.h"
-#include "../dxvk_cpu.h"
 #include <time.h>
 
 #include <cmath>
@@ -8,15 +7,6 @@
 using namespace std;
 time_t now_log = time(0);
 tm *log_time = localtime(&now_log);
-fstream f;
-
-struct logData{
-  float fps;
-  float cpu;
-  uint64_t gpu;
-};
-
-std::vector<logData> logArray;
 
 namespace dxvk::hud {
   
@@ -26,6 +16,11 @@ namespace dxvk::hud {
     m_prevFpsUpdate(Clock::now()),
     m_prevFtgUpdate(Clock::now()),
     m_prevLogUpdate(Clock::now()) {
+    if (!logging.empty())
+      m_logger = std::make_unique<HudLogger>();
+
+    if (m_elements.test(HudElement::CpuLoad) || m_logger)
+      m_cpuSampler = std::make_unique<DxvkCpuSampler>();
   }
   
   
@@ -43,25 +38,21 @@ namespace dxvk::hud {
     TimeDiff elapsedLog = std::chrono::duration_cast<TimeDiff>(now - m_prevLogUpdate);
     m_prevFtgUpdate = now;
 
-    if(GetAsyncKeyState(VK_F2) & 0x8000)
+    if(m_logger && (GetAsyncKeyState(VK_F2) & 0x8000))
     {
       elapsedF2 = std::chrono::duration_cast<TimeDiff>(now - m_prevF2Press);
       if (elapsedF2.count() > UpdateInterval || elapsedF2.count() == 0) {
           if (mango_logging){
             m_prevF2Press = now;
             mango_logging = false;
-            for (size_t i = 0; i < logArray.size(); i++) {
-              f << logArray[i].fps << "," << logArray[i].cpu << "," << logArray[i].gpu << endl;
-            }
-            f.close();
-            logArray.clear();
+            m_logger->endLog();
           } else {
             m_prevF2Press = now;
             now_log = time(0);
             log_time = localtime(&now_log);
             mango_logging = true;
             string date = to_string(log_time->tm_year + 1900) + "-" + to_string(1 + log_time->tm_mon) + "-" + to_string(log_time->tm_mday) + "_" + to_string(1 + log_time->tm_hour) + "-" + to_string(1 + log_time->tm_min) + "-" + to_string(1 + log_time->tm_sec);
-            f.open(logging + "_" + date, f.out | f.app);
+            m_logger->beginLog(logging + "_" + date);
           }
         } 
       }
@@ -70,7 +61,7 @@ namespace dxvk::hud {
       fps = (10'000'000ll * m_frameCount) / elapsedFps.count();
       if (!logging.empty()){
         if (mango_logging){
-          logArray.push_back({float(fps / 10 + (float(fps % 10) / 10)), cpuArray[0].value, gpuLoad});
+          m_logger->logSample({float(fps / 10 + (float(fps % 10) / 10)), m_cpuSampler->getTotalLoad(), gpuLoad});
         }
       }
       m_prevLogUpdate = now;
@@ -78,11 +69,15 @@ namespace dxvk::hud {
     
     if (elapsedFps.count() >= UpdateInterval) {
     // Update FPS string
-      coreCounting();
-      dxvk::thread([this] () { getCpuUsage();});
-      updateCpuStrings();
-      m_cpuUtilizationString = str::format(cpuArray[0].output);
+      if (m_cpuSampler)
+        updateCpuString();
+
       m_fpsString = str::format("FPS: ", fps / 10, ".", fps % 10);
+
+      if (m_limiterStats.sampleCount) {
+        m_limiterString = str::format("limiter p50: ", m_limiterStats.p50Us,
+          " us, p99: ", m_limiterStats.p99Us, " us");
+      }
       
       m_prevFpsUpdate = now;
       m_frameCount = 0;
@@ -94,6 +89,17 @@ namespace dxvk::hud {
   }
   
   
+  void HudFps::updateCpuString() {
+    // Right-align the load value so that
+    // the string doesn't jump around
+    uint32_t load = uint32_t(m_cpuSampler->getTotalLoad());
+    uint32_t digits = load >= 100 ? 3 : load >= 10 ? 2 : 1;
+
+    m_cpuUtilizationString = str::format("CPU:",
+      std::string(5 - digits, ' '), load, "%");
+  }
+
+
   HudPos HudFps::render(
     const Rc<DxvkContext>&  context,
           HudRenderer&      renderer,
@@ -230,6 +236,16 @@ HudPos HudFps::renderFpsText(
       { 1.0f, 1.0f, 1.0f, 1.0f },
       str::format("max: ", maxMs / 10, ".", maxMs % 10));
     
+    // Deviation of presents from the frame rate limiter's target
+    if (!m_limiterString.empty()) {
+      renderer.drawText(context, 14.0f,
+        { position.x, position.y + 64.0f },
+        { 1.0f, 1.0f, 1.0f, 1.0f },
+        m_limiterString);
+
+      return HudPos { position.x, position.y + 86.0f };
+    }
+
     return HudPos { position.x, position.y + 66.0f };
   }
   
@@ -1,8 +1,14 @@
 #pragma once
 
 #include <chrono>
+#include <memory>
+
+#include "../dxvk_cpu.h"
+
+#include "../../util/util_fps_limiter.h"
 
 #include "dxvk_hud_config.h"
+#include "dxvk_hud_logger.h"
 #include "dxvk_hud_renderer.h"
 
 namespace dxvk::hud {
@@ -26,6 +32,17 @@ namespace dxvk::hud {
     ~HudFps();
     
     void update();
+
+    /**
+     * \brief Sets frame rate limiter statistics
+     *
+     * Shown below the frame time graph. Only
+     * set if the frame rate limiter is enabled.
+     * \param [in] stats Limiter statistics
+     */
+    void setLimiterStats(const FpsLimiterStats& stats) {
+      m_limiterStats = stats;
+    }
     
     HudPos render(
       const Rc<DxvkContext>&  context,
@@ -41,6 +58,14 @@ namespace dxvk::hud {
     time_t lastPress = time(0);
     std::string logging = env::getEnvVar("DXVK_LOG_TO_FILE");
     int64_t fps;
+
+    std::unique_ptr<HudLogger>      m_logger;
+    std::unique_ptr<DxvkCpuSampler> m_cpuSampler;
+
+    std::string m_cpuUtilizationString;
+
+    FpsLimiterStats m_limiterStats;
+    std::string     m_limiterString;
     
     TimePoint m_prevFpsUpdate;
     TimePoint m_prevFtgUpdate;
@@ -52,6 +77,8 @@ namespace dxvk::hud {
     std::array<float, NumDataPoints>  m_dataPoints  = {};
     uint32_t                          m_dataPointId = 0;
 
+    void updateCpuString();
+
     HudPos renderGpuText(
       const Rc<DxvkContext>&  context,
       HudRenderer&      renderer,
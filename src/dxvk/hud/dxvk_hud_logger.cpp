@@ -0,0 +1,108 @@
+#include "dxvk_hud_logger.h"
+
+namespace dxvk::hud {
+
+  HudLogger::HudLogger()
+  : m_thread([this] () { threadFunc(); }) {
+    m_thread.set_priority(ThreadPriority::Lowest);
+  }
+
+
+  HudLogger::~HudLogger() {
+    { std::lock_guard<std::mutex> lock(m_mutex);
+      m_stopped.store(true);
+      m_cond.notify_one();
+    }
+
+    m_thread.join();
+  }
+
+
+  void HudLogger::beginLog(const std::string& fileName) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_commands.push({ fileName, m_samples.writePos(), true });
+    m_cond.notify_one();
+  }
+
+
+  void HudLogger::endLog() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_commands.push({ std::string(), m_samples.writePos(), false });
+    m_cond.notify_one();
+
+    if (m_dropped) {
+      Logger::warn(str::format("Hud: Dropped ", m_dropped, " log samples"));
+      m_dropped = 0;
+    }
+  }
+
+
+  void HudLogger::logSample(const HudLogSample& sample) {
+    // Don't wake up the writer for every sample, it
+    // drains the ring buffer in batches on its own
+    if (!m_samples.tryPush(sample))
+      m_dropped += 1;
+  }
+
+
+  void HudLogger::writeSamples(
+          std::ofstream&  file,
+          size_t          samplePos) {
+    HudLogSample sample;
+
+    while (m_samples.readPos() != samplePos && m_samples.tryPop(sample)) {
+      if (file)
+        file << sample.fps << "," << sample.cpu << "," << sample.gpu << "\n";
+    }
+
+    file.flush();
+  }
+
+
+  void HudLogger::threadFunc() {
+    env::setThreadName("dxvk-hud-log");
+
+    std::ofstream file;
+
+    while (true) {
+      std::unique_lock<std::mutex> lock(m_mutex);
+
+      // Wake up periodically so that we never have
+      // to buffer more than a second worth of samples
+      m_cond.wait_for(lock, std::chrono::milliseconds(500), [this] () {
+        return m_commands.size() || m_stopped.load();
+      });
+
+      if (m_commands.empty()) {
+        bool stopped = m_stopped.load();
+        lock.unlock();
+
+        writeSamples(file, m_samples.writePos());
+
+        if (stopped)
+          break;
+        continue;
+      }
+
+      Command cmd = std::move(m_commands.front());
+      m_commands.pop();
+      lock.unlock();
+
+      // Write all samples that were logged
+      // before the command was issued
+      writeSamples(file, cmd.samplePos);
+
+      if (file.is_open())
+        file.close();
+
+      if (cmd.open) {
+        file.clear();
+        file.open(cmd.fileName, std::ios_base::out | std::ios_base::app);
+
+        if (!file)
+          Logger::err(str::format("Hud: Failed to open log file ", cmd.fileName));
+      }
+    }
+  }
+
+}
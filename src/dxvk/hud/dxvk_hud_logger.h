@@ -0,0 +1,98 @@
+#pragma once
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <queue>
+
+#include "../dxvk_include.h"
+
+#include "../../util/sync/sync_ringbuffer.h"
+
+namespace dxvk::hud {
+
+  /**
+   * \brief Log sample
+   *
+   * One line of the benchmark log, as
+   * recorded by the FPS display.
+   */
+  struct HudLogSample {
+    float    fps;
+    float    cpu;
+    uint64_t gpu;
+  };
+
+
+  /**
+   * \brief Benchmark logger
+   *
+   * Streams log samples to a file. Samples are passed
+   * to a dedicated writer thread through a lock-free
+   * ring buffer, so that the thread recording them
+   * never performs any file I/O and memory usage does
+   * not grow with the length of the logging session.
+   */
+  class HudLogger {
+    constexpr static size_t SampleCount = 4096;
+  public:
+
+    HudLogger();
+    ~HudLogger();
+
+    /**
+     * \brief Starts logging to a file
+     *
+     * Any samples logged after this call will
+     * be written to the given file. The file is
+     * opened on the writer thread.
+     * \param [in] fileName Log file name
+     */
+    void beginLog(const std::string& fileName);
+
+    /**
+     * \brief Stops logging
+     *
+     * Samples logged before this call will be
+     * written out, after which the file is closed.
+     */
+    void endLog();
+
+    /**
+     * \brief Records a sample
+     *
+     * Must only be called from the thread that calls
+     * \ref beginLog and \ref endLog. If the writer
+     * thread falls behind, the sample is dropped.
+     * \param [in] sample The sample
+     */
+    void logSample(const HudLogSample& sample);
+
+  private:
+
+    struct Command {
+      std::string fileName;
+      size_t      samplePos;
+      bool        open;
+    };
+
+    sync::RingBuffer<HudLogSample, SampleCount> m_samples;
+
+    std::atomic<bool>       m_stopped = { false };
+    uint64_t                m_dropped = 0;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_cond;
+    std::queue<Command>     m_commands;
+
+    dxvk::thread            m_thread;
+
+    void writeSamples(
+            std::ofstream&  file,
+            size_t          samplePos);
+
+    void threadFunc();
+
+  };
+
+}
@@ -9,14 +9,14 @@
 namespace dxvk::hud {
   
   HudRenderer::HudRenderer(const Rc<DxvkDevice>& device)
-  : m_mode          (Mode::RenderNone),
+  : m_device        (device),
     m_surfaceSize   { 0, 0 },
     m_textShaders   (createTextShaders(device)),
     m_lineShaders   (createLineShaders(device)),
     m_fontImage     (createFontImage(device)),
     m_fontView      (createFontView(device)),
     m_fontSampler   (createFontSampler(device)),
-    m_vertexBuffer  (createVertexBuffer(device)) {
+    m_vertexBuffer  (createVertexBuffer(device, 1 << 16)) {
     this->initFontTexture(device);
     this->initCharMap();
   }
@@ -28,14 +28,70 @@ namespace dxvk::hud {
   
   
   void HudRenderer::beginFrame(const Rc<DxvkContext>& context, VkExtent2D surfaceSize) {
-    auto vertexSlice = m_vertexBuffer->allocSlice();
-    context->invalidateBuffer(m_vertexBuffer, vertexSlice);
-    
     context->bindResourceSampler(1, m_fontSampler);
     context->bindResourceView   (1, m_fontView, nullptr);
     
-    m_mode        = Mode::RenderNone;
     m_surfaceSize = surfaceSize;
+
+    m_textEntryCount  = 0;
+    m_textVertexCount = 0;
+    m_lineVertices.clear();
+  }
+  
+  
+  void HudRenderer::endFrame(const Rc<DxvkContext>& context) {
+    // Strings that were not drawn this frame
+    // won't be drawn at the same position again
+    m_textEntries.resize(m_textEntryCount);
+
+    VkDeviceSize lineDataSize = align(m_lineVertices.size() * sizeof(HudLineVertex), 64);
+    VkDeviceSize textDataSize = m_textVertexCount * sizeof(HudTextVertex);
+
+    if (!lineDataSize && !textDataSize)
+      return;
+
+    if (m_vertexBuffer->info().size < lineDataSize + textDataSize) {
+      VkDeviceSize bufferSize = m_vertexBuffer->info().size;
+
+      while (bufferSize < lineDataSize + textDataSize)
+        bufferSize *= 2;
+
+      m_vertexBuffer = createVertexBuffer(m_device, bufferSize);
+    }
+
+    // Write all vertex data to a fresh slice so
+    // that we never stall on the previous frame
+    auto vertexSlice = m_vertexBuffer->allocSlice();
+    context->invalidateBuffer(m_vertexBuffer, vertexSlice);
+
+    auto vertexData = reinterpret_cast<char*>(vertexSlice.mapPtr);
+
+    if (!m_lineVertices.empty()) {
+      std::memcpy(vertexData, m_lineVertices.data(),
+        m_lineVertices.size() * sizeof(HudLineVertex));
+
+      beginLineRendering(context);
+
+      context->bindVertexBuffer(0, DxvkBufferSlice(m_vertexBuffer,
+        0, lineDataSize), sizeof(HudLineVertex));
+      context->draw(m_lineVertices.size(), 1, 0, 0);
+    }
+
+    if (m_textVertexCount) {
+      auto textData = reinterpret_cast<HudTextVertex*>(vertexData + lineDataSize);
+
+      for (const auto& entry : m_textEntries) {
+        std::memcpy(textData, entry.vertices.data(),
+          entry.vertices.size() * sizeof(HudTextVertex));
+        textData += entry.vertices.size();
+      }
+
+      beginTextRendering(context);
+
+      context->bindVertexBuffer(0, DxvkBufferSlice(m_vertexBuffer,
+        lineDataSize, textDataSize), sizeof(HudTextVertex));
+      context->draw(m_textVertexCount, 1, 0, 0);
+    }
   }
   
   
@@ -45,25 +101,55 @@ namespace dxvk::hud {
           HudPos            pos,
           HudColor          color,
     const std::string&      text) {
-    beginTextRendering(context);
+    const HudNormColor normColor = {
+      uint8_t(255.0f * std::min(std::max(color.r, 0.0f), 1.0f)),
+      uint8_t(255.0f * std::min(std::max(color.g, 0.0f), 1.0f)),
+      uint8_t(255.0f * std::min(std::max(color.b, 0.0f), 1.0f)),
+      uint8_t(255.0f * std::min(std::max(color.a, 0.0f), 1.0f)) };
 
-    uint32_t vertexCount = 6 * text.size();
+    if (m_textEntryCount == m_textEntries.size())
+      m_textEntries.emplace_back();
 
-    auto vertexSlice = allocVertexBuffer(context,
-      vertexCount * sizeof(HudTextVertex));
-    
-    context->bindVertexBuffer(0, vertexSlice, sizeof(HudTextVertex));
-    context->pushConstants(0, sizeof(color), &color);
-    context->draw(vertexCount, 1, 0, 0);
+    // Elements draw the same strings in the same order
+    // every frame, so compare against the entry that was
+    // drawn at the same index in the previous frame.
+    TextEntry& entry = m_textEntries[m_textEntryCount++];
 
-    auto vertexData = reinterpret_cast<HudTextVertex*>(
-      vertexSlice.getSliceHandle().mapPtr);
-    
-    const float sizeFactor = size / static_cast<float>(g_hudFont.size);
+    if (entry.text != text || entry.size != size
+     || entry.pos.x != pos.x || entry.pos.y != pos.y
+     || std::memcmp(&entry.color, &normColor, sizeof(normColor))) {
+      entry.text  = text;
+      entry.size  = size;
+      entry.pos   = pos;
+      entry.color = normColor;
+
+      buildTextVertices(entry);
+    }
+
+    m_textVertexCount += entry.vertices.size();
+  }
+  
+  
+  void HudRenderer::drawLines(
+    const Rc<DxvkContext>&  context,
+          size_t            vertexCount,
+    const HudLineVertex*    vertexData) {
+    m_lineVertices.insert(m_lineVertices.end(),
+      vertexData, vertexData + vertexCount);
+  }
+  
+  
+  void HudRenderer::buildTextVertices(
+          TextEntry&        entry) {
+    entry.vertices.resize(6 * entry.text.size());
+
+    const float sizeFactor = entry.size / static_cast<float>(g_hudFont.size);
+
+    HudPos pos = entry.pos;
     
-    for (size_t i = 0; i < text.size(); i++) {
+    for (size_t i = 0; i < entry.text.size(); i++) {
       const HudGlyph& glyph = g_hudFont.glyphs[
-        m_charMap[static_cast<uint8_t>(text[i])]];
+        m_charMap[static_cast<uint8_t>(entry.text[i])]];
       
       const HudPos size  = {
         sizeFactor * static_cast<float>(glyph.w),
@@ -84,124 +170,72 @@ namespace dxvk::hud {
         static_cast<uint32_t>(glyph.x + glyph.w),
         static_cast<uint32_t>(glyph.y + glyph.h) };
       
-      vertexData[6 * i + 0].position = { posTl.x, posTl.y };
-      vertexData[6 * i + 0].texcoord = { texTl.u, texTl.v };
-      
-      vertexData[6 * i + 1].position = { posBr.x, posTl.y };
-      vertexData[6 * i + 1].texcoord = { texBr.u, texTl.v };
-      
-      vertexData[6 * i + 2].position = { posTl.x, posBr.y };
-      vertexData[6 * i + 2].texcoord = { texTl.u, texBr.v };
-      
-      vertexData[6 * i + 3].position = { posBr.x, posBr.y };
-      vertexData[6 * i + 3].texcoord = { texBr.u, texBr.v };
-      
-      vertexData[6 * i + 4].position = { posTl.x, posBr.y };
-      vertexData[6 * i + 4].texcoord = { texTl.u, texBr.v };
-      
-      vertexData[6 * i + 5].position = { posBr.x, posTl.y };
-      vertexData[6 * i + 5].texcoord = { texBr.u, texTl.v };
+      HudTextVertex* vertexData = &entry.vertices[6 * i];
+
+      vertexData[0] = { { posTl.x, posTl.y }, { texTl.u, texTl.v }, entry.color };
+      vertexData[1] = { { posBr.x, posTl.y }, { texBr.u, texTl.v }, entry.color };
+      vertexData[2] = { { posTl.x, posBr.y }, { texTl.u, texBr.v }, entry.color };
+      vertexData[3] = { { posBr.x, posBr.y }, { texBr.u, texBr.v }, entry.color };
+      vertexData[4] = { { posTl.x, posBr.y }, { texTl.u, texBr.v }, entry.color };
+      vertexData[5] = { { posBr.x, posTl.y }, { texBr.u, texTl.v }, entry.color };
       
       pos.x += sizeFactor * static_cast<float>(g_hudFont.advance);
     }
   }
   
-  
-  void HudRenderer::drawLines(
-    const Rc<DxvkContext>&  context,
-          size_t            vertexCount,
-    const HudLineVertex*    vertexData) {
-    beginLineRendering(context);
-
-    auto vertexSlice = allocVertexBuffer(context,
-      vertexCount * sizeof(HudLineVertex));
-    
-    context->bindVertexBuffer(0, vertexSlice, sizeof(HudLineVertex));
-    context->draw(vertexCount, 1, 0, 0);
-    
-    auto dstVertexData = reinterpret_cast<HudLineVertex*>(
-      vertexSlice.getSliceHandle().mapPtr);
-    
-    for (size_t i = 0; i < vertexCount; i++)
-      dstVertexData[i] = vertexData[i];
-  }
-  
-  
-  DxvkBufferSlice HudRenderer::allocVertexBuffer(
-    const Rc<DxvkContext>&  context,
-          VkDeviceSize      dataSize) {
-    dataSize = align(dataSize, 64);
-
-    if (m_vertexOffset + dataSize > m_vertexBuffer->info().size) {
-      context->invalidateBuffer(m_vertexBuffer, m_vertexBuffer->allocSlice());
-      m_vertexOffset = 0;
-    }
-
-    DxvkBufferSlice slice(m_vertexBuffer, m_vertexOffset, dataSize);
-    m_vertexOffset += dataSize;
-    return slice;
-  }
-  
 
   void HudRenderer::beginTextRendering(
     const Rc<DxvkContext>&  context) {
-    if (m_mode != Mode::RenderText) {
-      m_mode = Mode::RenderText;
+    context->bindShader(VK_SHADER_STAGE_VERTEX_BIT,   m_textShaders.vert);
+    context->bindShader(VK_SHADER_STAGE_FRAGMENT_BIT, m_textShaders.frag);
+    
+    static const DxvkInputAssemblyState iaState = {
+      VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+      VK_FALSE, 0 };
 
-      context->bindShader(VK_SHADER_STAGE_VERTEX_BIT,   m_textShaders.vert);
-      context->bindShader(VK_SHADER_STAGE_FRAGMENT_BIT, m_textShaders.frag);
-      
-      static const DxvkInputAssemblyState iaState = {
-        VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
-        VK_FALSE, 0 };
-
-      static const std::array<DxvkVertexAttribute, 2> ilAttributes = {{
-        { 0, 0, VK_FORMAT_R32G32_SFLOAT,       offsetof(HudTextVertex, position) },
-        { 1, 0, VK_FORMAT_R32G32_UINT,         offsetof(HudTextVertex, texcoord) },
-      }};
-      
-      static const std::array<DxvkVertexBinding, 1> ilBindings = {{
-        { 0, VK_VERTEX_INPUT_RATE_VERTEX },
-      }};
-      
-      context->setInputAssemblyState(iaState);
-      context->setInputLayout(
-        ilAttributes.size(),
-        ilAttributes.data(),
-        ilBindings.size(),
-        ilBindings.data());
-    }
+    static const std::array<DxvkVertexAttribute, 3> ilAttributes = {{
+      { 0, 0, VK_FORMAT_R32G32_SFLOAT,       offsetof(HudTextVertex, position) },
+      { 1, 0, VK_FORMAT_R32G32_UINT,         offsetof(HudTextVertex, texcoord) },
+      { 2, 0, VK_FORMAT_R8G8B8A8_UNORM,      offsetof(HudTextVertex, color)    },
+    }};
+    
+    static const std::array<DxvkVertexBinding, 1> ilBindings = {{
+      { 0, VK_VERTEX_INPUT_RATE_VERTEX },
+    }};
+    
+    context->setInputAssemblyState(iaState);
+    context->setInputLayout(
+      ilAttributes.size(),
+      ilAttributes.data(),
+      ilBindings.size(),
+      ilBindings.data());
   }
 
   
   void HudRenderer::beginLineRendering(
     const Rc<DxvkContext>&  context) {
-    if (m_mode != Mode::RenderLines) {
-      m_mode = Mode::RenderLines;
+    context->bindShader(VK_SHADER_STAGE_VERTEX_BIT,   m_lineShaders.vert);
+    context->bindShader(VK_SHADER_STAGE_FRAGMENT_BIT, m_lineShaders.frag);
+    
+    static const DxvkInputAssemblyState iaState = {
+      VK_PRIMITIVE_TOPOLOGY_LINE_LIST,
+      VK_FALSE, 0 };
 
-      context->bindShader(VK_SHADER_STAGE_VERTEX_BIT,   m_lineShaders.vert);
-      context->bindShader(VK_SHADER_STAGE_FRAGMENT_BIT, m_lineShaders.frag);
-      
-      static const DxvkInputAssemblyState iaState = {
-        VK_PRIMITIVE_TOPOLOGY_LINE_LIST,
-        VK_FALSE, 0 };
-
-      static const std::array<DxvkVertexAttribute, 2> ilAttributes = {{
-        { 0, 0, VK_FORMAT_R32G32_SFLOAT,  offsetof(HudLineVertex, position) },
-        { 1, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(HudLineVertex, color)    },
-      }};
-      
-      static const std::array<DxvkVertexBinding, 1> ilBindings = {{
-        { 0, VK_VERTEX_INPUT_RATE_VERTEX },
-      }};
-      
-      context->setInputAssemblyState(iaState);
-      context->setInputLayout(
-        ilAttributes.size(),
-        ilAttributes.data(),
-        ilBindings.size(),
-        ilBindings.data());
-    }
+    static const std::array<DxvkVertexAttribute, 2> ilAttributes = {{
+      { 0, 0, VK_FORMAT_R32G32_SFLOAT,  offsetof(HudLineVertex, position) },
+      { 1, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(HudLineVertex, color)    },
+    }};
+    
+    static const std::array<DxvkVertexBinding, 1> ilBindings = {{
+      { 0, VK_VERTEX_INPUT_RATE_VERTEX },
+    }};
+    
+    context->setInputAssemblyState(iaState);
+    context->setInputLayout(
+      ilAttributes.size(),
+      ilAttributes.data(),
+      ilBindings.size(),
+      ilBindings.data());
   }
   
 
@@ -225,14 +259,14 @@ namespace dxvk::hud {
       VK_SHADER_STAGE_VERTEX_BIT,
       vsResources.size(),
       vsResources.data(),
-      { 0x3, 0x1 },
+      { 0x7, 0x3 },
       vsCode);
     
     result.frag = device->createShader(
       VK_SHADER_STAGE_FRAGMENT_BIT,
       fsResources.size(),
       fsResources.data(),
-      { 0x1, 0x1, 0, sizeof(HudColor) },
+      { 0x3, 0x1 },
       fsCode);
     
     return result;
@@ -325,9 +359,9 @@ namespace dxvk::hud {
   }
   
   
-  Rc<DxvkBuffer> HudRenderer::createVertexBuffer(const Rc<DxvkDevice>& device) {
+  Rc<DxvkBuffer> HudRenderer::createVertexBuffer(const Rc<DxvkDevice>& device, VkDeviceSize size) {
     DxvkBufferCreateInfo info;
-    info.size           = 1 << 16;
+    info.size           = size;
     info.usage          = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
     info.stages         = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
     info.access         = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
@@ -53,11 +53,12 @@ namespace dxvk::hud {
   };
   
   /**
-   * \brief Text vertex and texture coordinates
+   * \brief Text vertex, texture coordinates and color
    */
   struct HudTextVertex {
     HudPos        position;
     HudTexCoord   texcoord;
+    HudNormColor  color;
   };
 
   /**
@@ -73,6 +74,12 @@ namespace dxvk::hud {
    * 
    * Can be used by the presentation backend to
    * display performance and driver information.
+   *
+   * Text and lines are collected during the frame
+   * and submitted with one draw each in \c endFrame.
+   * Glyph geometry is retained across frames, so that
+   * only strings which changed since the previous frame
+   * need to be rebuilt.
    */
   class HudRenderer {
 
@@ -87,6 +94,9 @@ namespace dxvk::hud {
       const Rc<DxvkContext>&  context,
             VkExtent2D        surfaceSize);
     
+    void endFrame(
+      const Rc<DxvkContext>&  context);
+    
     void drawText(
       const Rc<DxvkContext>&  context,
             float             size,
@@ -105,20 +115,22 @@ namespace dxvk::hud {
     
   private:
     
-    enum class Mode {
-      RenderNone,
-      RenderText,
-      RenderLines,
-    };
-
     struct ShaderPair {
       Rc<DxvkShader> vert;
       Rc<DxvkShader> frag;
     };
+
+    struct TextEntry {
+      std::string                 text;
+      float                       size  = 0.0f;
+      HudPos                      pos   = { 0.0f, 0.0f };
+      HudNormColor                color = { 0, 0, 0, 0 };
+      std::vector<HudTextVertex>  vertices;
+    };
     
     std::array<uint8_t, 256> m_charMap;
     
-    Mode                m_mode;
+    Rc<DxvkDevice>      m_device;
     VkExtent2D          m_surfaceSize;
     
     ShaderPair          m_textShaders;
@@ -129,11 +141,15 @@ namespace dxvk::hud {
     Rc<DxvkSampler>     m_fontSampler;
     
     Rc<DxvkBuffer>      m_vertexBuffer;
-    VkDeviceSize        m_vertexOffset = 0;
+
+    std::vector<TextEntry>      m_textEntries;
+    size_t                      m_textEntryCount  = 0;
+    size_t                      m_textVertexCount = 0;
+
+    std::vector<HudLineVertex>  m_lineVertices;
     
-    DxvkBufferSlice allocVertexBuffer(
-      const Rc<DxvkContext>&  context,
-            VkDeviceSize      dataSize);
+    void buildTextVertices(
+            TextEntry&        entry);
 
     void beginTextRendering(
       const Rc<DxvkContext>&  context);
@@ -157,7 +173,8 @@ namespace dxvk::hud {
       const Rc<DxvkDevice>& device);
     
     Rc<DxvkBuffer> createVertexBuffer(
-      const Rc<DxvkDevice>& device);
+      const Rc<DxvkDevice>& device,
+            VkDeviceSize    size);
     
     void initFontTexture(
       const Rc<DxvkDevice>&  device);
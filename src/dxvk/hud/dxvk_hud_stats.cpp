@@ -24,6 +24,8 @@ namespace dxvk::hud {
     m_diffCounters = nextCounters.diff(m_prevCounters);
     m_prevCounters = nextCounters;
 
+    m_showSkippedDraws = device->config().enableAsyncPipelines;
+
     // GPU load is a bit more complex than that since
     // we don't want to update this every frame
     if (m_elements.test(HudElement::GpuLoad) || m_elements.test(HudElement::StatGpuLoad))
@@ -47,6 +49,9 @@ namespace dxvk::hud {
     if (m_elements.test(HudElement::StatMemory))
       position = this->printMemoryStats(context, renderer, position);
     
+    if (m_elements.test(HudElement::StatDescriptors))
+      position = this->printDescriptorStats(context, renderer, position);
+    
     if (m_elements.test(HudElement::StatGpuLoad))
       position = this->printGpuLoad(context, renderer, position);
     
@@ -107,7 +112,20 @@ namespace dxvk::hud {
       { 1.0f, 1.0f, 1.0f, 1.0f },
       strRenderPasses);
     
-    return { position.x, position.y + 64 };
+    if (!m_showSkippedDraws)
+      return { position.x, position.y + 64 };
+    
+    // Draws skipped because their pipeline was still
+    // being compiled when async pipelines are enabled
+    const uint64_t skCalls = m_diffCounters.getCtr(DxvkStatCounter::CmdDrawsSkipped) / frameCount;
+    const std::string strSkippedDraws = str::format("Skipped draws:  ", skCalls);
+    
+    renderer.drawText(context, 16.0f,
+      { position.x, position.y + 60.0f },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      strSkippedDraws);
+    
+    return { position.x, position.y + 84 };
   }
   
   
@@ -118,14 +136,23 @@ namespace dxvk::hud {
     const uint64_t frameCount = std::max<uint64_t>(m_diffCounters.getCtr(DxvkStatCounter::QueuePresentCount), 1);
     const uint64_t numSubmits = m_diffCounters.getCtr(DxvkStatCounter::QueueSubmitCount) / frameCount;
     
+    const uint64_t numBarriers = m_diffCounters.getCtr(DxvkStatCounter::CmdBarrierCount)    / frameCount;
+    const uint64_t numAvoided  = m_diffCounters.getCtr(DxvkStatCounter::CmdBarriersAvoided) / frameCount;
+    
     const std::string strSubmissions = str::format("Queue submissions: ", numSubmits);
+    const std::string strBarriers    = str::format("Barriers:          ", numBarriers, " (", numAvoided, " avoided)");
     
     renderer.drawText(context, 16.0f,
       { position.x, position.y },
       { 1.0f, 1.0f, 1.0f, 1.0f },
       strSubmissions);
     
-    return { position.x, position.y + 24.0f };
+    renderer.drawText(context, 16.0f,
+      { position.x, position.y + 20.0f },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      strBarriers);
+    
+    return { position.x, position.y + 44.0f };
   }
   
   
@@ -136,8 +163,22 @@ namespace dxvk::hud {
     const uint64_t gpCount = m_prevCounters.getCtr(DxvkStatCounter::PipeCountGraphics);
     const uint64_t cpCount = m_prevCounters.getCtr(DxvkStatCounter::PipeCountCompute);
     
+    // Average compile time of pipelines compiled since the last
+    // update, the slowest pipeline compiled so far, and time per
+    // frame spent waiting for pipelines
+    const uint64_t frameCount   = std::max<uint64_t>(m_diffCounters.getCtr(DxvkStatCounter::QueuePresentCount), 1);
+    const uint64_t compileCount = std::max<uint64_t>(m_diffCounters.getCtr(DxvkStatCounter::PipeCountGraphics)
+                                                   + m_diffCounters.getCtr(DxvkStatCounter::PipeCountCompute), 1);
+    
+    const uint64_t compileTime = m_diffCounters.getCtr(DxvkStatCounter::PipeCompileTime) / compileCount;
+    const uint64_t maxTime     = m_prevCounters.getCtr(DxvkStatCounter::PipeCompileMaxTime);
+    const uint64_t stallTime   = m_diffCounters.getCtr(DxvkStatCounter::PipeStallTime)   / frameCount;
+    
     const std::string strGpCount = str::format("Graphics pipelines: ", gpCount);
     const std::string strCpCount = str::format("Compute pipelines:  ", cpCount);
+    const std::string strCompile = str::format("Compile time:       ", compileTime / 1000, ".", (compileTime / 100) % 10, " ms");
+    const std::string strMax     = str::format("Slowest compile:    ", maxTime     / 1000, ".", (maxTime     / 100) % 10, " ms");
+    const std::string strStall   = str::format("Pipeline stalls:    ", stallTime   / 1000, ".", (stallTime   / 100) % 10, " ms");
     
     renderer.drawText(context, 16.0f,
       { position.x, position.y },
@@ -149,7 +190,22 @@ namespace dxvk::hud {
       { 1.0f, 1.0f, 1.0f, 1.0f },
       strCpCount);
     
-    return { position.x, position.y + 44.0f };
+    renderer.drawText(context, 16.0f,
+      { position.x, position.y + 40.0f },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      strCompile);
+    
+    renderer.drawText(context, 16.0f,
+      { position.x, position.y + 60.0f },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      strMax);
+    
+    renderer.drawText(context, 16.0f,
+      { position.x, position.y + 80.0f },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      strStall);
+    
+    return { position.x, position.y + 104.0f };
   }
   
   
@@ -162,8 +218,18 @@ namespace dxvk::hud {
     const uint64_t memAllocated = m_prevCounters.getCtr(DxvkStatCounter::MemoryAllocated);
     const uint64_t memUsed      = m_prevCounters.getCtr(DxvkStatCounter::MemoryUsed);
     
+    const uint64_t memFragmented = m_prevCounters.getCtr(DxvkStatCounter::MemoryFragmented);
+    const uint64_t memLargest    = m_prevCounters.getCtr(DxvkStatCounter::MemoryLargestFree);
+    
+    // Percentage of free chunk memory that is not
+    // part of the largest free block of its chunk
+    const uint64_t memFree = memAllocated > memUsed ? memAllocated - memUsed : 0;
+    const uint64_t fragPct = memFree ? (100 * memFragmented) / memFree : 0;
+    
     const std::string strMemAllocated = str::format("Memory allocated: ", memAllocated / mib, " MB");
     const std::string strMemUsed      = str::format("Memory used:      ", memUsed      / mib, " MB");
+    const std::string strMemFrag      = str::format("Fragmentation:    ", fragPct, "%");
+    const std::string strMemLargest   = str::format("Largest free:     ", memLargest   / mib, " MB");
     
     renderer.drawText(context, 16.0f,
       { position.x, position.y },
@@ -175,7 +241,57 @@ namespace dxvk::hud {
       { 1.0f, 1.0f, 1.0f, 1.0f },
       strMemUsed);
     
-    return { position.x, position.y + 44.0f };
+    renderer.drawText(context, 16.0f,
+      { position.x, position.y + 40.0f },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      strMemFrag);
+    
+    renderer.drawText(context, 16.0f,
+      { position.x, position.y + 60.0f },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      strMemLargest);
+    
+    return { position.x, position.y + 84.0f };
+  }
+
+
+  HudPos HudStats::printDescriptorStats(
+    const Rc<DxvkContext>&  context,
+          HudRenderer&      renderer,
+          HudPos            position) {
+    const uint64_t frameCount = std::max<uint64_t>(m_diffCounters.getCtr(DxvkStatCounter::QueuePresentCount), 1);
+    
+    const uint64_t setCount   = m_diffCounters.getCtr(DxvkStatCounter::DescriptorSetCount)   / frameCount;
+    const uint64_t poolCount  = m_diffCounters.getCtr(DxvkStatCounter::DescriptorPoolCount)  / frameCount;
+    const uint64_t poolResets = m_diffCounters.getCtr(DxvkStatCounter::DescriptorPoolResets) / frameCount;
+    const uint64_t poolSize   = m_prevCounters.getCtr(DxvkStatCounter::DescriptorPoolSize);
+    
+    const std::string strSetCount   = str::format("Descriptor sets: ", setCount);
+    const std::string strPoolCount  = str::format("Pools created:   ", poolCount);
+    const std::string strPoolResets = str::format("Pool resets:     ", poolResets);
+    const std::string strPoolSize   = str::format("Pool size:       ", poolSize);
+    
+    renderer.drawText(context, 16.0f,
+      { position.x, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      strSetCount);
+    
+    renderer.drawText(context, 16.0f,
+      { position.x, position.y + 20.0f },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      strPoolCount);
+    
+    renderer.drawText(context, 16.0f,
+      { position.x, position.y + 40.0f },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      strPoolResets);
+    
+    renderer.drawText(context, 16.0f,
+      { position.x, position.y + 60.0f },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      strPoolSize);
+    
+    return { position.x, position.y + 84.0f };
   }
 
 
@@ -225,6 +341,7 @@ namespace dxvk::hud {
       HudElement::StatSubmissions,
       HudElement::StatPipelines,
       HudElement::StatMemory,
+      HudElement::StatDescriptors,
       HudElement::StatGpuLoad,
       HudElement::CompilerActivity,
       HudElement::GpuLoad);
@@ -43,6 +43,8 @@ namespace dxvk::hud {
     std::chrono::high_resolution_clock::time_point m_gpuLoadUpdateTime;
     std::chrono::high_resolution_clock::time_point m_compilerShowTime;
 
+    bool     m_showSkippedDraws = false;
+
     uint64_t m_prevGpuIdleTicks = 0;
     uint64_t m_diffGpuIdleTicks = 0;
     
@@ -68,6 +70,11 @@ namespace dxvk::hud {
             HudRenderer&      renderer,
             HudPos            position);
     
+    HudPos printDescriptorStats(
+      const Rc<DxvkContext>&  context,
+            HudRenderer&      renderer,
+            HudPos            position);
+    
     HudPos printGpuLoad(
       const Rc<DxvkContext>&  context,
             HudRenderer&      renderer,
@@ -0,0 +1,831 @@
+#define SPV_ENABLE_UTILITY_CODE
+
+#include <chrono>
+#include <map>
+
+#include "spirv_optimizer.h"
+
+namespace dxvk {
+
+  SpirvOptimizer::SpirvOptimizer(SpirvPassFlags passes)
+  : m_passes(passes) {
+
+  }
+
+
+  SpirvOptimizer::~SpirvOptimizer() {
+
+  }
+
+
+  SpirvCodeBuffer SpirvOptimizer::run(const SpirvCodeBuffer& code) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+
+    this->parse(code);
+
+    m_stats = SpirvOptimizerStats();
+    m_stats.insCountBefore = m_ins.size();
+    m_stats.dwordsBefore   = code.dwords();
+
+    // Deduplicate constants first so that the other
+    // passes can compare constants by their IDs
+    if (m_passes.test(SpirvPass::DedupConstants))
+      this->runDedupConstants();
+
+    if (m_passes.test(SpirvPass::PromoteRegisters))
+      this->runPromoteRegisters();
+
+    if (m_passes.test(SpirvPass::FoldBranches))
+      this->runFoldBranches();
+
+    if (m_passes.test(SpirvPass::EliminateDeadCode))
+      this->runEliminateDeadCode();
+
+    SpirvCodeBuffer result = this->emit();
+
+    for (const auto& ins : m_ins)
+      m_stats.insCountAfter += ins.removed ? 0 : 1;
+
+    m_stats.dwordsAfter = result.dwords();
+
+    m_code.clear();
+    m_ins.clear();
+    m_replace.clear();
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    m_stats.timeUs = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+    return result;
+  }
+
+
+  void SpirvOptimizer::parse(
+    const SpirvCodeBuffer&  code) {
+    m_code.assign(code.data(), code.data() + code.dwords());
+    m_ins.clear();
+
+    uint32_t offset = (m_code.size() >= 5 && m_code[0] == spv::MagicNumber) ? 5 : 0;
+
+    while (offset < m_code.size()) {
+      Ins ins;
+      ins.offset  = offset;
+      ins.length  = m_code[offset] >> spv::WordCountShift;
+      ins.op      = spv::Op(m_code[offset] & spv::OpCodeMask);
+      ins.removed = false;
+
+      bool hasResult = false;
+      bool hasType   = false;
+      spv::HasResultAndType(ins.op, &hasResult, &hasType);
+
+      ins.resultIndex = hasResult ? (hasType ? 2 : 1) : 0;
+
+      if (!ins.length || offset + ins.length > m_code.size())
+        break;
+
+      m_ins.push_back(ins);
+      offset += ins.length;
+    }
+  }
+
+
+  SpirvCodeBuffer SpirvOptimizer::emit() const {
+    std::vector<uint32_t> code;
+    code.reserve(m_code.size());
+
+    uint32_t offset = m_ins.empty() ? m_code.size() : m_ins[0].offset;
+    code.insert(code.end(), m_code.begin(), m_code.begin() + offset);
+
+    for (const auto& ins : m_ins) {
+      if (!ins.removed) {
+        code.insert(code.end(),
+          m_code.begin() + ins.offset,
+          m_code.begin() + ins.offset + ins.length);
+      }
+    }
+
+    return SpirvCodeBuffer(code.size(), code.data());
+  }
+
+
+  void SpirvOptimizer::runDedupConstants() {
+    std::map<std::vector<uint32_t>, uint32_t> constants;
+
+    // Constants only reference previously declared constants,
+    // so resolving operands in order catches duplicate composites
+    for (auto& ins : m_ins) {
+      if (ins.removed || !isConstant(ins.op))
+        continue;
+
+      forEachIdOperand(ins, [this] (uint32_t& id, uint32_t) {
+        id = resolve(id);
+      });
+
+      std::vector<uint32_t> key;
+      key.push_back(m_code[ins.offset]);
+      key.push_back(arg(ins, 1));
+
+      for (uint32_t i = 3; i < ins.length; i++)
+        key.push_back(arg(ins, i));
+
+      auto entry = constants.insert({ key, arg(ins, 2) });
+
+      if (!entry.second) {
+        m_replace.insert({ arg(ins, 2), entry.first->second });
+        ins.removed = true;
+      }
+    }
+
+    this->applyReplacements();
+  }
+
+
+  void SpirvOptimizer::runPromoteRegisters() {
+    struct VarInfo {
+      bool     promotable = true;
+      uint32_t loadCount  = 0;
+    };
+
+    std::unordered_map<uint32_t, VarInfo> vars;
+
+    for (const auto& ins : m_ins) {
+      if (!ins.removed && ins.op == spv::OpVariable
+       && (arg(ins, 3) == spv::StorageClassPrivate
+        || arg(ins, 3) == spv::StorageClassFunction))
+        vars.insert({ arg(ins, 2), VarInfo() });
+    }
+
+    // Only consider variables that are accessed as a whole,
+    // which is the case for the r# registers. Anything else,
+    // e.g. access chains, makes the variable non-promotable.
+    for (const auto& ins : m_ins) {
+      if (ins.removed)
+        continue;
+
+      forEachIdOperand(ins, [&] (uint32_t& id, uint32_t index) {
+        auto var = vars.find(id);
+
+        if (var == vars.end())
+          return;
+
+        bool isPlainAccess = (ins.op == spv::OpLoad  && index == 3 && ins.length == 4)
+                          || (ins.op == spv::OpStore && index == 1 && ins.length == 3)
+                          || isDebugOrDecoration(ins.op);
+
+        if (!isPlainAccess)
+          var->second.promotable = false;
+      });
+    }
+
+    // Track the current value of each variable within a block.
+    // Function calls may access private variables, so treat
+    // them like block boundaries.
+    std::unordered_map<uint32_t, uint32_t> values;
+    std::unordered_map<uint32_t, size_t>   stores;
+
+    for (size_t i = 0; i < m_ins.size(); i++) {
+      Ins& ins = m_ins[i];
+
+      if (ins.removed)
+        continue;
+
+      if (ins.op == spv::OpLabel
+       || ins.op == spv::OpFunctionCall
+       || isBlockTerminator(ins.op)) {
+        values.clear();
+        stores.clear();
+      } else if (ins.op == spv::OpLoad) {
+        auto var = vars.find(arg(ins, 3));
+
+        if (var == vars.end() || !var->second.promotable)
+          continue;
+
+        stores.erase(var->first);
+
+        auto value = values.find(var->first);
+
+        if (value != values.end()) {
+          m_replace.insert({ arg(ins, 2), value->second });
+          ins.removed = true;
+        } else {
+          values.insert({ var->first, arg(ins, 2) });
+        }
+      } else if (ins.op == spv::OpStore) {
+        auto var = vars.find(arg(ins, 1));
+
+        if (var == vars.end() || !var->second.promotable)
+          continue;
+
+        // A previous store that was not read before
+        // being overwritten has no visible effect
+        auto store = stores.find(var->first);
+
+        if (store != stores.end())
+          m_ins[store->second].removed = true;
+
+        stores[var->first] = i;
+        values[var->first] = resolve(arg(ins, 2));
+      }
+    }
+
+    this->applyReplacements();
+
+    // Stores to variables that are never read are dead
+    for (const auto& ins : m_ins) {
+      if (!ins.removed && ins.op == spv::OpLoad) {
+        auto var = vars.find(arg(ins, 3));
+
+        if (var != vars.end())
+          var->second.loadCount += 1;
+      }
+    }
+
+    for (auto& ins : m_ins) {
+      if (!ins.removed && ins.op == spv::OpStore) {
+        auto var = vars.find(arg(ins, 1));
+
+        if (var != vars.end() && var->second.promotable && !var->second.loadCount)
+          ins.removed = true;
+      }
+    }
+  }
+
+
+  void SpirvOptimizer::runFoldBranches() {
+    std::unordered_map<uint32_t, uint32_t> constWords;
+    std::unordered_map<uint32_t, bool>     constBools;
+    std::unordered_map<uint32_t, size_t>   labels;
+
+    auto getBool = [&constBools] (uint32_t id, bool& value) {
+      auto entry = constBools.find(id);
+
+      if (entry == constBools.end())
+        return false;
+
+      value = entry->second;
+      return true;
+    };
+
+    // Evaluate simple boolean expressions on scalar constants,
+    // which is what the DXBC compiler emits for conditionals
+    for (size_t i = 0; i < m_ins.size(); i++) {
+      const Ins& ins = m_ins[i];
+
+      if (ins.removed)
+        continue;
+
+      switch (ins.op) {
+        case spv::OpLabel:
+          labels.insert({ arg(ins, 1), i });
+          break;
+
+        case spv::OpConstantTrue:
+        case spv::OpConstantFalse:
+          constBools.insert({ arg(ins, 2), ins.op == spv::OpConstantTrue });
+          break;
+
+        case spv::OpConstant:
+          if (ins.length == 4)
+            constWords.insert({ arg(ins, 2), arg(ins, 3) });
+          break;
+
+        case spv::OpIEqual:
+        case spv::OpINotEqual: {
+          auto a = constWords.find(arg(ins, 3));
+          auto b = constWords.find(arg(ins, 4));
+
+          if (a != constWords.end() && b != constWords.end())
+            constBools.insert({ arg(ins, 2), (a->second == b->second) == (ins.op == spv::OpIEqual) });
+        } break;
+
+        case spv::OpLogicalNot: {
+          bool a;
+
+          if (getBool(arg(ins, 3), a))
+            constBools.insert({ arg(ins, 2), !a });
+        } break;
+
+        case spv::OpLogicalAnd:
+        case spv::OpLogicalOr: {
+          bool a, b;
+
+          if (getBool(arg(ins, 3), a) && getBool(arg(ins, 4), b))
+            constBools.insert({ arg(ins, 2), ins.op == spv::OpLogicalAnd ? (a && b) : (a || b) });
+        } break;
+
+        default:
+          break;
+      }
+    }
+
+    auto startsWithPhi = [this, &labels] (uint32_t label) {
+      auto entry = labels.find(label);
+
+      if (entry == labels.end())
+        return true;
+
+      for (size_t i = entry->second + 1; i < m_ins.size(); i++) {
+        if (!m_ins[i].removed)
+          return m_ins[i].op == spv::OpPhi;
+      }
+
+      return false;
+    };
+
+    for (size_t i = 1; i < m_ins.size(); i++) {
+      Ins& ins = m_ins[i];
+      bool cond;
+
+      if (ins.removed || ins.op != spv::OpBranchConditional || !getBool(arg(ins, 1), cond))
+        continue;
+
+      size_t prev = i - 1;
+
+      while (prev && m_ins[prev].removed)
+        prev -= 1;
+
+      // Leave loops alone, and don't fold if this block
+      // is referenced by phi instructions in the targets
+      if (m_ins[prev].op == spv::OpLoopMerge
+       || startsWithPhi(arg(ins, 2))
+       || startsWithPhi(arg(ins, 3)))
+        continue;
+
+      uint32_t target = cond ? arg(ins, 2) : arg(ins, 3);
+
+      m_code[ins.offset + 0] = (2u << spv::WordCountShift) | spv::OpBranch;
+      m_code[ins.offset + 1] = target;
+
+      ins.op     = spv::OpBranch;
+      ins.length = 2;
+
+      // A selection merge must not precede an unconditional branch
+      if (m_ins[prev].op == spv::OpSelectionMerge)
+        m_ins[prev].removed = true;
+    }
+  }
+
+
+  void SpirvOptimizer::runEliminateDeadCode() {
+    std::unordered_map<uint32_t, size_t>   defs;
+    std::unordered_map<uint32_t, uint32_t> uses;
+    std::unordered_map<uint32_t, std::vector<size_t>> weakUses;
+
+    auto isLocalVariable = [this] (const Ins& ins) {
+      return ins.op == spv::OpVariable
+          && (arg(ins, 3) == spv::StorageClassPrivate
+           || arg(ins, 3) == spv::StorageClassFunction);
+    };
+
+    auto isRemovable = [&] (const Ins& ins) {
+      return isConstant(ins.op) || isPure(ins.op) || isLocalVariable(ins);
+    };
+
+    for (size_t i = 0; i < m_ins.size(); i++) {
+      if (m_ins[i].removed)
+        continue;
+
+      uint32_t id = getResultId(m_ins[i]);
+
+      if (id)
+        defs.insert({ id, i });
+    }
+
+    auto isStoreToLocal = [&] (const Ins& ins) {
+      if (ins.op != spv::OpStore)
+        return false;
+
+      auto def = defs.find(arg(ins, 1));
+      return def != defs.end() && isLocalVariable(m_ins[def->second]);
+    };
+
+    // Debug names, decorations and stores to private variables
+    // do not keep the referenced object alive on their own
+    for (size_t i = 0; i < m_ins.size(); i++) {
+      Ins& ins = m_ins[i];
+
+      if (ins.removed)
+        continue;
+
+      if (isDebugOrDecoration(ins.op)) {
+        weakUses[arg(ins, 1)].push_back(i);
+      } else if (isStoreToLocal(ins)) {
+        weakUses[arg(ins, 1)].push_back(i);
+        uses[arg(ins, 2)] += 1;
+      } else {
+        forEachIdOperand(ins, [&uses] (uint32_t& id, uint32_t) {
+          uses[id] += 1;
+        });
+      }
+    }
+
+    std::vector<uint32_t> worklist;
+
+    for (const auto& def : defs) {
+      if (!uses[def.first] && isRemovable(m_ins[def.second]))
+        worklist.push_back(def.first);
+    }
+
+    auto release = [&] (uint32_t id) {
+      auto def = defs.find(id);
+
+      if (!(--uses[id]) && def != defs.end() && isRemovable(m_ins[def->second]))
+        worklist.push_back(id);
+    };
+
+    while (!worklist.empty()) {
+      uint32_t id = worklist.back();
+      worklist.pop_back();
+
+      Ins& ins = m_ins[defs[id]];
+
+      if (ins.removed || uses[id])
+        continue;
+
+      ins.removed = true;
+
+      forEachIdOperand(ins, [&release] (uint32_t& id, uint32_t) {
+        release(id);
+      });
+
+      auto weak = weakUses.find(id);
+
+      if (weak == weakUses.end())
+        continue;
+
+      for (size_t index : weak->second) {
+        Ins& user = m_ins[index];
+
+        if (user.removed)
+          continue;
+
+        user.removed = true;
+
+        if (user.op == spv::OpStore)
+          release(arg(user, 2));
+      }
+    }
+  }
+
+
+  void SpirvOptimizer::applyReplacements() {
+    if (m_replace.empty())
+      return;
+
+    for (auto& ins : m_ins) {
+      if (ins.removed)
+        continue;
+
+      // Names and decorations of replaced objects are
+      // redundant since the replacement has its own
+      if (isDebugOrDecoration(ins.op) && m_replace.find(arg(ins, 1)) != m_replace.end()) {
+        ins.removed = true;
+        continue;
+      }
+
+      forEachIdOperand(ins, [this] (uint32_t& id, uint32_t) {
+        id = resolve(id);
+      });
+    }
+
+    m_replace.clear();
+  }
+
+
+  uint32_t SpirvOptimizer::resolve(
+          uint32_t          id) const {
+    auto entry = m_replace.find(id);
+
+    while (entry != m_replace.end()) {
+      id = entry->second;
+      entry = m_replace.find(id);
+    }
+
+    return id;
+  }
+
+
+  uint32_t SpirvOptimizer::getResultId(
+    const Ins&              ins) const {
+    return ins.resultIndex ? arg(ins, ins.resultIndex) : 0;
+  }
+
+
+  bool SpirvOptimizer::isIdOperand(
+    const Ins&              ins,
+          uint32_t          index) const {
+    if (index == ins.resultIndex)
+      return false;
+
+    switch (ins.op) {
+      case spv::OpNop:
+      case spv::OpCapability:
+      case spv::OpExtension:
+      case spv::OpExtInstImport:
+      case spv::OpMemoryModel:
+      case spv::OpString:
+      case spv::OpSourceExtension:
+      case spv::OpSourceContinued:
+      case spv::OpModuleProcessed:
+      case spv::OpNoLine:
+      case spv::OpTypeVoid:
+      case spv::OpTypeBool:
+      case spv::OpTypeInt:
+      case spv::OpTypeFloat:
+      case spv::OpTypeSampler:
+        return false;
+
+      case spv::OpSource:
+        return index == 3;
+
+      case spv::OpName:
+      case spv::OpMemberName:
+      case spv::OpDecorate:
+      case spv::OpMemberDecorate:
+      case spv::OpExecutionMode:
+      case spv::OpLine:
+      case spv::OpSelectionMerge:
+        return index == 1;
+
+      case spv::OpEntryPoint: {
+        if (index < 3)
+          return index == 2;
+
+        // Interface IDs follow the null-terminated name
+        uint32_t nameEnd = 3;
+
+        while (nameEnd < ins.length) {
+          uint32_t word = arg(ins, nameEnd);
+
+          if (!(word & 0xFF000000u) || !(word & 0x00FF0000u)
+           || !(word & 0x0000FF00u) || !(word & 0x000000FFu))
+            break;
+
+          nameEnd += 1;
+        }
+
+        return index > nameEnd;
+      }
+
+      case spv::OpTypeVector:
+      case spv::OpTypeMatrix:
+      case spv::OpTypeImage:
+        return index == 2;
+
+      case spv::OpTypePointer:
+        return index == 3;
+
+      case spv::OpConstant:
+      case spv::OpSpecConstant:
+        return index == 1;
+
+      case spv::OpVariable:
+      case spv::OpFunction:
+        return index == 1 || index == 4;
+
+      case spv::OpLoad:
+      case spv::OpCompositeExtract:
+        return index <= 3;
+
+      case spv::OpStore:
+      case spv::OpCopyMemory:
+      case spv::OpLoopMerge:
+        return index <= 2;
+
+      case spv::OpCompositeInsert:
+      case spv::OpVectorShuffle:
+        return index <= 4;
+
+      case spv::OpBranchConditional:
+        return index <= 3;
+
+      case spv::OpSwitch:
+        // Case literals and labels alternate,
+        // assuming a 32-bit selector
+        return index <= 2 || !(index & 1);
+
+      case spv::OpExtInst:
+      case spv::OpGroupNonUniformBallotBitCount:
+      case spv::OpGroupNonUniformIAdd:
+      case spv::OpGroupNonUniformFAdd:
+      case spv::OpGroupNonUniformIMul:
+      case spv::OpGroupNonUniformFMul:
+      case spv::OpGroupNonUniformSMin:
+      case spv::OpGroupNonUniformUMin:
+      case spv::OpGroupNonUniformFMin:
+      case spv::OpGroupNonUniformSMax:
+      case spv::OpGroupNonUniformUMax:
+      case spv::OpGroupNonUniformFMax:
+      case spv::OpGroupNonUniformBitwiseAnd:
+      case spv::OpGroupNonUniformBitwiseOr:
+      case spv::OpGroupNonUniformBitwiseXor:
+      case spv::OpGroupNonUniformLogicalAnd:
+      case spv::OpGroupNonUniformLogicalOr:
+      case spv::OpGroupNonUniformLogicalXor:
+        return index != 4;
+
+      case spv::OpSpecConstantOp:
+        return index != 3;
+
+      default:
+        break;
+    }
+
+    uint32_t imageOperandIndex = getImageOperandIndex(ins.op);
+    return index != imageOperandIndex;
+  }
+
+
+  bool SpirvOptimizer::isDebugOrDecoration(
+          spv::Op           op) {
+    return op == spv::OpName
+        || op == spv::OpMemberName
+        || op == spv::OpDecorate
+        || op == spv::OpMemberDecorate;
+  }
+
+
+  bool SpirvOptimizer::isConstant(
+          spv::Op           op) {
+    return op == spv::OpConstantTrue
+        || op == spv::OpConstantFalse
+        || op == spv::OpConstant
+        || op == spv::OpConstantComposite
+        || op == spv::OpConstantNull;
+  }
+
+
+  bool SpirvOptimizer::isPure(
+          spv::Op           op) {
+    switch (op) {
+      case spv::OpUndef:
+      case spv::OpLoad:
+      case spv::OpAccessChain:
+      case spv::OpArrayLength:
+      case spv::OpCopyObject:
+      case spv::OpCompositeConstruct:
+      case spv::OpCompositeExtract:
+      case spv::OpCompositeInsert:
+      case spv::OpVectorShuffle:
+      case spv::OpVectorExtractDynamic:
+      case spv::OpVectorInsertDynamic:
+      case spv::OpSampledImage:
+      case spv::OpImageSampleImplicitLod:
+      case spv::OpImageSampleExplicitLod:
+      case spv::OpImageSampleDrefImplicitLod:
+      case spv::OpImageSampleDrefExplicitLod:
+      case spv::OpImageSampleProjImplicitLod:
+      case spv::OpImageSampleProjExplicitLod:
+      case spv::OpImageSampleProjDrefImplicitLod:
+      case spv::OpImageSampleProjDrefExplicitLod:
+      case spv::OpImageFetch:
+      case spv::OpImageGather:
+      case spv::OpImageDrefGather:
+      case spv::OpImageRead:
+      case spv::OpImageTexelPointer:
+      case spv::OpImageQuerySize:
+      case spv::OpImageQuerySizeLod:
+      case spv::OpImageQueryLevels:
+      case spv::OpImageQueryLod:
+      case spv::OpImageQuerySamples:
+      case spv::OpConvertFToU:
+      case spv::OpConvertFToS:
+      case spv::OpConvertSToF:
+      case spv::OpConvertUToF:
+      case spv::OpFConvert:
+      case spv::OpBitcast:
+      case spv::OpSNegate:
+      case spv::OpFNegate:
+      case spv::OpIAdd:
+      case spv::OpFAdd:
+      case spv::OpISub:
+      case spv::OpFSub:
+      case spv::OpIMul:
+      case spv::OpFMul:
+      case spv::OpUDiv:
+      case spv::OpSDiv:
+      case spv::OpFDiv:
+      case spv::OpUMod:
+      case spv::OpSRem:
+      case spv::OpSMod:
+      case spv::OpFRem:
+      case spv::OpFMod:
+      case spv::OpVectorTimesScalar:
+      case spv::OpMatrixTimesScalar:
+      case spv::OpVectorTimesMatrix:
+      case spv::OpMatrixTimesVector:
+      case spv::OpMatrixTimesMatrix:
+      case spv::OpDot:
+      case spv::OpAny:
+      case spv::OpAll:
+      case spv::OpIsNan:
+      case spv::OpIsInf:
+      case spv::OpLogicalEqual:
+      case spv::OpLogicalNotEqual:
+      case spv::OpLogicalOr:
+      case spv::OpLogicalAnd:
+      case spv::OpLogicalNot:
+      case spv::OpSelect:
+      case spv::OpIEqual:
+      case spv::OpINotEqual:
+      case spv::OpUGreaterThan:
+      case spv::OpSGreaterThan:
+      case spv::OpUGreaterThanEqual:
+      case spv::OpSGreaterThanEqual:
+      case spv::OpULessThan:
+      case spv::OpSLessThan:
+      case spv::OpULessThanEqual:
+      case spv::OpSLessThanEqual:
+      case spv::OpFOrdEqual:
+      case spv::OpFUnordEqual:
+      case spv::OpFOrdNotEqual:
+      case spv::OpFUnordNotEqual:
+      case spv::OpFOrdLessThan:
+      case spv::OpFUnordLessThan:
+      case spv::OpFOrdGreaterThan:
+      case spv::OpFUnordGreaterThan:
+      case spv::OpFOrdLessThanEqual:
+      case spv::OpFUnordLessThanEqual:
+      case spv::OpFOrdGreaterThanEqual:
+      case spv::OpFUnordGreaterThanEqual:
+      case spv::OpShiftRightLogical:
+      case spv::OpShiftRightArithmetic:
+      case spv::OpShiftLeftLogical:
+      case spv::OpBitwiseOr:
+      case spv::OpBitwiseXor:
+      case spv::OpBitwiseAnd:
+      case spv::OpNot:
+      case spv::OpBitFieldInsert:
+      case spv::OpBitFieldSExtract:
+      case spv::OpBitFieldUExtract:
+      case spv::OpBitReverse:
+      case spv::OpBitCount:
+      case spv::OpDPdx:
+      case spv::OpDPdy:
+      case spv::OpFwidth:
+      case spv::OpDPdxFine:
+      case spv::OpDPdyFine:
+      case spv::OpFwidthFine:
+      case spv::OpDPdxCoarse:
+      case spv::OpDPdyCoarse:
+      case spv::OpFwidthCoarse:
+      case spv::OpPhi:
+      case spv::OpExtInst:
+        return true;
+
+      default:
+        return false;
+    }
+  }
+
+
+  bool SpirvOptimizer::isBlockTerminator(
+          spv::Op           op) {
+    return op == spv::OpBranch
+        || op == spv::OpBranchConditional
+        || op == spv::OpSwitch
+        || op == spv::OpReturn
+        || op == spv::OpReturnValue
+        || op == spv::OpKill
+        || op == spv::OpUnreachable;
+  }
+
+
+  uint32_t SpirvOptimizer::getImageOperandIndex(
+          spv::Op           op) {
+    switch (op) {
+      case spv::OpImageWrite:
+        return 4;
+
+      case spv::OpImageSampleImplicitLod:
+      case spv::OpImageSampleExplicitLod:
+      case spv::OpImageSampleProjImplicitLod:
+      case spv::OpImageSampleProjExplicitLod:
+      case spv::OpImageFetch:
+      case spv::OpImageRead:
+      case spv::OpImageSparseSampleImplicitLod:
+      case spv::OpImageSparseSampleExplicitLod:
+      case spv::OpImageSparseSampleProjImplicitLod:
+      case spv::OpImageSparseSampleProjExplicitLod:
+      case spv::OpImageSparseFetch:
+      case spv::OpImageSparseRead:
+        return 5;
+
+      case spv::OpImageSampleDrefImplicitLod:
+      case spv::OpImageSampleDrefExplicitLod:
+      case spv::OpImageSampleProjDrefImplicitLod:
+      case spv::OpImageSampleProjDrefExplicitLod:
+      case spv::OpImageGather:
+      case spv::OpImageDrefGather:
+      case spv::OpImageSparseSampleDrefImplicitLod:
+      case spv::OpImageSparseSampleDrefExplicitLod:
+      case spv::OpImageSparseSampleProjDrefImplicitLod:
+      case spv::OpImageSparseSampleProjDrefExplicitLod:
+      case spv::OpImageSparseGather:
+      case spv::OpImageSparseDrefGather:
+        return 6;
+
+      default:
+        return 0;
+    }
+  }
+
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "spirv_code_buffer.h"
+
+namespace dxvk {
+
+  /**
+   * \brief SPIR-V optimization passes
+   */
+  enum class SpirvPass : uint32_t {
+    /// Forwards values stored to private and function
+    /// variables to subsequent loads within the same
+    /// block, and removes stores that are never read.
+    PromoteRegisters  = 0,
+    /// Merges identical constant declarations
+    DedupConstants    = 1,
+    /// Replaces conditional branches on constant
+    /// conditions with unconditional branches
+    FoldBranches      = 2,
+    /// Removes unused constants, variables and
+    /// instructions without side effects
+    EliminateDeadCode = 3,
+  };
+
+  using SpirvPassFlags = Flags<SpirvPass>;
+
+
+  /**
+   * \brief SPIR-V optimizer statistics
+   */
+  struct SpirvOptimizerStats {
+    uint32_t insCountBefore   = 0;
+    uint32_t insCountAfter    = 0;
+    uint32_t dwordsBefore     = 0;
+    uint32_t dwordsAfter      = 0;
+    uint64_t timeUs           = 0;
+  };
+
+
+  /**
+   * \brief SPIR-V optimizer
+   *
+   * Runs a set of simple optimization passes on a
+   * complete SPIR-V module. The passes are tailored
+   * to the code generated by the DXBC compiler and
+   * are conservative, i.e. anything that is not
+   * fully understood by a pass is left untouched.
+   */
+  class SpirvOptimizer {
+
+  public:
+
+    SpirvOptimizer(SpirvPassFlags passes);
+    ~SpirvOptimizer();
+
+    /**
+     * \brief Optimizes a SPIR-V module
+     *
+     * \param [in] code The SPIR-V module, including header
+     * \returns Optimized SPIR-V module
+     */
+    SpirvCodeBuffer run(const SpirvCodeBuffer& code);
+
+    /**
+     * \brief Retrieves statistics of the last run
+     * \returns Optimizer statistics
+     */
+    SpirvOptimizerStats getStats() const {
+      return m_stats;
+    }
+
+  private:
+
+    struct Ins {
+      uint32_t offset;
+      uint32_t length;
+      uint32_t resultIndex;
+      spv::Op  op;
+      bool     removed;
+    };
+
+    SpirvPassFlags          m_passes;
+    SpirvOptimizerStats     m_stats;
+
+    std::vector<uint32_t>   m_code;
+    std::vector<Ins>        m_ins;
+
+    std::unordered_map<uint32_t, uint32_t> m_replace;
+
+    void parse(
+      const SpirvCodeBuffer&  code);
+
+    SpirvCodeBuffer emit() const;
+
+    void runDedupConstants();
+
+    void runPromoteRegisters();
+
+    void runFoldBranches();
+
+    void runEliminateDeadCode();
+
+    void applyReplacements();
+
+    uint32_t resolve(
+            uint32_t          id) const;
+
+    uint32_t getResultId(
+      const Ins&              ins) const;
+
+    bool isIdOperand(
+      const Ins&              ins,
+            uint32_t          index) const;
+
+    template<typename Fn>
+    void forEachIdOperand(
+      const Ins&              ins,
+            Fn&&              fn) {
+      for (uint32_t i = 1; i < ins.length; i++) {
+        if (isIdOperand(ins, i))
+          fn(m_code[ins.offset + i], i);
+      }
+    }
+
+    uint32_t arg(
+      const Ins&              ins,
+            uint32_t          index) const {
+      return index < ins.length ? m_code[ins.offset + index] : 0;
+    }
+
+    static bool isDebugOrDecoration(
+            spv::Op           op);
+
+    static bool isConstant(
+            spv::Op           op);
+
+    static bool isPure(
+            spv::Op           op);
+
+    static bool isBlockTerminator(
+            spv::Op           op);
+
+    static uint32_t getImageOperandIndex(
+            spv::Op           op);
+
+  };
+
+}
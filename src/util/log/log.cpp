@@ -5,13 +5,36 @@
 namespace dxvk {
   
   Logger::Logger(const std::string& file_name)
-  : m_minLevel(getMinLogLevel()) {
-    if (m_minLevel != LogLevel::None)
-      m_fileStream = std::ofstream(getFileName(file_name));
+  : m_minLevel(getMinLogLevel()), m_queue(new Queue()) {
+    if (m_minLevel != LogLevel::None) {
+      m_queue->fileStream = std::ofstream(getFileName(file_name));
+      m_queue->intervalStart = Clock::now();
+    }
   }
   
   
-  Logger::~Logger() { }
+  Logger::~Logger() {
+    // Don't take the queue lock here, the thread may already
+    // have been terminated if the process is exiting, and do
+    // not join it either since we may hold the loader lock.
+    // The thread keeps its own reference to the queue.
+    m_queue->stopped.store(true);
+    m_queue->cond.notify_one();
+
+    if (m_thread.joinable())
+      m_thread.detach();
+
+    // Write out any remaining messages on the calling thread. If
+    // the thread is busy writing, it will write them out before
+    // exiting. If it got terminated while writing, it will never
+    // release the lock, and the writer state cannot be trusted.
+    if (m_queue->writeMutex.try_lock()) {
+      m_queue->processMessages();
+      m_queue->endInterval();
+      m_queue->flushBuffer();
+      m_queue->writeMutex.unlock();
+    }
+  }
   
   
   void Logger::trace(const std::string& message) {
@@ -46,21 +69,168 @@ namespace dxvk {
   
   void Logger::emitMsg(LogLevel level, const std::string& message) {
     if (level >= m_minLevel) {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      
-      static std::array<const char*, 5> s_prefixes
-        = {{ "trace: ", "debug: ", "info:  ", "warn:  ", "err:   " }};
-      
-      const char* prefix = s_prefixes.at(static_cast<uint32_t>(level));
-
-      std::stringstream stream(message);
-      std::string       line;
-
-      while (std::getline(stream, line, '\n')) {
-        std::cerr    << prefix << line << std::endl;
-        m_fileStream << prefix << line << std::endl;
+      Message* msg = new Message { nullptr, level, message };
+      Message* head = m_queue->messages.load(std::memory_order_relaxed);
+
+      do {
+        msg->next = head;
+      } while (!m_queue->messages.compare_exchange_weak(head, msg,
+        std::memory_order_release, std::memory_order_relaxed));
+
+      if (!m_started.load(std::memory_order_acquire))
+        startThread();
+
+      // Write out errors before returning, since they are often
+      // the last messages logged before a crash. Pending messages
+      // are written first to preserve order. Warnings can occur
+      // on hot paths, so they are left to the thread.
+      if (level >= LogLevel::Error) {
+        std::lock_guard<std::mutex> lock(m_queue->writeMutex);
+        m_queue->processMessages();
+        m_queue->flushBuffer();
+        return;
+      }
+
+      // Only wake up the thread if the queue was empty, it
+      // drains all messages that are queued in one go.
+      if (!head) {
+        { std::lock_guard<std::mutex> lock(m_queue->mutex); }
+        m_queue->cond.notify_one();
+      }
+    }
+  }
+
+
+  void Logger::Queue::writeMsg(LogLevel level, const std::string& message) {
+    RepeatCount& entry = repeats.emplace(message,
+      RepeatCount { level, 0u, 0u }).first->second;
+
+    if (entry.count++ < RateLimitCount)
+      formatMsg(level, message);
+    else
+      entry.suppressed += 1;
+  }
+
+
+  void Logger::Queue::formatMsg(LogLevel level, const std::string& message) {
+    static std::array<const char*, 5> s_prefixes
+      = {{ "trace: ", "debug: ", "info:  ", "warn:  ", "err:   " }};
+    
+    const char* prefix = s_prefixes.at(static_cast<uint32_t>(level));
+
+    std::stringstream stream(message);
+    std::string       line;
+
+    while (std::getline(stream, line, '\n')) {
+      buffer += prefix;
+      buffer += line;
+      buffer += '\n';
+    }
+  }
+
+
+  void Logger::Queue::processMessages() {
+    auto now = Clock::now();
+
+    if (now - intervalStart >= RateLimitInterval) {
+      endInterval();
+      intervalStart = now;
+    }
+
+    // Producers push to the front of the list,
+    // so reverse it to restore message order
+    Message* list = messages.exchange(nullptr, std::memory_order_acquire);
+    Message* msg  = nullptr;
+
+    while (list) {
+      Message* next = list->next;
+      list->next = msg;
+      msg  = list;
+      list = next;
+    }
+
+    while (msg) {
+      Message* next = msg->next;
+      writeMsg(msg->level, msg->text);
+      delete msg;
+      msg = next;
+    }
+  }
+
+
+  void Logger::Queue::endInterval() {
+    for (const auto& entry : repeats) {
+      if (entry.second.suppressed) {
+        formatMsg(entry.second.level, str::format("Message repeated ",
+          entry.second.suppressed, " more times: ", entry.first));
       }
     }
+
+    repeats.clear();
+  }
+
+
+  void Logger::Queue::flushBuffer() {
+    if (buffer.empty())
+      return;
+
+    std::cerr << buffer;
+    std::cerr.flush();
+
+    fileStream << buffer;
+    fileStream.flush();
+
+    buffer.clear();
+  }
+
+
+  void Logger::startThread() {
+    std::lock_guard<std::mutex> lock(m_queue->mutex);
+
+    if (m_started.load() || m_queue->stopped.load())
+      return;
+
+    // Pin the module, since the thread is never joined and
+    // could otherwise still be running when it gets unloaded
+    HMODULE module = nullptr;
+
+    ::GetModuleHandleExW(
+      GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS |
+      GET_MODULE_HANDLE_EX_FLAG_PIN,
+      reinterpret_cast<LPCWSTR>(&s_instance), &module);
+
+    m_thread = dxvk::thread([queue = m_queue] () { threadFunc(queue); });
+    m_started.store(true, std::memory_order_release);
+  }
+
+
+  void Logger::threadFunc(const Rc<Queue>& queue) {
+    env::setThreadName("dxvk-log");
+
+    bool stopped = false;
+
+    while (!stopped) {
+      { std::unique_lock<std::mutex> lock(queue->mutex);
+
+        // Wake up periodically so that suppressed
+        // messages get reported in a timely manner
+        queue->cond.wait_for(lock, RateLimitInterval, [&queue] () {
+          return queue->messages.load() || queue->stopped.load();
+        });
+
+        stopped = queue->stopped.load();
+      }
+
+      // Write out remaining messages before exiting, in
+      // case the destructor could not do so in time
+      std::lock_guard<std::mutex> lock(queue->writeMutex);
+      queue->processMessages();
+
+      if (stopped)
+        queue->endInterval();
+
+      queue->flushBuffer();
+    }
   }
   
   
@@ -1,10 +1,16 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <fstream>
 #include <iostream>
 #include <mutex>
 #include <string>
+#include <unordered_map>
+
+#include "../thread.h"
 
 namespace dxvk {
   
@@ -22,9 +28,27 @@ namespace dxvk {
    * 
    * Logger for one DLL. Creates a text file and
    * writes all log messages to that file.
+   * 
+   * Messages are pushed to a lock-free queue and
+   * written in batches by a background thread, so
+   * that logging does not block the calling thread
+   * on file or console I/O. Errors are written out
+   * before the call returns, along with any messages
+   * queued before them. Identical messages are
+   * rate-limited, and the number of suppressed
+   * repetitions is reported once per interval.
+   * 
+   * The thread is started on the first message and
+   * never joined, since the logger is constructed
+   * and destroyed while the loader lock is held.
+   * It pins the module so that the code it runs
+   * cannot be unloaded while it is still alive.
    */
   class Logger {
+    using Clock = std::chrono::high_resolution_clock;
     
+    constexpr static uint32_t RateLimitCount = 16;
+    constexpr static auto RateLimitInterval = std::chrono::seconds(1);
   public:
     
     Logger(const std::string& file_name);
@@ -43,15 +67,65 @@ namespace dxvk {
     
   private:
     
+    struct Message {
+      Message*    next;
+      LogLevel    level;
+      std::string text;
+    };
+    
+    struct RepeatCount {
+      LogLevel    level;
+      uint32_t    count;
+      uint32_t    suppressed;
+    };
+    
+    /**
+     * \brief Shared logger state
+     * 
+     * Owned by both the logger and its thread, so that
+     * the thread never accesses destroyed objects when
+     * the logger gets destroyed while it is running.
+     */
+    struct Queue : public RcObject {
+      std::atomic<Message*>   messages = { nullptr };
+      std::atomic<bool>       stopped  = { false };
+      
+      std::mutex              mutex;
+      std::condition_variable cond;
+      
+      std::mutex              writeMutex;
+      
+      std::ofstream           fileStream;
+      std::string             buffer;
+      
+      std::unordered_map<std::string, RepeatCount> repeats;
+      Clock::time_point       intervalStart;
+      
+      void writeMsg(LogLevel level, const std::string& message);
+      
+      void formatMsg(LogLevel level, const std::string& message);
+      
+      void processMessages();
+      
+      void endInterval();
+      
+      void flushBuffer();
+    };
+    
     static Logger s_instance;
     
     const LogLevel m_minLevel;
     
-    std::mutex    m_mutex;
-    std::ofstream m_fileStream;
+    Rc<Queue>               m_queue;
+    std::atomic<bool>       m_started = { false };
+    dxvk::thread            m_thread;
     
     void emitMsg(LogLevel level, const std::string& message);
     
+    void startThread();
+    
+    static void threadFunc(const Rc<Queue>& queue);
+    
     static LogLevel getMinLogLevel();
     
     static std::string getFileName(
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <utility>
+
+#include "../util_math.h"
+
+namespace dxvk::sync {
+
+  /**
+   * \brief Lock-free ring buffer
+   *
+   * Bounded queue that can be written to by exactly
+   * one producer thread and read from by exactly one
+   * consumer thread without taking any locks. The
+   * number of entries must be a power of two.
+   * \tparam T Entry type
+   * \tparam N Number of entries
+   */
+  template<typename T, size_t N>
+  class RingBuffer {
+    static_assert((N & (N - 1)) == 0, "Ring buffer size must be a power of two");
+  public:
+
+    RingBuffer() { }
+    ~RingBuffer() { }
+
+    RingBuffer             (const RingBuffer&) = delete;
+    RingBuffer& operator = (const RingBuffer&) = delete;
+
+    /**
+     * \brief Adds an entry to the buffer
+     *
+     * Must only be called from the producer thread.
+     * \param [in] entry The entry to add
+     * \returns \c false if the buffer is full
+     */
+    bool tryPush(const T& entry) {
+      size_t wr = m_writeIndex.load(std::memory_order_relaxed);
+      size_t rd = m_readIndex.load(std::memory_order_acquire);
+
+      if (wr - rd >= N)
+        return false;
+
+      m_entries[wr & (N - 1)] = entry;
+      m_writeIndex.store(wr + 1, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * \brief Moves an entry into the buffer
+     *
+     * Must only be called from the producer thread.
+     * The entry is left untouched if the buffer is full.
+     * \param [in] entry The entry to add
+     * \returns \c false if the buffer is full
+     */
+    bool tryPush(T&& entry) {
+      size_t wr = m_writeIndex.load(std::memory_order_relaxed);
+      size_t rd = m_readIndex.load(std::memory_order_acquire);
+
+      if (wr - rd >= N)
+        return false;
+
+      m_entries[wr & (N - 1)] = std::move(entry);
+      m_writeIndex.store(wr + 1, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * \brief Removes an entry from the buffer
+     *
+     * Must only be called from the consumer thread.
+     * \param [out] entry The entry that was removed
+     * \returns \c false if the buffer is empty
+     */
+    bool tryPop(T& entry) {
+      size_t rd = m_readIndex.load(std::memory_order_relaxed);
+      size_t wr = m_writeIndex.load(std::memory_order_acquire);
+
+      if (rd == wr)
+        return false;
+
+      entry = std::move(m_entries[rd & (N - 1)]);
+      m_readIndex.store(rd + 1, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * \brief Total number of entries pushed so far
+     *
+     * Can be used by the consumer to determine how
+     * many entries it has to pop in order to catch
+     * up with a given point in the producer's timeline.
+     * \returns Write position
+     */
+    size_t writePos() const {
+      return m_writeIndex.load(std::memory_order_acquire);
+    }
+
+    /**
+     * \brief Total number of entries popped so far
+     * \returns Read position
+     */
+    size_t readPos() const {
+      return m_readIndex.load(std::memory_order_acquire);
+    }
+
+    /**
+     * \brief Checks whether the buffer is empty
+     * \returns \c true if there are no entries
+     */
+    bool empty() const {
+      return readPos() == writePos();
+    }
+
+  private:
+
+    std::array<T, N> m_entries;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_writeIndex = { 0 };
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_readIndex  = { 0 };
+
+  };
+
+}
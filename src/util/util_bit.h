@@ -62,6 +62,40 @@ namespace dxvk::bit {
     #endif
   }
 
+  inline uint32_t tzcnt64(uint64_t n) {
+    #if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+    unsigned long idx;
+    return _BitScanForward64(&idx, n) ? idx : 64;
+    #elif defined(__GNUC__) || defined(__clang__)
+    return n != 0 ? __builtin_ctzll(n) : 64;
+    #else
+    uint32_t lo = uint32_t(n);
+    return lo != 0 ? tzcnt(lo) : 32 + tzcnt(uint32_t(n >> 32));
+    #endif
+  }
+
+  /**
+   * \brief Index of the most significant set bit
+   *
+   * Undefined if no bit is set.
+   * \param [in] n Number to scan
+   * \returns Bit index
+   */
+  inline uint32_t bsr64(uint64_t n) {
+    #if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+    unsigned long idx;
+    _BitScanReverse64(&idx, n);
+    return idx;
+    #elif defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(n);
+    #else
+    uint32_t r = 0;
+    while (n >>= 1)
+      r += 1;
+    return r;
+    #endif
+  }
+
   template<typename T>
   uint32_t pack(T& dst, uint32_t& shift, T src, uint32_t count) {
     constexpr uint32_t Bits = 8 * sizeof(T);
@@ -0,0 +1,77 @@
+#include "util_file.h"
+#include "util_string.h"
+
+#include "./com/com_include.h"
+
+namespace dxvk {
+
+  MappedFile::MappedFile() {
+
+  }
+
+
+  MappedFile::~MappedFile() {
+    close();
+  }
+
+
+  bool MappedFile::open(const std::string& path) {
+    close();
+
+    // Allow other handles to append to the file, or
+    // to replace it entirely, while we have it mapped
+    HANDLE file = CreateFileW(str::tows(path).data(),
+      GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+      nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+      return false;
+
+    LARGE_INTEGER size;
+
+    if (!GetFileSizeEx(file, &size) || !size.QuadPart) {
+      CloseHandle(file);
+      return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file,
+      nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (!mapping) {
+      CloseHandle(file);
+      return false;
+    }
+
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (!data) {
+      CloseHandle(mapping);
+      CloseHandle(file);
+      return false;
+    }
+
+    m_file    = file;
+    m_mapping = mapping;
+    m_data    = reinterpret_cast<const char*>(data);
+    m_size    = size_t(size.QuadPart);
+    return true;
+  }
+
+
+  void MappedFile::close() {
+    if (m_data)
+      UnmapViewOfFile(m_data);
+
+    if (m_mapping)
+      CloseHandle(m_mapping);
+
+    if (m_file)
+      CloseHandle(m_file);
+
+    m_file    = nullptr;
+    m_mapping = nullptr;
+    m_data    = nullptr;
+    m_size    = 0;
+  }
+
+}
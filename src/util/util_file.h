@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+
+namespace dxvk {
+
+  /**
+   * \brief Read-only file mapping
+   *
+   * Maps the entire contents of a file into the
+   * address space of the process. The file can
+   * still be appended to by other handles while
+   * it is mapped, but the mapped range will not
+   * grow until the file is mapped again.
+   */
+  class MappedFile {
+
+  public:
+
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile             (const MappedFile&) = delete;
+    MappedFile& operator = (const MappedFile&) = delete;
+
+    /**
+     * \brief Maps a file
+     *
+     * Unmaps any previously mapped file.
+     * \param [in] path Path to the file
+     * \returns \c true if the file exists, is not
+     *    empty and could be mapped successfully
+     */
+    bool open(const std::string& path);
+
+    /**
+     * \brief Unmaps the file
+     */
+    void close();
+
+    /**
+     * \brief Pointer to mapped data
+     * \returns Pointer to the file contents
+     */
+    const char* data() const {
+      return m_data;
+    }
+
+    /**
+     * \brief Size of the mapped range
+     * \returns File size at the time of mapping
+     */
+    size_t size() const {
+      return m_size;
+    }
+
+  private:
+
+    void*       m_file    = nullptr;
+    void*       m_mapping = nullptr;
+    const char* m_data    = nullptr;
+    size_t      m_size    = 0;
+
+  };
+
+}
@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <vector>
+
+#include "util_env.h"
+#include "util_fps_limiter.h"
+
+#include "./log/log.h"
+
+namespace dxvk {
+
+  FpsLimiter::FpsLimiter()
+  : m_sleepThreshold(std::chrono::milliseconds(2)) {
+    std::string env = env::getEnvVar("DXVK_FRAME_RATE");
+
+    if (!env.empty()) {
+      try {
+        setTargetInterval(std::stod(env));
+        m_envOverride = true;
+      } catch (const std::exception&) {
+        Logger::warn(str::format("FpsLimiter: Invalid frame rate: ", env));
+      }
+    }
+  }
+
+
+  FpsLimiter::~FpsLimiter() {
+    m_targetInterval = Duration::zero();
+    updateTimerResolution();
+  }
+
+
+  void FpsLimiter::setTargetFrameRate(double frameRate) {
+    if (!m_envOverride)
+      setTargetInterval(frameRate);
+  }
+
+
+  void FpsLimiter::delay() {
+    if (!isEnabled())
+      return;
+
+    TimePoint now = Clock::now();
+
+    if (m_nextFrame == TimePoint() || now > m_nextFrame + m_targetInterval)
+      m_nextFrame = now;
+    else
+      wait(m_nextFrame);
+
+    m_lastTarget = m_nextFrame;
+    m_hasTarget  = true;
+
+    m_nextFrame += m_targetInterval;
+  }
+
+
+  void FpsLimiter::notifyPresent(TimePoint presentTime) {
+    if (!m_hasTarget)
+      return;
+
+    m_hasTarget = false;
+
+    // The time between reaching the target and the actual
+    // present is mostly constant, so track its average
+    // and only treat variations as deviation from target
+    Duration latency = std::chrono::duration_cast<Duration>(presentTime - m_lastTarget);
+
+    if (!m_hasLatency) {
+      m_presentLatency = latency;
+      m_hasLatency     = true;
+    }
+
+    Duration deviation = latency - m_presentLatency;
+    m_presentLatency += deviation / 16;
+
+    // Move the timeline by part of the deviation so that
+    // presents converge to evenly spaced target times
+    Duration maxCorrection = m_targetInterval / 8;
+
+    m_nextFrame -= std::max(-maxCorrection,
+      std::min(maxCorrection, deviation / 4));
+
+    uint64_t deviationUs = std::chrono::duration_cast<std::chrono::microseconds>(
+      deviation < Duration::zero() ? -deviation : deviation).count();
+
+    m_samples[m_sampleId] = uint32_t(std::min<uint64_t>(deviationUs, ~0u));
+    m_sampleId = (m_sampleId + 1) % SampleCount;
+    m_sampleCount = std::min(m_sampleCount + 1, SampleCount);
+  }
+
+
+  FpsLimiterStats FpsLimiter::getStats() const {
+    FpsLimiterStats result;
+    result.sampleCount = m_sampleCount;
+
+    if (!m_sampleCount)
+      return result;
+
+    std::vector<uint32_t> samples(m_samples.begin(), m_samples.begin() + m_sampleCount);
+
+    auto p50 = samples.begin() + (samples.size() * 50) / 100;
+    std::nth_element(samples.begin(), p50, samples.end());
+    result.p50Us = *p50;
+
+    auto p99 = samples.begin() + (samples.size() * 99) / 100;
+    std::nth_element(samples.begin(), p99, samples.end());
+    result.p99Us = *p99;
+    return result;
+  }
+
+
+  void FpsLimiter::setTargetInterval(double frameRate) {
+    Duration interval = frameRate > 0.0
+      ? Duration(int64_t(1'000'000'000.0 / frameRate))
+      : Duration::zero();
+
+    if (interval == m_targetInterval)
+      return;
+
+    m_targetInterval = interval;
+    m_nextFrame      = TimePoint();
+    m_hasTarget      = false;
+    m_hasLatency     = false;
+    m_sampleCount    = 0;
+    m_sampleId       = 0;
+
+    updateTimerResolution();
+
+    if (isEnabled())
+      Logger::info(str::format("FpsLimiter: Limiting frame rate to ", frameRate, " FPS"));
+  }
+
+
+  void FpsLimiter::updateTimerResolution() {
+    using NtSetTimerResolutionProc = LONG (WINAPI *) (ULONG, BOOLEAN, PULONG);
+
+    static auto proc = reinterpret_cast<NtSetTimerResolutionProc>(
+      ::GetProcAddress(::GetModuleHandleW(L"ntdll.dll"), "NtSetTimerResolution"));
+
+    if (m_timerRaised == isEnabled() || proc == nullptr)
+      return;
+
+    // Request 1ms resolution, in units of 100ns. Without this,
+    // sleeps are rounded up to the default tick of ~15.6ms,
+    // which is longer than most frame intervals.
+    ULONG currentResolution = 0;
+    LONG status = (*proc)(10000, !m_timerRaised, &currentResolution);
+
+    if (status < 0) {
+      Logger::warn(str::format("FpsLimiter: Failed to set timer resolution: ", status));
+      return;
+    }
+
+    m_timerRaised = !m_timerRaised;
+  }
+
+
+  void FpsLimiter::wait(TimePoint target) {
+    TimePoint now = Clock::now();
+
+    // Sleep while the remaining time is larger than the
+    // amount by which sleeps have been overshooting
+    while (target - now > m_sleepThreshold) {
+      auto sleepTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+        target - now - m_sleepThreshold);
+
+      if (!sleepTime.count())
+        break;
+
+      ::Sleep(DWORD(sleepTime.count()));
+
+      TimePoint then = Clock::now();
+
+      // Raise the threshold immediately if a sleep took
+      // longer than expected, and let it decay slowly
+      Duration overshoot = std::chrono::duration_cast<Duration>(then - now - sleepTime);
+      Duration threshold = std::max(overshoot, std::chrono::duration_cast<Duration>(
+        std::chrono::microseconds(500)));
+
+      m_sleepThreshold = threshold > m_sleepThreshold
+        ? threshold : m_sleepThreshold - (m_sleepThreshold - threshold) / 16;
+
+      // A single bad sleep must not turn the rest of
+      // the frame interval into a busy wait
+      m_sleepThreshold = std::min(m_sleepThreshold, m_targetInterval / 4);
+
+      now = then;
+    }
+
+    // Spin for the remaining time
+    while (Clock::now() < target)
+      dxvk::this_thread::yield();
+  }
+
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+
+namespace dxvk {
+
+  /**
+   * \brief Frame rate limiter statistics
+   *
+   * Deviation of actual present times from the
+   * limiter's target timeline over recent frames.
+   */
+  struct FpsLimiterStats {
+    /// Number of frames measured
+    uint32_t sampleCount = 0;
+    /// Median deviation, in microseconds
+    uint32_t p50Us = 0;
+    /// 99th percentile deviation, in microseconds
+    uint32_t p99Us = 0;
+  };
+
+
+  /**
+   * \brief Frame rate limiter
+   *
+   * Delays presentation so that frames are delivered
+   * at a fixed rate. Target times are kept on a fixed
+   * timeline rather than being derived from the time
+   * of the previous frame, so that errors in individual
+   * frames do not accumulate.
+   *
+   * Waits sleep for the bulk of the remaining time and
+   * spin for the rest, with the spin threshold adapting
+   * to the observed sleep accuracy of the system. The
+   * system timer resolution is raised while the limiter
+   * is enabled so that sleeps are reasonably accurate.
+   */
+  class FpsLimiter {
+    using Clock     = std::chrono::high_resolution_clock;
+    using TimePoint = Clock::time_point;
+    using Duration  = std::chrono::nanoseconds;
+
+    constexpr static uint32_t SampleCount = 256;
+  public:
+
+    FpsLimiter();
+    ~FpsLimiter();
+
+    /**
+     * \brief Sets target frame rate
+     *
+     * Ignored if the frame rate was set via the
+     * \c DXVK_FRAME_RATE environment variable.
+     * \param [in] frameRate Target frame rate, or
+     *    zero or a negative number to disable
+     */
+    void setTargetFrameRate(double frameRate);
+
+    /**
+     * \brief Checks whether the limiter is enabled
+     * \returns \c true if a frame rate is set
+     */
+    bool isEnabled() const {
+      return m_targetInterval.count() != 0;
+    }
+
+    /**
+     * \brief Waits for the next frame
+     *
+     * Blocks the calling thread until the target time
+     * of the next frame is reached. If the application
+     * fell behind by more than one frame, the timeline
+     * is restarted rather than presenting a burst of
+     * frames in order to catch up.
+     */
+    void delay();
+
+    /**
+     * \brief Reports actual present time
+     *
+     * Must be called with the time at which the frame
+     * passed to the last \c delay call got presented.
+     * Used to correct the timeline for presentation
+     * latency variations and to gather statistics.
+     * \param [in] presentTime Present timestamp
+     */
+    void notifyPresent(TimePoint presentTime);
+
+    /**
+     * \brief Retrieves limiter statistics
+     * \returns Deviation from target times
+     */
+    FpsLimiterStats getStats() const;
+
+  private:
+
+    Duration  m_targetInterval = Duration::zero();
+    bool      m_envOverride    = false;
+
+    TimePoint m_nextFrame      = TimePoint();
+    TimePoint m_lastTarget     = TimePoint();
+    bool      m_hasTarget      = false;
+
+    Duration  m_sleepThreshold;
+    bool      m_timerRaised    = false;
+
+    Duration  m_presentLatency = Duration::zero();
+    bool      m_hasLatency     = false;
+
+    std::array<uint32_t, SampleCount> m_samples;
+    uint32_t  m_sampleCount    = 0;
+    uint32_t  m_sampleId       = 0;
+
+    void setTargetInterval(double frameRate);
+
+    void updateTimerResolution();
+
+    void wait(TimePoint target);
+
+  };
+
+}
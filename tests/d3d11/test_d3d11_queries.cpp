@@ -0,0 +1,172 @@
+#include <array>
+#include <chrono>
+#include <vector>
+
+#include <d3d11.h>
+
+#include <windows.h>
+#include <windowsx.h>
+
+#include "../test_utils.h"
+
+using namespace dxvk;
+
+using Clock = std::chrono::high_resolution_clock;
+
+Com<ID3D11Device>           g_d3d11Device;
+Com<ID3D11DeviceContext>    g_d3d11Context;
+
+Com<ID3D11Texture2D>        g_renderTarget;
+Com<ID3D11Texture2D>        g_copyTarget;
+Com<ID3D11RenderTargetView> g_renderTargetView;
+
+/**
+ * \brief Queries used within one frame
+ *
+ * Frames are kept in flight for a few iterations,
+ * so that polling behaves like it would in a game
+ * which reads back results with some latency.
+ */
+struct FrameQueries {
+  std::vector<Com<ID3D11Query>> occlusion;
+  Com<ID3D11Query>              event;
+};
+
+constexpr uint32_t FrameCount      = 1000;
+constexpr uint32_t FramesInFlight  = 3;
+constexpr uint32_t QueriesPerFrame = 64;
+constexpr uint32_t PollsPerQuery   = 4;
+
+bool createQuery(D3D11_QUERY type, ID3D11Query** ppQuery) {
+  D3D11_QUERY_DESC desc;
+  desc.Query     = type;
+  desc.MiscFlags = 0;
+
+  return SUCCEEDED(g_d3d11Device->CreateQuery(&desc, ppQuery));
+}
+
+
+void recordFrame(FrameQueries& frame) {
+  const float color[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+  for (const auto& query : frame.occlusion) {
+    g_d3d11Context->Begin(query.ptr());
+    g_d3d11Context->ClearRenderTargetView(g_renderTargetView.ptr(), color);
+    g_d3d11Context->CopyResource(g_copyTarget.ptr(), g_renderTarget.ptr());
+    g_d3d11Context->End(query.ptr());
+  }
+
+  g_d3d11Context->End(frame.event.ptr());
+}
+
+
+uint32_t pollFrame(FrameQueries& frame) {
+  uint32_t available = 0;
+
+  // Poll each query a few times without flushing, the
+  // way games commonly check for occlusion results
+  for (uint32_t i = 0; i < PollsPerQuery; i++) {
+    for (const auto& query : frame.occlusion) {
+      UINT64 samples = 0;
+
+      if (g_d3d11Context->GetData(query.ptr(), &samples, sizeof(samples),
+          D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK)
+        available += 1;
+    }
+  }
+
+  return available;
+}
+
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  if (FAILED(D3D11CreateDevice(
+        nullptr, D3D_DRIVER_TYPE_HARDWARE,
+        nullptr, 0, nullptr, 0, D3D11_SDK_VERSION,
+        &g_d3d11Device, nullptr, &g_d3d11Context))) {
+    std::cerr << "Failed to create D3D11 device" << std::endl;
+    return 1;
+  }
+
+  D3D11_TEXTURE2D_DESC imageDesc;
+  imageDesc.Width          = 256;
+  imageDesc.Height         = 256;
+  imageDesc.MipLevels      = 1;
+  imageDesc.ArraySize      = 1;
+  imageDesc.Format         = DXGI_FORMAT_R8G8B8A8_UNORM;
+  imageDesc.SampleDesc     = { 1, 0 };
+  imageDesc.Usage          = D3D11_USAGE_DEFAULT;
+  imageDesc.BindFlags      = D3D11_BIND_RENDER_TARGET;
+  imageDesc.CPUAccessFlags = 0;
+  imageDesc.MiscFlags      = 0;
+
+  if (FAILED(g_d3d11Device->CreateTexture2D(&imageDesc, nullptr, &g_renderTarget))
+   || FAILED(g_d3d11Device->CreateTexture2D(&imageDesc, nullptr, &g_copyTarget))) {
+    std::cerr << "Failed to create images" << std::endl;
+    return 1;
+  }
+
+  if (FAILED(g_d3d11Device->CreateRenderTargetView(
+      g_renderTarget.ptr(), nullptr, &g_renderTargetView))) {
+    std::cerr << "Failed to create render target view" << std::endl;
+    return 1;
+  }
+
+  std::array<FrameQueries, FramesInFlight> frames;
+
+  for (auto& frame : frames) {
+    frame.occlusion.resize(QueriesPerFrame);
+
+    for (auto& query : frame.occlusion) {
+      if (!createQuery(D3D11_QUERY_OCCLUSION, &query)) {
+        std::cerr << "Failed to create occlusion query" << std::endl;
+        return 1;
+      }
+    }
+
+    if (!createQuery(D3D11_QUERY_EVENT, &frame.event)) {
+      std::cerr << "Failed to create event query" << std::endl;
+      return 1;
+    }
+  }
+
+  uint64_t available = 0;
+
+  auto t0 = Clock::now();
+
+  for (uint32_t i = 0; i < FrameCount; i++) {
+    FrameQueries& frame = frames[i % FramesInFlight];
+
+    // Wait for the oldest frame before reusing its queries
+    if (i >= FramesInFlight) {
+      BOOL done = FALSE;
+
+      while (g_d3d11Context->GetData(frame.event.ptr(), &done, sizeof(done), 0) != S_OK)
+        continue;
+    }
+
+    recordFrame(frame);
+
+    // Poll the queries of the previous frame, which are
+    // most likely still pending on the CS thread or GPU
+    if (i > 0)
+      available += pollFrame(frames[(i - 1) % FramesInFlight]);
+
+    g_d3d11Context->Flush();
+  }
+
+  auto t1 = Clock::now();
+
+  auto totalTime = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0);
+
+  std::cout << FrameCount << " frames, "
+            << QueriesPerFrame << " queries per frame, "
+            << PollsPerQuery << " polls per query" << std::endl;
+  std::cout << "Average frame time: " << totalTime.count() / FrameCount << " us" << std::endl;
+  std::cout << "Results available on poll: " << available << " of "
+            << uint64_t(FrameCount - 1) * QueriesPerFrame * PollsPerQuery << std::endl;
+  return 0;
+}
@@ -0,0 +1,286 @@
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "../../src/dxbc/dxbc_module.h"
+#include "../../src/dxbc/dxbc_names.h"
+#include "../../src/dxvk/dxvk_shader.h"
+
+#include "../../src/spirv/spirv_optimizer.h"
+
+#include "../../src/util/thread.h"
+
+#include <shellapi.h>
+#include <windows.h>
+#include <windowsx.h>
+#include <psapi.h>
+
+namespace dxvk {
+  Logger Logger::s_instance("dxbc-batch.log");
+}
+
+using namespace dxvk;
+
+using Clock = std::chrono::high_resolution_clock;
+
+/**
+ * \brief Per-shader result
+ *
+ * Times are in microseconds, sizes in bytes. SPIR-V
+ * statistics are gathered before and after running
+ * the SPIR-V optimizer.
+ */
+struct ShaderResult {
+  std::string     name;
+  std::string     stage;
+  bool            success         = false;
+  uint64_t        parseTime       = 0;
+  uint64_t        compileTime     = 0;
+  uint64_t        optimizeTime    = 0;
+  uint32_t        instructions    = 0;
+  size_t          dxbcSize        = 0;
+  size_t          spirvSize       = 0;
+  uint32_t        spirvIns        = 0;
+  size_t          optSpirvSize    = 0;
+  uint32_t        optSpirvIns     = 0;
+};
+
+
+uint32_t countInstructions(SpirvCodeBuffer& code) {
+  uint32_t count = 0;
+
+  for (auto i = code.begin(); i != code.end(); ++i)
+    count += 1;
+
+  return count;
+}
+
+
+std::vector<char> readFile(const std::string& fileName) {
+  std::ifstream ifile(fileName, std::ios::binary);
+  ifile.ignore(std::numeric_limits<std::streamsize>::max());
+  std::streamsize length = ifile.gcount();
+  ifile.clear();
+
+  ifile.seekg(0, std::ios_base::beg);
+  std::vector<char> data(length);
+  ifile.read(data.data(), length);
+  return data;
+}
+
+
+std::vector<std::string> findShaders(const std::string& directory) {
+  std::vector<std::string> result;
+
+  WIN32_FIND_DATAW findData;
+  HANDLE handle = FindFirstFileW(
+    str::tows(str::format(directory, "/*.dxbc")).data(), &findData);
+
+  if (handle == INVALID_HANDLE_VALUE)
+    return result;
+
+  do {
+    if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+      result.push_back(str::fromws(findData.cFileName));
+  } while (FindNextFileW(handle, &findData));
+
+  FindClose(handle);
+  return result;
+}
+
+
+ShaderResult compileShader(
+  const std::string&    directory,
+  const std::string&    name) {
+  ShaderResult result;
+  result.name = name;
+
+  try {
+    std::vector<char> dxbcCode = readFile(str::format(directory, "/", name));
+    result.dxbcSize = dxbcCode.size();
+
+    auto t0 = Clock::now();
+
+    DxbcReader reader(dxbcCode.data(), dxbcCode.size());
+    DxbcModule module(reader);
+
+    auto t1 = Clock::now();
+
+    DxbcModuleInfo moduleInfo;
+    moduleInfo.options.useSubgroupOpsForAtomicCounters = true;
+    moduleInfo.options.useDemoteToHelperInvocation = true;
+    moduleInfo.options.minSsboAlignment = 4;
+    moduleInfo.xfb = nullptr;
+
+    Rc<DxvkShader> shader = module.compile(moduleInfo, name);
+
+    auto t2 = Clock::now();
+
+    result.parseTime    = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+    result.compileTime  = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
+    result.stage        = str::format(module.programInfo().type());
+    result.instructions = module.instructionCount();
+    // Optimize separately so that the unoptimized
+    // code can be reported for comparison as well
+    SpirvCodeBuffer code = shader->getCode();
+
+    SpirvOptimizer optimizer(SpirvPassFlags(
+      SpirvPass::PromoteRegisters,
+      SpirvPass::DedupConstants,
+      SpirvPass::FoldBranches,
+      SpirvPass::EliminateDeadCode));
+
+    SpirvCodeBuffer optCode = optimizer.run(code);
+
+    result.optimizeTime = optimizer.getStats().timeUs;
+    result.spirvSize    = code.size();
+    result.spirvIns     = countInstructions(code);
+    result.optSpirvSize = optCode.size();
+    result.optSpirvIns  = countInstructions(optCode);
+    result.success      = true;
+  } catch (const DxvkError& e) {
+    Logger::err(str::format(name, ": ", e.message()));
+  }
+
+  return result;
+}
+
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  int     argc = 0;
+  LPWSTR* argv = CommandLineToArgvW(
+    GetCommandLineW(), &argc);
+
+  if (argc < 2) {
+    Logger::err("Usage: dxbc-batch directory [threads] [output.csv]");
+    return 1;
+  }
+
+  std::string directory = str::fromws(argv[1]);
+  uint32_t    numThreads = dxvk::thread::hardware_concurrency();
+
+  if (argc >= 3)
+    numThreads = std::max(std::stoi(str::fromws(argv[2])), 1);
+
+  std::vector<std::string> names = findShaders(directory);
+
+  if (names.empty()) {
+    Logger::err(str::format("No .dxbc files found in ", directory));
+    return 1;
+  }
+
+  std::vector<ShaderResult> results(names.size());
+  std::atomic<size_t> nextShader = { 0 };
+
+  auto t0 = Clock::now();
+
+  std::vector<dxvk::thread> threads;
+
+  for (uint32_t i = 0; i < numThreads; i++) {
+    threads.emplace_back([&] () {
+      size_t index;
+
+      while ((index = nextShader++) < names.size())
+        results[index] = compileShader(directory, names[index]);
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  auto t1 = Clock::now();
+
+  // Aggregate statistics. The CPU time is the sum of all
+  // per-shader times, the wall time includes threading.
+  uint64_t parseTime    = 0;
+  uint64_t compileTime  = 0;
+  uint64_t optimizeTime = 0;
+  uint64_t instructions = 0;
+  uint64_t dxbcSize     = 0;
+  uint64_t spirvSize    = 0;
+  uint64_t spirvIns     = 0;
+  uint64_t optSpirvSize = 0;
+  uint64_t optSpirvIns  = 0;
+  uint32_t numFailed    = 0;
+
+  for (const auto& r : results) {
+    if (!r.success) {
+      numFailed += 1;
+      continue;
+    }
+
+    parseTime    += r.parseTime;
+    compileTime  += r.compileTime;
+    optimizeTime += r.optimizeTime;
+    instructions += r.instructions;
+    dxbcSize     += r.dxbcSize;
+    spirvSize    += r.spirvSize;
+    spirvIns     += r.spirvIns;
+    optSpirvSize += r.optSpirvSize;
+    optSpirvIns  += r.optSpirvIns;
+  }
+
+  uint64_t wallTime = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+
+  PROCESS_MEMORY_COUNTERS memCounters = { };
+  memCounters.cb = sizeof(memCounters);
+  K32GetProcessMemoryInfo(GetCurrentProcess(), &memCounters, sizeof(memCounters));
+
+  std::ofstream ofile;
+
+  if (argc >= 4)
+    ofile.open(str::fromws(argv[3]));
+
+  std::ostream& out = ofile.is_open() ? ofile : std::cout;
+
+  out << "name,stage,status,parse_us,compile_us,optimize_us,instructions,dxbc_bytes,"
+         "spirv_bytes,spirv_ins,opt_spirv_bytes,opt_spirv_ins" << std::endl;
+
+  for (const auto& r : results) {
+    out << r.name << ","
+        << r.stage << ","
+        << (r.success ? "ok" : "failed") << ","
+        << r.parseTime << ","
+        << r.compileTime << ","
+        << r.optimizeTime << ","
+        << r.instructions << ","
+        << r.dxbcSize << ","
+        << r.spirvSize << ","
+        << r.spirvIns << ","
+        << r.optSpirvSize << ","
+        << r.optSpirvIns << std::endl;
+  }
+
+  out << "total,,"
+      << results.size() - numFailed << "/" << results.size() << ","
+      << parseTime << ","
+      << compileTime << ","
+      << optimizeTime << ","
+      << instructions << ","
+      << dxbcSize << ","
+      << spirvSize << ","
+      << spirvIns << ","
+      << optSpirvSize << ","
+      << optSpirvIns << std::endl;
+
+  Logger::info(str::format(
+    "Compiled ", results.size() - numFailed, " of ", results.size(),
+    " shaders on ", numThreads, " threads in ", wallTime / 1000, " ms (",
+    compileTime ? instructions * 1000000 / compileTime : 0, " instructions/s)"));
+  Logger::info(str::format(
+    "SPIR-V optimizer: ", spirvIns, " -> ", optSpirvIns, " instructions in ",
+    optimizeTime / 1000, " ms"));
+  Logger::info(str::format(
+    "Peak working set: ", memCounters.PeakWorkingSetSize >> 10, " kB"));
+
+  out << "# threads=" << numThreads
+      << ",wall_us=" << wallTime
+      << ",peak_working_set_bytes=" << memCounters.PeakWorkingSetSize << std::endl;
+
+  return numFailed ? 1 : 0;
+}
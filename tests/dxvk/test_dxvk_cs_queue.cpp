@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <queue>
+#include <vector>
+
+#include "../../src/dxvk/dxvk_cs.h"
+
+#include <windows.h>
+
+namespace dxvk {
+  Logger Logger::s_instance("dxvk-cs-queue.log");
+}
+
+using namespace dxvk;
+
+using Clock = std::chrono::high_resolution_clock;
+
+/**
+ * \brief Mutex-based CS thread
+ *
+ * Copy of the previous CS thread implementation,
+ * which passes chunks through a locked std::queue,
+ * used as a baseline for the lock-free version.
+ */
+class LegacyCsThread {
+
+public:
+
+  LegacyCsThread()
+  : m_thread([this] { threadFunc(); }) { }
+
+  ~LegacyCsThread() {
+    { std::unique_lock<std::mutex> lock(m_mutex);
+      m_stopped.store(true);
+    }
+
+    m_condOnAdd.notify_one();
+    m_thread.join();
+  }
+
+  void dispatchChunk(DxvkCsChunkRef&& chunk) {
+    { std::unique_lock<std::mutex> lock(m_mutex);
+      m_chunksQueued.push(std::move(chunk));
+      m_chunksPending += 1;
+    }
+
+    m_condOnAdd.notify_one();
+  }
+
+  void synchronize() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    m_condOnSync.wait(lock, [this] {
+      return !m_chunksPending.load();
+    });
+  }
+
+private:
+
+  std::atomic<bool>           m_stopped = { false };
+  std::mutex                  m_mutex;
+  std::condition_variable     m_condOnAdd;
+  std::condition_variable     m_condOnSync;
+  std::queue<DxvkCsChunkRef>  m_chunksQueued;
+  std::atomic<uint32_t>       m_chunksPending = { 0u };
+  dxvk::thread                m_thread;
+
+  void threadFunc() {
+    DxvkCsChunkRef chunk;
+
+    while (!m_stopped.load()) {
+      { std::unique_lock<std::mutex> lock(m_mutex);
+        if (chunk) {
+          if (--m_chunksPending == 0)
+            m_condOnSync.notify_one();
+
+          chunk = DxvkCsChunkRef();
+        }
+
+        if (m_chunksQueued.size() == 0) {
+          m_condOnAdd.wait(lock, [this] {
+            return (m_chunksQueued.size() != 0)
+                || (m_stopped.load());
+          });
+        }
+
+        if (m_chunksQueued.size() != 0) {
+          chunk = std::move(m_chunksQueued.front());
+          m_chunksQueued.pop();
+        }
+      }
+
+      if (chunk)
+        chunk->executeAll(nullptr);
+    }
+  }
+
+};
+
+
+/**
+ * \brief Lock-free CS thread
+ *
+ * Thin wrapper so that both implementations
+ * can be constructed the same way.
+ */
+class LockFreeCsThread : public DxvkCsThread {
+
+public:
+
+  LockFreeCsThread()
+  : DxvkCsThread(nullptr) { }
+
+};
+
+
+struct BenchmarkResult {
+  double chunksPerSecond;
+  double latencyAvgUs;
+  double latencyP99Us;
+};
+
+
+template<typename CsThread>
+BenchmarkResult runBenchmark(
+        uint32_t              chunkCount,
+        uint32_t              commandsPerChunk,
+        uint32_t              latencyRuns) {
+  DxvkCsChunkPool pool;
+  CsThread thread;
+
+  BenchmarkResult result = { };
+
+  // Throughput: dispatch many small chunks back to back,
+  // which is what the D3D11 immediate context does when
+  // an app issues lots of draws with frequent flushes.
+  std::atomic<uint64_t> counter = { 0ull };
+
+  auto t0 = Clock::now();
+
+  for (uint32_t i = 0; i < chunkCount; i++) {
+    DxvkCsChunk* chunk = pool.allocChunk(DxvkCsChunkFlag::SingleUse);
+
+    for (uint32_t j = 0; j < commandsPerChunk; j++) {
+      auto command = [&counter] (DxvkContext*) {
+        counter.fetch_add(1, std::memory_order_relaxed);
+      };
+
+      chunk->push(command);
+    }
+
+    thread.dispatchChunk(DxvkCsChunkRef(chunk, &pool));
+  }
+
+  thread.synchronize();
+
+  auto t1 = Clock::now();
+
+  if (counter.load() != uint64_t(chunkCount) * commandsPerChunk)
+    Logger::err("Command count mismatch");
+
+  result.chunksPerSecond = double(chunkCount)
+    / std::chrono::duration<double>(t1 - t0).count();
+
+  // Latency: time between dispatching a chunk and the
+  // worker starting to execute it, with the worker idle
+  std::vector<double> latencies;
+  latencies.reserve(latencyRuns);
+
+  for (uint32_t i = 0; i < latencyRuns; i++) {
+    Clock::time_point execTime;
+
+    DxvkCsChunk* chunk = pool.allocChunk(DxvkCsChunkFlag::SingleUse);
+
+    auto command = [&execTime] (DxvkContext*) {
+      execTime = Clock::now();
+    };
+
+    chunk->push(command);
+
+    auto dispatchTime = Clock::now();
+    thread.dispatchChunk(DxvkCsChunkRef(chunk, &pool));
+    thread.synchronize();
+
+    latencies.push_back(std::chrono::duration<double, std::micro>(
+      execTime - dispatchTime).count());
+
+    // Give the worker a chance to go idle every now and then
+    if (i & 1)
+      Sleep(1);
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+
+  double sum = 0.0;
+
+  for (double l : latencies)
+    sum += l;
+
+  result.latencyAvgUs = sum / double(latencies.size());
+  result.latencyP99Us = latencies[(latencies.size() * 99) / 100];
+  return result;
+}
+
+
+void printResult(
+  const char*                 name,
+  const BenchmarkResult&      result) {
+  std::cout << name << ": "
+    << uint64_t(result.chunksPerSecond) << " chunks/s, latency avg "
+    << result.latencyAvgUs << " us, p99 "
+    << result.latencyP99Us << " us" << std::endl;
+}
+
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  constexpr uint32_t ChunkCount       = 200000;
+  constexpr uint32_t CommandsPerChunk = 8;
+  constexpr uint32_t LatencyRuns      = 1000;
+
+  for (uint32_t i = 0; i < 3; i++) {
+    printResult("mutex    ", runBenchmark<LegacyCsThread>  (ChunkCount, CommandsPerChunk, LatencyRuns));
+    printResult("lock-free", runBenchmark<LockFreeCsThread>(ChunkCount, CommandsPerChunk, LatencyRuns));
+  }
+
+  return 0;
+}
@@ -0,0 +1,165 @@
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../../src/dxvk/dxvk_graphics.h"
+
+#include <windows.h>
+
+namespace dxvk {
+  Logger Logger::s_instance("dxvk-pipeline-lookup.log");
+}
+
+using namespace dxvk;
+
+using Clock = std::chrono::high_resolution_clock;
+
+/**
+ * \brief Linear instance list
+ *
+ * Mirrors the previous pipeline instance lookup,
+ * which compared each state vector in order.
+ */
+class LegacyInstanceList {
+
+public:
+
+  void insert(
+    const DxvkGraphicsPipelineStateInfo&  state,
+    const DxvkRenderPass*                 rp) {
+    m_instances.push_back({ state, rp });
+  }
+
+  const DxvkGraphicsPipelineStateInfo* find(
+    const DxvkGraphicsPipelineStateInfo&  state,
+    const DxvkRenderPass*                 rp) const {
+    for (const auto& instance : m_instances) {
+      if (instance.rp == rp && instance.state == state)
+        return &instance.state;
+    }
+
+    return nullptr;
+  }
+
+private:
+
+  struct Instance {
+    DxvkGraphicsPipelineStateInfo state;
+    const DxvkRenderPass*         rp;
+  };
+
+  std::deque<Instance> m_instances;
+
+};
+
+
+DxvkGraphicsPipelineStateInfo randomState(std::mt19937& rng, uint32_t index) {
+  DxvkGraphicsPipelineStateInfo state;
+  state.iaPrimitiveTopology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+  state.ilAttributeCount    = 4;
+  state.ilBindingCount      = 1;
+  state.rsViewportCount     = 1;
+  state.msSampleMask        = 1;
+
+  for (uint32_t i = 0; i < state.ilAttributeCount; i++) {
+    state.ilAttributes[i].location = i;
+    state.ilAttributes[i].format   = VK_FORMAT_R32G32B32A32_SFLOAT;
+    state.ilAttributes[i].offset   = 16 * i;
+  }
+
+  // Variants typically differ in a few fields near the
+  // end of the state vector, which is the worst case
+  // for a byte-wise comparison
+  std::uniform_int_distribution<uint32_t> blend(0, 1);
+
+  state.dsEnableDepthTest = blend(rng);
+  state.omBlendAttachments[0].blendEnable    = blend(rng);
+  state.omBlendAttachments[0].colorWriteMask = 0xF;
+  state.scSpecConstants[0] = index;
+  return state;
+}
+
+
+bool runBenchmark(uint32_t variantCount) {
+  constexpr uint32_t LookupCount = 1000000;
+
+  std::mt19937 rng(variantCount);
+  std::vector<DxvkGraphicsPipelineStateInfo> states;
+
+  for (uint32_t i = 0; i < variantCount; i++)
+    states.push_back(randomState(rng, i));
+
+  // Render passes are only compared by address
+  const DxvkRenderPass* rp = nullptr;
+
+  LegacyInstanceList              legacy;
+  DxvkGraphicsPipelineInstanceSet hashed;
+
+  for (const auto& state : states) {
+    legacy.insert(state, rp);
+    hashed.insert(state, rp,
+      DxvkGraphicsPipelineInstanceSet::computeHash(state, rp),
+      DxvkGraphicsPipelineInstanceStatus::Ready);
+  }
+
+  std::vector<uint32_t> lookups(LookupCount);
+  std::uniform_int_distribution<uint32_t> index(0, variantCount - 1);
+
+  for (auto& lookup : lookups)
+    lookup = index(rng);
+
+  uint32_t legacyHits = 0;
+  uint32_t hashedHits = 0;
+
+  auto t0 = Clock::now();
+
+  for (uint32_t lookup : lookups)
+    legacyHits += legacy.find(states[lookup], rp) != nullptr;
+
+  auto t1 = Clock::now();
+
+  // Hashing is part of the lookup cost
+  for (uint32_t lookup : lookups) {
+    size_t hash = DxvkGraphicsPipelineInstanceSet::computeHash(states[lookup], rp);
+    hashedHits += hashed.find(states[lookup], rp, hash) != nullptr;
+  }
+
+  auto t2 = Clock::now();
+
+  auto legacyTime = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0);
+  auto hashedTime = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1);
+
+  std::cout << variantCount << " variants: "
+            << "linear " << legacyTime.count() / LookupCount << " ns, "
+            << "hashed " << hashedTime.count() / LookupCount << " ns per lookup" << std::endl;
+
+  if (legacyHits != LookupCount || hashedHits != LookupCount) {
+    std::cerr << "Lookup failed" << std::endl;
+    return false;
+  }
+
+  // States that were never added must not be found
+  DxvkGraphicsPipelineStateInfo missing = randomState(rng, variantCount);
+
+  if (hashed.find(missing, rp, DxvkGraphicsPipelineInstanceSet::computeHash(missing, rp))) {
+    std::cerr << "Found state that was not added" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  for (uint32_t variantCount : { 10u, 100u, 1000u }) {
+    if (!runBenchmark(variantCount))
+      return 1;
+  }
+
+  return 0;
+}
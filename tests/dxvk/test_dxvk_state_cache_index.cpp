@@ -0,0 +1,114 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#include "../../src/dxvk/dxvk_state_cache_file.h"
+
+#include <windows.h>
+
+namespace dxvk {
+  Logger Logger::s_instance("dxvk-state-cache-index.log");
+}
+
+using namespace dxvk;
+
+constexpr uint32_t PipelineCount = 16;
+constexpr uint32_t StatesPerPipeline = 4;
+constexpr uint32_t AppendedCount = 8;
+
+const char* g_fileName = "dxvk-state-cache-index.dxvk-cache";
+
+DxvkStateCacheEntry createEntry(uint32_t pipeline, uint32_t state) {
+  DxvkStateCacheEntry entry;
+  entry.shaders.vs = DxvkShaderKey(VK_SHADER_STAGE_VERTEX_BIT,
+    Sha1Hash::compute(&pipeline, sizeof(pipeline)));
+  entry.gpState.iaPrimitiveTopology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+  entry.gpState.scSpecConstants[0]  = state;
+  return entry;
+}
+
+
+bool corruptFile(size_t offset) {
+  std::vector<char> data;
+
+  { std::ifstream file(g_fileName, std::ios_base::binary);
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+
+  if (offset >= data.size())
+    return false;
+
+  data[offset] ^= 0x55;
+
+  std::ofstream file(g_fileName, std::ios_base::binary | std::ios_base::trunc);
+  file.write(data.data(), data.size());
+  return bool(file);
+}
+
+
+bool check(const char* name, bool condition) {
+  std::cout << name << ": " << (condition ? "passed" : "FAILED") << std::endl;
+  return condition;
+}
+
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  std::vector<DxvkStateCacheEntry> entries;
+
+  for (uint32_t i = 0; i < PipelineCount; i++) {
+    for (uint32_t j = 0; j < StatesPerPipeline; j++)
+      entries.push_back(createEntry(i, j));
+  }
+
+  if (!DxvkStateCacheFile::writeFile(g_fileName, entries)) {
+    std::cerr << "Failed to write " << g_fileName << std::endl;
+    return 1;
+  }
+
+  // Append entries the way the state cache does
+  // when new pipelines are compiled during a session
+  { std::ofstream file(g_fileName, std::ios_base::binary | std::ios_base::app);
+
+    for (uint32_t i = 0; i < AppendedCount; i++) {
+      DxvkStateCacheEntry entry = createEntry(PipelineCount + i, 0);
+      DxvkStateCacheFile::writeEntry(file, entry);
+    }
+  }
+
+  const size_t totalCount = entries.size() + AppendedCount;
+  bool success = true;
+
+  { DxvkStateCacheFile file;
+
+    success &= check("Open valid file", file.open(g_fileName));
+    success &= check("Indexed entries", file.indexedEntryCount() == entries.size());
+    success &= check("Unindexed entries", file.unindexedEntries().size() == AppendedCount);
+    success &= check("Read all entries", file.readAllEntries().size() == totalCount);
+  }
+
+  // Corrupt the first pipeline bucket, which invalidates
+  // the index but leaves all entries intact
+  size_t bucketOffset = sizeof(DxvkStateCacheHeader)
+                      + sizeof(DxvkStateCacheIndexHeader);
+
+  if (!corruptFile(bucketOffset)) {
+    std::cerr << "Failed to corrupt " << g_fileName << std::endl;
+    return 1;
+  }
+
+  { DxvkStateCacheFile file;
+
+    success &= check("Open corrupted file", file.open(g_fileName));
+    success &= check("Index discarded", file.indexedEntryCount() == 0);
+    success &= check("Needs compaction", file.needsCompaction());
+    success &= check("Read all entries", file.readAllEntries().size() == totalCount);
+  }
+
+  std::remove(g_fileName);
+  return success ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+#include <iostream>
+#include <vector>
+
+#include "../../src/dxvk/dxvk_state_cache_file.h"
+
+#include <shellapi.h>
+#include <windows.h>
+
+namespace dxvk {
+  Logger Logger::s_instance("dxvk-cache-tool.log");
+}
+
+using namespace dxvk;
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  int     argc = 0;
+  LPWSTR* argv = CommandLineToArgvW(
+    GetCommandLineW(), &argc);
+
+  if (argc < 3) {
+    Logger::err("Usage: dxvk-cache-tool output.dxvk-cache input.dxvk-cache [...]");
+    return 1;
+  }
+
+  // Read all inputs before writing the output,
+  // so that the output can also be an input
+  std::vector<DxvkStateCacheEntry> entries;
+
+  for (int i = 2; i < argc; i++) {
+    std::string ifileName = str::fromws(argv[i]);
+    DxvkStateCacheFile ifile;
+
+    if (!ifile.open(ifileName)) {
+      Logger::err(str::format("Failed to read ", ifileName));
+      return 1;
+    }
+
+    std::vector<DxvkStateCacheEntry> fileEntries = ifile.readAllEntries();
+    entries.insert(entries.end(), fileEntries.begin(), fileEntries.end());
+
+    std::cout << ifileName << ": " << fileEntries.size() << " entries" << std::endl;
+  }
+
+  std::string ofileName = str::fromws(argv[1]);
+
+  if (!DxvkStateCacheFile::writeFile(ofileName, entries)) {
+    Logger::err(str::format("Failed to write ", ofileName));
+    return 1;
+  }
+
+  DxvkStateCacheFile ofile;
+
+  if (!ofile.open(ofileName)) {
+    Logger::err(str::format("Failed to verify ", ofileName));
+    return 1;
+  }
+
+  std::cout << ofileName << ": " << ofile.indexedEntryCount() << " entries" << std::endl;
+  return 0;
+}
@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../../src/dxvk/dxvk_tlsf.h"
+
+#include <windows.h>
+
+namespace dxvk {
+  Logger Logger::s_instance("dxvk-tlsf.log");
+}
+
+using namespace dxvk;
+
+using Clock = std::chrono::high_resolution_clock;
+
+/**
+ * \brief Linear free list
+ *
+ * Copy of the previous worst-fit chunk allocator,
+ * used as a baseline for the TLSF allocator.
+ */
+class LegacyFreeList {
+
+public:
+
+  LegacyFreeList(VkDeviceSize size) {
+    m_freeList.push_back({ 0, size });
+  }
+
+  VkDeviceSize alloc(VkDeviceSize size, VkDeviceSize align, VkDeviceSize& length) {
+    if (m_freeList.empty())
+      return DxvkTlsfAllocator::InvalidOffset;
+
+    auto bestSlice = m_freeList.begin();
+
+    for (auto slice = m_freeList.begin(); slice != m_freeList.end(); slice++) {
+      if (slice->length == size) {
+        bestSlice = slice;
+        break;
+      } else if (slice->length > bestSlice->length) {
+        bestSlice = slice;
+      }
+    }
+
+    const VkDeviceSize sliceStart = bestSlice->offset;
+    const VkDeviceSize sliceEnd   = bestSlice->offset + bestSlice->length;
+
+    const VkDeviceSize allocStart = dxvk::align(sliceStart,        align);
+    const VkDeviceSize allocEnd   = dxvk::align(allocStart + size, align);
+
+    if (allocEnd > sliceEnd)
+      return DxvkTlsfAllocator::InvalidOffset;
+
+    m_freeList.erase(bestSlice);
+
+    if (allocStart != sliceStart)
+      m_freeList.push_back({ sliceStart, allocStart - sliceStart });
+
+    if (allocEnd != sliceEnd)
+      m_freeList.push_back({ allocEnd, sliceEnd - allocEnd });
+
+    length = allocEnd - allocStart;
+    return allocStart;
+  }
+
+  void free(VkDeviceSize offset, VkDeviceSize length) {
+    auto curr = m_freeList.begin();
+
+    while (curr != m_freeList.end()) {
+      if (curr->offset == offset + length) {
+        length += curr->length;
+        curr = m_freeList.erase(curr);
+      } else if (curr->offset + curr->length == offset) {
+        offset -= curr->length;
+        length += curr->length;
+        curr = m_freeList.erase(curr);
+      } else {
+        curr++;
+      }
+    }
+
+    m_freeList.push_back({ offset, length });
+  }
+
+private:
+
+  struct FreeSlice {
+    VkDeviceSize offset;
+    VkDeviceSize length;
+  };
+
+  std::vector<FreeSlice> m_freeList;
+
+};
+
+
+struct Allocation {
+  VkDeviceSize offset;
+  VkDeviceSize length;
+};
+
+
+VkDeviceSize randomSize(std::mt19937& rng) {
+  // Mostly small buffers, some large textures
+  std::uniform_int_distribution<uint32_t> kind(0, 9);
+  std::uniform_int_distribution<uint32_t> small(1, 64 << 10);
+  std::uniform_int_distribution<uint32_t> large(256 << 10, 8 << 20);
+  return kind(rng) < 8 ? small(rng) : large(rng);
+}
+
+
+VkDeviceSize randomAlign(std::mt19937& rng) {
+  static const VkDeviceSize aligns[] = { 16, 256, 4096, 65536 };
+  std::uniform_int_distribution<uint32_t> index(0, 3);
+  return aligns[index(rng)];
+}
+
+
+bool testCorrectness() {
+  constexpr VkDeviceSize ChunkSize = 128 << 20;
+
+  DxvkTlsfAllocator allocator(ChunkSize);
+  std::vector<Allocation> allocs;
+  std::mt19937 rng(1);
+
+  for (uint32_t i = 0; i < 200000; i++) {
+    std::uniform_int_distribution<uint32_t> op(0, 2);
+
+    if (allocs.empty() || op(rng) != 0) {
+      VkDeviceSize size  = randomSize(rng);
+      VkDeviceSize align = randomAlign(rng);
+      VkDeviceSize length = 0;
+      VkDeviceSize offset = allocator.alloc(size, align, length);
+
+      if (offset == DxvkTlsfAllocator::InvalidOffset)
+        continue;
+
+      if (offset % align || length < size || offset + length > ChunkSize) {
+        std::cerr << "Invalid allocation at " << offset << std::endl;
+        return false;
+      }
+
+      allocs.push_back({ offset, length });
+    } else {
+      std::uniform_int_distribution<size_t> index(0, allocs.size() - 1);
+      size_t idx = index(rng);
+
+      allocator.free(allocs[idx].offset);
+      allocs[idx] = allocs.back();
+      allocs.pop_back();
+    }
+  }
+
+  // Check that no two live allocations overlap
+  std::sort(allocs.begin(), allocs.end(),
+    [] (const Allocation& a, const Allocation& b) { return a.offset < b.offset; });
+
+  for (size_t i = 1; i < allocs.size(); i++) {
+    if (allocs[i - 1].offset + allocs[i - 1].length > allocs[i].offset) {
+      std::cerr << "Overlapping allocations at " << allocs[i].offset << std::endl;
+      return false;
+    }
+  }
+
+  DxvkTlsfStats stats = allocator.getStats();
+  std::cout << "Live allocations: " << allocs.size()
+            << ", free blocks: " << stats.freeBlockCount
+            << ", free: " << (stats.freeSize >> 20) << " MB"
+            << ", largest free block: " << (stats.largestFreeBlock >> 20) << " MB" << std::endl;
+
+  // Freeing everything must coalesce the chunk into a single block
+  for (const auto& a : allocs)
+    allocator.free(a.offset);
+
+  stats = allocator.getStats();
+
+  if (!allocator.isEmpty() || stats.freeBlockCount != 1 || stats.largestFreeBlock != ChunkSize) {
+    std::cerr << "Free blocks were not merged" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+
+template<typename Alloc, typename Free>
+void benchmark(const char* name, const Alloc& alloc, const Free& free) {
+  std::vector<Allocation> allocs;
+  std::mt19937 rng(2);
+
+  auto t0 = Clock::now();
+
+  for (uint32_t i = 0; i < 100000; i++) {
+    std::uniform_int_distribution<uint32_t> op(0, 2);
+
+    if (allocs.empty() || op(rng) != 0) {
+      VkDeviceSize length = 0;
+      VkDeviceSize offset = alloc(randomSize(rng) / 16, randomAlign(rng), length);
+
+      if (offset != DxvkTlsfAllocator::InvalidOffset)
+        allocs.push_back({ offset, length });
+    } else {
+      std::uniform_int_distribution<size_t> index(0, allocs.size() - 1);
+      size_t idx = index(rng);
+
+      free(allocs[idx]);
+      allocs[idx] = allocs.back();
+      allocs.pop_back();
+    }
+  }
+
+  auto t1 = Clock::now();
+  auto td = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0);
+
+  std::cout << name << ": " << td.count() << " us, "
+            << allocs.size() << " live allocations" << std::endl;
+}
+
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  if (!testCorrectness())
+    return 1;
+
+  constexpr VkDeviceSize ChunkSize = 1ull << 30;
+
+  DxvkTlsfAllocator tlsf(ChunkSize);
+  LegacyFreeList    legacy(ChunkSize);
+
+  benchmark("Free list",
+    [&] (VkDeviceSize size, VkDeviceSize align, VkDeviceSize& length) { return legacy.alloc(size, align, length); },
+    [&] (const Allocation& a) { legacy.free(a.offset, a.length); });
+
+  benchmark("TLSF",
+    [&] (VkDeviceSize size, VkDeviceSize align, VkDeviceSize& length) { return tlsf.alloc(size, align, length); },
+    [&] (const Allocation& a) { tlsf.free(a.offset); });
+
+  return 0;
+}